@@ -0,0 +1,37 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _GNU_FCNTL_H_
+#define _GNU_FCNTL_H_
+
+
+#include_next <fcntl.h>
+#include <features.h>
+
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+
+#ifdef _DEFAULT_SOURCE
+
+
+/* flags for splice() */
+#define SPLICE_F_MOVE		0x01	/* ignored, pages are never moved */
+#define SPLICE_F_NONBLOCK	0x02	/* do not block on the target */
+#define SPLICE_F_MORE		0x04	/* ignored */
+#define SPLICE_F_GIFT		0x08	/* ignored */
+
+
+__BEGIN_DECLS
+
+extern ssize_t splice(int inFD, off_t* inOffset, int outFD, off_t* outOffset,
+	size_t length, unsigned int flags);
+
+__END_DECLS
+
+
+#endif
+
+
+#endif	/* _GNU_FCNTL_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright 2020, Haiku, Inc. All rights reserved.
+ * Copyright 2020-2026, Haiku, Inc. All rights reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef _NETINET_UDP_H
@@ -14,4 +14,7 @@ struct udphdr {
 	uint16_t uh_sum;
 };
 
+/* options for the IPPROTO_UDP level */
+#define UDP_GRO		104	/* coalesce received datagrams of the same flow */
+
 #endif /* _NETINET_UDP_H */
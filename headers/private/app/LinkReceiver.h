@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2006, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -17,6 +18,7 @@
 class BGradient;
 class BString;
 class BRegion;
+struct link_ring_header;
 
 
 namespace BPrivate {
@@ -29,6 +31,8 @@ class LinkReceiver {
 		void SetPort(port_id port);
 		port_id	Port(void) const { return fReceivePort; }
 
+		status_t SetRing(void* ring, size_t size);
+
 		status_t GetNextMessage(int32& code, bigtime_t timeout = B_INFINITE_TIMEOUT);
 		bool HasMessages() const;
 		bool NeedsReply() const;
@@ -48,6 +52,7 @@ class LinkReceiver {
 		virtual status_t ReadFromPort(bigtime_t timeout);
 		virtual status_t AdjustReplyBuffer(bigtime_t timeout);
 		void ResetBuffer();
+		void ReleaseRingBatch();
 
 		port_id fReceivePort;
 
@@ -60,6 +65,12 @@ class LinkReceiver {
 		int32	fReplySize;	//size of current reply message
 
 		status_t fReadError;	//Read failed for current message
+
+		link_ring_header* fRing;
+		char*	fRingData;
+		uint32	fRingSize;
+		char*	fPortBuffer;	//our buffer, while fRecvBuffer is in the ring
+		uint32	fRingRelease;	//ring position to release after the batch
 };
 
 }	// namespace BPrivate
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2005, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -14,6 +15,9 @@
 #include <OS.h>
 
 
+struct link_ring_header;
+
+
 namespace BPrivate {
 	
 class LinkSender {
@@ -27,6 +31,8 @@ class LinkSender {
 		team_id TargetTeam() const;
 		void SetTargetTeam(team_id team);
 
+		status_t SetRing(void* ring, size_t size);
+
 		status_t StartMessage(int32 code, size_t minSize = 0);
 		void CancelMessage(void);
 		status_t EndMessage(bool needsReply = false);
@@ -46,12 +52,22 @@ class LinkSender {
 
 		status_t AdjustBuffer(size_t newBufferSize, char **_oldBuffer = NULL);
 		status_t FlushCompleted(size_t newBufferSize);
+		bool ReserveRingBuffer(size_t minSize);
 
 		port_id	fPort;
 		team_id fTargetTeam;
 
 		char	*fBuffer;
 		size_t	fBufferSize;
+		char	*fHeapBuffer;
+		size_t	fHeapBufferSize;
+
+		link_ring_header *fRing;
+		char	*fRingData;
+		size_t	fRingSize;
+		uint32	fRingOffset;		// where the next batch starts
+		uint32	fRingPosition;		// same, but counting all bytes ever used
+		bool	fBufferInRing;
 
 		uint32	fCurrentEnd;		// current append position
 		uint32	fCurrentStart;		// start of current message
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2016, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -374,6 +375,13 @@ enum {
 	AS_VIEW_CLIP_TO_RECT,
 	AS_VIEW_CLIP_TO_SHAPE,
 
+	// debugging helper, appended to keep the codes above stable
+	AS_DUMP_FONT_CACHE,
+
+	AS_SET_RETAIN_WINDOW_CONTENTS,
+	AS_GET_RETAIN_WINDOW_CONTENTS,
+	AS_DUMP_REDRAWS,
+
 	AS_LAST_CODE
 };
 
@@ -2,6 +2,7 @@
  * Copyright 2001-2014, Axel Dörfler, axeld@pinc-software.de.
  * Copyright 2010, Clemens Zeidler <haiku@clemens-zeidler.de>
  * Copyright 2011, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 #ifndef _FILE_SYSTEMS_QUERY_PARSER_H
@@ -20,6 +21,7 @@
 // are.
 
 #ifdef FS_SHELL
+#	include <algorithm>
 #	include <new>
 
 #	include "fssh_api_wrapper.h"
@@ -76,6 +78,7 @@ template<typename QueryPolicy> class Equation;
 template<typename QueryPolicy> class Expression;
 template<typename QueryPolicy> class Term;
 template<typename QueryPolicy> class Query;
+class NodeIDSet;
 
 
 enum ops {
@@ -108,6 +111,50 @@ union value {
 };
 
 
+/*!	A sorted set of node IDs, as collected by scanning an index.
+
+	When a query combines several indexed terms with "and", only one of the
+	indices is iterated, and every candidate found there had to be loaded to
+	evaluate the other terms. Instead, the planner collects the IDs of the
+	nodes matching the other terms from their own indices, and uses the
+	intersection of those sets to drop candidates without loading them.
+	The sets are bounded by kMaxCount; terms that match more nodes than that
+	are evaluated the old way.
+*/
+class NodeIDSet {
+public:
+	static const int32		kMaxCount = 65536;
+
+public:
+	inline					NodeIDSet();
+	inline					~NodeIDSet();
+
+	inline	status_t		Add(ino_t id);
+	inline	void			Finish();
+	inline	void			MakeEmpty();
+
+	inline	bool			Contains(ino_t id) const;
+			int32			Count() const { return fCount; }
+			ino_t			IDAt(int32 index) const { return fIDs[index]; }
+
+	inline	void			Adopt(NodeIDSet& other);
+	inline	void			Intersect(const NodeIDSet& other);
+	inline	status_t		Unite(const NodeIDSet& other);
+
+private:
+							NodeIDSet(const NodeIDSet& other);
+							NodeIDSet& operator=(const NodeIDSet& other);
+								// no implementation
+
+	inline	status_t		_Resize(int32 capacity);
+
+private:
+			ino_t*			fIDs;
+			int32			fCount;
+			int32			fCapacity;
+};
+
+
 template<typename QueryPolicy>
 class Query {
 public:
@@ -146,8 +193,12 @@ public:
 			uint32			Flags() const
 								{ return fFlags; }
 
+private:
+	static	const int32		kFilterScoreFactor = 4;
+
 private:
 			status_t		_GetNextEntry(struct dirent* dirent, size_t size);
+			void			_PrepareFilter();
 			void			_EvaluateLiveUpdate(Entry* entry, Node* node,
 								const char* attribute, int32 type,
 								const uint8* oldKey, size_t oldLength,
@@ -163,6 +214,11 @@ private:
 			IndexIterator*	fIterator;
 			Index			fIndex;
 			Stack<Equation<QueryPolicy>*> fStack;
+			NodeIDSet		fFilter;
+			bool			fHasFilter;
+			NodeIDSet		fCandidates;
+			int32			fCandidateIndex;
+			bool			fHasCandidates;
 
 			uint32			fFlags;
 			port_id			fPort;
@@ -201,6 +257,8 @@ public:
 	virtual	void		CalculateScore(Index& index) = 0;
 	virtual	int32		Score() const = 0;
 
+	virtual	status_t	CollectNodeIDs(Context* context, NodeIDSet& set) = 0;
+
 	virtual	status_t	InitCheck() = 0;
 
 	virtual	bool		NeedsEntry() = 0;
@@ -255,11 +313,17 @@ public:
 			status_t	PrepareQuery(Context* context, Index& index,
 							IndexIterator** iterator, bool queryNonIndexed);
 			status_t	GetNextMatching(Context* context,
-							IndexIterator* iterator, struct dirent* dirent,
-							size_t bufferSize);
+							IndexIterator* iterator, const NodeIDSet* filter,
+							struct dirent* dirent, size_t bufferSize);
+			status_t	GetNextCandidate(Context* context,
+							const NodeIDSet& candidates, int32& index,
+							struct dirent* dirent, size_t bufferSize);
 
 	virtual	void		CalculateScore(Index &index);
 	virtual	int32		Score() const { return fScore; }
+			bool		UsesTrigrams() const { return fUseTrigrams; }
+
+	virtual	status_t	CollectNodeIDs(Context* context, NodeIDSet& set);
 
 	virtual	bool		NeedsEntry();
 
@@ -276,6 +340,17 @@ private:
 			bool		CompareTo(const uint8* value, size_t size);
 			uint8*		Value() const { return (uint8*)&fValue; }
 
+			void		_CalculateIndexScore(Index& index);
+			int32		_CalculateTrigramScore(Index& index);
+			status_t	_CollectTrigramNodeIDs(Context* context,
+							NodeIDSet& set);
+			status_t	_CollectKeyNodeIDs(Index& index,
+							const uint8* key, size_t keyLength,
+							NodeIDSet& ids);
+			status_t	_MatchEntry(Context* context, Entry* entry,
+							bool matchSelf, struct dirent* dirent,
+							size_t bufferSize);
+
 			char*		fAttribute;
 			char*		fString;
 			union value<QueryPolicy> fValue;
@@ -285,6 +360,10 @@ private:
 
 			int32		fScore;
 			bool		fHasIndex;
+
+			uint32*		fTrigrams;
+			int32		fTrigramCount;
+			bool		fUseTrigrams;
 };
 
 
@@ -316,6 +395,8 @@ public:
 	virtual	void		CalculateScore(Index& index);
 	virtual	int32		Score() const;
 
+	virtual	status_t	CollectNodeIDs(Context* context, NodeIDSet& set);
+
 	virtual	status_t	InitCheck();
 
 	virtual	bool		NeedsEntry();
@@ -366,6 +447,136 @@ private:
 //	#pragma mark -
 
 
+NodeIDSet::NodeIDSet()
+	:
+	fIDs(NULL),
+	fCount(0),
+	fCapacity(0)
+{
+}
+
+
+NodeIDSet::~NodeIDSet()
+{
+	free(fIDs);
+}
+
+
+/*!	Adds \a id to the set. Finish() must be called once all IDs have been
+	added, before the set can be used.
+*/
+status_t
+NodeIDSet::Add(ino_t id)
+{
+	if (fCount == fCapacity) {
+		if (fCapacity == kMaxCount)
+			return B_BUFFER_OVERFLOW;
+
+		status_t status = _Resize(fCapacity == 0 ? 256
+			: min_c(fCapacity * 2, kMaxCount));
+		if (status != B_OK)
+			return status;
+	}
+
+	fIDs[fCount++] = id;
+	return B_OK;
+}
+
+
+/*!	Sorts the IDs, and removes duplicates, as a node can be found more than
+	once in an index.
+*/
+void
+NodeIDSet::Finish()
+{
+	std::sort(fIDs, fIDs + fCount);
+	fCount = std::unique(fIDs, fIDs + fCount) - fIDs;
+}
+
+
+void
+NodeIDSet::MakeEmpty()
+{
+	free(fIDs);
+	fIDs = NULL;
+	fCount = 0;
+	fCapacity = 0;
+}
+
+
+bool
+NodeIDSet::Contains(ino_t id) const
+{
+	return std::binary_search(fIDs, fIDs + fCount, id);
+}
+
+
+/*!	Takes over the IDs of \a other, which is left empty. */
+void
+NodeIDSet::Adopt(NodeIDSet& other)
+{
+	free(fIDs);
+	fIDs = other.fIDs;
+	fCount = other.fCount;
+	fCapacity = other.fCapacity;
+
+	other.fIDs = NULL;
+	other.fCount = 0;
+	other.fCapacity = 0;
+}
+
+
+/*!	Removes all IDs that are not in \a other as well. */
+void
+NodeIDSet::Intersect(const NodeIDSet& other)
+{
+	fCount = std::set_intersection(fIDs, fIDs + fCount, other.fIDs,
+		other.fIDs + other.fCount, fIDs) - fIDs;
+}
+
+
+/*!	Adds all IDs of \a other. Fails with \c B_BUFFER_OVERFLOW if the
+	resulting set would exceed kMaxCount entries.
+*/
+status_t
+NodeIDSet::Unite(const NodeIDSet& other)
+{
+	if (other.fCount == 0)
+		return B_OK;
+	if (fCount + other.fCount > kMaxCount)
+		return B_BUFFER_OVERFLOW;
+
+	ino_t* ids = (ino_t*)malloc((fCount + other.fCount) * sizeof(ino_t));
+	if (ids == NULL)
+		return B_NO_MEMORY;
+
+	int32 count = std::set_union(fIDs, fIDs + fCount, other.fIDs,
+		other.fIDs + other.fCount, ids) - ids;
+
+	free(fIDs);
+	fIDs = ids;
+	fCapacity = fCount + other.fCount;
+	fCount = count;
+	return B_OK;
+}
+
+
+status_t
+NodeIDSet::_Resize(int32 capacity)
+{
+	ino_t* ids = (ino_t*)realloc(fIDs, capacity * sizeof(ino_t));
+	if (ids == NULL)
+		return B_NO_MEMORY;
+
+	fIDs = ids;
+	fCapacity = capacity;
+	return B_OK;
+}
+
+
+//	#pragma mark -
+
+
 template<typename QueryPolicy>
 Equation<QueryPolicy>::Equation(const char** expr)
 	:
@@ -374,7 +585,10 @@ Equation<QueryPolicy>::Equation(const char** expr)
 	fString(NULL),
 	fType(0),
 	fIsPattern(false),
-	fScore(INT32_MAX)
+	fScore(INT32_MAX),
+	fTrigrams(NULL),
+	fTrigramCount(0),
+	fUseTrigrams(false)
 {
 	const char* string = *expr;
 	const char* start = string;
@@ -503,6 +717,7 @@ Equation<QueryPolicy>::~Equation()
 {
 	free(fAttribute);
 	free(fString);
+	free(fTrigrams);
 }
 
 
@@ -761,6 +976,19 @@ Equation<QueryPolicy>::Match(Entry* entry, Node* node,
 template<typename QueryPolicy>
 void
 Equation<QueryPolicy>::CalculateScore(Index &index)
+{
+	_CalculateIndexScore(index);
+
+	int32 trigramScore = _CalculateTrigramScore(index);
+	fUseTrigrams = trigramScore < fScore;
+	if (fUseTrigrams)
+		fScore = trigramScore;
+}
+
+
+template<typename QueryPolicy>
+void
+Equation<QueryPolicy>::_CalculateIndexScore(Index &index)
 {
 	// As always, these values could be tuned and refined.
 	// And the code could also need some real world testing :-)
@@ -778,6 +1006,12 @@ Equation<QueryPolicy>::CalculateScore(Index &index)
 		return;
 	}
 
+	// fSize is only known once the value has been converted to the type of
+	// the index
+	if (ConvertValue(QueryPolicy::IndexGetType(index),
+			QueryPolicy::IndexGetKeySize(index)) != B_OK)
+		return;
+
 	// if we have a pattern, how much does it help our search?
 	if (fIsPattern) {
 		const int32 firstSymbolIndex = getFirstPatternSymbol(fString);
@@ -798,6 +1032,43 @@ Equation<QueryPolicy>::CalculateScore(Index &index)
 }
 
 
+/*!	Returns the score of answering this equation via the trigram index of
+	its attribute, or INT32_MAX if that is not possible. This is the case
+	for patterns that contain at least three consecutive fixed characters,
+	ignoring their case.
+	A trigram index is only used once it is known to list all nodes; one
+	that has just been created misses the values that were written before.
+*/
+template<typename QueryPolicy>
+int32
+Equation<QueryPolicy>::_CalculateTrigramScore(Index& index)
+{
+	if (!QueryPolicy::kHasTrigramIndices || !fIsPattern
+		|| Term<QueryPolicy>::fOp != OP_EQUAL)
+		return INT32_MAX;
+
+	char name[QueryPolicy::kMaxFileNameLength];
+	if (getTrigramIndexName(fAttribute, name, sizeof(name)) != B_OK
+		|| QueryPolicy::IndexSetTo(index, name) != B_OK
+		|| !QueryPolicy::IndexHasAllTrigrams(index))
+		return INT32_MAX;
+
+	if (fTrigrams == NULL) {
+		fTrigrams = (uint32*)malloc(kMaxTrigrams * sizeof(uint32));
+		if (fTrigrams == NULL)
+			return INT32_MAX;
+
+		fTrigramCount = getPatternTrigrams(fString, fTrigrams, kMaxTrigrams);
+	}
+	if (fTrigramCount == 0)
+		return INT32_MAX;
+
+	// Every trigram only covers a small part of the index, and the more
+	// trigrams there are, the fewer nodes will contain all of them
+	return QueryPolicy::IndexGetSize(index) / 16 + fTrigramCount;
+}
+
+
 template<typename QueryPolicy>
 status_t
 Equation<QueryPolicy>::PrepareQuery(Context* /*context*/, Index& index,
@@ -894,7 +1165,8 @@ Equation<QueryPolicy>::PrepareQuery(Context* /*context*/, Index& index,
 template<typename QueryPolicy>
 status_t
 Equation<QueryPolicy>::GetNextMatching(Context* context,
-	IndexIterator* iterator, struct dirent* dirent, size_t bufferSize)
+	IndexIterator* iterator, const NodeIDSet* filter, struct dirent* dirent,
+	size_t bufferSize)
 {
 	while (true) {
 		NodeHolder nodeHolder;
@@ -924,6 +1196,12 @@ Equation<QueryPolicy>::GetNextMatching(Context* context,
 			continue;
 		}
 
+		if (filter != NULL
+			&& !filter->Contains(QueryPolicy::IndexIteratorGetNodeID(iterator))) {
+			// the indices of the other terms already ruled this node out
+			continue;
+		}
+
 		Entry* entry = NULL;
 		status = QueryPolicy::IndexIteratorGetEntry(context, iterator,
 			nodeHolder, &entry);
@@ -932,70 +1210,107 @@ Equation<QueryPolicy>::GetNextMatching(Context* context,
 			continue;
 		}
 
-		// TODO: check user permissions here - but which one?!
-		// we could filter out all those where we don't have
-		// read access... (we should check for every parent
-		// directory if the X_OK is allowed)
-		// Although it's quite expensive to open all parents,
-		// it's likely that the application that runs the
-		// query will do something similar (and we don't have
-		// to do it for root, either).
-
-		// go up in the tree until a &&-operator is found, and check if the
-		// node matches with the rest of the expression - we don't have to
-		// check ||-operators for that
-		Term<QueryPolicy>* term = this;
-		status = MATCH_OK;
-
-		if (!fHasIndex)
-			status = Match(entry, QueryPolicy::EntryGetNode(entry));
-
-		while (term != NULL && status == MATCH_OK) {
-			Operator<QueryPolicy>* parent
-				= (Operator<QueryPolicy>*)term->Parent();
-			if (parent == NULL)
-				break;
+		if (_MatchEntry(context, entry, !fHasIndex, dirent, bufferSize)
+				== MATCH_OK) {
+			return B_OK;
+		}
+	}
+	QUERY_RETURN_ERROR(B_ERROR);
+}
 
-			if (parent->Op() == OP_AND) {
-				// choose the other child of the parent
-				Term<QueryPolicy>* other = parent->Right();
-				if (other == term)
-					other = parent->Left();
 
-				if (other == NULL) {
-					QUERY_FATAL("&&-operator has only one child... "
-						"(parent = %p)\n", parent);
-					break;
-				}
-				status = other->Match(entry, QueryPolicy::EntryGetNode(entry));
-				if (status < 0) {
-					QUERY_REPORT_ERROR(status);
-					status = NO_MATCH;
-				}
-			}
-			term = (Term<QueryPolicy>*)parent;
+template<typename QueryPolicy>
+status_t
+Equation<QueryPolicy>::GetNextCandidate(Context* context,
+	const NodeIDSet& candidates, int32& index, struct dirent* dirent,
+	size_t bufferSize)
+{
+	while (index < candidates.Count()) {
+		NodeHolder nodeHolder;
+		Entry* entry = NULL;
+		if (QueryPolicy::ContextGetEntry(context, candidates.IDAt(index++),
+				nodeHolder, &entry) != B_OK) {
+			continue;
 		}
 
-		if (status == MATCH_OK) {
-			ssize_t nameLength = QueryPolicy::EntryGetName(entry,
-				dirent->d_name,
-				(const char*)dirent + bufferSize - dirent->d_name);
-			if (nameLength < 0) {
-				// Invalid or unknown name.
-				nameLength = 0;
+		if (_MatchEntry(context, entry, true, dirent, bufferSize) == MATCH_OK)
+			return B_OK;
+	}
+
+	return B_ENTRY_NOT_FOUND;
+}
+
+
+/*!	Checks if \a entry matches the whole expression, and fills in \a dirent
+	if it does. The equation itself is only evaluated if \a matchSelf is
+	\c true, ie. if the index did not already decide about it.
+*/
+template<typename QueryPolicy>
+status_t
+Equation<QueryPolicy>::_MatchEntry(Context* context, Entry* entry,
+	bool matchSelf, struct dirent* dirent, size_t bufferSize)
+{
+	// TODO: check user permissions here - but which one?!
+	// we could filter out all those where we don't have
+	// read access... (we should check for every parent
+	// directory if the X_OK is allowed)
+	// Although it's quite expensive to open all parents,
+	// it's likely that the application that runs the
+	// query will do something similar (and we don't have
+	// to do it for root, either).
+
+	// go up in the tree until a &&-operator is found, and check if the
+	// node matches with the rest of the expression - we don't have to
+	// check ||-operators for that
+	Term<QueryPolicy>* term = this;
+	status_t status = MATCH_OK;
+
+	if (matchSelf)
+		status = Match(entry, QueryPolicy::EntryGetNode(entry));
+
+	while (term != NULL && status == MATCH_OK) {
+		Operator<QueryPolicy>* parent
+			= (Operator<QueryPolicy>*)term->Parent();
+		if (parent == NULL)
+			break;
+
+		if (parent->Op() == OP_AND) {
+			// choose the other child of the parent
+			Term<QueryPolicy>* other = parent->Right();
+			if (other == term)
+				other = parent->Left();
+
+			if (other == NULL) {
+				QUERY_FATAL("&&-operator has only one child... "
+					"(parent = %p)\n", parent);
+				break;
+			}
+			status = other->Match(entry, QueryPolicy::EntryGetNode(entry));
+			if (status < 0) {
+				QUERY_REPORT_ERROR(status);
+				status = NO_MATCH;
 			}
+		}
+		term = (Term<QueryPolicy>*)parent;
+	}
 
-			dirent->d_dev = QueryPolicy::ContextGetVolumeID(context);
-			dirent->d_ino = QueryPolicy::EntryGetNodeID(entry);
-			dirent->d_pdev = dirent->d_dev;
-			dirent->d_pino = QueryPolicy::EntryGetParentID(entry);
-			dirent->d_reclen = offsetof(struct dirent, d_name) + nameLength;
+	if (status == MATCH_OK) {
+		ssize_t nameLength = QueryPolicy::EntryGetName(entry,
+			dirent->d_name,
+			(const char*)dirent + bufferSize - dirent->d_name);
+		if (nameLength < 0) {
+			// Invalid or unknown name.
+			nameLength = 0;
 		}
 
-		if (status == MATCH_OK)
-			return B_OK;
+		dirent->d_dev = QueryPolicy::ContextGetVolumeID(context);
+		dirent->d_ino = QueryPolicy::EntryGetNodeID(entry);
+		dirent->d_pdev = dirent->d_dev;
+		dirent->d_pino = QueryPolicy::EntryGetParentID(entry);
+		dirent->d_reclen = offsetof(struct dirent, d_name) + nameLength;
 	}
-	QUERY_RETURN_ERROR(B_ERROR);
+
+	return status;
 }
 
 
@@ -1007,6 +1322,186 @@ Equation<QueryPolicy>::NeedsEntry()
 }
 
 
+/*!	Fills \a set with the IDs of all nodes that match this equation according
+	to its index. Returns \c B_NOT_SUPPORTED if there is no index that could
+	answer the equation on its own, or \c B_BUFFER_OVERFLOW if too many nodes
+	match.
+*/
+template<typename QueryPolicy>
+status_t
+Equation<QueryPolicy>::CollectNodeIDs(Context* context, NodeIDSet& set)
+{
+	if (Term<QueryPolicy>::fOp == OP_UNEQUAL)
+		return B_NOT_SUPPORTED;
+
+	if (fUseTrigrams && _CollectTrigramNodeIDs(context, set) == B_OK)
+		return B_OK;
+
+	Index index(context);
+	if (QueryPolicy::IndexSetTo(index, fAttribute) != B_OK)
+		return B_NOT_SUPPORTED;
+
+	IndexIterator* iterator = NULL;
+	status_t status = PrepareQuery(context, index, &iterator, false);
+	if (status == B_ENTRY_NOT_FOUND && iterator != NULL) {
+		// the value is not in the index at all
+		status = B_OK;
+	} else if (status == B_OK) {
+		while (true) {
+			union value<QueryPolicy> indexValue;
+			size_t keyLength;
+			size_t duplicate = 0;
+
+			if (QueryPolicy::IndexIteratorFetchNextEntry(iterator, &indexValue,
+					&keyLength, (size_t)sizeof(indexValue), &duplicate)
+						!= B_OK) {
+				break;
+			}
+
+			// see GetNextMatching()
+			if (duplicate < 2 && !CompareTo((uint8*)&indexValue, keyLength)) {
+				if (Term<QueryPolicy>::fOp == OP_LESS_THAN
+					|| Term<QueryPolicy>::fOp == OP_LESS_THAN_OR_EQUAL
+					|| (Term<QueryPolicy>::fOp == OP_EQUAL && !fIsPattern))
+					break;
+
+				if (duplicate > 0)
+					QueryPolicy::IndexIteratorSkipDuplicates(iterator);
+				continue;
+			}
+
+			status = set.Add(QueryPolicy::IndexIteratorGetNodeID(iterator));
+			if (status != B_OK)
+				break;
+		}
+	}
+
+	QueryPolicy::IndexIteratorDelete(iterator);
+	QueryPolicy::IndexUnset(index);
+
+	if (status != B_OK) {
+		set.MakeEmpty();
+		return status;
+	}
+
+	set.Finish();
+	return B_OK;
+}
+
+
+/*!	Fills \a set with the IDs of all nodes that contain all trigrams of the
+	pattern, according to the trigram index. As the trigrams are case folded,
+	this is a superset of the matching nodes.
+	Only the start of long values is indexed, so the nodes with such values
+	are always part of the set, too.
+	Trigrams that occur in too many nodes are ignored; if that is true for
+	all of them, \c B_BUFFER_OVERFLOW is returned.
+*/
+template<typename QueryPolicy>
+status_t
+Equation<QueryPolicy>::_CollectTrigramNodeIDs(Context* context,
+	NodeIDSet& set)
+{
+	char name[QueryPolicy::kMaxFileNameLength];
+	Index index(context);
+	if (getTrigramIndexName(fAttribute, name, sizeof(name)) != B_OK
+		|| QueryPolicy::IndexSetTo(index, name) != B_OK)
+		return B_NOT_SUPPORTED;
+
+	status_t status = B_OK;
+	bool hasSet = false;
+
+	for (int32 i = 0; i < fTrigramCount; i++) {
+		uint8 key[kTrigramLength];
+		trigramToKey(fTrigrams[i], key);
+
+		NodeIDSet ids;
+		status = _CollectKeyNodeIDs(index, key, kTrigramLength, ids);
+		if (status == B_BUFFER_OVERFLOW) {
+			// this trigram is too common to be of any help
+			status = B_OK;
+			continue;
+		}
+		if (status != B_OK)
+			break;
+
+		if (hasSet)
+			set.Intersect(ids);
+		else
+			set.Adopt(ids);
+		hasSet = true;
+
+		if (set.Count() == 0)
+			break;
+	}
+
+	if (status == B_OK && !hasSet)
+		status = B_BUFFER_OVERFLOW;
+
+	if (status == B_OK) {
+		NodeIDSet longValues;
+		status = _CollectKeyNodeIDs(index,
+			(const uint8*)TRIGRAM_LONG_VALUE_KEY,
+			sizeof(TRIGRAM_LONG_VALUE_KEY) - 1, longValues);
+		if (status == B_OK)
+			status = set.Unite(longValues);
+	}
+
+	QueryPolicy::IndexUnset(index);
+
+	if (status != B_OK)
+		set.MakeEmpty();
+
+	return status;
+}
+
+
+/*!	Fills \a ids with the IDs of all nodes that are listed under \a key in
+	the trigram \a index.
+*/
+template<typename QueryPolicy>
+status_t
+Equation<QueryPolicy>::_CollectKeyNodeIDs(Index& index, const uint8* key,
+	size_t keyLength, NodeIDSet& ids)
+{
+	IndexIterator* iterator = QueryPolicy::IndexCreateIterator(index);
+	if (iterator == NULL)
+		return B_NO_MEMORY;
+
+	status_t status = QueryPolicy::IndexIteratorFind(iterator, key,
+		keyLength);
+	if (status == B_OK) {
+		while (true) {
+			union value<QueryPolicy> indexValue;
+			size_t foundLength;
+			size_t duplicate = 0;
+
+			if (QueryPolicy::IndexIteratorFetchNextEntry(iterator,
+					&indexValue, &foundLength, (size_t)sizeof(indexValue),
+					&duplicate) != B_OK
+				|| foundLength != keyLength
+				|| memcmp(&indexValue, key, keyLength) != 0) {
+				break;
+			}
+
+			status = ids.Add(QueryPolicy::IndexIteratorGetNodeID(iterator));
+			if (status != B_OK)
+				break;
+		}
+	} else if (status == B_ENTRY_NOT_FOUND) {
+		// no node is listed under this key
+		status = B_OK;
+	}
+
+	QueryPolicy::IndexIteratorDelete(iterator);
+
+	if (status == B_OK)
+		ids.Finish();
+
+	return status;
+}
+
+
 //	#pragma mark -
 
 
@@ -1129,6 +1624,41 @@ Operator<QueryPolicy>::NeedsEntry()
 }
 
 
+/*!	Unites the node IDs of both children for an "or", and intersects them for
+	an "and". In the latter case, one child is enough, as the resulting set
+	only has to contain all matching nodes, not only those.
+*/
+template<typename QueryPolicy>
+status_t
+Operator<QueryPolicy>::CollectNodeIDs(Context* context, NodeIDSet& set)
+{
+	NodeIDSet right;
+	status_t leftStatus = fLeft->CollectNodeIDs(context, set);
+	if (leftStatus != B_OK && Term<QueryPolicy>::fOp == OP_OR)
+		return leftStatus;
+
+	status_t rightStatus = fRight->CollectNodeIDs(context, right);
+
+	if (Term<QueryPolicy>::fOp == OP_OR) {
+		if (rightStatus == B_OK)
+			rightStatus = set.Unite(right);
+		if (rightStatus != B_OK)
+			set.MakeEmpty();
+		return rightStatus;
+	}
+
+	if (leftStatus != B_OK) {
+		if (rightStatus == B_OK)
+			set.Adopt(right);
+		return rightStatus;
+	}
+
+	if (rightStatus == B_OK)
+		set.Intersect(right);
+	return B_OK;
+}
+
+
 //	#pragma mark -
 
 #ifdef DEBUG_QUERY
@@ -1420,6 +1950,9 @@ Query<QueryPolicy>::Query(Context* context, Expression<QueryPolicy>* expression,
 	fCurrent(NULL),
 	fIterator(NULL),
 	fIndex(context),
+	fHasFilter(false),
+	fCandidateIndex(0),
+	fHasCandidates(false),
 	fFlags(flags),
 	fPort(port),
 	fToken(token),
@@ -1491,6 +2024,10 @@ Query<QueryPolicy>::Rewind()
 	QueryPolicy::IndexIteratorDelete(fIterator);
 	fIterator = NULL;
 	fCurrent = NULL;
+	fFilter.MakeEmpty();
+	fHasFilter = false;
+	fCandidates.MakeEmpty();
+	fHasCandidates = false;
 
 	// put the whole expression on the stack
 
@@ -1667,29 +2204,48 @@ Query<QueryPolicy>::_GetNextEntry(struct dirent* dirent, size_t size)
 	// If we don't have an equation to use yet/anymore, get a new one
 	// from the stack
 	while (true) {
-		if (fIterator == NULL) {
+		if (fIterator == NULL && !fHasCandidates) {
 			if (!fStack.Pop(&fCurrent)
 				|| fCurrent == NULL)
 				return B_ENTRY_NOT_FOUND;
 
-			status_t status = fCurrent->PrepareQuery(fContext, fIndex,
-				&fIterator, fFlags & B_QUERY_NON_INDEXED);
-			if (status == B_ENTRY_NOT_FOUND) {
-				// try next equation
-				continue;
-			}
+			_PrepareFilter();
 
-			if (status != B_OK)
-				return status;
+			if (fCurrent->UsesTrigrams()
+				&& fCurrent->CollectNodeIDs(fContext, fCandidates) == B_OK) {
+				// the trigram index already told us which nodes to look at
+				if (fHasFilter)
+					fCandidates.Intersect(fFilter);
+				fCandidateIndex = 0;
+				fHasCandidates = true;
+			} else {
+				status_t status = fCurrent->PrepareQuery(fContext, fIndex,
+					&fIterator, fFlags & B_QUERY_NON_INDEXED);
+				if (status == B_ENTRY_NOT_FOUND) {
+					// try next equation
+					continue;
+				}
+
+				if (status != B_OK)
+					return status;
+			}
 		}
 		if (fCurrent == NULL)
 			QUERY_RETURN_ERROR(B_ERROR);
 
-		status_t status = fCurrent->GetNextMatching(fContext, fIterator, dirent,
-			size);
+		status_t status;
+		if (fHasCandidates) {
+			status = fCurrent->GetNextCandidate(fContext, fCandidates,
+				fCandidateIndex, dirent, size);
+		} else {
+			status = fCurrent->GetNextMatching(fContext, fIterator,
+				fHasFilter ? &fFilter : NULL, dirent, size);
+		}
 		if (status != B_OK) {
 			QueryPolicy::IndexIteratorDelete(fIterator);
 			fIterator = NULL;
+			fCandidates.MakeEmpty();
+			fHasCandidates = false;
 			fCurrent = NULL;
 		} else {
 			// only return if we have another entry
@@ -1699,6 +2255,59 @@ Query<QueryPolicy>::_GetNextEntry(struct dirent* dirent, size_t size)
 }
 
 
+/*!	Builds the filter for the equation that is about to be iterated: every
+	term that is combined with it by an "and" operator contributes the set of
+	nodes its own index says it matches, and only nodes in all of those sets
+	need to be loaded and evaluated.
+	A term is only asked for its set if its score is not much worse than the
+	one of the equation, as scanning its index would cost more than it saves
+	otherwise.
+
+	Since the filter is built from the indices alone, a node that has no entry
+	in the index of such a term is not returned, even if it has the attribute;
+	this happens for attributes that were written before the index was
+	created. This is the same result the query would have had if that term's
+	index had been iterated instead.
+	The B_QUERY_SINGLE_INDEX flag turns this off, and makes the query use just
+	the one index with the best score.
+*/
+template<typename QueryPolicy>
+void
+Query<QueryPolicy>::_PrepareFilter()
+{
+	fFilter.MakeEmpty();
+	fHasFilter = false;
+
+	if ((fFlags & B_QUERY_SINGLE_INDEX) != 0)
+		return;
+
+	// Loading a node costs about as much as reading a few index entries
+	const int64 maxScore = min_c((int64)fCurrent->Score() * kFilterScoreFactor,
+		(int64)NodeIDSet::kMaxCount);
+
+	Term<QueryPolicy>* term = fCurrent;
+	while (Term<QueryPolicy>* parent = term->Parent()) {
+		Operator<QueryPolicy>* op = (Operator<QueryPolicy>*)parent;
+		if (op->Op() == OP_AND) {
+			Term<QueryPolicy>* other = op->Right();
+			if (other == term)
+				other = op->Left();
+
+			NodeIDSet set;
+			if (other->Score() <= maxScore
+				&& other->CollectNodeIDs(fContext, set) == B_OK) {
+				if (fHasFilter)
+					fFilter.Intersect(set);
+				else
+					fFilter.Adopt(set);
+				fHasFilter = true;
+			}
+		}
+		term = parent;
+	}
+}
+
+
 template<typename QueryPolicy>
 void
 Query<QueryPolicy>::_SendEntryNotification(Entry* entry, int32 opcode,
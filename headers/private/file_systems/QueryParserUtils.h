@@ -2,6 +2,7 @@
  * Copyright 2001-2014, Axel Dörfler, axeld@pinc-software.de.
  * Copyright 2010, Clemens Zeidler <haiku@clemens-zeidler.de>
  * Copyright 2011, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 #ifndef _FILE_SYSTEMS_QUERY_PARSER_UTILS_H
@@ -38,6 +39,20 @@ enum {
 	PATTERN_INVALID_SET
 };
 
+// A trigram index of an attribute is a string index named after the
+// attribute with this suffix. Its keys are the case folded three byte
+// sequences of the attribute values, so that it can answer substring, and
+// case insensitive matches.
+#define TRIGRAM_INDEX_SUFFIX	":trigrams"
+
+// Only the start of an attribute value is indexed. Values that might be
+// longer are also listed under this key, which is no valid trigram, as they
+// can match without containing all trigrams of a pattern in their start.
+#define TRIGRAM_LONG_VALUE_KEY	"\xff"
+
+static const int32 kTrigramLength = 3;
+static const int32 kMaxTrigrams = 256;
+
 
 __BEGIN_DECLS
 
@@ -51,6 +66,16 @@ int32		getFirstPatternSymbol(const char* string);
 status_t	isValidPattern(const char* pattern);
 status_t	matchString(const char* pattern, const char* string);
 
+status_t	getTrigramIndexName(const char* attribute, char* buffer,
+				size_t bufferSize);
+status_t	getTrigramAttributeName(const char* indexName, char* buffer,
+				size_t bufferSize);
+int32		getTrigrams(const char* string, size_t length, uint32* trigrams,
+				int32 maxCount);
+int32		getPatternTrigrams(const char* pattern, uint32* trigrams,
+				int32 maxCount);
+void		trigramToKey(uint32 trigram, uint8* key);
+
 
 __END_DECLS
 
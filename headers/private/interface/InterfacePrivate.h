@@ -1,5 +1,6 @@
 /*
  * Copyright 2007-2009, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -29,6 +30,9 @@ void		set_workspaces_layout(uint32 columns, uint32 rows);
 bool		get_control_look(BString& path);
 status_t	set_control_look(const BString& path);
 
+bool		retain_window_contents();
+void		set_retain_window_contents(bool retain);
+
 }	// namespace BPrivate
 
 
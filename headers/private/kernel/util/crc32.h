@@ -0,0 +1,47 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef KERNEL_UTIL_CRC32_H
+#define KERNEL_UTIL_CRC32_H
+
+
+#include <SupportDefs.h>
+
+
+typedef enum crc_implementation {
+	CRC_IMPLEMENTATION_DEFAULT = 0,
+		// the fastest one available on this CPU
+	CRC_IMPLEMENTATION_BYTEWISE,
+	CRC_IMPLEMENTATION_SLICING_BY_8,
+	CRC_IMPLEMENTATION_HARDWARE
+		// falls back to slicing-by-8 if the CPU doesn't support it
+} crc_implementation;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Both functions neither invert the initial nor the final value; callers
+ * that need the standard checksum have to pass ~0 and invert the result.
+ */
+uint32	calculate_crc32(uint32 crc, const void* buffer, size_t length);
+			/* IEEE 802.3, reflected polynomial 0xedb88320 */
+uint32	calculate_crc32c(uint32 crc, const void* buffer, size_t length);
+			/* Castagnoli, reflected polynomial 0x82f63b78 */
+
+uint32	calculate_crc32_etc(uint32 crc, const void* buffer, size_t length,
+			crc_implementation implementation);
+uint32	calculate_crc32c_etc(uint32 crc, const void* buffer, size_t length,
+			crc_implementation implementation);
+
+bool	crc32_has_hardware_support(void);
+bool	crc32c_has_hardware_support(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif	/* KERNEL_UTIL_CRC32_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2010, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef NET_UTILITIES_H
@@ -139,4 +139,25 @@ private:
 };
 
 
+/*!	Chooses one of \a count sockets that share their local address via
+	SO_REUSEPORT for the flow with the address pair hash \a flowHash (as
+	returned by net_address_module_info::hash_address_pair()). All packets
+	of a flow are sent to the same socket, as long as the group does not
+	change.
+*/
+static inline uint32
+reuse_port_index(uint32 flowHash, uint32 count)
+{
+	// the address pair hashes are only meant for hash tables; spread their
+	// bits, so that the ports influence all of them
+	flowHash ^= flowHash >> 16;
+	flowHash *= 0x85ebca6b;
+	flowHash ^= flowHash >> 13;
+	flowHash *= 0xc2b2ae35;
+	flowHash ^= flowHash >> 16;
+
+	return flowHash % count;
+}
+
+
 #endif	// NET_UTILITIES_H
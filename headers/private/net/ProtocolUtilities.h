@@ -1,5 +1,5 @@
 /*
- * Copyright 2007-2013, Haiku, Inc. All Rights Reserved.
+ * Copyright 2007-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -120,6 +120,8 @@ public:
 			net_buffer*			Dequeue(bool clone);
 			status_t			BlockingDequeue(bool peek, bigtime_t timeout,
 									net_buffer** _buffer);
+			ssize_t				DequeueBatch(uint32 flags, bigtime_t deadline,
+									net_buffer** buffers, size_t count);
 
 			void				Clear();
 
@@ -132,8 +134,9 @@ public:
 protected:
 	virtual	status_t			SocketStatus(bool peek) const;
 
-private:
 			status_t			_Enqueue(net_buffer* buffer);
+
+private:
 			net_buffer*			_Dequeue(bool peek);
 			void				_Clear();
 
@@ -263,6 +266,46 @@ DECL_DATAGRAM_SOCKET(inline status_t)::BlockingDequeue(bool peek,
 }
 
 
+/*!	Dequeues up to \a count buffers at once, while only acquiring the lock
+	a single time. Waits for the first buffer like Dequeue() does, but not
+	longer than until the absolute \a deadline; any further buffers are
+	only returned if they are already queued.
+	Returns the number of buffers dequeued, or an error code.
+*/
+DECL_DATAGRAM_SOCKET(inline ssize_t)::DequeueBatch(uint32 flags,
+	bigtime_t deadline, net_buffer** buffers, size_t count)
+{
+	// MSG_NOSIGNAL and the control message flags are handled by the socket
+	// layer, they are just passed on to us; peeking is done one by one
+	if ((flags & ~(MSG_DONTWAIT | MSG_NOSIGNAL | MSG_CMSG_CLOEXEC
+			| MSG_CMSG_CLOFORK)) != 0) {
+		return EOPNOTSUPP;
+	}
+
+	bigtime_t timeout = _SocketTimeout(flags);
+	if (timeout != 0 && deadline < timeout)
+		timeout = deadline;
+
+	AutoLocker _(fLock);
+
+	while (fBuffers.IsEmpty()) {
+		status_t status = SocketStatus(false);
+		if (status != B_OK)
+			return status;
+
+		status = _Wait(timeout);
+		if (status != B_OK)
+			return status;
+	}
+
+	size_t dequeued = 0;
+	while (dequeued < count && !fBuffers.IsEmpty())
+		buffers[dequeued++] = _Dequeue(false);
+
+	return dequeued;
+}
+
+
 DECL_DATAGRAM_SOCKET(inline void)::Clear()
 {
 	AutoLocker _(fLock);
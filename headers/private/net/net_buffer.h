@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2010, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef NET_BUFFER_H
@@ -46,6 +46,8 @@ typedef struct net_buffer {
 
 struct ancillary_data_container;
 
+typedef void (*net_buffer_release_func)(void* cookie);
+
 struct net_buffer_module_info {
 	module_info info;
 
@@ -74,6 +76,9 @@ struct net_buffer_module_info {
 	status_t		(*trim)(net_buffer* buffer, size_t newSize);
 	status_t		(*append_cloned)(net_buffer* buffer, net_buffer* source,
 						uint32 offset, size_t bytes);
+	status_t		(*append_external)(net_buffer* buffer, const void* data,
+						size_t bytes, net_buffer_release_func release,
+						void* cookie);
 
 	status_t		(*associate_data)(net_buffer* buffer, void* data);
 
@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2010, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef NET_PROTOCOL_H
@@ -125,6 +125,11 @@ struct net_protocol_module_info {
 					size_t vecCount, ancillary_data_container** _ancillaryData,
 					struct sockaddr* _address, socklen_t* _addressLength,
 					int flags);
+
+	ssize_t		(*send_data_batch)(net_protocol* self, net_buffer** buffers,
+					size_t count);
+	ssize_t		(*read_data_batch)(net_protocol* self, size_t count,
+					uint32 flags, bigtime_t deadline, net_buffer** _buffers);
 };
 
 
@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2010, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef NET_SOCKET_H
@@ -108,6 +108,13 @@ struct net_socket_module_info {
 					size_t length, int flags);
 	ssize_t		(*send)(net_socket* socket, struct msghdr* , const void* data,
 					size_t length, int flags);
+	ssize_t		(*send_external)(net_socket* socket, const void* data,
+					size_t length, int flags, net_buffer_release_func release,
+					void* cookie);
+	ssize_t		(*send_batch)(net_socket* socket, struct mmsghdr* messages,
+					size_t count, int flags);
+	ssize_t		(*receive_batch)(net_socket* socket, struct mmsghdr* messages,
+					size_t count, int flags, bigtime_t deadline);
 	int			(*setsockopt)(net_socket* socket, int level, int option,
 					const void* optionValue, int optionLength);
 	int			(*shutdown)(net_socket* socket, int direction);
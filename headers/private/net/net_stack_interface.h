@@ -1,5 +1,5 @@
 /*
- * Copyright 2008, Haiku, Inc. All Rights Reserved.
+ * Copyright 2008-2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 #ifndef NET_STACK_INTERFACE_H
@@ -42,6 +42,8 @@ struct net_stack_interface_module_info {
 					int flags, struct sockaddr* address,
 					socklen_t* _addressLength);
 	ssize_t (*recvmsg)(net_socket* socket, struct msghdr* message, int flags);
+	ssize_t (*recvmmsg)(net_socket* socket, struct mmsghdr* messages,
+					size_t count, int flags, bigtime_t timeout);
 
 	ssize_t (*send)(net_socket* socket, const void* data, size_t length,
 					int flags);
@@ -50,6 +52,11 @@ struct net_stack_interface_module_info {
 					socklen_t addressLength);
 	ssize_t (*sendmsg)(net_socket* socket, const struct msghdr* message,
 					int flags);
+	ssize_t (*sendmmsg)(net_socket* socket, struct mmsghdr* messages,
+					size_t count, int flags);
+	ssize_t (*send_external)(net_socket* socket, const void* data,
+					size_t length, int flags, void (*release)(void* cookie),
+					void* cookie);
 
 	status_t (*getsockopt)(net_socket* socket, int level, int option,
 					void* value, socklen_t* _length);
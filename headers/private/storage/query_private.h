@@ -6,5 +6,9 @@
 // attributes on all entries in the query.
 #define B_QUERY_WATCH_ALL		0x0000F000
 
+// Only use the index with the best score to evaluate the query, and ignore
+// the indices of the other terms; meant for comparing query plans.
+#define B_QUERY_SINGLE_INDEX	0x00010000
+
 
 #endif
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2009, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef USERLAND_FS_PORT_H
@@ -7,6 +8,8 @@
 
 #include <OS.h>
 
+#include "RequestRing.h"
+
 class KernelDebug;
 
 namespace UserlandFSUtil {
@@ -20,6 +23,8 @@ public:
 				port_id			owner_port;
 				port_id			client_port;
 				int32			size;
+				area_id			area;
+					// the channel shared by both sides, -1 if there is none
 			};
 
 public:
@@ -40,10 +45,29 @@ public:
 			void				Unreserve(int32 endOffset);
 			int32				ReservedSize() const { return fReservedSize; }
 
+			area_id				GetSharedArea() const { return fInfo.area; }
+			void*				AllocateSharedData(int32 size, int32 align,
+									int32* _offset);
+			void				UnreserveSharedData(int32 endOffset);
+			int32				SharedDataReservedSize() const
+									{ return fSharedDataReserved; }
+			void*				GetPeerSharedData(int32 offset,
+									int32 size) const;
+
 			status_t			Send(const void* message, int32 size);
 			status_t			Receive(void** _message, size_t* _size,
 									bigtime_t timeout = -1);
 
+private:
+			struct ChannelHeader;
+
+			status_t			_CreateChannel();
+			status_t			_CloneChannel();
+			status_t			_InitChannel(size_t areaSize);
+
+			status_t			_WaitForWakeUp(uint32 timeoutFlags,
+									bigtime_t timeout);
+
 private:
 			friend class ::KernelDebug;
 
@@ -51,6 +75,14 @@ private:
 			uint8*				fBuffer;
 			int32				fCapacity;
 			int32				fReservedSize;
+			area_id				fChannelArea;
+			uint8*				fChannel;
+			RequestRing			fSendRing;
+			RequestRing			fReceiveRing;
+			int32				fSharedDataOffset;
+			int32				fSharedDataSize;
+			int32				fSharedDataReserved;
+			int32				fPeerSharedDataOffset;
 			status_t			fInitStatus;
 			bool				fOwner;
 };
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2009, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef USERLAND_FS_REQUEST_ALLOCATOR_H
@@ -62,6 +63,7 @@ private:
 			Request*			fRequest;
 			int32				fRequestSize;
 			int32				fPortReservedOffset;
+			int32				fSharedDataReservedOffset;
 			int32				fRequestOffset;
 			area_id				fAllocatedAreas[MAX_REQUEST_ADDRESS_COUNT];
 			int32				fAllocatedAreaCount;
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef USERLAND_FS_REQUEST_RING_H
+#define USERLAND_FS_REQUEST_RING_H
+
+#include <OS.h>
+
+namespace UserlandFSUtil {
+
+// RequestRing
+//
+// A single producer, single consumer ring buffer of variable sized messages
+// in memory that is shared between the kernel and the userland server.
+//
+// Both sides keep private copies of the positions, and only publish them in
+// the shared header, so that a misbehaving peer can only garble the messages,
+// but not make us read or write outside of the ring.
+class RequestRing {
+public:
+			struct Header {
+				int32			head;
+					// bytes ever written, updated by the producer
+				int32			tail;
+					// bytes ever read, updated by the consumer
+				int32			waiting;
+					// set by the consumer before it blocks on the port
+				int32			reserved;
+			};
+
+public:
+								RequestRing();
+
+			void				SetTo(Header* header, void* data, int32 size);
+			bool				IsValid() const	{ return fHeader != NULL; }
+
+			int32				MaxMessageSize() const;
+
+			status_t			Push(const void* message, int32 size);
+			status_t			Pop(void** _message, size_t* _size);
+			bool				IsEmpty() const;
+
+			// consumer side
+			bool				PrepareToWait();
+			bool				CancelWait();
+
+			// producer side
+			bool				NeedsWakeUp();
+
+private:
+			Header*				fHeader;
+			uint8*				fData;
+			uint32				fSize;
+			uint32				fPosition;
+				// head for the producer, tail for the consumer
+};
+
+}	// namespace UserlandFSUtil
+
+using UserlandFSUtil::RequestRing;
+
+#endif	// USERLAND_FS_REQUEST_RING_H
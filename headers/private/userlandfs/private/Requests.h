@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2009, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef USERLAND_FS_REQUESTS_H
@@ -260,6 +261,8 @@ enum {
 
 namespace UserlandFSUtil {
 
+class Port;
+
 // ReplyRequest
 class ReplyRequest : public Request {
 public:
@@ -2399,7 +2402,7 @@ status_t get_request_address_infos(Request* request, AddressInfo* infos,
 	int32* count);
 status_t check_request(Request* request);
 status_t relocate_request(Request* request, int32 requestBufferSize,
-	area_id* areas, int32* count);
+	area_id* areas, int32* count, Port* port = NULL);
 
 }	// namespace UserlandFSUtil
 
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2017, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  *
  * Roughly based on 'btlib' written by Marcus J. Ranum - it shares
@@ -1685,6 +1686,62 @@ BPlusTree::_SplitNode(bplustree_node* node, off_t nodeOffset,
 }
 
 
+/*!	Like _SplitNode(), but instead of splitting the \a node into two halves,
+	all of its keys are moved into \a other. Only the new key remains in the
+	\a node, or, if it is an index node, is passed on to the parent.
+	The new key must sort after all keys of the node. This is used when keys
+	are appended in ascending order: the node that is left behind will not
+	receive any further keys, and can therefore stay completely filled.
+*/
+status_t
+BPlusTree::_SplitNodeAtEnd(bplustree_node* node, off_t nodeOffset,
+	bplustree_node* other, off_t otherOffset, uint8* key, uint16* _keyLength,
+	off_t* _value)
+{
+	uint16 count = node->NumKeys();
+	if (count == 0)
+		return B_BAD_VALUE;
+
+	other->left_link = node->left_link;
+	other->right_link = HOST_ENDIAN_TO_BFS_INT64(nodeOffset);
+	other->all_key_count = node->all_key_count;
+	other->all_key_length = node->all_key_length;
+
+	memcpy(other->Keys(), node->Keys(), node->AllKeyLength());
+	memcpy(other->KeyLengths(), node->KeyLengths(), count * sizeof(uint16));
+	memcpy(other->Values(), node->Values(), count * sizeof(off_t));
+
+	node->left_link = HOST_ENDIAN_TO_BFS_INT64(otherOffset);
+	node->all_key_count = 0;
+	node->all_key_length = 0;
+
+	if (node->OverflowLink() != BPLUSTREE_NULL) {
+		// The new key is dropped, and passed on to the parent; the node it
+		// points to covers the keys between the last one of the other node
+		// and the new key
+		other->overflow_link = HOST_ENDIAN_TO_BFS_INT64(*_value);
+		*_value = otherOffset;
+		return B_OK;
+	}
+
+	_InsertKey(node, 0, key, *_keyLength, *_value);
+
+	// the last key of the other node is inserted in the parent node
+	uint16 newLength;
+	uint8* newKey = other->KeyAt(count - 1, &newLength);
+	if (newLength > BPLUSTREE_MAX_KEY_LENGTH) {
+		fStream->GetVolume()->Panic();
+		RETURN_ERROR(B_BAD_DATA);
+	}
+
+	memcpy(key, newKey, newLength);
+	*_keyLength = newLength;
+	*_value = otherOffset;
+
+	return B_OK;
+}
+
+
 /*!	This inserts a key into the tree. The changes made to the tree will
 	all be part of the \a transaction.
 	You need to have the inode write locked.
@@ -1692,6 +1749,29 @@ BPlusTree::_SplitNode(bplustree_node* node, off_t nodeOffset,
 status_t
 BPlusTree::Insert(Transaction& transaction, const uint8* key, uint16 keyLength,
 	off_t value)
+{
+	return _Insert(transaction, key, keyLength, value, false);
+}
+
+
+/*!	Inserts a key into the tree, just like Insert(), but is optimized for
+	keys that are added in ascending order, as when an index is built from
+	a sorted list: instead of splitting full nodes in half, nodes on the
+	right edge of the tree are left completely filled. Keys that do not sort
+	after all keys in the tree are inserted as usual.
+	You need to have the inode write locked.
+*/
+status_t
+BPlusTree::Append(Transaction& transaction, const uint8* key, uint16 keyLength,
+	off_t value)
+{
+	return _Insert(transaction, key, keyLength, value, true);
+}
+
+
+status_t
+BPlusTree::_Insert(Transaction& transaction, const uint8* key,
+	uint16 keyLength, off_t value, bool append)
 {
 	if (keyLength < BPLUSTREE_MIN_KEY_LENGTH
 		|| keyLength > BPLUSTREE_MAX_KEY_LENGTH)
@@ -1785,9 +1865,21 @@ BPlusTree::Insert(Transaction& transaction, const uint8* key, uint16 keyLength,
 				RETURN_ERROR(status);
 			}
 
-			if (_SplitNode(writableNode, nodeAndKey.nodeOffset, other,
+			uint16 splitAt;
+			if (append && nodeAndKey.keyIndex == writableNode->NumKeys()
+				&& writableNode->RightLink() == BPLUSTREE_NULL) {
+				// we're at the right edge of the tree, keep all existing
+				// keys together
+				splitAt = writableNode->NumKeys() + 1;
+				status = _SplitNodeAtEnd(writableNode, nodeAndKey.nodeOffset,
+					other, otherOffset, keyBuffer, &keyLength, &value);
+			} else {
+				status = _SplitNode(writableNode, nodeAndKey.nodeOffset, other,
 					otherOffset, &nodeAndKey.keyIndex, keyBuffer, &keyLength,
-					&value) != B_OK) {
+					&value);
+				splitAt = writableNode->NumKeys();
+			}
+			if (status != B_OK) {
 				// free root node & other node here
 				cachedOther.Free(transaction, otherOffset);
 				cachedNewRoot.Free(transaction, newRoot);
@@ -1800,7 +1892,7 @@ BPlusTree::Insert(Transaction& transaction, const uint8* key, uint16 keyLength,
 #endif
 
 			_UpdateIterators(nodeAndKey.nodeOffset, otherOffset,
-				nodeAndKey.keyIndex, writableNode->NumKeys(), 1);
+				nodeAndKey.keyIndex, splitAt, 1);
 
 			// update the right link of the node in the left of the new node
 			if ((other = cachedOther.SetToWritable(transaction,
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2015, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 #ifndef B_PLUS_TREE_H
@@ -275,6 +276,9 @@ public:
 			status_t			Insert(Transaction& transaction,
 									const uint8* key, uint16 keyLength,
 									off_t value);
+			status_t			Append(Transaction& transaction,
+									const uint8* key, uint16 keyLength,
+									off_t value);
 
 			status_t			Remove(Transaction& transaction, const char* key,
 									off_t value);
@@ -340,6 +344,13 @@ private:
 									off_t otherOffset, uint16* _keyIndex,
 									uint8* key, uint16* _keyLength,
 									off_t* _value);
+			status_t			_SplitNodeAtEnd(bplustree_node* node,
+									off_t nodeOffset, bplustree_node* other,
+									off_t otherOffset, uint8* key,
+									uint16* _keyLength, off_t* _value);
+			status_t			_Insert(Transaction& transaction,
+									const uint8* key, uint16 keyLength,
+									off_t value, bool append);
 
 			status_t			_RemoveDuplicate(Transaction& transaction,
 									const bplustree_node* node,
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2020, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 
@@ -30,10 +31,24 @@
 // group can span several blocks in the block bitmap, the AllocationBlock
 // class is there to make handling those easier.
 
+// Every allocation group has its own lock, and since the groups never share
+// a block of the bitmap, allocations in different groups can run in parallel.
+// The allocator's rw_lock is only write locked by operations that need to see
+// the whole bitmap at once (like the file system check); everything else just
+// read locks it. Some group fields (the number of free bits, and the largest
+// free range) are also peeked at without holding the group's lock, so that
+// groups that cannot fulfill a request don't need to be locked and scanned
+// at all - that information is only used as a hint, though, and is always
+// verified with the lock held before anything is allocated.
+
 // The current implementation is only slightly optimized and could probably
 // be improved a lot. Furthermore, the allocation policies used here should
 // have some real world tests.
 
+static const uint32 kLargeExtentSize = 1024 * 1024;
+	// streams that grow by at least this many bytes at once will be placed
+	// in the least used allocation group if their group is too crowded
+
 #if BFS_TRACING && !defined(FS_SHELL)
 namespace BFSBlockTracing {
 
@@ -195,10 +210,20 @@ private:
 class AllocationGroup {
 public:
 	AllocationGroup();
+	~AllocationGroup();
 
 	void AddFreeRange(int32 start, int32 blocks);
 	bool IsFull() const { return fFreeBits == 0; }
 
+	mutex& Lock() { return fLock; }
+
+	// These may also be called without holding the lock, they are hints then
+	// - but only once the group has been initialized
+	bool IsInitialized() { return atomic_get(&fInitialized) != 0; }
+	int32 FreeBits() { return atomic_get(&fFreeBits); }
+	int32 LargestHint() const
+		{ return fLargestValid ? fLargestLength : fFreeBits; }
+
 	status_t Allocate(Transaction& transaction, uint16 start, int32 length);
 	status_t Free(Transaction& transaction, uint16 start, int32 length);
 
@@ -209,6 +234,7 @@ public:
 private:
 	friend class BlockAllocator;
 
+	mutex	fLock;
 	uint32	fNumBits;
 	uint32	fNumBitmapBlocks;
 	int32	fStart;
@@ -218,6 +244,7 @@ private:
 	int32	fLargestStart;
 	int32	fLargestLength;
 	bool	fLargestValid;
+	int32	fInitialized;
 };
 
 
@@ -369,9 +396,18 @@ AllocationBlock::Free(uint16 start, uint16 numBlocks)
 AllocationGroup::AllocationGroup()
 	:
 	fFirstFree(-1),
+	fNumBits(0),
 	fFreeBits(0),
-	fLargestValid(false)
+	fLargestValid(false),
+	fInitialized(0)
 {
+	mutex_init(&fLock, "bfs allocation group");
+}
+
+
+AllocationGroup::~AllocationGroup()
+{
+	mutex_destroy(&fLock);
 }
 
 
@@ -398,7 +434,7 @@ AllocationGroup::AddFreeRange(int32 start, int32 blocks)
 	Doesn't check if the run is valid or already allocated partially, nor
 	does it maintain the free ranges hints or the volume's used blocks count.
 	It only does the low-level work of allocating some bits in the block bitmap.
-	Assumes that the block bitmap lock is hold.
+	Assumes that the group's lock is held.
 */
 status_t
 AllocationGroup::Allocate(Transaction& transaction, uint16 start, int32 length)
@@ -467,7 +503,7 @@ AllocationGroup::Allocate(Transaction& transaction, uint16 start, int32 length)
 	Doesn't check if the run is valid or was not completely allocated, nor
 	does it maintain the free ranges hints or the volume's used blocks count.
 	It only does the low-level work of freeing some bits in the block bitmap.
-	Assumes that the block bitmap lock is hold.
+	Assumes that the group's lock is held.
 */
 status_t
 AllocationGroup::Free(Transaction& transaction, uint16 start, int32 length)
@@ -529,18 +565,21 @@ AllocationGroup::Free(Transaction& transaction, uint16 start, int32 length)
 BlockAllocator::BlockAllocator(Volume* volume)
 	:
 	fVolume(volume),
-	fGroups(NULL)
+	fGroups(NULL),
+	fLeastUsedGroup(0)
 	//fCheckBitmap(NULL),
 	//fCheckCookie(NULL)
 {
-	recursive_lock_init(&fLock, "bfs allocator");
+	rw_lock_init(&fLock, "bfs allocator");
+	mutex_init(&fUsedBlocksLock, "bfs used blocks");
 }
 
 
 BlockAllocator::~BlockAllocator()
 {
-	recursive_lock_destroy(&fLock);
 	delete[] fGroups;
+	mutex_destroy(&fUsedBlocksLock);
+	rw_lock_destroy(&fLock);
 }
 
 
@@ -558,15 +597,18 @@ BlockAllocator::Initialize(bool full)
 	if (!full)
 		return B_OK;
 
-	recursive_lock_lock(&fLock);
-		// the lock will be released by the _Initialize() method
+	// Lock all groups until they are initialized; the locks will be released
+	// by the _Initialize() method
+	for (int32 i = 0; i < fNumGroups; i++)
+		mutex_lock(&fGroups[i].Lock());
 
 	thread_id id = spawn_kernel_thread((thread_func)BlockAllocator::_Initialize,
 		"bfs block allocator", B_LOW_PRIORITY, this);
 	if (id < B_OK)
 		return _Initialize(this);
 
-	recursive_lock_transfer_lock(&fLock, id);
+	for (int32 i = 0; i < fNumGroups; i++)
+		mutex_transfer_lock(&fGroups[i].Lock(), id);
 
 	return resume_thread(id);
 }
@@ -613,6 +655,7 @@ BlockAllocator::InitializeAndClearBitmap(Transaction& transaction)
 		fGroups[i].fFirstFree = fGroups[i].fLargestStart = 0;
 		fGroups[i].fFreeBits = fGroups[i].fLargestLength = fGroups[i].fNumBits;
 		fGroups[i].fLargestValid = true;
+		atomic_set(&fGroups[i].fInitialized, 1);
 
 		offset += fBlocksPerGroup;
 	}
@@ -641,22 +684,25 @@ BlockAllocator::InitializeAndClearBitmap(Transaction& transaction)
 status_t
 BlockAllocator::_Initialize(BlockAllocator* allocator)
 {
-	// The lock must already be held at this point
-	RecursiveLocker locker(allocator->fLock, true);
-
+	// The group locks must already be held at this point
 	Volume* volume = allocator->fVolume;
 	uint32 blocks = allocator->fBlocksPerGroup;
 	uint32 blockShift = volume->BlockShift();
 	off_t freeBlocks = 0;
 
+	AllocationGroup* groups = allocator->fGroups;
+	int32 numGroups = allocator->fNumGroups;
+
 	uint32* buffer = (uint32*)malloc(blocks << blockShift);
-	if (buffer == NULL)
+	if (buffer == NULL) {
+		for (int32 i = 0; i < numGroups; i++)
+			mutex_unlock(&groups[i].Lock());
 		RETURN_ERROR(B_NO_MEMORY);
+	}
 
-	AllocationGroup* groups = allocator->fGroups;
 	off_t offset = 1;
 	uint32 bitsPerGroup = 8 * (blocks << blockShift);
-	int32 numGroups = allocator->fNumGroups;
+	int32 leastUsedGroup = 0;
 
 	for (int32 i = 0; i < numGroups; i++) {
 		if (read_pos(volume->Device(), offset << blockShift, buffer,
@@ -696,12 +742,18 @@ BlockAllocator::_Initialize(BlockAllocator* allocator)
 		if (range)
 			groups[i].AddFreeRange(start, range);
 
+		atomic_set(&groups[i].fInitialized, 1);
+
 		freeBlocks += groups[i].fFreeBits;
+		if (groups[i].fFreeBits > groups[leastUsedGroup].fFreeBits)
+			leastUsedGroup = i;
 
 		offset += blocks;
 	}
 	free(buffer);
 
+	atomic_set(&allocator->fLeastUsedGroup, leastUsedGroup);
+
 	// check if block bitmap and log area are reserved
 	uint32 reservedBlocks = volume->ToBlock(volume->Log()) + volume->Log().Length();
 
@@ -732,6 +784,9 @@ BlockAllocator::_Initialize(BlockAllocator* allocator)
 		volume->SuperBlock().used_blocks = HOST_ENDIAN_TO_BFS_INT64(usedBlocks);
 	}
 
+	for (int32 i = 0; i < numGroups; i++)
+		mutex_unlock(&groups[i].Lock());
+
 	return B_OK;
 }
 
@@ -740,8 +795,32 @@ void
 BlockAllocator::Uninitialize()
 {
 	// We only have to make sure that the initializer thread isn't running
-	// anymore.
-	recursive_lock_lock(&fLock);
+	// anymore, and that nobody else can allocate anything.
+	rw_lock_write_lock(&fLock);
+	_WaitForInitialization();
+}
+
+
+/*!	Locks out all other users of the allocator, and waits until the block
+	bitmap has been read in completely. The calling thread may still allocate
+	and free blocks, though.
+*/
+status_t
+BlockAllocator::Lock()
+{
+	status_t status = rw_lock_write_lock(&fLock);
+	if (status != B_OK)
+		return status;
+
+	_WaitForInitialization();
+	return B_OK;
+}
+
+
+void
+BlockAllocator::Unlock()
+{
+	rw_lock_write_unlock(&fLock);
 }
 
 
@@ -763,179 +842,239 @@ BlockAllocator::AllocateBlocks(Transaction& transaction, int32 groupIndex,
 		", maximum = %" B_PRIu16 ", minimum = %" B_PRIu16 "\n",
 		groupIndex, start, maximum, minimum));
 
-	AllocationBlock cached(fVolume);
-	RecursiveLocker lock(fLock);
-
-	uint32 bitsPerFullBlock = fVolume->BlockSize() << 3;
+	ReadLocker locker(fLock);
 
-	// Find the block_run that can fulfill the request best
-	int32 bestGroup = -1;
-	int32 bestStart = -1;
-	int32 bestLength = -1;
+	while (true) {
+		// Find the block_run that can fulfill the request best
+		int32 bestGroup = -1;
+		int32 bestStart = -1;
+		int32 bestLength = -1;
 
-	for (int32 i = 0; i < fNumGroups + 1; i++, groupIndex++, start = 0) {
-		groupIndex = groupIndex % fNumGroups;
-		AllocationGroup& group = fGroups[groupIndex];
+		int32 index = groupIndex;
+		uint16 groupStart = start;
 
-		CHECK_ALLOCATION_GROUP(groupIndex);
+		for (int32 i = 0; i < fNumGroups + 1; i++, index++, groupStart = 0) {
+			index = index % fNumGroups;
+			AllocationGroup& group = fGroups[index];
 
-		if (start >= group.NumBits() || group.IsFull())
-			continue;
-
-		// The wanted maximum is smaller than the largest free block in the
-		// group or already smaller than the minimum
+			// Don't bother locking groups that cannot give us more than what
+			// we already have; groups that are still being initialized have
+			// to be waited for, though, as their hints aren't valid yet
+			if (group.IsInitialized()
+				&& (groupStart >= group.NumBits()
+					|| group.LargestHint() <= max_c(bestLength, 0))) {
+				continue;
+			}
 
-		if (start < group.fFirstFree)
-			start = group.fFirstFree;
+			MutexLocker groupLocker(group.Lock());
+			AllocationBlock cached(fVolume);
 
-		if (group.fLargestValid) {
-			if (group.fLargestLength < bestLength)
-				continue;
+			CHECK_ALLOCATION_GROUP(index);
 
-			if (group.fLargestStart >= start) {
-				if (group.fLargestLength >= bestLength) {
-					bestGroup = groupIndex;
-					bestStart = group.fLargestStart;
-					bestLength = group.fLargestLength;
+			int32 rangeStart;
+			int32 rangeLength;
+			status_t status = _FindFreeRange(cached, index, groupStart,
+				maximum, rangeStart, rangeLength);
+			if (status != B_OK)
+				return status;
 
-					if (bestLength >= maximum)
-						break;
-				}
+			if (rangeLength >= maximum) {
+				// We can take this one right away
+				return _AllocateRange(transaction, index, rangeStart,
+					rangeLength, maximum, minimum, run);
+			}
 
-				// We know everything about this group we have to, let's skip
-				// to the next
-				continue;
+			if (rangeLength > bestLength) {
+				bestGroup = index;
+				bestStart = rangeStart;
+				bestLength = rangeLength;
 			}
 		}
 
-		// There may be more than one block per allocation group - and
-		// we iterate through it to find a place for the allocation.
-		// (one allocation can't exceed one allocation group)
-
-		uint32 block = start / (fVolume->BlockSize() << 3);
-		int32 currentStart = 0, currentLength = 0;
-		int32 groupLargestStart = -1;
-		int32 groupLargestLength = -1;
-		int32 currentBit = start;
-		bool canFindGroupLargest = start == 0;
-
-		for (; block < group.NumBitmapBlocks(); block++) {
-			if (cached.SetTo(group, block) < B_OK)
-				RETURN_ERROR(B_ERROR);
-
-			T(Block("alloc-in", group.Start() + block, cached.Block(),
-				fVolume->BlockSize(), groupIndex, currentStart));
-
-			// find a block large enough to hold the allocation
-			for (uint32 bit = start % bitsPerFullBlock;
-					bit < cached.NumBlockBits(); bit++) {
-				if (!cached.IsUsed(bit)) {
-					if (currentLength == 0) {
-						// start new range
-						currentStart = currentBit;
-					}
+		if (bestLength < minimum)
+			return B_DEVICE_FULL;
+
+		// The best group has been unlocked in the mean time, so we need to
+		// look again
+		AllocationGroup& group = fGroups[bestGroup];
+		MutexLocker groupLocker(group.Lock());
+		AllocationBlock cached(fVolume);
+
+		int32 rangeStart;
+		int32 rangeLength;
+		status_t status = _FindFreeRange(cached, bestGroup, bestStart,
+			bestLength, rangeStart, rangeLength);
+		if (status != B_OK)
+			return status;
+
+		if (rangeLength >= minimum) {
+			return _AllocateRange(transaction, bestGroup, rangeStart,
+				rangeLength, maximum, minimum, run);
+		}
 
-					// have we found a range large enough to hold numBlocks?
-					if (++currentLength >= maximum) {
-						bestGroup = groupIndex;
-						bestStart = currentStart;
-						bestLength = currentLength;
-						break;
-					}
-				} else {
-					if (currentLength) {
-						// end of a range
-						if (currentLength > bestLength) {
-							bestGroup = groupIndex;
-							bestStart = currentStart;
-							bestLength = currentLength;
-						}
-						if (currentLength > groupLargestLength) {
-							groupLargestStart = currentStart;
-							groupLargestLength = currentLength;
-						}
-						currentLength = 0;
-					}
-					if (((int32)group.NumBits() - currentBit)
-							<= groupLargestLength) {
-						// We can't find a bigger block in this group anymore,
-						// let's skip the rest.
-						block = group.NumBitmapBlocks();
-						break;
-					}
+		// Someone else got the range before us, start over
+	}
+}
+
+
+/*!	Looks for a free range of up to \a maximum blocks in the allocation group
+	\a groupIndex, starting at \a start. The largest range found, or the first
+	one that has at least \a maximum blocks is returned in \a _start and
+	\a _length; if there are no free blocks, \a _length is set to -1.
+
+	If the whole group had to be scanned, its largest range hint is updated
+	as well.
+	The group must be locked by the caller.
+*/
+status_t
+BlockAllocator::_FindFreeRange(AllocationBlock& cached, int32 groupIndex,
+	uint16 start, uint16 maximum, int32& _start, int32& _length)
+{
+	AllocationGroup& group = fGroups[groupIndex];
+	ASSERT_LOCKED_MUTEX(&group.Lock());
 
-					// Advance the current bit to one before the next free (or last) bit,
-					// so that the next loop iteration will check the next free bit.
-					const uint32 nextFreeOffset = cached.NextFree(bit) - bit;
-					bit += nextFreeOffset - 1;
-					currentBit += nextFreeOffset - 1;
+	_start = -1;
+	_length = -1;
+
+	if (start >= group.NumBits() || group.IsFull())
+		return B_OK;
+
+	if (start < group.fFirstFree)
+		start = group.fFirstFree;
+
+	if (group.fLargestValid && group.fLargestStart >= start) {
+		// We know everything about this group we have to
+		_start = group.fLargestStart;
+		_length = group.fLargestLength;
+		return B_OK;
+	}
+
+	// There may be more than one block per allocation group - and
+	// we iterate through it to find a place for the allocation.
+	// (one allocation can't exceed one allocation group)
+
+	uint32 bitsPerFullBlock = fVolume->BlockSize() << 3;
+	uint32 block = start / bitsPerFullBlock;
+	int32 currentStart = 0, currentLength = 0;
+	int32 groupLargestStart = -1;
+	int32 groupLargestLength = -1;
+	int32 currentBit = start;
+	bool canFindGroupLargest = start == 0;
+
+	for (; block < group.NumBitmapBlocks(); block++) {
+		if (cached.SetTo(group, block) < B_OK)
+			RETURN_ERROR(B_ERROR);
+
+		T(Block("alloc-in", group.Start() + block, cached.Block(),
+			fVolume->BlockSize(), groupIndex, currentStart));
+
+		// find a block large enough to hold the allocation
+		for (uint32 bit = start % bitsPerFullBlock;
+				bit < cached.NumBlockBits(); bit++) {
+			if (!cached.IsUsed(bit)) {
+				if (currentLength == 0) {
+					// start new range
+					currentStart = currentBit;
 				}
-				currentBit++;
-			}
 
-			T(Block("alloc-out", block, cached.Block(),
-				fVolume->BlockSize(), groupIndex, currentStart));
+				// have we found a range large enough to hold numBlocks?
+				if (++currentLength >= maximum) {
+					_start = currentStart;
+					_length = currentLength;
+					break;
+				}
+			} else {
+				if (currentLength) {
+					// end of a range
+					if (currentLength > _length) {
+						_start = currentStart;
+						_length = currentLength;
+					}
+					if (currentLength > groupLargestLength) {
+						groupLargestStart = currentStart;
+						groupLargestLength = currentLength;
+					}
+					currentLength = 0;
+				}
+				if (((int32)group.NumBits() - currentBit)
+						<= groupLargestLength) {
+					// We can't find a bigger block in this group anymore,
+					// let's skip the rest.
+					block = group.NumBitmapBlocks();
+					break;
+				}
 
-			if (bestLength >= maximum) {
-				canFindGroupLargest = false;
-				break;
+				// Advance the current bit to one before the next free (or last) bit,
+				// so that the next loop iteration will check the next free bit.
+				const uint32 nextFreeOffset = cached.NextFree(bit) - bit;
+				bit += nextFreeOffset - 1;
+				currentBit += nextFreeOffset - 1;
 			}
-
-			// start from the beginning of the next block
-			start = 0;
+			currentBit++;
 		}
 
-		if (currentBit == (int32)group.NumBits()) {
-			if (currentLength > bestLength) {
-				bestGroup = groupIndex;
-				bestStart = currentStart;
-				bestLength = currentLength;
-			}
-			if (canFindGroupLargest && currentLength > groupLargestLength) {
-				groupLargestStart = currentStart;
-				groupLargestLength = currentLength;
-			}
+		T(Block("alloc-out", block, cached.Block(),
+			fVolume->BlockSize(), groupIndex, currentStart));
+
+		if (_length >= maximum) {
+			canFindGroupLargest = false;
+			break;
 		}
 
-		if (canFindGroupLargest && !group.fLargestValid
-			&& groupLargestLength >= 0) {
-			group.fLargestStart = groupLargestStart;
-			group.fLargestLength = groupLargestLength;
-			group.fLargestValid = true;
+		// start from the beginning of the next block
+		start = 0;
+	}
+
+	if (currentBit == (int32)group.NumBits()) {
+		if (currentLength > _length) {
+			_start = currentStart;
+			_length = currentLength;
+		}
+		if (canFindGroupLargest && currentLength > groupLargestLength) {
+			groupLargestStart = currentStart;
+			groupLargestLength = currentLength;
 		}
+	}
 
-		if (bestLength >= maximum)
-			break;
+	if (canFindGroupLargest && !group.fLargestValid
+		&& groupLargestLength >= 0) {
+		group.fLargestStart = groupLargestStart;
+		group.fLargestLength = groupLargestLength;
+		group.fLargestValid = true;
 	}
 
-	// If we found a suitable range, mark the blocks as in use, and
-	// write the updated block bitmap back to disk
-	if (bestLength < minimum)
-		return B_DEVICE_FULL;
+	return B_OK;
+}
+
 
-	if (bestLength > maximum)
-		bestLength = maximum;
+/*!	Marks up to \a maximum blocks of the free range \a start and \a length
+	as in use, and puts the resulting allocation into \a run.
+	The group must be locked by the caller.
+*/
+status_t
+BlockAllocator::_AllocateRange(Transaction& transaction, int32 groupIndex,
+	int32 start, int32 length, uint16 maximum, uint16 minimum, block_run& run)
+{
+	AllocationGroup& group = fGroups[groupIndex];
+	ASSERT_LOCKED_MUTEX(&group.Lock());
+
+	if (length > maximum)
+		length = maximum;
 	else if (minimum > 1) {
-		// make sure bestLength is a multiple of minimum
-		bestLength = round_down(bestLength, minimum);
+		// make sure length is a multiple of minimum
+		length = round_down(length, minimum);
 	}
 
-	if (fGroups[bestGroup].Allocate(transaction, bestStart, bestLength) != B_OK)
+	if (group.Allocate(transaction, start, length) != B_OK)
 		RETURN_ERROR(B_IO_ERROR);
 
-	CHECK_ALLOCATION_GROUP(bestGroup);
+	CHECK_ALLOCATION_GROUP(groupIndex);
 
-	run.allocation_group = HOST_ENDIAN_TO_BFS_INT32(bestGroup);
-	run.start = HOST_ENDIAN_TO_BFS_INT16(bestStart);
-	run.length = HOST_ENDIAN_TO_BFS_INT16(bestLength);
+	run.allocation_group = HOST_ENDIAN_TO_BFS_INT32(groupIndex);
+	run.start = HOST_ENDIAN_TO_BFS_INT16(start);
+	run.length = HOST_ENDIAN_TO_BFS_INT16(length);
 
-	fVolume->SuperBlock().used_blocks
-		= HOST_ENDIAN_TO_BFS_INT64(fVolume->UsedBlocks() + bestLength);
-		// We are not writing back the disk's superblock - it's
-		// either done by the journaling code, or when the disk
-		// is unmounted.
-		// If the value is not correct at mount time, it will be
-		// fixed anyway.
+	_ChangeUsedBlocks(length);
 
 	// We need to flush any remaining blocks in the new allocation to make sure
 	// they won't interfere with the file cache.
@@ -947,6 +1086,76 @@ BlockAllocator::AllocateBlocks(Transaction& transaction, int32 groupIndex,
 }
 
 
+/*!	Returns whether or not the allocation group \a groupIndex is likely to
+	have a free range of \a blocks blocks. This does not lock the group, and
+	can therefore only be a hint. As long as the group is still being
+	initialized, nothing is known about it, and it is assumed to have room.
+*/
+bool
+BlockAllocator::_HasRoomFor(int32 groupIndex, int32 blocks)
+{
+	AllocationGroup& group = fGroups[groupIndex % fNumGroups];
+	if (!group.IsInitialized())
+		return true;
+
+	return group.FreeBits() >= blocks && group.LargestHint() >= blocks;
+}
+
+
+/*!	Returns the allocation group with the most free blocks. The result is
+	only a hint that is maintained without locking: Free() updates it when a
+	group becomes emptier than the current one, and it is only looked for
+	again when the current group no longer has room for \a blocks.
+*/
+int32
+BlockAllocator::_LeastUsedGroup(int32 blocks)
+{
+	int32 leastUsed = atomic_get(&fLeastUsedGroup);
+	if (_HasRoomFor(leastUsed, blocks))
+		return leastUsed;
+
+	int32 mostFree = fGroups[leastUsed].FreeBits();
+	for (int32 i = 0; i < fNumGroups; i++) {
+		int32 freeBits = fGroups[i].FreeBits();
+		if (freeBits > mostFree) {
+			leastUsed = i;
+			mostFree = freeBits;
+		}
+	}
+
+	atomic_set(&fLeastUsedGroup, leastUsed);
+	return leastUsed;
+}
+
+
+void
+BlockAllocator::_ChangeUsedBlocks(off_t blocks)
+{
+	MutexLocker locker(fUsedBlocksLock);
+
+	fVolume->SuperBlock().used_blocks
+		= HOST_ENDIAN_TO_BFS_INT64(fVolume->UsedBlocks() + blocks);
+		// We are not writing back the disk's superblock - it's
+		// either done by the journaling code, or when the disk
+		// is unmounted.
+		// If the value is not correct at mount time, it will be
+		// fixed anyway.
+}
+
+
+/*!	Waits until the initializer thread has read in the block bitmap, and
+	released all group locks.
+*/
+void
+BlockAllocator::_WaitForInitialization()
+{
+	for (int32 i = 0; i < fNumGroups; i++) {
+		mutex_lock(&fGroups[i].Lock());
+		mutex_unlock(&fGroups[i].Lock());
+	}
+}
+
+
 status_t
 BlockAllocator::AllocateForInode(Transaction& transaction,
 	const block_run* parent, mode_t type, block_run& run)
@@ -1021,6 +1230,16 @@ BlockAllocator::Allocate(Transaction& transaction, Inode* inode,
 		group = inode->BlockRun().AllocationGroup() + 1;
 	}
 
+	if (!inode->IsContainer() && !inode->IsSymLink()
+		&& numBlocks >= (kLargeExtentSize >> fVolume->BlockShift())
+		&& !_HasRoomFor(group, numBlocks)) {
+		// A large extent would only be split up in a crowded group, and
+		// we would have to look through all groups after it to find a
+		// better place, so we directly go to the emptiest group instead
+		group = _LeastUsedGroup(numBlocks);
+		start = 0;
+	}
+
 	return AllocateBlocks(transaction, group, start, numBlocks, minimum, run);
 }
 
@@ -1028,7 +1247,7 @@ BlockAllocator::Allocate(Transaction& transaction, Inode* inode,
 status_t
 BlockAllocator::Free(Transaction& transaction, block_run run)
 {
-	RecursiveLocker lock(fLock);
+	ReadLocker locker(fLock);
 
 	int32 group = run.AllocationGroup();
 	uint16 start = run.Start();
@@ -1066,6 +1285,8 @@ BlockAllocator::Free(Transaction& transaction, block_run run)
 		return B_BAD_DATA;
 #endif
 
+	MutexLocker groupLocker(fGroups[group].Lock());
+
 	CHECK_ALLOCATION_GROUP(group);
 
 	if (fGroups[group].Free(transaction, start, length) != B_OK)
@@ -1073,6 +1294,11 @@ BlockAllocator::Free(Transaction& transaction, block_run run)
 
 	CHECK_ALLOCATION_GROUP(group);
 
+	if (fGroups[group].FreeBits()
+			> fGroups[atomic_get(&fLeastUsedGroup)].FreeBits()) {
+		atomic_set(&fLeastUsedGroup, group);
+	}
+
 #ifdef DEBUG
 	if (CheckBlockRun(run, NULL, false) != B_OK) {
 		DEBUGGER(("CheckBlockRun() reports allocated blocks (which were just "
@@ -1080,8 +1306,7 @@ BlockAllocator::Free(Transaction& transaction, block_run run)
 	}
 #endif
 
-	fVolume->SuperBlock().used_blocks =
-		HOST_ENDIAN_TO_BFS_INT64(fVolume->UsedBlocks() - run.Length());
+	_ChangeUsedBlocks(-(off_t)run.Length());
 	return B_OK;
 }
 
@@ -1091,7 +1316,7 @@ void
 BlockAllocator::Fragment()
 {
 	AllocationBlock cached(fVolume);
-	RecursiveLocker lock(fLock);
+	Lock();
 
 	// only leave 4 block holes
 	static const uint32 kMask = 0x0f0f0f0f;
@@ -1103,8 +1328,10 @@ BlockAllocator::Fragment()
 		for (uint32 block = 0; block < group.NumBlocks(); block++) {
 			Transaction transaction(fVolume, 0);
 
-			if (cached.SetToWritable(transaction, group, block) != B_OK)
+			if (cached.SetToWritable(transaction, group, block) != B_OK) {
+				Unlock();
 				return;
+			}
 
 			for (int32 index = 0; index < valuesPerBlock; index++) {
 				cached.Block(index) |= HOST_ENDIAN_TO_BFS_INT32(kMask);
@@ -1113,6 +1340,8 @@ BlockAllocator::Fragment()
 			transaction.Done();
 		}
 	}
+
+	Unlock();
 }
 #endif	// DEBUG_FRAGMENTER
 
@@ -1122,7 +1351,7 @@ void
 BlockAllocator::_CheckGroup(int32 groupIndex) const
 {
 	AllocationBlock cached(fVolume);
-	ASSERT_LOCKED_RECURSIVE(&fLock);
+	ASSERT_LOCKED_MUTEX(&fGroups[groupIndex].Lock());
 
 	AllocationGroup& group = fGroups[groupIndex];
 
@@ -1210,7 +1439,7 @@ BlockAllocator::Trim(uint64 offset, uint64 size, uint64& trimmedSize)
 		return B_NO_MEMORY;
 
 	MemoryDeleter deleter(trimData);
-	RecursiveLocker locker(fLock);
+	ReadLocker locker(fLock);
 
 	// TODO: take given offset and size into account!
 	int32 lastGroup = fNumGroups - 1;
@@ -1229,6 +1458,10 @@ BlockAllocator::Trim(uint64 offset, uint64 size, uint64& trimmedSize)
 	for (int32 groupIndex = 0; groupIndex <= lastGroup; groupIndex++) {
 		AllocationGroup& group = fGroups[groupIndex];
 
+		// The free ranges must not be allocated before they have been
+		// trimmed, so we keep the group locked until then
+		MutexLocker groupLocker(group.Lock());
+
 		for (uint32 block = firstBlock; block < group.NumBitmapBlocks(); block++) {
 			cached.SetTo(group, block);
 
@@ -1262,12 +1495,22 @@ BlockAllocator::Trim(uint64 offset, uint64 size, uint64& trimmedSize)
 			}
 		}
 
+		cached.Unset();
+
+		// Trim everything that is left in this group before unlocking it; a
+		// free range that continues in the next group is just split up
+		status_t status = _TrimNext(*trimData, kTrimRanges,
+			firstFree << blockShift, freeLength << blockShift, true,
+			trimmedSize);
+		if (status != B_OK)
+			return status;
+
+		freeLength = 0;
 		firstBlock = 0;
 		firstBit = 0;
 	}
 
-	return _TrimNext(*trimData, kTrimRanges, firstFree << blockShift,
-		freeLength << blockShift, true, trimmedSize);
+	return B_OK;
 }
 
 
@@ -1385,7 +1628,7 @@ BlockAllocator::_TrimNext(fs_trim_data& trimData, uint32 maxRanges,
 
 	const bool rangesFilled = _AddTrim(trimData, maxRanges, offset, size);
 
-	if (rangesFilled || force) {
+	if ((rangesFilled || force) && trimData.range_count > 0) {
 		// Trim now
 		trimData.trimmed_size = 0;
 #ifdef DEBUG_TRIM
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2013, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 #ifndef BLOCK_ALLOCATOR_H
@@ -9,6 +10,7 @@
 #include "system_dependencies.h"
 
 
+class AllocationBlock;
 class AllocationGroup;
 class Inode;
 class Transaction;
@@ -55,7 +57,8 @@ public:
 			bool			IsValidBlockRun(block_run run,
 								const char* type = NULL);
 
-			recursive_lock&	Lock() { return fLock; }
+			status_t		Lock();
+			void			Unlock();
 
 #ifdef BFS_DEBUGGER_COMMANDS
 			void			Dump(int32 index);
@@ -74,15 +77,32 @@ private:
 								uint64 offset, uint64 size, bool force,
 								uint64& trimmedSize);
 
+			status_t		_FindFreeRange(AllocationBlock& cached,
+								int32 groupIndex, uint16 start,
+								uint16 maximum, int32& _start,
+								int32& _length);
+			status_t		_AllocateRange(Transaction& transaction,
+								int32 groupIndex, int32 start, int32 length,
+								uint16 maximum, uint16 minimum,
+								block_run& run);
+			bool			_HasRoomFor(int32 groupIndex, int32 blocks);
+			int32			_LeastUsedGroup(int32 blocks);
+			void			_ChangeUsedBlocks(off_t blocks);
+			void			_WaitForInitialization();
+
 	static	status_t		_Initialize(BlockAllocator* self);
 
 private:
 			Volume*			fVolume;
-			recursive_lock	fLock;
+			rw_lock			fLock;
+				// read locked by everyone but Lock()
+			mutex			fUsedBlocksLock;
 			AllocationGroup* fGroups;
 			int32			fNumGroups;
 			uint32			fBlocksPerGroup;
 			uint32			fNumBitmapBlocks;
+			int32			fLeastUsedGroup;
+				// only a hint, accessed without locking
 };
 
 #ifdef BFS_DEBUGGER_COMMANDS
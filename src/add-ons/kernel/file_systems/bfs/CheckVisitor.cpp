@@ -1,6 +1,7 @@
 /*
  * Copyright 2002-2020, Axel Dörfler, axeld@pinc-software.de.
  * Copyright 2012, Andreas Henriksson, sausageboy@gmail.com
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 
@@ -51,12 +52,12 @@ CheckVisitor::StartBitmapPass()
 
 	// Lock the volume's journal and block allocator
 	GetVolume()->GetJournal(0)->Lock(NULL, true);
-	recursive_lock_lock(&GetVolume()->Allocator().Lock());
+	GetVolume()->Allocator().Lock();
 
 	size_t size = _BitmapSize();
 	fCheckBitmap = (uint32*)malloc(size);
 	if (fCheckBitmap == NULL) {
-		recursive_lock_unlock(&GetVolume()->Allocator().Lock());
+		GetVolume()->Allocator().Unlock();
 		GetVolume()->GetJournal(0)->Unlock(NULL, true);
 		return B_NO_MEMORY;
 	}
@@ -192,7 +193,7 @@ CheckVisitor::StopChecking()
 
 	_FreeIndices();
 
-	recursive_lock_unlock(&GetVolume()->Allocator().Lock());
+	GetVolume()->Allocator().Unlock();
 	GetVolume()->GetJournal(0)->Unlock(NULL, true);
 	return B_OK;
 }
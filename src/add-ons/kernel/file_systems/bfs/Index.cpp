@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2017, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 
@@ -9,6 +10,8 @@
 
 #include "Index.h"
 
+#include <algorithm>
+
 #include <file_systems/QueryParserUtils.h>
 
 #include "Debug.h"
@@ -17,6 +20,137 @@
 #include "BPlusTree.h"
 
 
+static const uint32 kBulkChunkSize = 32;
+
+struct bulk_entry {
+	ino_t	id;
+	uint16	length;
+	bool	indexed;
+	uint8	key[MAX_INDEX_KEY_LENGTH];
+};
+
+
+/*!	Sorts the entries of a BulkInsert() chunk by key, and by inode ID. */
+class BulkEntryLess {
+public:
+	BulkEntryLess(uint32 type)
+		:
+		fType(type)
+	{
+	}
+
+	bool operator()(const bulk_entry* a, const bulk_entry* b) const
+	{
+		int compare = QueryParser::compareKeys(fType, a->key, a->length,
+			b->key, b->length);
+		if (compare != 0)
+			return compare < 0;
+
+		return a->id < b->id;
+	}
+
+private:
+	uint32	fType;
+};
+
+
+static bool
+bulk_entry_id_less(const bulk_entry* entry, ino_t id)
+{
+	return entry->id < id;
+}
+
+
+/*!	Removes the trigrams of \a oldKey that are not part of \a newKey from
+	the trigram index \a tree, and adds those of \a newKey that were not
+	part of \a oldKey.
+	When filling an index, \a replace makes sure that the node is not listed
+	twice for a trigram, in case its value was written after the index had
+	been created.
+*/
+static status_t
+update_trigrams(Transaction& transaction, BPlusTree* tree,
+	const uint8* oldKey, uint16 oldLength, const uint8* newKey,
+	uint16 newLength, ino_t id, bool replace)
+{
+	uint32* oldTrigrams = (uint32*)malloc(
+		2 * QueryParser::kMaxTrigrams * sizeof(uint32));
+	if (oldTrigrams == NULL)
+		return B_NO_MEMORY;
+
+	MemoryDeleter deleter(oldTrigrams);
+	uint32* newTrigrams = oldTrigrams + QueryParser::kMaxTrigrams;
+
+	int32 oldCount = 0;
+	if (oldKey != NULL) {
+		oldCount = QueryParser::getTrigrams((const char*)oldKey, oldLength,
+			oldTrigrams, QueryParser::kMaxTrigrams);
+	}
+	int32 newCount = 0;
+	if (newKey != NULL) {
+		newCount = QueryParser::getTrigrams((const char*)newKey, newLength,
+			newTrigrams, QueryParser::kMaxTrigrams);
+	}
+
+	// both lists are sorted, so we can just walk them in parallel
+	int32 oldIndex = 0;
+	int32 newIndex = 0;
+	while (oldIndex < oldCount || newIndex < newCount) {
+		uint8 key[QueryParser::kTrigramLength];
+		status_t status = B_OK;
+
+		if (newIndex == newCount || (oldIndex < oldCount
+				&& oldTrigrams[oldIndex] < newTrigrams[newIndex])) {
+			QueryParser::trigramToKey(oldTrigrams[oldIndex++], key);
+			status = tree->Remove(transaction, key, sizeof(key), id);
+			if (status == B_ENTRY_NOT_FOUND) {
+				// the index may have been created after the attribute
+				status = B_OK;
+			}
+		} else if (oldIndex == oldCount
+				|| newTrigrams[newIndex] < oldTrigrams[oldIndex]) {
+			QueryParser::trigramToKey(newTrigrams[newIndex++], key);
+			if (replace) {
+				status = tree->Remove(transaction, key, sizeof(key), id);
+				if (status == B_ENTRY_NOT_FOUND)
+					status = B_OK;
+			}
+			if (status == B_OK)
+				status = tree->Insert(transaction, key, sizeof(key), id);
+		} else {
+			// the trigram stays
+			oldIndex++;
+			newIndex++;
+		}
+
+		if (status != B_OK)
+			RETURN_ERROR(status);
+	}
+
+	// Only the first MAX_INDEX_KEY_LENGTH bytes of a value are passed in; if
+	// there might be more, the value is listed under an extra key, so that
+	// queries always look at it
+	bool wasLong = oldKey != NULL && oldLength >= MAX_INDEX_KEY_LENGTH;
+	bool isLong = newKey != NULL && newLength >= MAX_INDEX_KEY_LENGTH;
+	if (wasLong == isLong && !(isLong && replace))
+		return B_OK;
+
+	const uint8* longKey = (const uint8*)TRIGRAM_LONG_VALUE_KEY;
+	const uint16 longKeyLength = sizeof(TRIGRAM_LONG_VALUE_KEY) - 1;
+
+	status_t status = tree->Remove(transaction, longKey, longKeyLength, id);
+	if (status == B_ENTRY_NOT_FOUND)
+		status = B_OK;
+	if (status == B_OK && isLong)
+		status = tree->Insert(transaction, longKey, longKeyLength, id);
+
+	RETURN_ERROR(status);
+}
+
+
+//	#pragma mark -
+
+
 Index::Index(Volume* volume)
 	:
 	fVolume(volume),
@@ -205,8 +339,12 @@ Index::Create(Transaction& transaction, const char* name, uint32 type)
 	}
 
 	// Inode::Create() will keep the inode locked for us
-	return Inode::Create(transaction, fVolume->IndicesNode(), name,
+	status_t status = Inode::Create(transaction, fVolume->IndicesNode(), name,
 		S_INDEX_DIR | S_DIRECTORY | mode, 0, type, NULL, NULL, &fNode);
+	if (status == B_OK)
+		fVolume->IndexCreated(name);
+
+	return status;
 }
 
 
@@ -248,6 +386,13 @@ Index::Update(Transaction& transaction, const char* name, int32 type,
 			newKey, newLength);
 	}
 
+	if (type == B_STRING_TYPE) {
+		status_t status = _UpdateTrigrams(transaction, name, oldKey, oldLength,
+			newKey, newLength, inode);
+		if (status != B_OK && status != B_BAD_INDEX)
+			return status;
+	}
+
 	if (((name != fName || strcmp(name, fName)) && SetTo(name) != B_OK)
 		|| fNode == NULL)
 		return B_BAD_INDEX;
@@ -283,6 +428,277 @@ Index::Update(Transaction& transaction, const char* name, int32 type,
 }
 
 
+/*!	Adds the inodes \a ids to the index, using the current value of their
+	attribute as key. This is used to populate an index for files that
+	already had the attribute before the index was created.
+	If the inodes are sorted by their attribute value, the tree is built
+	using BPlusTree::Append(), and its nodes will be completely filled.
+	Inodes that don't have the attribute, or that are already part of the
+	index are skipped; \a _inserted is set to the number of inodes that
+	were actually added.
+	Since all changes have to fit into the \a transaction, this might stop
+	before all of the \a _count inodes have been processed; \a _count is
+	set to the number of inodes that have been looked at.
+	The index must have been set via SetTo() before.
+*/
+status_t
+Index::BulkInsert(Transaction& transaction, const ino_t* ids, uint32& _count,
+	uint32& _inserted)
+{
+	uint32 count = _count;
+	_count = 0;
+	_inserted = 0;
+
+	if (fNode == NULL)
+		return B_BAD_INDEX;
+
+	// the built-in indices are always complete
+	if (!strcmp(fName, "name") || !strcmp(fName, "size")
+		|| !strcmp(fName, "last_modified"))
+		return B_NOT_ALLOWED;
+
+	// a trigram index is filled from the attribute it belongs to
+	char attribute[INODE_FILE_NAME_LENGTH];
+	if (QueryParser::getTrigramAttributeName(fName, attribute,
+			sizeof(attribute)) == B_OK) {
+		return _BulkInsertTrigrams(transaction, attribute, ids, count, _count,
+			_inserted);
+	}
+
+	BPlusTree* tree = Node()->Tree();
+	if (tree == NULL)
+		return B_BAD_VALUE;
+
+	uint32 type = Type();
+	size_t keySize = KeySize();
+
+	bulk_entry* entries = (bulk_entry*)malloc(
+		kBulkChunkSize * sizeof(bulk_entry));
+	if (entries == NULL)
+		return B_NO_MEMORY;
+
+	MemoryDeleter entriesDeleter(entries);
+	bulk_entry* sorted[kBulkChunkSize];
+	BulkEntryLess less(type);
+
+	Node()->WriteLockInTransaction(transaction);
+
+	uint8 foundKey[BPLUSTREE_MAX_KEY_LENGTH];
+	Journal* journal = fVolume->GetJournal(0);
+	size_t maxTransactionSize = fVolume->Log().Length() / 4;
+
+	// The inodes are processed in chunks that are sorted by key and ID, so
+	// that the entries an inode might already have in the index only need to
+	// be looked up once per key, and inodes that are listed twice end up
+	// next to each other
+	for (uint32 first = 0; first < count; first += kBulkChunkSize) {
+		if (first > 0 && journal->CurrentTransactionSize() > maxTransactionSize)
+			break;
+
+		uint32 chunkCount = min_c(count - first, kBulkChunkSize);
+		int32 sortedCount = 0;
+
+		for (uint32 i = 0; i < chunkCount; i++) {
+			Vnode vnode(fVolume, ids[first + i]);
+			Inode* inode;
+			if (vnode.Get(&inode) != B_OK || inode->IsDeleted()
+				|| !inode->IsRegularNode())
+				continue;
+
+			bulk_entry& entry = entries[sortedCount];
+			size_t length = MAX_INDEX_KEY_LENGTH;
+			if (inode->ReadAttribute(fName, 0, 0, entry.key, &length) != B_OK
+				|| length == 0 || (keySize != 0 && length != keySize))
+				continue;
+
+			entry.id = inode->ID();
+			entry.length = length;
+			entry.indexed = false;
+			sorted[sortedCount++] = &entry;
+		}
+
+		std::sort(sorted, sorted + sortedCount, less);
+
+		for (int32 start = 0; start < sortedCount;) {
+			bulk_entry* run = sorted[start];
+			int32 end = start + 1;
+			while (end < sortedCount && QueryParser::compareKeys(type,
+					run->key, run->length, sorted[end]->key,
+					sorted[end]->length) == 0) {
+				end++;
+			}
+
+			// Don't add an inode twice; it might have been added when its
+			// attribute was written since the index has been created
+			TreeIterator iterator(tree);
+			if (iterator.Find(run->key, run->length) == B_OK) {
+				uint16 foundLength;
+				off_t value;
+				while (iterator.GetNextEntry(foundKey, &foundLength,
+						sizeof(foundKey), &value) == B_OK
+					&& QueryParser::compareKeys(type, run->key, run->length,
+						foundKey, foundLength) == 0) {
+					bulk_entry** found = std::lower_bound(sorted + start,
+						sorted + end, (ino_t)value, bulk_entry_id_less);
+					if (found != sorted + end && (*found)->id == value)
+						(*found)->indexed = true;
+				}
+			}
+
+			for (int32 i = start; i < end; i++) {
+				bulk_entry* entry = sorted[i];
+				if (entry->indexed
+					|| (i > start && sorted[i - 1]->id == entry->id))
+					continue;
+
+				Vnode vnode(fVolume, entry->id);
+				Inode* inode;
+				if (vnode.Get(&inode) != B_OK)
+					continue;
+
+				status_t status = tree->Append(transaction, entry->key,
+					entry->length, entry->id);
+				if (status != B_OK)
+					RETURN_ERROR(status);
+
+				if (type == B_STRING_TYPE) {
+					status = _UpdateTrigrams(transaction, fName, NULL, 0,
+						entry->key, entry->length, inode);
+					if (status != B_OK && status != B_BAD_INDEX)
+						RETURN_ERROR(status);
+				}
+
+				_inserted++;
+			}
+
+			start = end;
+		}
+
+		_count = first + chunkCount;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Marks the trigram index as listing all files that have its attribute,
+	so that queries start to use it. This must only be called once all files
+	that had the attribute before the index was created have been added to
+	it via BulkInsert().
+*/
+status_t
+Index::SetTrigramsComplete(Transaction& transaction)
+{
+	if (fNode == NULL)
+		return B_BAD_INDEX;
+
+	char attribute[INODE_FILE_NAME_LENGTH];
+	if (QueryParser::getTrigramAttributeName(fName, attribute,
+			sizeof(attribute)) != B_OK) {
+		return B_BAD_VALUE;
+	}
+
+	Node()->WriteLockInTransaction(transaction);
+	Node()->Node().flags |= HOST_ENDIAN_TO_BFS_INT32(INODE_TRIGRAMS_COMPLETE);
+	return Node()->WriteBack(transaction);
+}
+
+
+/*!	Adds the trigrams of the \a attribute of the inodes \a ids to this
+	trigram index; see BulkInsert().
+	Since the name is not an actual attribute, it is taken from the inode.
+*/
+status_t
+Index::_BulkInsertTrigrams(Transaction& transaction, const char* attribute,
+	const ino_t* ids, uint32 count, uint32& _count, uint32& _inserted)
+{
+	BPlusTree* tree = Node()->Tree();
+	if (tree == NULL)
+		return B_BAD_VALUE;
+
+	bool isName = !strcmp(attribute, "name");
+	if (!isName && (!strcmp(attribute, "size")
+			|| !strcmp(attribute, "last_modified"))) {
+		return B_BAD_TYPE;
+	}
+
+	Node()->WriteLockInTransaction(transaction);
+
+	Journal* journal = fVolume->GetJournal(0);
+	size_t maxTransactionSize = fVolume->Log().Length() / 4;
+	uint8 key[INODE_FILE_NAME_LENGTH];
+
+	for (uint32 i = 0; i < count; i++) {
+		if (i > 0 && journal->CurrentTransactionSize() > maxTransactionSize)
+			break;
+
+		_count = i + 1;
+
+		Vnode vnode(fVolume, ids[i]);
+		Inode* inode;
+		if (vnode.Get(&inode) != B_OK || inode->IsDeleted()
+			|| !inode->IsRegularNode())
+			continue;
+
+		size_t length = MAX_INDEX_KEY_LENGTH;
+		if (isName) {
+			if (inode->GetName((char*)key, sizeof(key)) != B_OK)
+				continue;
+			length = strlen((char*)key);
+		} else if (inode->ReadAttribute(attribute, 0, 0, key, &length)
+				!= B_OK) {
+			continue;
+		}
+		if (length == 0)
+			continue;
+
+		status_t status = update_trigrams(transaction, tree, NULL, 0, key,
+			length, inode->ID(), true);
+		if (status != B_OK)
+			RETURN_ERROR(status);
+
+		_inserted++;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Updates the trigram index of the attribute \a name, if there is one.
+	Only the trigrams that differ between the old and the new key are
+	removed from, or added to the index.
+	Returns B_BAD_INDEX if there is no trigram index for the attribute.
+*/
+status_t
+Index::_UpdateTrigrams(Transaction& transaction, const char* name,
+	const uint8* oldKey, uint16 oldLength, const uint8* newKey,
+	uint16 newLength, Inode* inode)
+{
+	// avoid the index lookup on the common volume without trigram indices
+	if (!fVolume->HasTrigramIndices())
+		return B_BAD_INDEX;
+
+	char indexName[INODE_FILE_NAME_LENGTH];
+	if (QueryParser::getTrigramIndexName(name, indexName, sizeof(indexName))
+			!= B_OK) {
+		return B_BAD_INDEX;
+	}
+
+	Index index(fVolume);
+	if (index.SetTo(indexName) != B_OK)
+		return B_BAD_INDEX;
+
+	BPlusTree* tree = index.Node()->Tree();
+	if (tree == NULL)
+		return B_BAD_VALUE;
+
+	index.Node()->WriteLockInTransaction(transaction);
+
+	return update_trigrams(transaction, tree, oldKey, oldLength, newKey,
+		newLength, inode->ID(), false);
+}
+
+
 status_t
 Index::InsertName(Transaction& transaction, const char* name, Inode* inode)
 {
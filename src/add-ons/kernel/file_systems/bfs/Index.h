@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2012, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 #ifndef INDEX_H
@@ -34,6 +35,10 @@ public:
 								uint16 oldLength, const uint8* newKey,
 								uint16 newLength, Inode* inode,
 								bool updateLiveQueries = true);
+			status_t		BulkInsert(Transaction& transaction,
+								const ino_t* ids, uint32& _count,
+								uint32& _inserted);
+			status_t		SetTrigramsComplete(Transaction& transaction);
 
 			status_t		InsertName(Transaction& transaction,
 								const char* name, Inode* inode);
@@ -59,6 +64,15 @@ private:
 							Index& operator=(const Index& other);
 								// no implementation
 
+			status_t		_BulkInsertTrigrams(Transaction& transaction,
+								const char* attribute, const ino_t* ids,
+								uint32 count, uint32& _count,
+								uint32& _inserted);
+			status_t		_UpdateTrigrams(Transaction& transaction,
+								const char* name, const uint8* oldKey,
+								uint16 oldLength, const uint8* newKey,
+								uint16 newLength, Inode* inode);
+
 private:
 			Volume*			fVolume;
 			Inode*			fNode;
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2020, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 
@@ -344,7 +345,8 @@ Inode::Inode(Volume* volume, ino_t id)
 	fTree(NULL),
 	fAttributes(NULL),
 	fCache(NULL),
-	fMap(NULL)
+	fMap(NULL),
+	fReservedBlocks(0)
 {
 	PRINT(("Inode::Inode(volume = %p, id = %" B_PRIdINO ") @ %p\n",
 		volume, id, this));
@@ -378,7 +380,8 @@ Inode::Inode(Volume* volume, Transaction& transaction, ino_t id, mode_t mode,
 	fTree(NULL),
 	fAttributes(NULL),
 	fCache(NULL),
-	fMap(NULL)
+	fMap(NULL),
+	fReservedBlocks(0)
 {
 	PRINT(("Inode::Inode(volume = %p, transaction = %p, id = %" B_PRIdINO
 		") @ %p\n", volume, &transaction, id, this));
@@ -424,6 +427,8 @@ Inode::~Inode()
 	file_map_delete(Map());
 	delete fTree;
 
+	fVolume->UpdateReservation(this, fReservedBlocks, 0);
+
 	rw_lock_destroy(&fLock);
 	recursive_lock_destroy(&fSmallDataLock);
 }
@@ -1776,14 +1781,12 @@ Inode::_GrowStream(Transaction& transaction, off_t size)
 			if (size < 1 * 1024 * 1024 && bytes < 512 * 1024) {
 				// Preallocate 64 KB for file sizes <1 MB and grow rates <512 KB
 				roundTo = 65536 >> fVolume->BlockShift();
-			} else if (size < 32 * 1024 * 1024 && bytes <= 1 * 1024 * 1024) {
-				// Preallocate 512 KB for file sizes between 1 MB and 32 MB, and
-				// grow rates smaller than 1 MB
-				roundTo = (512 * 1024) >> fVolume->BlockShift();
 			} else {
-				// Preallocate 1/16 of the file size (ie. 4 MB for 64 MB,
-				// 64 MB for 1 GB)
-				roundTo = size >> (fVolume->BlockShift() + 4);
+				// Preallocate 1/8 of the file size, but at least 512 KB (ie.
+				// 1 MB for 8 MB, 128 MB for 1 GB): the extents grow with the
+				// file, so that files that are written in many small steps,
+				// or next to others, still end up in only a few runs
+				roundTo = max_c(512 * 1024, size >> 3) >> fVolume->BlockShift();
 			}
 		} else if (IsIndex()) {
 			// Always preallocate 64 KB for index directories
@@ -2341,10 +2344,38 @@ Inode::TrimPreallocation(Transaction& transaction)
 	if (status < B_OK)
 		return status;
 
+	fVolume->UpdateReservation(this, fReservedBlocks, 0);
+
 	return WriteBack(transaction);
 }
 
 
+/*!	Called when a file that has been written to is closed, instead of trimming
+	its preallocated blocks right away. They stay reserved for the file until
+	its vnode is released, so that the next writer can continue where the
+	last one stopped, and files that are appended to every now and then (like
+	logs) still grow contiguously.
+	Returns \c false if the blocks should be trimmed anyway, because too many
+	blocks are already reserved that way.
+	The inode must be locked.
+*/
+bool
+Inode::KeepPreallocation()
+{
+	off_t blocks = 0;
+	if (IsFile() && !IsDeleted()) {
+		const data_stream& data = Node().data;
+		off_t allocated = max_c(data.MaxDirectRange(),
+			max_c(data.MaxIndirectRange(), data.MaxDoubleIndirectRange()));
+
+		blocks = (allocated - round_up(Size(), fVolume->BlockSize()))
+			>> fVolume->BlockShift();
+	}
+
+	return fVolume->UpdateReservation(this, fReservedBlocks, blocks);
+}
+
+
 //!	Frees the file's data stream and removes all attributes
 status_t
 Inode::Free(Transaction& transaction)
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2020, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 #ifndef INODE_H
@@ -29,6 +30,7 @@ class Transaction;
 
 class Inode : public TransactionListener {
 	typedef DoublyLinkedListLink<Inode> Link;
+	friend class ReservedInodeGetLink;
 
 public:
 								Inode(Volume* volume, ino_t id);
@@ -155,6 +157,7 @@ public:
 			status_t			Append(Transaction& transaction, off_t bytes);
 			status_t			TrimPreallocation(Transaction& transaction);
 			bool				NeedsTrimming() const;
+			bool				KeepPreallocation();
 
 			status_t			Free(Transaction& transaction);
 			status_t			Sync();
@@ -268,6 +271,10 @@ private:
 			off_t				fOldLastModified;
 				// we need those values to ensure we will remove
 				// the correct keys from the indices
+			off_t				fReservedBlocks;
+				// preallocated blocks kept after the file has been closed,
+				// guarded by the volume's reservation lock
+			Link				fReservationLink;
 
 			mutable recursive_lock fSmallDataLock;
 			SinglyLinkedList<AttributeIterator> fIterators;
@@ -298,6 +305,20 @@ Inode::InLastModifiedIndex() const
 }
 
 
+inline DoublyLinkedListLink<Inode>*
+ReservedInodeGetLink::operator()(Inode* inode) const
+{
+	return &inode->fReservationLink;
+}
+
+
+inline const DoublyLinkedListLink<Inode>*
+ReservedInodeGetLink::operator()(const Inode* inode) const
+{
+	return &inode->fReservationLink;
+}
+
+
 #if _KERNEL_MODE && KDEBUG
 #	define ASSERT_READ_LOCKED_INODE(inode) inode->AssertReadLocked()
 #	define ASSERT_WRITE_LOCKED_INODE(inode) inode->AssertWriteLocked()
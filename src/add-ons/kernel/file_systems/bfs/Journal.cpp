@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2020, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 
@@ -11,10 +12,18 @@
 
 #include "Journal.h"
 
+#include "bfs_control.h"
 #include "Debug.h"
 #include "Inode.h"
 
 
+static const bigtime_t kGroupCommitWindow = 1000;
+	// how long a commit waits for other transactions to join it
+static const bigtime_t kGroupCommitInterval = 20000;
+	// only commits that follow this closely on a commit of another thread
+	// will wait for others to join
+
+
 struct run_array {
 	int32		count;
 	int32		max_runs;
@@ -407,10 +416,25 @@ Journal::Journal(Volume* volume)
 	fUsed(0),
 	fUnwrittenTransactions(0),
 	fHasSubtransaction(false),
-	fSeparateSubTransactions(false)
+	fSeparateSubTransactions(false),
+	fEndedTransactions(0),
+	fLoggedTransactions(0),
+	fCommitWaiters(0),
+	fStartedCommits(0),
+	fFinishedCommits(0),
+	fLastCommitThread(-1),
+	fLastCommitTime(0),
+	fStatisticsStart(system_time()),
+	fTransactionCount(0),
+	fLogWrites(0),
+	fLoggedBlocks(0),
+	fCommitRequests(0),
+	fCommitWrites(0)
 {
 	recursive_lock_init(&fLock, "bfs journal");
 	mutex_init(&fEntriesLock, "bfs journal entries");
+	mutex_init(&fCommitLock, "bfs journal commit");
+	fCommitSem = create_sem(0, "bfs journal commit");
 
 	fLogFlusherSem = create_sem(0, "bfs log flusher");
 	fLogFlusher = spawn_kernel_thread(&Journal::_LogFlusher, "bfs log flusher",
@@ -426,6 +450,8 @@ Journal::~Journal()
 
 	recursive_lock_destroy(&fLock);
 	mutex_destroy(&fEntriesLock);
+	mutex_destroy(&fCommitLock);
+	delete_sem(fCommitSem);
 
 	sem_id logFlusher = fLogFlusherSem;
 	fLogFlusherSem = -1;
@@ -437,6 +463,9 @@ Journal::~Journal()
 status_t
 Journal::InitCheck()
 {
+	if (fCommitSem < 0)
+		return fCommitSem;
+
 	return B_OK;
 }
 
@@ -778,10 +807,12 @@ Journal::_WriteTransactionToLog()
 			fTransactionID = cache_detach_sub_transaction(fVolume->BlockCache(),
 				fTransactionID, NULL, NULL);
 			fUnwrittenTransactions = 1;
+			atomic_set(&fLoggedTransactions, fEndedTransactions - 1);
 		} else {
 			cache_end_transaction(fVolume->BlockCache(), fTransactionID, NULL,
 				NULL);
 			fUnwrittenTransactions = 0;
+			atomic_set(&fLoggedTransactions, fEndedTransactions);
 		}
 		return B_OK;
 	}
@@ -893,6 +924,9 @@ Journal::_WriteTransactionToLog()
 	// If that call fails, we can't do anything about it anyway
 	ioctl(fVolume->Device(), B_FLUSH_DRIVE_CACHE);
 
+	fLogWrites++;
+	fLoggedBlocks += runArrays.LogEntryLength();
+
 	// at this point, we can finally end the transaction - we're in
 	// a guaranteed valid state
 
@@ -905,6 +939,7 @@ Journal::_WriteTransactionToLog()
 		fTransactionID = cache_detach_sub_transaction(fVolume->BlockCache(),
 			fTransactionID, _TransactionWritten, logEntry);
 		fUnwrittenTransactions = 1;
+		atomic_set(&fLoggedTransactions, fEndedTransactions - 1);
 
 		if (status == B_OK && _TransactionSize() > fLogSize) {
 			// If the transaction is too large after writing, there is no way to
@@ -917,6 +952,7 @@ Journal::_WriteTransactionToLog()
 		cache_end_transaction(fVolume->BlockCache(), fTransactionID,
 			_TransactionWritten, logEntry);
 		fUnwrittenTransactions = 0;
+		atomic_set(&fLoggedTransactions, fEndedTransactions);
 	}
 
 	return status;
@@ -966,6 +1002,105 @@ Journal::FlushLogAndBlocks()
 }
 
 
+/*!	Makes sure that all transactions that have been completed before this
+	call are stored in the log, and that the drive has flushed its cache, so
+	that they, and all data written before, survive a crash.
+
+	Concurrent callers are grouped together: only one of them writes out the
+	log and flushes the drive cache for all of the others ("group commit").
+	If commits of different threads follow each other closely, the one doing
+	the work waits a short moment for further transactions to end, so that
+	they can share the log write as well.
+	This must not be called with a transaction running.
+*/
+status_t
+Journal::CommitLog()
+{
+	thread_id thread = find_thread(NULL);
+
+	mutex_lock(&fCommitLock);
+	fCommitRequests++;
+
+	// Any commit that starts after this point covers our transactions
+	int32 needed = fStartedCommits + 1;
+
+	while (fStartedCommits != fFinishedCommits) {
+		// Another thread is committing the log right now, wait for it
+		fCommitWaiters++;
+		mutex_unlock(&fCommitLock);
+		acquire_sem(fCommitSem);
+		mutex_lock(&fCommitLock);
+
+		if (fFinishedCommits - needed >= 0) {
+			// someone did the work for us
+			mutex_unlock(&fCommitLock);
+			return B_OK;
+		}
+	}
+
+	fStartedCommits++;
+	fCommitWrites++;
+
+	bool wait = fLastCommitThread != thread
+		&& system_time() - fLastCommitTime < kGroupCommitInterval;
+	mutex_unlock(&fCommitLock);
+
+	if (wait)
+		snooze(kGroupCommitWindow);
+
+	int32 target = atomic_get(&fEndedTransactions);
+	int64 logWrites = fLogWrites;
+	status_t status = B_OK;
+
+	// If the current transaction is too large to be written at once, the
+	// first attempt will only write back its parent transaction
+	for (int32 tries = 0; tries < 2 && status == B_OK
+			&& atomic_get(&fLoggedTransactions) - target < 0; tries++) {
+		status = _FlushLog(true, false);
+	}
+
+	if (status == B_OK && fLogWrites == logWrites) {
+		// Writing the log did not flush the drive cache for us
+		ioctl(fVolume->Device(), B_FLUSH_DRIVE_CACHE);
+	}
+
+	mutex_lock(&fCommitLock);
+	fFinishedCommits = fStartedCommits;
+	fLastCommitThread = thread;
+	fLastCommitTime = system_time();
+
+	int32 waiters = fCommitWaiters;
+	fCommitWaiters = 0;
+	mutex_unlock(&fCommitLock);
+
+	if (waiters > 0)
+		release_sem_etc(fCommitSem, waiters, 0);
+
+	return status;
+}
+
+
+void
+Journal::GetStatistics(bfs_journal_stats& stats)
+{
+	recursive_lock_lock(&fLock);
+
+	stats.log_size = fLogSize;
+	stats.max_transaction_size = fMaxTransactionSize;
+	stats.elapsed = system_time() - fStatisticsStart;
+	stats.transactions = fTransactionCount;
+	stats.log_writes = fLogWrites;
+	stats.logged_blocks = fLoggedBlocks;
+
+	recursive_lock_unlock(&fLock);
+
+	mutex_lock(&fCommitLock);
+	stats.commit_requests = fCommitRequests;
+	stats.commit_writes = fCommitWrites;
+	mutex_unlock(&fCommitLock);
+}
+
+
 status_t
 Journal::Lock(Transaction* owner, bool separateSubTransactions)
 {
@@ -1075,11 +1210,15 @@ Journal::_TransactionDone(bool success)
 		} else {
 			cache_abort_transaction(fVolume->BlockCache(), fTransactionID);
 			fUnwrittenTransactions = 0;
+			atomic_set(&fLoggedTransactions, fEndedTransactions);
 		}
 
 		return B_OK;
 	}
 
+	atomic_add(&fEndedTransactions, 1);
+	fTransactionCount++;
+
 	// Up to a maximum size, we will just batch several
 	// transactions together to improve speed
 	uint32 size = _TransactionSize();
@@ -1118,6 +1257,20 @@ Journal::Dump()
 	kprintf("  transaction ID:       %" B_PRId32 "\n", fTransactionID);
 	kprintf("  has subtransaction:   %d\n", fHasSubtransaction);
 	kprintf("  separate sub-trans.:  %d\n", fSeparateSubTransactions);
+	kprintf("  ended transactions:   %" B_PRId32 "\n", fEndedTransactions);
+	kprintf("  logged transactions:  %" B_PRId32 "\n", fLoggedTransactions);
+
+	bigtime_t elapsed = max_c(system_time() - fStatisticsStart, 1);
+	kprintf("  transactions:         %" B_PRId64 "\n", fTransactionCount);
+	kprintf("  log writes:           %" B_PRId64 " (%" B_PRId64 "/s)\n",
+		fLogWrites, fLogWrites * 1000000 / elapsed);
+	if (fLogWrites > 0) {
+		kprintf("  avg. batch size:      %" B_PRId64 " transactions, %"
+			B_PRId64 " blocks\n", fTransactionCount / fLogWrites,
+			fLoggedBlocks / fLogWrites);
+	}
+	kprintf("  commits:              %" B_PRId64 " requested, %" B_PRId64
+		" done\n", fCommitRequests, fCommitWrites);
 	kprintf("entries:\n");
 	kprintf("  address        id  start length\n");
 
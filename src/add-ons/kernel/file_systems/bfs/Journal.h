@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2012, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 #ifndef JOURNAL_H
@@ -12,6 +13,7 @@
 #include "Utility.h"
 
 
+struct bfs_journal_stats;
 struct run_array;
 class Inode;
 class LogEntry;
@@ -36,11 +38,14 @@ public:
 			bool			CurrentTransactionTooLarge() const;
 
 			status_t		FlushLogAndBlocks();
+			status_t		CommitLog();
 			Volume*			GetVolume() const { return fVolume; }
 			int32			TransactionID() const { return fTransactionID; }
 
 	inline	uint32			FreeLogBlocks() const;
 
+			void			GetStatistics(bfs_journal_stats& stats);
+
 #ifdef BFS_DEBUGGER_COMMANDS
 			void			Dump();
 #endif
@@ -79,6 +84,27 @@ private:
 
 			thread_id		fLogFlusher;
 			sem_id			fLogFlusherSem;
+
+			int32			fEndedTransactions;
+			int32			fLoggedTransactions;
+				// sequence numbers of the last transaction that has been
+				// completed, and the last one that has been written to the log
+
+			mutex			fCommitLock;
+			sem_id			fCommitSem;
+			int32			fCommitWaiters;
+			int32			fStartedCommits;
+			int32			fFinishedCommits;
+			thread_id		fLastCommitThread;
+			bigtime_t		fLastCommitTime;
+
+			// statistics
+			bigtime_t		fStatisticsStart;
+			int64			fTransactionCount;
+			int64			fLogWrites;
+			int64			fLoggedBlocks;
+			int64			fCommitRequests;
+			int64			fCommitWrites;
 };
 
 
@@ -1,7 +1,7 @@
 /*
  * Copyright 2001-2020, Axel Dörfler, axeld@pinc-software.de.
  * Copyright 2010, Clemens Zeidler <haiku@clemens-zeidler.de>
- * Copyright 2024, Haiku, Inc. All rights reserved.
+ * Copyright 2024-2026, Haiku, Inc. All rights reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -57,6 +57,7 @@ struct Query::QueryPolicy {
 	};
 
 	static const int32 kMaxFileNameLength = INODE_FILE_NAME_LENGTH;
+	static const bool kHasTrigramIndices = true;
 
 	// Entry interface
 
@@ -140,6 +141,12 @@ struct Query::QueryPolicy {
 		return index.KeySize();
 	}
 
+	static bool IndexHasAllTrigrams(Index& index)
+	{
+		// set once the index has been filled with the existing values
+		return (index.Node()->Flags() & INODE_TRIGRAMS_COMPLETE) != 0;
+	}
+
 	static IndexIterator* IndexCreateIterator(Index& index)
 	{
 		IndexIterator* iterator = new(std::nothrow) IndexIterator(index.Node()->Tree());
@@ -206,6 +213,12 @@ struct Query::QueryPolicy {
 		return B_OK;
 	}
 
+	static ino_t IndexIteratorGetNodeID(IndexIterator* iterator)
+	{
+		// the values of an index are the block numbers of the inodes
+		return iterator->offset;
+	}
+
 	static void IndexIteratorSkipDuplicates(IndexIterator* iterator)
 	{
 		iterator->SkipDuplicates();
@@ -285,6 +298,13 @@ struct Query::QueryPolicy {
 
 	// Volume interface
 
+	static status_t ContextGetEntry(Context* context, ino_t id,
+		NodeHolder& holder, Inode** _entry)
+	{
+		holder.vnode.SetTo(context->fVolume, id);
+		return holder.vnode.Get(_entry);
+	}
+
 	static dev_t ContextGetVolumeID(Context* context)
 	{
 		return context->fVolume->ID();
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2019, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 
@@ -7,7 +8,10 @@
 //! superblock, mounting, etc.
 
 
+#include <file_systems/QueryParserUtils.h>
+
 #include "Attribute.h"
+#include "BPlusTree.h"
 #include "CheckVisitor.h"
 #include "Debug.h"
 #include "file_systems/DeviceOpener.h"
@@ -131,18 +135,22 @@ Volume::Volume(fs_volume* volume)
 	fBlockAllocator(this),
 	fRootNode(NULL),
 	fIndicesNode(NULL),
+	fHasTrigramIndices(false),
 	fDirtyCachedBlocks(0),
 	fFlags(0),
 	fCheckingThread(-1),
-	fCheckVisitor(NULL)
+	fCheckVisitor(NULL),
+	fReservedBlocks(0)
 {
 	mutex_init(&fLock, "bfs volume");
 	mutex_init(&fQueryLock, "bfs queries");
+	mutex_init(&fReservationLock, "bfs reservations");
 }
 
 
 Volume::~Volume()
 {
+	mutex_destroy(&fReservationLock);
 	mutex_destroy(&fQueryLock);
 	mutex_destroy(&fLock);
 }
@@ -276,6 +284,7 @@ Volume::Mount(const char* deviceName, uint32 flags)
 				}
 			} else {
 				// we don't use the vnode layer to access the indices node
+				_CheckForTrigramIndices();
 			}
 		} else {
 			FATAL(("could not create root node: publish_vnode() failed!\n"));
@@ -370,6 +379,42 @@ Volume::CreateIndicesRoot(Transaction& transaction)
 }
 
 
+/*!	Must be called whenever an index has been created, so that string
+	attribute updates start to maintain the trigram index \a name refers to.
+*/
+void
+Volume::IndexCreated(const char* name)
+{
+	size_t length = strlen(name);
+	size_t suffixLength = strlen(TRIGRAM_INDEX_SUFFIX);
+	if (length > suffixLength
+		&& !strcmp(name + length - suffixLength, TRIGRAM_INDEX_SUFFIX))
+		fHasTrigramIndices = true;
+}
+
+
+/*!	Scans the index directory for trigram indices; as long as there are
+	none, string attribute updates don't need to look for them.
+	The flag is not reset when a trigram index is removed again.
+*/
+void
+Volume::_CheckForTrigramIndices()
+{
+	BPlusTree* tree = fIndicesNode->Tree();
+	if (tree == NULL)
+		return;
+
+	TreeIterator iterator(tree);
+	char name[B_FILE_NAME_LENGTH];
+	uint16 length;
+	off_t id;
+	while (!fHasTrigramIndices && iterator.GetNextEntry(name, &length,
+			sizeof(name), &id) == B_OK) {
+		IndexCreated(name);
+	}
+}
+
+
 status_t
 Volume::CreateVolumeID(Transaction& transaction)
 {
@@ -403,6 +448,94 @@ Volume::AllocateForInode(Transaction& transaction, const Inode* parent,
 }
 
 
+/*!	Replaces the reservation \a reserved of \a inode with \a blocks blocks.
+	Reserved blocks are preallocated blocks that an inode may keep after it
+	has been closed. Only a small part of the free space may be reserved that
+	way; if there is not enough room, the old reservation is still released.
+	Returns whether or not the new reservation could be made.
+*/
+bool
+Volume::UpdateReservation(Inode* inode, off_t& reserved, off_t blocks)
+{
+	MutexLocker locker(fReservationLock);
+
+	if (reserved > 0)
+		fReservedInodes.Remove(inode);
+
+	fReservedBlocks -= reserved;
+	reserved = 0;
+
+	if (blocks <= 0 || fReservedBlocks + blocks > (FreeBlocks() >> 5))
+		return false;
+
+	fReservedBlocks += blocks;
+	reserved = blocks;
+	fReservedInodes.Add(inode);
+	return true;
+}
+
+
+/*!	Trims the preallocated blocks of the inodes that kept them reserved after
+	they had been closed, so that an allocation that failed because the volume
+	was full can be retried.
+	Must not be called with a transaction running, or with an inode locked.
+	Returns whether or not any reservations were outstanding.
+*/
+bool
+Volume::TrimReservations()
+{
+	if (IsReadOnly())
+		return false;
+
+	bool outstanding = false;
+
+	// The inodes can only be locked without the reservation lock held, so
+	// collect their IDs in batches first; the vnode references keep them
+	// alive then. Every inode that is handled leaves the list, so we are
+	// done once it is empty, or once a whole batch could not be trimmed.
+	while (true) {
+		ino_t ids[64];
+		int32 count = 0;
+
+		MutexLocker locker(fReservationLock);
+		ReservedInodeList::Iterator iterator = fReservedInodes.GetIterator();
+		while (count < (int32)B_COUNT_OF(ids) && iterator.HasNext())
+			ids[count++] = iterator.Next()->ID();
+		locker.Unlock();
+
+		if (count == 0)
+			break;
+
+		outstanding = true;
+		int32 released = 0;
+
+		for (int32 i = 0; i < count; i++) {
+			Vnode vnode(this, ids[i]);
+			Inode* inode;
+			if (vnode.Get(&inode) != B_OK)
+				continue;
+
+			Transaction transaction(this, inode->BlockNumber());
+			inode->WriteLockInTransaction(transaction);
+
+			if (!inode->NeedsTrimming()) {
+				// nothing left to trim, just drop the stale reservation
+				inode->KeepPreallocation();
+				released++;
+			} else if (inode->TrimPreallocation(transaction) == B_OK) {
+				transaction.Done();
+				released++;
+			}
+		}
+
+		if (released == 0)
+			break;
+	}
+
+	return outstanding;
+}
+
+
 status_t
 Volume::WriteSuperBlock()
 {
@@ -548,7 +681,7 @@ Volume::Identify(int fd, disk_super_block* superBlock)
 
 status_t
 Volume::Initialize(int fd, const char* name, uint32 blockSize,
-	uint32 flags)
+	uint32 logSize, uint32 flags)
 {
 	// although there is no really good reason for it, we won't
 	// accept '/' in disk names (mkbfs does this, too - and since
@@ -585,18 +718,30 @@ Volume::Initialize(int fd, const char* name, uint32 blockSize,
 	fBlockShift = fSuperBlock.BlockShift();
 	fAllocationGroupShift = fSuperBlock.AllocationGroupShift();
 
-	// determine log size depending on the size of the volume
-	off_t logSize = 2048;
-	if (numBlocks <= 20480)
-		logSize = 512;
-	if (deviceSize > 1LL * 1024 * 1024 * 1024)
-		logSize = 4096;
+	// determine log size depending on the size of the volume; a larger log
+	// allows for larger batches of transactions to be written at once
+	if (logSize == 0) {
+		logSize = 2048;
+		if (numBlocks <= 20480)
+			logSize = 512;
+		if (deviceSize > 1LL * 1024 * 1024 * 1024)
+			logSize = 4096;
+		if (deviceSize > 32LL * 1024 * 1024 * 1024)
+			logSize = 8192;
+		if (deviceSize > 256LL * 1024 * 1024 * 1024)
+			logSize = 16384;
+	}
+	if (logSize < BFS_MIN_LOG_SIZE || logSize > BFS_MAX_LOG_SIZE)
+		return B_BAD_VALUE;
 
 	// since the allocator has not been initialized yet, we
 	// cannot use BlockAllocator::BitmapSize() here
 	off_t bitmapBlocks = (numBlocks + blockSize * 8 - 1) / (blockSize * 8);
 
+	// the log must not span more than one allocation group
 	fSuperBlock.log_blocks = ToBlockRun(bitmapBlocks + 1);
+	logSize = min_c(logSize,
+		(1UL << fAllocationGroupShift) - fSuperBlock.log_blocks.Start());
 	fSuperBlock.log_blocks.length = HOST_ENDIAN_TO_BFS_INT16(logSize);
 	fSuperBlock.log_start = fSuperBlock.log_end = HOST_ENDIAN_TO_BFS_INT64(
 		ToBlock(Log()));
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2012, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 #ifndef VOLUME_H
@@ -28,6 +29,15 @@ enum volume_initialize_flags {
 
 typedef DoublyLinkedList<Inode> InodeList;
 
+class ReservedInodeGetLink {
+public:
+	inline DoublyLinkedListLink<Inode>* operator()(Inode* inode) const;
+	inline const DoublyLinkedListLink<Inode>* operator()(
+		const Inode* inode) const;
+};
+
+typedef DoublyLinkedList<Inode, ReservedInodeGetLink> ReservedInodeList;
+
 
 class Volume {
 public:
@@ -37,7 +47,8 @@ public:
 			status_t		Mount(const char* device, uint32 flags);
 			status_t		Unmount();
 			status_t		Initialize(int fd, const char* name,
-								uint32 blockSize, uint32 flags);
+								uint32 blockSize, uint32 logSize,
+								uint32 flags);
 
 			bool			IsInitializing() const { return fVolume == NULL; }
 
@@ -51,6 +62,9 @@ public:
 			Inode*			RootNode() const { return fRootNode; }
 			block_run		Indices() const { return fSuperBlock.indices; }
 			Inode*			IndicesNode() const { return fIndicesNode; }
+			bool			HasTrigramIndices() const
+								{ return fHasTrigramIndices; }
+			void			IndexCreated(const char* name);
 			block_run		Log() const { return fSuperBlock.log_blocks; }
 			vint32&			LogStart() { return fLogStart; }
 			vint32&			LogEnd() { return fLogEnd; }
@@ -114,6 +128,11 @@ public:
 								off_t numBlocks, block_run& run,
 								uint16 minimum = 1);
 			status_t		Free(Transaction& transaction, block_run run);
+			bool			UpdateReservation(Inode* inode,
+								off_t& reserved, off_t blocks);
+			bool			TrimReservations();
+			off_t			ReservedBlocks() const
+								{ return fReservedBlocks; }
 			void			SetCheckingThread(thread_id thread)
 								{ fCheckingThread = thread; }
 			bool			IsCheckingThread() const
@@ -150,6 +169,7 @@ public:
 
 private:
 			status_t		_EraseUnusedBootBlock();
+			void			_CheckForTrigramIndices();
 
 protected:
 			fs_volume*		fVolume;
@@ -169,6 +189,7 @@ protected:
 
 			Inode*			fRootNode;
 			Inode*			fIndicesNode;
+			bool			fHasTrigramIndices;
 
 			vint32			fDirtyCachedBlocks;
 
@@ -182,6 +203,10 @@ protected:
 			::CheckVisitor*	fCheckVisitor;
 
 			InodeList		fRemovedInodes;
+
+			mutex			fReservationLock;
+			off_t			fReservedBlocks;
+			ReservedInodeList fReservedInodes;
 };
 
 
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2017, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Parts of this code is based on work previously done by Marcus Overhagen.
  *
  * This file may be used under the terms of the MIT License.
@@ -113,6 +114,10 @@ struct disk_super_block {
 #define SUPER_BLOCK_DISK_CLEAN		'CLEN'		/* CLEN */
 #define SUPER_BLOCK_DISK_DIRTY		'DIRT'		/* DIRT */
 
+// limits for the size of the log area, in blocks
+#define BFS_MIN_LOG_SIZE			512
+#define BFS_MAX_LOG_SIZE			65535
+
 //**************************************
 
 #define NUM_DIRECT_BLOCKS			12
@@ -259,6 +264,7 @@ enum inode_flags {
 	INODE_DELETED			= 0x00000010,
 	INODE_NOT_READY			= 0x00000020,	// used during Inode construction
 	INODE_LONG_SYMLINK		= 0x00000040,	// symlink in data stream
+	INODE_TRIGRAMS_COMPLETE	= 0x00000080,	// trigram index lists all files
 
 	INODE_PERMANENT_FLAGS	= 0x0000ffff,
 
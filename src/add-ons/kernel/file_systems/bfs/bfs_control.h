@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2014, Axel Dörfler, axeld@pinc-software.de
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 #ifndef BFS_CONTROL_H
@@ -104,4 +105,57 @@ struct check_control {
 #define BFS_IOCTL_RESIZE		14205
 
 
+/* Retrieves statistics about the journal of the volume; the parameter is
+ * a struct bfs_journal_stats. Dividing the number of transactions by the
+ * number of log writes yields the average batch size, and dividing the log
+ * writes by the elapsed time the log write rate.
+ */
+#define BFS_IOCTL_JOURNAL_STATS	14206
+
+struct bfs_journal_stats {
+	uint32			log_size;
+		// size of the log in blocks
+	uint32			max_transaction_size;
+		// number of blocks up to which transactions are batched
+	int64			elapsed;
+		// time in usecs the statistics cover
+	int64			transactions;
+		// number of transactions that have been completed
+	int64			log_writes;
+		// number of log entries written (and drive cache flushes caused)
+	int64			logged_blocks;
+	int64			commit_requests;
+		// number of times a commit was requested, ie. via fsync()
+	int64			commit_writes;
+		// number of times the log was actually written or the drive cache
+		// flushed to fulfill those requests
+};
+
+
+/* Adds existing files to an index, using their current attribute value as
+ * key. The parameter is a struct bfs_bulk_index. Sorting the inodes by
+ * their attribute value lets BFS build the index with densely packed nodes,
+ * which is much faster than rewriting the attributes one by one.
+ * For a trigram index, the files are added with the trigrams of the value
+ * of its attribute. Queries only use a trigram index once a call with the
+ * BFS_BULK_INDEX_COMPLETE flag said that all files have been added to it.
+ */
+#define BFS_IOCTL_BULK_INDEX	14207
+#define BFS_BULK_INDEX_MAX_INODES	4096
+
+/* values for the flags field */
+#define BFS_BULK_INDEX_COMPLETE	1
+
+struct bfs_bulk_index {
+	const char*		name;
+		// name of the index
+	const int64*	inodes;
+		// inodes to add, sorted by their attribute value
+	uint32			count;
+	uint32			flags;
+	uint32			inserted;
+		// returns how many inodes have actually been added to the index
+};
+
+
 #endif	/* BFS_CONTROL_H */
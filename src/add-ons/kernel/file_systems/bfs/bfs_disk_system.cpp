@@ -1,5 +1,6 @@
 /*
  * Copyright 2007-2008, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -31,14 +32,24 @@ parse_initialize_parameters(const char* parameterString,
 	if (string != NULL)
 		blockSize = strtoul(string, NULL, 0);
 
+	string = get_driver_parameter(handle, "log_size", NULL, NULL);
+	uint32 logSize = 0;
+	if (string != NULL)
+		logSize = strtoul(string, NULL, 0);
+
 	unload_driver_settings(handle);
 
 	if (blockSize != 1024 && blockSize != 2048 && blockSize != 4096
 		&& blockSize != 8192) {
 		return B_BAD_VALUE;
 	}
+	if (logSize != 0
+		&& (logSize < BFS_MIN_LOG_SIZE || logSize > BFS_MAX_LOG_SIZE)) {
+		return B_BAD_VALUE;
+	}
 
 	parameters.blockSize = blockSize;
+	parameters.logSize = logSize;
 
 	return B_OK;
 }
@@ -1,5 +1,6 @@
 /*
  * Copyright 2007, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef _BFS_DISK_SYSTEM_H
@@ -10,6 +11,8 @@
 
 struct initialize_parameters {
 	uint32	blockSize;
+	uint32	logSize;
+		// in blocks, 0 lets the size depend on the size of the volume
 	uint32	flags;
 	bool	verbose;
 };
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2020, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 
@@ -341,7 +342,8 @@ bfs_put_vnode(fs_volume* _volume, fs_vnode* _node, bool reenter)
 	Inode* inode = (Inode*)_node->private_node;
 
 	// since a directory's size can be changed without having it opened,
-	// we need to take care about their preallocated blocks here
+	// we need to take care about their preallocated blocks here; files
+	// may also have kept theirs after being closed
 	if (!volume->IsReadOnly() && !volume->IsCheckingThread()
 		&& inode->NeedsTrimming()) {
 		Transaction transaction(volume, inode->BlockNumber());
@@ -793,6 +795,85 @@ bfs_ioctl(fs_volume* _volume, fs_vnode* _node, void* _cookie, uint32 cmd,
 			ResizeVisitor resizer(volume);
 			return resizer.Resize(size, -1);
 		}
+		case BFS_IOCTL_BULK_INDEX:
+		{
+			// only root users are allowed to fill indices
+			if (geteuid() != 0)
+				return B_NOT_ALLOWED;
+			if (volume->IsReadOnly())
+				return B_READ_ONLY_DEVICE;
+
+			bfs_bulk_index bulk;
+			if (bufferLength != sizeof(bfs_bulk_index))
+				return B_BAD_VALUE;
+			if (user_memcpy(&bulk, buffer, sizeof(bfs_bulk_index)) != B_OK)
+				return B_BAD_ADDRESS;
+			if (bulk.count > BFS_BULK_INDEX_MAX_INODES)
+				return B_BAD_VALUE;
+
+			char name[B_FILE_NAME_LENGTH];
+			if (user_strlcpy(name, bulk.name, sizeof(name)) < B_OK)
+				return B_BAD_ADDRESS;
+
+			// a call without any inodes can be used to check if the index
+			// exists, and bulk indexing is supported at all
+			ino_t* ids = (ino_t*)malloc(bulk.count * sizeof(ino_t));
+			if (ids == NULL && bulk.count > 0)
+				return B_NO_MEMORY;
+
+			MemoryDeleter idsDeleter(ids);
+			if (user_memcpy(ids, bulk.inodes, bulk.count * sizeof(ino_t))
+					!= B_OK) {
+				return B_BAD_ADDRESS;
+			}
+
+			Index index(volume);
+			status_t status = index.SetTo(name);
+			if (status != B_OK)
+				return status;
+
+			// BulkInsert() stops before a transaction grows too large, the
+			// rest is then added in another one
+			uint32 inserted = 0;
+			for (uint32 i = 0; i < bulk.count && status == B_OK;) {
+				Transaction transaction(volume, index.Node()->BlockNumber());
+
+				uint32 count = bulk.count - i;
+				uint32 insertedNow;
+				status = index.BulkInsert(transaction, ids + i, count,
+					insertedNow);
+				if (status == B_OK)
+					status = transaction.Done();
+				if (status == B_OK) {
+					inserted += insertedNow;
+					i += count;
+				}
+			}
+
+			if (status == B_OK
+				&& (bulk.flags & BFS_BULK_INDEX_COMPLETE) != 0) {
+				Transaction transaction(volume, index.Node()->BlockNumber());
+				status = index.SetTrigramsComplete(transaction);
+				if (status == B_OK)
+					status = transaction.Done();
+			}
+
+			bfs_bulk_index* userBulk = (bfs_bulk_index*)buffer;
+			if (user_memcpy(&userBulk->inserted, &inserted, sizeof(uint32))
+					!= B_OK) {
+				return B_BAD_ADDRESS;
+			}
+			return status;
+		}
+		case BFS_IOCTL_JOURNAL_STATS:
+		{
+			if (bufferLength != sizeof(bfs_journal_stats))
+				return B_BAD_VALUE;
+
+			bfs_journal_stats stats;
+			volume->GetJournal(0)->GetStatistics(stats);
+			return user_memcpy(buffer, &stats, sizeof(bfs_journal_stats));
+		}
 
 #ifdef DEBUG_FRAGMENTER
 		case 56741:
@@ -853,8 +934,15 @@ bfs_fsync(fs_volume* _volume, fs_vnode* _node)
 {
 	FUNCTION();
 
+	Volume* volume = (Volume*)_volume->private_volume;
 	Inode* inode = (Inode*)_node->private_node;
-	return inode->Sync();
+
+	status_t status = inode->Sync();
+	if (status != B_OK || volume->IsReadOnly())
+		return status;
+
+	// make sure the changes to the inode itself are on disk as well
+	return volume->GetJournal(0)->CommitLog();
 }
 
 
@@ -1432,6 +1520,23 @@ bfs_read(fs_volume* _volume, fs_vnode* _node, void* _cookie, off_t pos,
 }
 
 
+static status_t
+bfs_write_at(Inode* inode, off_t pos, const void* buffer, size_t* _length)
+{
+	Transaction transaction;
+		// We are not starting the transaction here, since
+		// it might not be needed at all (the contents of
+		// regular files aren't logged)
+
+	status_t status = inode->WriteAt(transaction, pos, (const uint8*)buffer,
+		_length);
+	if (status == B_OK)
+		status = transaction.Done();
+
+	return status;
+}
+
+
 static status_t
 bfs_write(fs_volume* _volume, fs_vnode* _node, void* _cookie, off_t pos,
 	const void* buffer, size_t* _length)
@@ -1453,15 +1558,14 @@ bfs_write(fs_volume* _volume, fs_vnode* _node, void* _cookie, off_t pos,
 	if (cookie->open_mode & O_APPEND)
 		pos = inode->Size();
 
-	Transaction transaction;
-		// We are not starting the transaction here, since
-		// it might not be needed at all (the contents of
-		// regular files aren't logged)
-
-	status_t status = inode->WriteAt(transaction, pos, (const uint8*)buffer,
-		_length);
-	if (status == B_OK)
-		status = transaction.Done();
+	size_t length = *_length;
+	status_t status = bfs_write_at(inode, pos, buffer, _length);
+	if (status == B_DEVICE_FULL && volume->TrimReservations()) {
+		// closed files kept some of their preallocated blocks; now that
+		// they have been given back, there might be enough room
+		*_length = length;
+		status = bfs_write_at(inode, pos, buffer, _length);
+	}
 	if (status == B_OK) {
 		InodeReadLocker locker(inode);
 
@@ -1505,6 +1609,13 @@ bfs_free_cookie(fs_volume* _volume, fs_vnode* _node, void* _cookie)
 		InodeReadLocker locker(inode);
 		needsTrimming = inode->NeedsTrimming();
 
+		if ((cookie->open_mode & O_RWMASK) != 0
+			&& inode->KeepPreallocation()) {
+			// the preallocated blocks stay reserved for the next writer, and
+			// are trimmed when the vnode is put
+			needsTrimming = false;
+		}
+
 		if ((cookie->open_mode & O_RWMASK) != 0
 			&& !inode->IsDeleted()
 			&& (needsTrimming
@@ -2367,7 +2478,7 @@ bfs_initialize(int fd, partition_id partitionID, const char* name,
 	// initialize the volume
 	Volume volume(NULL);
 	status = volume.Initialize(fd, name, parameters.blockSize,
-		parameters.flags);
+		parameters.logSize, parameters.flags);
 	if (status < B_OK) {
 		INFORM(("Initializing volume failed: %s\n", strerror(status)));
 		return status;
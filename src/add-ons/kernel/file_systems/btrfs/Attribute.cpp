@@ -3,6 +3,7 @@
  * Copyright 2010-2011, Jérôme Duval, korli@users.berlios.de.
  * Copyright 2010, François Revol, <revol@free.fr>.
  * Copyright 2004-2008, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 
@@ -10,8 +11,10 @@
 
 
 #include "Attribute.h"
+
+#include <util/crc32.h>
+
 #include "BTree.h"
-#include "CRCTable.h"
 #include "Utility.h"
 
 
@@ -146,7 +149,7 @@ status_t
 Attribute::_Lookup(const char* name, size_t nameLength,
 	btrfs_dir_entry** _entries, uint32* _length)
 {
-	uint32 hash = calculate_crc((uint32)~1, (uint8*)name, nameLength);
+	uint32 hash = calculate_crc32c((uint32)~1, (uint8*)name, nameLength);
 	struct btrfs_key key;
 	key.SetType(BTRFS_KEY_TYPE_XATTR_ITEM);
 	key.SetObjectID(fInode->ID());
@@ -1,9 +0,0 @@
-/*
- * Copyright 2011, Haiku Inc. All rights reserved.
- * This file may be used under the terms of the MIT License.
- *
- * Authors:
- *		Jérôme Duval
- */
-
-uint32 calculate_crc(uint32 crc, uint8* data, uint16 length);
@@ -1,12 +1,15 @@
 /*
  * Copyright 2017, Chế Vũ Gia Hy, cvghy116@gmail.com.
  * Copyright 2011-2013, Jérôme Duval, korli@users.berlios.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 
 
 #include "DirectoryIterator.h"
-#include "CRCTable.h"
+
+#include <util/crc32.h>
+
 
 
 //#define TRACE_BTRFS
@@ -118,7 +121,7 @@ DirectoryIterator::Lookup(const char* name, size_t nameLength, ino_t* _id)
 		return fInode->FindParent(_id);
 	}
 
-	uint32 hash = calculate_crc((uint32)~1, (uint8*)name, nameLength);
+	uint32 hash = calculate_crc32c((uint32)~1, (uint8*)name, nameLength);
 	btrfs_key key;
 	key.SetType(BTRFS_KEY_TYPE_DIR_ITEM);
 	key.SetObjectID(fInode->ID());
@@ -3,6 +3,7 @@
  * Copyright 2017, Chế Vũ Gia Hy, cvghy116@gmail.com.
  * Copyright 2011, Jérôme Duval, korli@users.berlios.de.
  * Copyright 2008-2010, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  *
  * This file may be used under the terms of the MIT License.
  */
@@ -12,10 +13,12 @@
 
 
 #include "Volume.h"
+
+#include <util/crc32.h>
+
 #include "BTree.h"
 #include "CachedBlock.h"
 #include "Chunk.h"
-#include "CRCTable.h"
 #include "DeviceOpener.h"
 #include "ExtentAllocator.h"
 #include "Inode.h"
@@ -509,7 +512,7 @@ Volume::FindBlock(off_t logical, off_t& physical)
 status_t
 Volume::WriteSuperBlock()
 {
-	uint32 checksum = calculate_crc((uint32)~1,
+	uint32 checksum = calculate_crc32c((uint32)~1,
 			(uint8 *)(&fSuperBlock + sizeof(fSuperBlock.checksum)),
 			sizeof(fSuperBlock) - sizeof(fSuperBlock.checksum));
 
@@ -1,5 +1,6 @@
 /*
  * Copyright 2011, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All rights reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -47,6 +48,7 @@ struct Query::QueryPolicy {
 	};
 
 	static const int32 kMaxFileNameLength = B_FILE_NAME_LENGTH;
+	static const bool kHasTrigramIndices = false;
 
 	// Entry interface
 
@@ -109,6 +111,11 @@ struct Query::QueryPolicy {
 		return index.index->KeyLength();
 	}
 
+	static bool IndexHasAllTrigrams(Index& index)
+	{
+		return false;
+	}
+
 	static IndexIterator* IndexCreateIterator(Index& index)
 	{
 		IndexIterator* iterator = new(std::nothrow) IndexIterator(index.index);
@@ -157,6 +164,11 @@ struct Query::QueryPolicy {
 		return B_OK;
 	}
 
+	static ino_t IndexIteratorGetNodeID(IndexIterator* indexIterator)
+	{
+		return indexIterator->entry->ID();
+	}
+
 	static void IndexIteratorSkipDuplicates(IndexIterator* indexIterator)
 	{
 		// Nothing to do.
@@ -222,6 +234,13 @@ struct Query::QueryPolicy {
 
 	// Volume interface
 
+	static status_t ContextGetEntry(Context* context, ino_t id,
+		NodeHolder& holder, Entry** _entry)
+	{
+		// only needed for trigram indices
+		return B_NOT_SUPPORTED;
+	}
+
 	static dev_t ContextGetVolumeID(Context* context)
 	{
 		return context->fVolume->ID();
@@ -1,5 +1,6 @@
 /*
  * Copyright 2009-2014, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -25,6 +26,7 @@
 
 #include "CachedDataReader.h"
 #include "DebugSupport.h"
+#include "NodeTreeCache.h"
 #include "PackageDirectory.h"
 #include "PackageFile.h"
 #include "PackagesDirectory.h"
@@ -539,16 +541,7 @@ Package::~Package()
 {
 	delete fHeapReader;
 
-	while (PackageNode* node = fNodes.RemoveHead())
-		node->ReleaseReference();
-
-	while (Resolvable* resolvable = fResolvables.RemoveHead())
-		delete resolvable;
-
-	while (Dependency* dependency = fDependencies.RemoveHead())
-		delete dependency;
-
-	delete fVersion;
+	_ClearContents();
 
 	fPackagesDirectory->ReleaseReference();
 
@@ -566,10 +559,14 @@ Package::Init(const char* fileName)
 }
 
 
+/*!	Loads the package's meta data and node tree. If a \a cache is given, and
+	it contains this package in its current state, the contents are taken from
+	it, and the package's TOC and attributes sections don't need to be read.
+*/
 status_t
-Package::Load(const PackageSettings& settings)
+Package::Load(const PackageSettings& settings, NodeTreeCache* cache)
 {
-	status_t error = _Load(settings);
+	status_t error = _Load(settings, cache);
 	if (error != B_OK)
 		return error;
 
@@ -712,7 +709,7 @@ Package::CreateDataReader(const PackageData& data,
 
 
 status_t
-Package::_Load(const PackageSettings& settings)
+Package::_Load(const PackageSettings& settings, NodeTreeCache* cache)
 {
 	// open package file
 	int fd = Open();
@@ -729,6 +726,18 @@ Package::_Load(const PackageSettings& settings)
 		status_t error = packageReader.Init(fd, false,
 			BHPKG::B_HPKG_READER_DONT_PRINT_VERSION_MISMATCH_MESSAGE);
 		if (error == B_OK) {
+			// Initializing the reader only reads the package header, so we
+			// can still skip parsing, if the package is in the node cache.
+			if (cache != NULL) {
+				if (cache->RestorePackage(this, fd, settings) == B_OK) {
+					fHeapReader = packageReader.DetachCachedHeapReader();
+					return B_OK;
+				}
+
+				// undo what might have been partially restored
+				_ClearContents();
+			}
+
 			// parse content
 			LoaderContentHandler handler(this, settings);
 			error = handler.Init();
@@ -753,6 +762,28 @@ Package::_Load(const PackageSettings& settings)
 }
 
 
+void
+Package::_ClearContents()
+{
+	while (PackageNode* node = fNodes.RemoveHead())
+		node->ReleaseReference();
+
+	while (Resolvable* resolvable = fResolvables.RemoveHead())
+		delete resolvable;
+
+	while (Dependency* dependency = fDependencies.RemoveHead())
+		delete dependency;
+
+	delete fVersion;
+	fVersion = NULL;
+
+	fName = String();
+	fInstallPath = String();
+	fFlags = 0;
+	fArchitecture = B_PACKAGE_ARCHITECTURE_ENUM_COUNT;
+}
+
+
 bool
 Package::_InitVersionedName()
 {
@@ -1,5 +1,6 @@
 /*
  * Copyright 2009-2011, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef PACKAGE_H
@@ -30,6 +31,7 @@ using BPackageKit::BHPKG::BAbstractBufferedDataReader;
 
 class PackageLinkDirectory;
 class PackagesDirectory;
+class NodeTreeCache;
 class PackageSettings;
 class Volume;
 class Version;
@@ -44,7 +46,8 @@ public:
 								~Package();
 
 			status_t			Init(const char* fileName);
-			status_t			Load(const PackageSettings& settings);
+			status_t			Load(const PackageSettings& settings,
+									NodeTreeCache* cache = NULL);
 
 			::Volume*			Volume() const		{ return fVolume; }
 			const String&		FileName() const	{ return fFileName; }
@@ -117,7 +120,9 @@ private:
 			struct CachingPackageReader;
 
 private:
-			status_t			_Load(const PackageSettings& settings);
+			status_t			_Load(const PackageSettings& settings,
+									NodeTreeCache* cache);
+			void				_ClearContents();
 			bool				_InitVersionedName();
 
 private:
@@ -1,5 +1,6 @@
 /*
  * Copyright 2009, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef PACKAGE_FILE_H
@@ -24,6 +25,8 @@ public:
 
 	virtual	off_t				FileSize() const;
 
+			const PackageData&	Data() const	{ return fData; }
+
 	virtual	status_t			Read(off_t offset, void* buffer,
 									size_t* bufferSize);
 	virtual	status_t			Read(io_request* request);
@@ -1,5 +1,6 @@
 /*
  * Copyright 2011, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef DEPENDENCY_H
@@ -36,6 +37,10 @@ public:
 									Version* version);
 									// version is optional; object takes over
 									// ownership
+			Version*			RequiredVersion() const
+									{ return fVersion; }
+			BPackageResolvableOperator VersionOperator() const
+									{ return fVersionOperator; }
 
 			::Package*			Package() const
 									{ return fPackage; }
@@ -1,5 +1,6 @@
 /*
  * Copyright 2011, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef VERSION_H
@@ -36,6 +37,12 @@ public:
 									// returns how big the buffer should have
 									// been (excluding the terminating null)
 
+			const String&		Major() const		{ return fMajor; }
+			const String&		Minor() const		{ return fMinor; }
+			const String&		Micro() const		{ return fMicro; }
+			const String&		PreRelease() const	{ return fPreRelease; }
+			uint32				Revision() const	{ return fRevision; }
+
 private:
 			String				fMajor;
 			String				fMinor;
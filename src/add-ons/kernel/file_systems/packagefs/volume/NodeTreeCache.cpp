@@ -0,0 +1,1070 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "NodeTreeCache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <new>
+
+#include <package/hpkg/HPKGDefsPrivate.h>
+
+#include <AutoDeleter.h>
+#include <AutoDeleterPosix.h>
+#include <PackagesDirectoryDefs.h>
+#include <syscalls.h>
+#include <util/OpenHashTable.h>
+
+#include "DebugSupport.h"
+#include "PackageDirectory.h"
+#include "PackageFile.h"
+#include "PackageSettings.h"
+#include "PackageSymlink.h"
+#include "Version.h"
+
+
+using BPackageKit::BHPKG::B_HPKG_MAX_INLINE_DATA_SIZE;
+using BPackageKit::BHPKG::BPrivate::hpkg_header;
+
+
+static const char* const kCacheFilePath
+	= PACKAGES_DIRECTORY_ADMIN_DIRECTORY "/packagefs-node-cache";
+static const char* const kTemporaryCacheFilePath
+	= PACKAGES_DIRECTORY_ADMIN_DIRECTORY "/packagefs-node-cache.tmp";
+
+static const uint32 kCacheMagic = 'pfnc';
+static const uint32 kCacheVersion = 1;
+
+// sanity limit for the cache file size
+static const size_t kMaxCacheSize = 64 * 1024 * 1024;
+
+static const uint64 kChecksumOffsetBasis = 0xcbf29ce484222325ULL;
+static const uint64 kChecksumPrime = 0x100000001b3ULL;
+
+
+/*!	The cache file starts with this header, followed by the string table,
+	and the package records. The file is only ever read on the machine that
+	wrote it, so everything is stored in host endianess.
+*/
+struct node_tree_cache_header {
+	uint32	magic;
+	uint32	version;
+	uint64	activation_checksum;
+	uint64	checksum;
+		// of everything following the header
+	uint32	string_count;
+	uint32	package_count;
+	uint64	strings_size;
+	uint64	packages_size;
+};
+
+
+// #pragma mark - Reader
+
+
+struct NodeTreeCache::Reader {
+	Reader(const uint8* data, size_t size, const String* strings,
+		uint32 stringCount)
+		:
+		fPosition(data),
+		fEnd(data + size),
+		fStrings(strings),
+		fStringCount(stringCount),
+		fError(false)
+	{
+	}
+
+	bool HasError() const
+	{
+		return fError;
+	}
+
+	const uint8* Skip(size_t size)
+	{
+		if (fError || size > (size_t)(fEnd - fPosition)) {
+			fError = true;
+			return NULL;
+		}
+
+		const uint8* data = fPosition;
+		fPosition += size;
+		return data;
+	}
+
+	template<typename Type>
+	Type Read()
+	{
+		Type value = 0;
+		if (const uint8* data = Skip(sizeof(Type)))
+			memcpy(&value, data, sizeof(Type));
+		return value;
+	}
+
+	uint8 ReadUInt8()	{ return Read<uint8>(); }
+	uint16 ReadUInt16()	{ return Read<uint16>(); }
+	uint32 ReadUInt32()	{ return Read<uint32>(); }
+	uint64 ReadUInt64()	{ return Read<uint64>(); }
+
+	String ReadString()
+	{
+		uint32 index = ReadUInt32();
+		if (fError || index >= fStringCount) {
+			fError = true;
+			return String();
+		}
+
+		return fStrings[index];
+	}
+
+private:
+	const uint8*	fPosition;
+	const uint8*	fEnd;
+	const String*	fStrings;
+	uint32			fStringCount;
+	bool			fError;
+};
+
+
+// #pragma mark - Writer
+
+
+struct NodeTreeCache::Writer {
+	struct Buffer {
+		uint8*	data;
+		size_t	size;
+		size_t	capacity;
+	};
+
+	struct StringEntry {
+		const char*		string;
+		uint32			index;
+		StringEntry*	hashNext;
+	};
+
+	struct StringEntryHashDefinition {
+		typedef const char*		KeyType;
+		typedef	StringEntry		ValueType;
+
+		size_t HashKey(const char* key) const
+		{
+			// the strings are unique in the string pool
+			return (addr_t)key / 8;
+		}
+
+		size_t Hash(const StringEntry* value) const
+		{
+			return HashKey(value->string);
+		}
+
+		bool Compare(const char* key, const StringEntry* value) const
+		{
+			return key == value->string;
+		}
+
+		StringEntry*& GetLink(StringEntry* value) const
+		{
+			return value->hashNext;
+		}
+	};
+
+	typedef BOpenHashTable<StringEntryHashDefinition> StringEntryTable;
+
+	Writer()
+		:
+		fStringCount(0),
+		fError(false)
+	{
+		memset(&fStrings, 0, sizeof(Buffer));
+		memset(&fPackages, 0, sizeof(Buffer));
+	}
+
+	~Writer()
+	{
+		StringEntry* entry = fStringTable.Clear(true);
+		while (entry != NULL) {
+			StringEntry* next = entry->hashNext;
+			delete entry;
+			entry = next;
+		}
+
+		free(fStrings.data);
+		free(fPackages.data);
+	}
+
+	status_t Init()
+	{
+		return fStringTable.Init();
+	}
+
+	bool HasError() const
+	{
+		return fError;
+	}
+
+	const Buffer& Strings() const
+	{
+		return fStrings;
+	}
+
+	uint32 CountStrings() const
+	{
+		return fStringCount;
+	}
+
+	const Buffer& Packages() const
+	{
+		return fPackages;
+	}
+
+	size_t Position() const
+	{
+		return fPackages.size;
+	}
+
+	void SetError()
+	{
+		fError = true;
+	}
+
+	void Write(const void* data, size_t size)
+	{
+		_Append(fPackages, data, size);
+	}
+
+	void WriteUInt8(uint8 value)	{ Write(&value, sizeof(value)); }
+	void WriteUInt32(uint32 value)	{ Write(&value, sizeof(value)); }
+	void WriteUInt64(uint64 value)	{ Write(&value, sizeof(value)); }
+
+	void PatchUInt32(size_t offset, uint32 value)
+	{
+		if (!fError)
+			memcpy(fPackages.data + offset, &value, sizeof(value));
+	}
+
+	void WriteString(const String& string)
+	{
+		StringEntry* entry = fStringTable.Lookup(string.Data());
+		if (entry == NULL) {
+			size_t length = strlen(string.Data());
+			if (length > 0xffff) {
+				fError = true;
+				return;
+			}
+
+			entry = new(std::nothrow) StringEntry;
+			if (entry == NULL) {
+				fError = true;
+				return;
+			}
+
+			entry->string = string.Data();
+			entry->index = fStringCount++;
+			fStringTable.Insert(entry);
+
+			uint16 length16 = length;
+			_Append(fStrings, &length16, sizeof(length16));
+			_Append(fStrings, string.Data(), length);
+		}
+
+		WriteUInt32(entry->index);
+	}
+
+private:
+	void _Append(Buffer& buffer, const void* data, size_t size)
+	{
+		if (fError)
+			return;
+
+		if (buffer.size + size > buffer.capacity) {
+			size_t capacity = max_c(buffer.capacity * 2, 64 * 1024);
+			while (capacity < buffer.size + size)
+				capacity *= 2;
+			if (capacity > kMaxCacheSize) {
+				fError = true;
+				return;
+			}
+
+			uint8* newData = (uint8*)realloc(buffer.data, capacity);
+			if (newData == NULL) {
+				fError = true;
+				return;
+			}
+
+			buffer.data = newData;
+			buffer.capacity = capacity;
+		}
+
+		memcpy(buffer.data + buffer.size, data, size);
+		buffer.size += size;
+	}
+
+private:
+	Buffer				fStrings;
+	Buffer				fPackages;
+	StringEntryTable	fStringTable;
+	uint32				fStringCount;
+	bool				fError;
+};
+
+
+// #pragma mark - NodeTreeCache
+
+
+NodeTreeCache::NodeTreeCache()
+	:
+	fData(NULL),
+	fDataSize(0),
+	fStrings(NULL),
+	fStringCount(0),
+	fPackages(NULL),
+	fPackageCount(0),
+	fRestoredPackages(0)
+{
+}
+
+
+NodeTreeCache::~NodeTreeCache()
+{
+	delete[] fStrings;
+	free(fPackages);
+	free(fData);
+}
+
+
+/*!	Returns a 64 bit FNV-1a hash of the given data. This only needs to detect
+	changes and corruption, not deliberate manipulation.
+*/
+/*static*/ uint64
+NodeTreeCache::Checksum(const void* data, size_t size)
+{
+	const uint8* bytes = (const uint8*)data;
+	uint64 checksum = kChecksumOffsetBasis;
+	for (size_t i = 0; i < size; i++) {
+		checksum ^= bytes[i];
+		checksum *= kChecksumPrime;
+	}
+
+	return checksum;
+}
+
+
+/*!	Reads the cache from the administrative directory of the packages
+	directory \a directoryFD, if it was written for the activation file with
+	the given checksum, and puts all of its strings into the string pool.
+	Does not change the object in case of an error.
+*/
+status_t
+NodeTreeCache::Load(int directoryFD, uint64 activationChecksum)
+{
+	FileDescriptorCloser fd(openat(directoryFD, kCacheFilePath, O_RDONLY));
+	if (!fd.IsSet())
+		return errno;
+
+	node_tree_cache_header header;
+	if (read(fd.Get(), &header, sizeof(header)) != (ssize_t)sizeof(header)
+		|| header.magic != kCacheMagic || header.version != kCacheVersion) {
+		return B_BAD_DATA;
+	}
+
+	if (header.activation_checksum != activationChecksum)
+		return B_MISMATCHED_VALUES;
+
+	if (header.strings_size > kMaxCacheSize
+		|| header.packages_size > kMaxCacheSize - header.strings_size
+		|| header.string_count > header.strings_size / sizeof(uint16)
+		|| header.package_count > header.packages_size / sizeof(uint32)) {
+		return B_BAD_DATA;
+	}
+
+	size_t dataSize = header.strings_size + header.packages_size;
+	uint8* data = (uint8*)malloc(dataSize);
+	if (data == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+	MemoryDeleter dataDeleter(data);
+
+	ssize_t bytesRead = read(fd.Get(), data, dataSize);
+	if (bytesRead < 0)
+		return errno;
+	if ((size_t)bytesRead != dataSize || Checksum(data, dataSize)
+			!= header.checksum) {
+		return B_BAD_DATA;
+	}
+
+	// put the strings into the string pool
+	String* strings = new(std::nothrow) String[header.string_count];
+	if (strings == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+	ArrayDeleter<String> stringsDeleter(strings);
+
+	Reader reader(data, header.strings_size, NULL, 0);
+	for (uint32 i = 0; i < header.string_count; i++) {
+		uint16 length = reader.ReadUInt16();
+		const char* string = (const char*)reader.Skip(length);
+		if (string == NULL)
+			return B_BAD_DATA;
+		if (!strings[i].SetToExactLength(string, length))
+			RETURN_ERROR(B_NO_MEMORY);
+	}
+
+	// find the start of each package record
+	const uint8** packages = (const uint8**)malloc(
+		max_c(header.package_count, 1) * sizeof(uint8*));
+	if (packages == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+	MemoryDeleter packagesDeleter(packages);
+
+	reader = Reader(data + header.strings_size, header.packages_size, NULL, 0);
+	for (uint32 i = 0; i < header.package_count; i++) {
+		const uint8* record = reader.Skip(0);
+		uint32 recordSize = reader.ReadUInt32();
+		if (recordSize < sizeof(uint32)
+			|| reader.Skip(recordSize - sizeof(uint32)) == NULL) {
+			return B_BAD_DATA;
+		}
+		packages[i] = record;
+	}
+
+	fData = (uint8*)dataDeleter.Detach();
+	fDataSize = dataSize;
+	fStrings = stringsDeleter.Detach();
+	fStringCount = header.string_count;
+	fPackages = (const uint8**)packagesDeleter.Detach();
+	fPackageCount = header.package_count;
+
+	return B_OK;
+}
+
+
+/*!	Restores the meta data and the node tree of the \a package from the
+	cache, if it contains the package, and the package file \a fd still is
+	the same as when the cache was written.
+	In case of an error, the package might have been partially restored.
+*/
+status_t
+NodeTreeCache::RestorePackage(Package* package, int fd,
+	const PackageSettings& settings)
+{
+	// Find the package's record. A linear search is fine here, as this is
+	// negligible compared to parsing a package.
+	Reader reader(NULL, 0, NULL, 0);
+	bool found = false;
+	for (uint32 i = 0; i < fPackageCount && !found; i++) {
+		const uint8* record = fPackages[i];
+		uint32 recordSize;
+		memcpy(&recordSize, record, sizeof(uint32));
+
+		reader = Reader(record + sizeof(uint32), recordSize - sizeof(uint32),
+			fStrings, fStringCount);
+		found = reader.ReadString() == package->FileName();
+	}
+	if (!found)
+		return B_ENTRY_NOT_FOUND;
+
+	// check that the package file has not changed
+	struct stat st;
+	uint64 checksum;
+	status_t error = _GetPackageIdentity(package, fd, st, checksum);
+	if (error != B_OK)
+		return error;
+
+	if (reader.ReadUInt64() != (uint64)st.st_ino
+		|| reader.ReadUInt64() != (uint64)st.st_size
+		|| reader.ReadUInt64() != (uint64)st.st_mtim.tv_sec
+		|| reader.ReadUInt32() != (uint32)st.st_mtim.tv_nsec
+		|| reader.ReadUInt64() != checksum) {
+		return B_MISMATCHED_VALUES;
+	}
+
+	// package meta data
+	String name = reader.ReadString();
+	const PackageSettingsItem* settingsItem = settings.PackageItemFor(name);
+	if (settingsItem != NULL && settingsItem->HasEntries()) {
+		// the package has blocked entries, which we don't store
+		return B_MISMATCHED_VALUES;
+	}
+
+	package->SetName(name);
+	package->SetInstallPath(reader.ReadString());
+	package->SetFlags(reader.ReadUInt32());
+
+	uint32 architecture = reader.ReadUInt32();
+	if (architecture >= B_PACKAGE_ARCHITECTURE_ENUM_COUNT)
+		return B_BAD_DATA;
+	package->SetArchitecture((BPackageArchitecture)architecture);
+
+	::Version* version;
+	error = _RestoreVersion(reader, version);
+	if (error != B_OK)
+		return error;
+	if (version != NULL)
+		package->SetVersion(version);
+
+	// resolvables
+	uint32 count = reader.ReadUInt32();
+	for (uint32 i = 0; i < count && !reader.HasError(); i++) {
+		String resolvableName = reader.ReadString();
+
+		::Version* resolvableVersion;
+		error = _RestoreVersion(reader, resolvableVersion);
+		if (error != B_OK)
+			return error;
+		ObjectDeleter< ::Version> versionDeleter(resolvableVersion);
+
+		::Version* compatibleVersion;
+		error = _RestoreVersion(reader, compatibleVersion);
+		if (error != B_OK)
+			return error;
+		ObjectDeleter< ::Version> compatibleVersionDeleter(compatibleVersion);
+
+		Resolvable* resolvable = new(std::nothrow) Resolvable(package);
+		if (resolvable == NULL)
+			RETURN_ERROR(B_NO_MEMORY);
+		ObjectDeleter<Resolvable> resolvableDeleter(resolvable);
+
+		error = resolvable->Init(resolvableName, versionDeleter.Detach(),
+			compatibleVersionDeleter.Detach());
+		if (error != B_OK)
+			RETURN_ERROR(error);
+
+		package->AddResolvable(resolvableDeleter.Detach());
+	}
+
+	// dependencies
+	count = reader.ReadUInt32();
+	for (uint32 i = 0; i < count && !reader.HasError(); i++) {
+		Dependency* dependency = new(std::nothrow) Dependency(package);
+		if (dependency == NULL)
+			RETURN_ERROR(B_NO_MEMORY);
+		ObjectDeleter<Dependency> dependencyDeleter(dependency);
+
+		error = dependency->Init(reader.ReadString());
+		if (error != B_OK)
+			RETURN_ERROR(error);
+
+		if (reader.ReadUInt8() != 0) {
+			BPackageResolvableOperator op
+				= (BPackageResolvableOperator)reader.ReadUInt32();
+
+			::Version* dependencyVersion;
+			error = _RestoreVersion(reader, dependencyVersion);
+			if (error != B_OK)
+				return error;
+
+			dependency->SetVersionRequirement(op, dependencyVersion);
+		}
+
+		package->AddDependency(dependencyDeleter.Detach());
+	}
+
+	error = _RestoreNodes(reader, package);
+	if (error != B_OK)
+		return error;
+
+	atomic_add(&fRestoredPackages, 1);
+	return B_OK;
+}
+
+
+/*!	Returns how many of the \a packages would be put into the cache by
+	Write() with the current \a settings.
+*/
+/*static*/ int32
+NodeTreeCache::CountCacheablePackages(const PackageFileNameHashTable& packages,
+	const PackageSettings& settings)
+{
+	int32 count = 0;
+	for (PackageFileNameHashTable::Iterator it = packages.GetIterator();
+			Package* package = it.Next();) {
+		if (_IsCacheable(package, settings))
+			count++;
+	}
+
+	return count;
+}
+
+
+/*!	Writes a cache for the activation file with the given checksum, that
+	contains all of the \a packages whose contents are not changed by the
+	package \a settings.
+	The cache is written to a temporary file first, and then renamed, so
+	that a partially written file is never used.
+*/
+/*static*/ status_t
+NodeTreeCache::Write(int directoryFD, uint64 activationChecksum,
+	const PackageFileNameHashTable& packages, const PackageSettings& settings)
+{
+	Writer writer;
+	status_t error = writer.Init();
+	if (error != B_OK)
+		RETURN_ERROR(error);
+
+	uint32 packageCount = 0;
+	for (PackageFileNameHashTable::Iterator it = packages.GetIterator();
+			Package* package = it.Next();) {
+		if (!_IsCacheable(package, settings))
+			continue;
+
+		error = _WritePackage(writer, package);
+		if (error != B_OK)
+			return error;
+
+		packageCount++;
+	}
+
+	if (writer.HasError())
+		return B_NO_MEMORY;
+
+	const Writer::Buffer& strings = writer.Strings();
+	const Writer::Buffer& packageData = writer.Packages();
+
+	// the checksum covers both sections, as if they were one
+	uint8* data = (uint8*)malloc(strings.size + packageData.size);
+	if (data == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+	MemoryDeleter dataDeleter(data);
+	memcpy(data, strings.data, strings.size);
+	memcpy(data + strings.size, packageData.data, packageData.size);
+
+	node_tree_cache_header header;
+	header.magic = kCacheMagic;
+	header.version = kCacheVersion;
+	header.activation_checksum = activationChecksum;
+	header.checksum = Checksum(data, strings.size + packageData.size);
+	header.string_count = writer.CountStrings();
+	header.package_count = packageCount;
+	header.strings_size = strings.size;
+	header.packages_size = packageData.size;
+
+	FileDescriptorCloser fd(openat(directoryFD, kTemporaryCacheFilePath,
+		O_WRONLY | O_CREAT | O_TRUNC, 0644));
+	if (!fd.IsSet())
+		return errno;
+
+	size_t dataSize = strings.size + packageData.size;
+	if (write(fd.Get(), &header, sizeof(header)) != (ssize_t)sizeof(header)
+		|| write(fd.Get(), data, dataSize) != (ssize_t)dataSize) {
+		error = errno;
+		fd.Unset();
+		unlinkat(directoryFD, kTemporaryCacheFilePath, 0);
+		return error;
+	}
+	fd.Unset();
+
+	error = _kern_rename(directoryFD, kTemporaryCacheFilePath, directoryFD,
+		kCacheFilePath);
+	if (error != B_OK) {
+		unlinkat(directoryFD, kTemporaryCacheFilePath, 0);
+		return error;
+	}
+
+	INFORM("Wrote node tree cache with %" B_PRIu32 " packages, %" B_PRIu32
+		" strings, %" B_PRIuSIZE " bytes\n", packageCount,
+		writer.CountStrings(), sizeof(header) + dataSize);
+	return B_OK;
+}
+
+
+/*!	Packages with blocked entries are not cached, since their node trees
+	depend on the settings.
+*/
+/*static*/ bool
+NodeTreeCache::_IsCacheable(Package* package, const PackageSettings& settings)
+{
+	const PackageSettingsItem* settingsItem
+		= settings.PackageItemFor(package->Name());
+	return settingsItem == NULL || !settingsItem->HasEntries();
+}
+
+
+/*!	Returns what identifies the contents of a package file without reading
+	all of it: its stat data, and a checksum of its header, which contains
+	the sizes and compression of all sections.
+*/
+/*static*/ status_t
+NodeTreeCache::_GetPackageIdentity(Package* package, int fd,
+	struct stat& _stat, uint64& _checksum)
+{
+	if (fstat(fd, &_stat) != 0)
+		return errno;
+	if (_stat.st_ino != package->NodeID())
+		return B_MISMATCHED_VALUES;
+
+	hpkg_header header;
+	ssize_t bytesRead = pread(fd, &header, sizeof(header), 0);
+	if (bytesRead < 0)
+		return errno;
+	if (bytesRead != (ssize_t)sizeof(header))
+		return B_BAD_DATA;
+
+	_checksum = Checksum(&header, sizeof(header));
+	return B_OK;
+}
+
+
+status_t
+NodeTreeCache::_RestoreVersion(Reader& reader, ::Version*& _version)
+{
+	_version = NULL;
+	if (reader.ReadUInt8() == 0)
+		return reader.HasError() ? B_BAD_DATA : B_OK;
+
+	String major = reader.ReadString();
+	String minor = reader.ReadString();
+	String micro = reader.ReadString();
+	String preRelease = reader.ReadString();
+	uint32 revision = reader.ReadUInt32();
+	if (reader.HasError())
+		return B_BAD_DATA;
+
+	return ::Version::Create(major, minor, micro, preRelease, revision,
+		_version);
+}
+
+
+/*!	Restores the node trees in the same order the package loader creates
+	them. The nodes are stored in pre-order, and each directory's children
+	are terminated by a mode of 0, as are the package's root nodes.
+*/
+status_t
+NodeTreeCache::_RestoreNodes(Reader& reader, Package* package)
+{
+	PackageDirectory* parent = NULL;
+	while (true) {
+		mode_t mode = reader.ReadUInt32();
+		if (reader.HasError())
+			return B_BAD_DATA;
+
+		if (mode == 0) {
+			// end of the current directory
+			if (parent == NULL)
+				return B_OK;
+
+			parent = parent->Parent();
+			continue;
+		}
+
+		String name = reader.ReadString();
+		timespec modifiedTime;
+		modifiedTime.tv_sec = reader.ReadUInt64();
+		modifiedTime.tv_nsec = reader.ReadUInt32();
+
+		PackageNode* node;
+		if (S_ISREG(mode)) {
+			PackageDataV2 data;
+			status_t error = _RestoreData(reader, data);
+			if (error != B_OK)
+				return error;
+
+			node = new PackageFile(package, mode, PackageData(data));
+		} else if (S_ISLNK(mode)) {
+			String path = reader.ReadString();
+
+			PackageSymlink* symlink = new PackageSymlink(package, mode);
+			if (symlink != NULL)
+				symlink->SetSymlinkPath(path);
+			node = symlink;
+		} else if (S_ISDIR(mode)) {
+			node = new PackageDirectory(package, mode);
+		} else
+			return B_BAD_DATA;
+
+		if (node == NULL)
+			RETURN_ERROR(B_NO_MEMORY);
+		BReference<PackageNode> nodeReference(node, true);
+
+		if (reader.HasError())
+			return B_BAD_DATA;
+
+		status_t error = node->Init(parent, name);
+		if (error != B_OK)
+			RETURN_ERROR(error);
+
+		node->SetModifiedTime(modifiedTime);
+
+		uint32 attributeCount = reader.ReadUInt32();
+		for (uint32 i = 0; i < attributeCount && !reader.HasError(); i++) {
+			String attributeName = reader.ReadString();
+			uint32 type = reader.ReadUInt32();
+
+			PackageDataV2 data;
+			error = _RestoreData(reader, data);
+			if (error != B_OK)
+				return error;
+
+			PackageNodeAttribute* attribute = new PackageNodeAttribute(type,
+				PackageData(data));
+			if (attribute == NULL)
+				RETURN_ERROR(B_NO_MEMORY);
+
+			attribute->Init(attributeName);
+			node->AddAttribute(attribute);
+		}
+
+		if (parent != NULL)
+			parent->AddChild(node);
+		else
+			package->AddNode(node);
+
+		if (S_ISDIR(mode))
+			parent = static_cast<PackageDirectory*>(node);
+	}
+}
+
+
+status_t
+NodeTreeCache::_RestoreData(Reader& reader, PackageDataV2& data)
+{
+	uint64 size = reader.ReadUInt64();
+	if (reader.ReadUInt8() != 0) {
+		if (size > B_HPKG_MAX_INLINE_DATA_SIZE)
+			return B_BAD_DATA;
+
+		const uint8* inlineData = reader.Skip(size);
+		if (inlineData == NULL)
+			return B_BAD_DATA;
+
+		data.SetData((uint8)size, inlineData);
+	} else
+		data.SetData(size, reader.ReadUInt64());
+
+	return reader.HasError() ? B_BAD_DATA : B_OK;
+}
+
+
+/*static*/ status_t
+NodeTreeCache::_WritePackage(Writer& writer, Package* package)
+{
+	int fd = package->Open();
+	if (fd < 0)
+		RETURN_ERROR(fd);
+	PackageCloser packageCloser(package);
+
+	struct stat st;
+	uint64 checksum;
+	status_t error = _GetPackageIdentity(package, fd, st, checksum);
+	if (error != B_OK)
+		return error;
+
+	// the size of the record is filled in at the end
+	size_t recordStart = writer.Position();
+	writer.WriteUInt32(0);
+
+	writer.WriteString(package->FileName());
+	writer.WriteUInt64(st.st_ino);
+	writer.WriteUInt64(st.st_size);
+	writer.WriteUInt64(st.st_mtim.tv_sec);
+	writer.WriteUInt32(st.st_mtim.tv_nsec);
+	writer.WriteUInt64(checksum);
+
+	writer.WriteString(package->Name());
+	writer.WriteString(package->InstallPath());
+	writer.WriteUInt32(package->Flags());
+	writer.WriteUInt32(package->Architecture());
+	_WriteVersion(writer, package->Version());
+
+	uint32 count = 0;
+	for (ResolvableList::ConstIterator it
+			= package->Resolvables().GetIterator(); it.Next() != NULL;) {
+		count++;
+	}
+	writer.WriteUInt32(count);
+	for (ResolvableList::ConstIterator it
+			= package->Resolvables().GetIterator();
+			Resolvable* resolvable = it.Next();) {
+		writer.WriteString(resolvable->Name());
+		_WriteVersion(writer, resolvable->Version());
+		_WriteVersion(writer, resolvable->CompatibleVersion());
+	}
+
+	count = 0;
+	for (DependencyList::ConstIterator it
+			= package->Dependencies().GetIterator(); it.Next() != NULL;) {
+		count++;
+	}
+	writer.WriteUInt32(count);
+	for (DependencyList::ConstIterator it
+			= package->Dependencies().GetIterator();
+			Dependency* dependency = it.Next();) {
+		writer.WriteString(dependency->Name());
+		::Version* version = dependency->RequiredVersion();
+		writer.WriteUInt8(version != NULL);
+		if (version != NULL) {
+			writer.WriteUInt32(dependency->VersionOperator());
+			_WriteVersion(writer, version);
+		}
+	}
+
+	_WriteNodes(writer, package->Nodes());
+
+	writer.PatchUInt32(recordStart, writer.Position() - recordStart);
+	return B_OK;
+}
+
+
+/*static*/ void
+NodeTreeCache::_WriteVersion(Writer& writer, const ::Version* version)
+{
+	writer.WriteUInt8(version != NULL);
+	if (version == NULL)
+		return;
+
+	writer.WriteString(version->Major());
+	writer.WriteString(version->Minor());
+	writer.WriteString(version->Micro());
+	writer.WriteString(version->PreRelease());
+	writer.WriteUInt32(version->Revision());
+}
+
+
+/*!	Writes the nodes and all of their descendants in pre-order.
+	Since the lists add new elements at their head, siblings are written in
+	reverse order, so that adding them in the order they are read restores
+	the lists as they are now.
+	Like Volume::_AddPackageContentRootNode(), this avoids recursion due to
+	the limited kernel stack size.
+*/
+/*static*/ void
+NodeTreeCache::_WriteNodes(Writer& writer, const PackageNodeList& nodes)
+{
+	struct Level {
+		PackageNode**	nodes;
+		int32			count;
+		int32			index;
+	};
+
+	Level* levels = NULL;
+	int32 depth = 0;
+	int32 capacity = 0;
+
+	const PackageNodeList* list = &nodes;
+	while (true) {
+		if (list != NULL) {
+			// descend into the new list
+			if (depth == capacity) {
+				capacity = max_c(capacity * 2, 16);
+				Level* newLevels = (Level*)realloc(levels,
+					capacity * sizeof(Level));
+				if (newLevels == NULL)
+					break;
+				levels = newLevels;
+			}
+
+			Level& level = levels[depth];
+			level.nodes = _CollectReversed(*list, level.count);
+			if (level.nodes == NULL)
+				break;
+			level.index = 0;
+			depth++;
+			list = NULL;
+		}
+
+		Level& level = levels[depth - 1];
+		if (level.index == level.count) {
+			// all nodes of this level are done
+			writer.WriteUInt32(0);
+			free(level.nodes);
+			if (--depth == 0)
+				break;
+			continue;
+		}
+
+		PackageNode* node = level.nodes[level.index++];
+		_WriteNode(writer, node);
+
+		if (S_ISDIR(node->Mode()))
+			list = &static_cast<PackageDirectory*>(node)->Children();
+	}
+
+	if (depth > 0 || list != NULL) {
+		// we ran out of memory
+		writer.SetError();
+		while (depth > 0)
+			free(levels[--depth].nodes);
+	}
+
+	free(levels);
+}
+
+
+/*!	Returns a malloc()ed array with the nodes of the \a list in reverse
+	order, or \c NULL, if there is not enough memory.
+*/
+/*static*/ PackageNode**
+NodeTreeCache::_CollectReversed(const PackageNodeList& list, int32& _count)
+{
+	int32 count = 0;
+	for (PackageNode* node = list.First(); node != NULL;
+			node = list.GetNext(node)) {
+		count++;
+	}
+
+	PackageNode** nodes = (PackageNode**)malloc(
+		max_c(count, 1) * sizeof(PackageNode*));
+	if (nodes == NULL)
+		return NULL;
+
+	int32 index = count;
+	for (PackageNode* node = list.First(); node != NULL;
+			node = list.GetNext(node)) {
+		nodes[--index] = node;
+	}
+
+	_count = count;
+	return nodes;
+}
+
+
+/*static*/ void
+NodeTreeCache::_WriteNode(Writer& writer, PackageNode* node)
+{
+	writer.WriteUInt32(node->Mode());
+	writer.WriteString(node->Name());
+
+	timespec modifiedTime = node->ModifiedTime();
+	writer.WriteUInt64(modifiedTime.tv_sec);
+	writer.WriteUInt32(modifiedTime.tv_nsec);
+
+	if (S_ISREG(node->Mode()))
+		_WriteData(writer, static_cast<PackageFile*>(node)->Data());
+	else if (S_ISLNK(node->Mode()))
+		writer.WriteString(static_cast<PackageSymlink*>(node)->SymlinkPath());
+
+	// write the attributes in reverse order as well
+	const PackageNodeAttributeList& attributes = node->Attributes();
+	uint32 count = 0;
+	for (PackageNodeAttribute* attribute = attributes.First();
+			attribute != NULL; attribute = attributes.GetNext(attribute)) {
+		count++;
+	}
+	writer.WriteUInt32(count);
+
+	for (uint32 i = count; i > 0; i--) {
+		PackageNodeAttribute* attribute = attributes.First();
+		for (uint32 j = 1; j < i; j++)
+			attribute = attributes.GetNext(attribute);
+
+		writer.WriteString(attribute->Name());
+		writer.WriteUInt32(attribute->Type());
+		_WriteData(writer, attribute->Data());
+	}
+}
+
+
+/*static*/ void
+NodeTreeCache::_WriteData(Writer& writer, const PackageData& data)
+{
+	const PackageDataV2& dataV2 = data.DataV2();
+	writer.WriteUInt64(dataV2.Size());
+	writer.WriteUInt8(dataV2.IsEncodedInline());
+	if (dataV2.IsEncodedInline())
+		writer.Write(dataV2.InlineData(), dataV2.Size());
+	else
+		writer.WriteUInt64(dataV2.Offset());
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef NODE_TREE_CACHE_H
+#define NODE_TREE_CACHE_H
+
+
+#include "Package.h"
+
+
+class PackageSettings;
+
+
+/*!	A snapshot of the node trees and the meta data of the packages of a
+	volume, together with the strings they use, that is stored in the
+	administrative directory, so that the package files don't have to be
+	parsed again at the next mount.
+
+	The cache is only used for the exact activation file it was written for.
+	Each package in it is additionally checked against its package file, and
+	is parsed normally if it doesn't match anymore.
+*/
+class NodeTreeCache {
+public:
+								NodeTreeCache();
+								~NodeTreeCache();
+
+	static	uint64				Checksum(const void* data, size_t size);
+
+			status_t			Load(int directoryFD,
+									uint64 activationChecksum);
+			status_t			RestorePackage(Package* package, int fd,
+									const PackageSettings& settings);
+									// may be called by several threads
+
+			int32				CountPackages() const
+									{ return fPackageCount; }
+			int32				CountRestoredPackages() const
+									{ return fRestoredPackages; }
+
+	static	int32				CountCacheablePackages(
+									const PackageFileNameHashTable& packages,
+									const PackageSettings& settings);
+	static	status_t			Write(int directoryFD,
+									uint64 activationChecksum,
+									const PackageFileNameHashTable& packages,
+									const PackageSettings& settings);
+
+private:
+			struct Reader;
+			struct Writer;
+
+private:
+	static	bool				_IsCacheable(Package* package,
+									const PackageSettings& settings);
+	static	status_t			_GetPackageIdentity(Package* package, int fd,
+									struct stat& _stat, uint64& _checksum);
+
+			status_t			_RestoreVersion(Reader& reader,
+									::Version*& _version);
+			status_t			_RestoreNodes(Reader& reader,
+									Package* package);
+			status_t			_RestoreData(Reader& reader,
+									PackageDataV2& data);
+
+	static	status_t			_WritePackage(Writer& writer,
+									Package* package);
+	static	void				_WriteVersion(Writer& writer,
+									const ::Version* version);
+	static	void				_WriteNodes(Writer& writer,
+									const PackageNodeList& nodes);
+	static	PackageNode**		_CollectReversed(const PackageNodeList& list,
+									int32& _count);
+	static	void				_WriteNode(Writer& writer, PackageNode* node);
+	static	void				_WriteData(Writer& writer,
+									const PackageData& data);
+
+private:
+			uint8*				fData;
+			size_t				fDataSize;
+			String*				fStrings;
+			uint32				fStringCount;
+			const uint8**		fPackages;
+			uint32				fPackageCount;
+			int32				fRestoredPackages;
+};
+
+
+#endif	// NODE_TREE_CACHE_H
@@ -1,5 +1,6 @@
 /*
  * Copyright 2013, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef PACKAGE_SETTINGS_H
@@ -110,6 +111,8 @@ public:
 			const String&		Name() const
 									{ return fName; }
 
+			bool				HasEntries() const
+									{ return fEntries.CountElements() > 0; }
 			void				AddEntry(Entry* entry);
 			status_t			AddEntry(const char* path, Entry*& _entry);
 			Entry*				FindEntry(Entry* parent, const String& name)
@@ -1,5 +1,6 @@
 /*
  * Copyright 2009-2014, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -26,6 +27,7 @@
 #include <AutoDeleterDrivers.h>
 #include <PackagesDirectoryDefs.h>
 
+#include <smp.h>
 #include <vfs.h>
 
 #include "AttributeIndex.h"
@@ -33,6 +35,7 @@
 #include "kernel_interface.h"
 #include "LastModifiedIndex.h"
 #include "NameIndex.h"
+#include "NodeTreeCache.h"
 #include "OldUnpackingNodeAttributes.h"
 #include "PackageFSRoot.h"
 #include "PackageLinkDirectory.h"
@@ -63,6 +66,9 @@ const size_t kMaxActivationRequestSize = 10 * 1024 * 1024;
 // sanity limit for activation file size
 const size_t kMaxActivationFileSize = 10 * 1024 * 1024;
 
+// maximum number of threads loading the initial packages in parallel
+static const int32 kMaxInitialPackageLoaders = 8;
+
 static const char* const kAdministrativeDirectoryName
 	= PACKAGES_DIRECTORY_ADMIN_DIRECTORY;
 static const char* const kActivationFileName
@@ -161,6 +167,156 @@ private:
 };
 
 
+// #pragma mark - InitialPackageLoader
+
+
+/*!	Loads the packages that are active when the volume is mounted. Opening
+	the package files and parsing their TOCs is independent of the volume
+	state, and is done by a number of threads in parallel. The packages are
+	added to the volume afterwards, in the order they were added to the
+	loader.
+*/
+struct Volume::InitialPackageLoader {
+public:
+	InitialPackageLoader(Volume* volume, PackagesDirectory* packagesDirectory,
+		NodeTreeCache* cache = NULL)
+		:
+		fVolume(volume),
+		fPackagesDirectory(packagesDirectory),
+		fCache(cache),
+		fEntries(NULL),
+		fCount(0),
+		fCapacity(0),
+		fNextIndex(0)
+	{
+	}
+
+	~InitialPackageLoader()
+	{
+		for (int32 i = 0; i < fCount; i++) {
+			free(fEntries[i].name);
+			if (fEntries[i].package != NULL)
+				fEntries[i].package->ReleaseReference();
+		}
+		free(fEntries);
+	}
+
+	status_t AddPackage(const char* name)
+	{
+		if (fCount == fCapacity) {
+			int32 capacity = fCapacity == 0 ? 64 : fCapacity * 2;
+			Entry* entries = (Entry*)realloc(fEntries,
+				capacity * sizeof(Entry));
+			if (entries == NULL)
+				RETURN_ERROR(B_NO_MEMORY);
+			fEntries = entries;
+			fCapacity = capacity;
+		}
+
+		Entry& entry = fEntries[fCount];
+		entry.name = strdup(name);
+		if (entry.name == NULL)
+			RETURN_ERROR(B_NO_MEMORY);
+		entry.package = NULL;
+		entry.error = B_OK;
+
+		fCount++;
+		return B_OK;
+	}
+
+	/*!	Loads all packages. The calling thread takes part in the work, so
+		that failing to spawn additional threads only makes this slower.
+	*/
+	void Load()
+	{
+		bigtime_t startTime = system_time();
+
+		int32 threadCount = min_c(smp_get_num_cpus(),
+			kMaxInitialPackageLoaders);
+		threadCount = min_c(threadCount, fCount) - 1;
+
+		thread_id threads[kMaxInitialPackageLoaders];
+		int32 spawned = 0;
+		for (int32 i = 0; i < threadCount; i++) {
+			thread_id thread = spawn_kernel_thread(&_LoaderEntry,
+				"packagefs package loader", B_NORMAL_PRIORITY, this);
+			if (thread < 0)
+				break;
+
+			threads[spawned++] = thread;
+			resume_thread(thread);
+		}
+
+		_Work();
+
+		for (int32 i = 0; i < spawned; i++)
+			wait_for_thread(threads[i], NULL);
+
+		INFORM("Loaded %" B_PRId32 " packages with %" B_PRId32 " threads in "
+			"%" B_PRId64 " ms\n", fCount, spawned + 1,
+			(system_time() - startTime) / 1000);
+	}
+
+	int32 CountPackages() const
+	{
+		return fCount;
+	}
+
+	const char* NameAt(int32 index) const
+	{
+		return fEntries[index].name;
+	}
+
+	status_t ErrorAt(int32 index) const
+	{
+		return fEntries[index].error;
+	}
+
+	Package* PackageAt(int32 index) const
+	{
+		return fEntries[index].package;
+	}
+
+private:
+	struct Entry {
+		char*		name;
+		Package*	package;
+		status_t	error;
+	};
+
+private:
+	static status_t _LoaderEntry(void* data)
+	{
+		((InitialPackageLoader*)data)->_Work();
+		return B_OK;
+	}
+
+	void _Work()
+	{
+		while (true) {
+			int32 index = atomic_add(&fNextIndex, 1);
+			if (index >= fCount)
+				break;
+
+			Entry& entry = fEntries[index];
+			entry.error = fVolume->_LoadPackage(fPackagesDirectory, entry.name,
+				entry.package, fCache);
+			if (entry.error != B_OK)
+				entry.package = NULL;
+		}
+	}
+
+private:
+	Volume*				fVolume;
+	PackagesDirectory*	fPackagesDirectory;
+	NodeTreeCache*		fCache;
+	Entry*				fEntries;
+	int32				fCount;
+	int32				fCapacity;
+	int32				fNextIndex;
+};
+
+
 // #pragma mark - Volume
 
 
@@ -755,6 +911,8 @@ Volume::_LoadOldPackagesStates(const char* packagesState)
 status_t
 Volume::_AddInitialPackages()
 {
+	bigtime_t startTime = system_time();
+
 	PackagesDirectory* packagesDirectory = fPackagesDirectories.Last();
 	INFORM("Adding packages from \"%s\"\n", packagesDirectory->Path());
 
@@ -798,6 +956,7 @@ Volume::_AddInitialPackages()
 	}
 
 	// add the packages to the node tree
+	bigtime_t addTime = system_time();
 	VolumeWriteLocker systemVolumeLocker(_SystemVolumeIfNotSelf());
 	VolumeWriteLocker volumeLocker(this);
 	for (PackageFileNameHashTable::Iterator it = fPackages.GetIterator();
@@ -813,6 +972,12 @@ Volume::_AddInitialPackages()
 		}
 	}
 
+	bigtime_t endTime = system_time();
+	INFORM("Activated %" B_PRIuSIZE " packages in %" B_PRId64 " ms (%" B_PRId64
+		" ms loading, %" B_PRId64 " ms adding to the node tree)\n",
+		fPackages.CountElements(), (endTime - startTime) / 1000,
+		(addTime - startTime) / 1000, (endTime - addTime) / 1000);
+
 	return B_OK;
 }
 
@@ -861,10 +1026,27 @@ Volume::_AddInitialPackagesFromActivationFile(
 		RETURN_ERROR(B_ERROR);
 	}
 
+	// Only the latest state has a node tree cache. It is only valid for the
+	// exact same activation file, so compute its checksum before parsing
+	// modifies the content.
+	NodeTreeCache cache;
+	NodeTreeCache* usedCache = NULL;
+	uint64 activationChecksum = 0;
+	if (packagesDirectory == fPackagesDirectory) {
+		activationChecksum = NodeTreeCache::Checksum(fileContent, st.st_size);
+		status_t error = cache.Load(packagesDirectory->DirectoryFD(),
+			activationChecksum);
+		if (error == B_OK)
+			usedCache = &cache;
+		else
+			INFORM("Not using the node tree cache: %s\n", strerror(error));
+	}
+
 	// null-terminate to simplify parsing
 	fileContent[st.st_size] = '\0';
 
 	// parse the file and add the respective packages
+	InitialPackageLoader loader(this, packagesDirectory, usedCache);
 	const char* packageName = fileContent;
 	char* const fileContentEnd = fileContent + st.st_size;
 	while (packageName < fileContentEnd) {
@@ -884,14 +1066,41 @@ Volume::_AddInitialPackagesFromActivationFile(
 			RETURN_ERROR(B_BAD_DATA);
 		}
 
-		status_t error = _LoadAndAddInitialPackage(packagesDirectory,
-			packageName);
+		status_t error = loader.AddPackage(packageName);
 		if (error != B_OK)
 			RETURN_ERROR(error);
 
 		packageName = packageNameEnd + 1;
 	}
 
+	status_t error = _LoadAndAddInitialPackages(loader, false);
+	if (error != B_OK || packagesDirectory != fPackagesDirectory)
+		return error;
+
+	// Update the cache, unless all of its packages could be used, and it
+	// already contains all packages it can. The latter is not the case when
+	// the settings of a package no longer block any of its entries.
+	if (usedCache != NULL) {
+		INFORM("Restored %" B_PRId32 " of %" B_PRId32 " packages from the node "
+			"tree cache\n", cache.CountRestoredPackages(),
+			loader.CountPackages());
+	}
+
+	if (usedCache == NULL
+		|| cache.CountRestoredPackages() < cache.CountPackages()
+		|| cache.CountRestoredPackages()
+			< NodeTreeCache::CountCacheablePackages(fPackages,
+				fPackageSettings)) {
+		status_t writeError = NodeTreeCache::Write(
+			packagesDirectory->DirectoryFD(), activationChecksum, fPackages,
+			fPackageSettings);
+		if (writeError != B_OK) {
+			// not fatal, e.g. the volume might be read-only
+			INFORM("Failed to write the node tree cache: %s\n",
+				strerror(writeError));
+		}
+	}
+
 	return B_OK;
 }
 
@@ -913,6 +1122,7 @@ Volume::_AddInitialPackagesFromDirectory()
 		RETURN_ERROR(errno);
 	}
 
+	InitialPackageLoader loader(this, fPackagesDirectory);
 	while (dirent* entry = readdir(dir.Get())) {
 		// skip "." and ".."
 		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
@@ -925,28 +1135,40 @@ Volume::_AddInitialPackagesFromDirectory()
 			continue;
 		}
 
-		_LoadAndAddInitialPackage(fPackagesDirectory, entry->d_name);
+		status_t error = loader.AddPackage(entry->d_name);
+		if (error != B_OK)
+			RETURN_ERROR(error);
 	}
 
-	return B_OK;
+	return _LoadAndAddInitialPackages(loader, true);
 }
 
 
+/*!	Loads all packages of the \a loader, and adds them to the volume. If
+	\a ignoreErrors is \c false, no packages are added after the first one
+	that failed to load, and its error is returned.
+*/
 status_t
-Volume::_LoadAndAddInitialPackage(PackagesDirectory* packagesDirectory,
-	const char* name)
+Volume::_LoadAndAddInitialPackages(InitialPackageLoader& loader,
+	bool ignoreErrors)
 {
-	Package* package;
-	status_t error = _LoadPackage(packagesDirectory, name, package);
-	if (error != B_OK) {
-		ERROR("Failed to load package \"%s\": %s\n", name, strerror(error));
-		RETURN_ERROR(error);
-	}
-	BReference<Package> packageReference(package, true);
+	loader.Load();
 
 	VolumeWriteLocker systemVolumeLocker(_SystemVolumeIfNotSelf());
 	VolumeWriteLocker volumeLocker(this);
-	_AddPackage(package);
+
+	for (int32 i = 0; i < loader.CountPackages(); i++) {
+		status_t error = loader.ErrorAt(i);
+		if (error != B_OK) {
+			ERROR("Failed to load package \"%s\": %s\n", loader.NameAt(i),
+				strerror(error));
+			if (!ignoreErrors)
+				RETURN_ERROR(error);
+			continue;
+		}
+
+		_AddPackage(loader.PackageAt(i));
+	}
 
 	return B_OK;
 }
@@ -1507,7 +1729,7 @@ Volume::_RemoveNodeAndVNode(Node* node)
 
 status_t
 Volume::_LoadPackage(PackagesDirectory* packagesDirectory, const char* name,
-	Package*& _package)
+	Package*& _package, NodeTreeCache* cache)
 {
 	// Find the package -- check the specified packages directory and iterate
 	// toward the newer states.
@@ -1537,7 +1759,7 @@ Volume::_LoadPackage(PackagesDirectory* packagesDirectory, const char* name,
 	if (error != B_OK)
 		return error;
 
-	error = package->Load(fPackageSettings);
+	error = package->Load(fPackageSettings, cache);
 	if (error != B_OK)
 		return error;
 
@@ -1,5 +1,6 @@
 /*
  * Copyright 2009-2014, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef VOLUME_H
@@ -27,6 +28,7 @@
 
 
 class Directory;
+class NodeTreeCache;
 class PackageFSRoot;
 class PackagesDirectory;
 class UnpackingNode;
@@ -109,6 +111,7 @@ private:
 private:
 			struct ShineThroughDirectory;
 			struct ActivationChangeRequest;
+			struct InitialPackageLoader;
 
 private:
 			status_t			_LoadOldPackagesStates(
@@ -118,9 +121,9 @@ private:
 			status_t			_AddInitialPackagesFromActivationFile(
 									PackagesDirectory* packagesDirectory);
 			status_t			_AddInitialPackagesFromDirectory();
-			status_t			_LoadAndAddInitialPackage(
-									PackagesDirectory* packagesDirectory,
-									const char* name);
+			status_t			_LoadAndAddInitialPackages(
+									InitialPackageLoader& loader,
+									bool ignoreErrors);
 
 	inline	void				_AddPackage(Package* package);
 	inline	void				_RemovePackage(Package* package);
@@ -155,7 +158,8 @@ private:
 
 			status_t			_LoadPackage(
 									PackagesDirectory* packagesDirectory,
-									const char* name, Package*& _package);
+									const char* name, Package*& _package,
+									NodeTreeCache* cache = NULL);
 
 			status_t			_ChangeActivation(
 									ActivationChangeRequest& request);
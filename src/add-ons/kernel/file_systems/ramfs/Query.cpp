@@ -1,6 +1,6 @@
 /*
  * Copyright 2011, Ingo Weinhold, ingo_weinhold@gmx.de.
- * Copyright 2023, Haiku, Inc. All rights reserved.
+ * Copyright 2023-2026, Haiku, Inc. All rights reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -128,6 +128,7 @@ struct Query::QueryPolicy {
 	};
 
 	static const int32 kMaxFileNameLength = B_FILE_NAME_LENGTH;
+	static const bool kHasTrigramIndices = false;
 
 	// Entry interface
 
@@ -190,6 +191,11 @@ struct Query::QueryPolicy {
 		return index.index->GetKeyLength();
 	}
 
+	static bool IndexHasAllTrigrams(Index& index)
+	{
+		return false;
+	}
+
 	static IndexIterator* IndexCreateIterator(Index& index)
 	{
 		IndexIterator* iterator = new(std::nothrow) IndexIterator(index.index);
@@ -225,6 +231,11 @@ struct Query::QueryPolicy {
 		return B_OK;
 	}
 
+	static ino_t IndexIteratorGetNodeID(IndexIterator* indexIterator)
+	{
+		return indexIterator->entry->GetNode()->GetID();
+	}
+
 	static void IndexIteratorSkipDuplicates(IndexIterator* indexIterator)
 	{
 		// Nothing to do.
@@ -278,6 +289,13 @@ struct Query::QueryPolicy {
 
 	// Volume interface
 
+	static status_t ContextGetEntry(Context* context, ino_t id,
+		NodeHolder& holder, Entry** _entry)
+	{
+		// only needed for trigram indices
+		return B_NOT_SUPPORTED;
+	}
+
 	static dev_t ContextGetVolumeID(Context* context)
 	{
 		return context->fVolume->GetID();
@@ -1,5 +1,6 @@
 /*
  * Copyright 2011, Haiku Inc. All rights reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  *
  * Authors:
@@ -9,11 +10,7 @@
 
 #include <sys/cdefs.h>
 
-
-uint16 calculate_crc(uint16 crc, uint8 *data, uint16 length);
-
-
-uint32 calculate_crc32c(uint32 crc32c, const unsigned char *buffer,
-	unsigned int length);
+#include <util/crc32.h>
 
 
+uint16 calculate_crc(uint16 crc, uint8 *data, uint16 length);
@@ -2,6 +2,7 @@
  * Copyright 2001-2014, Axel Dörfler, axeld@pinc-software.de.
  * Copyright 2010, Clemens Zeidler <haiku@clemens-zeidler.de>
  * Copyright 2011, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 
@@ -33,6 +34,68 @@ compare_integral(const Key& a, const Key& b)
 }
 
 
+/*!	Folds the case of ASCII characters only; all other bytes, including
+	those of multi-byte UTF-8 characters, stay the same.
+*/
+static inline uint8
+fold_case(uint8 c)
+{
+	if (c >= 'A' && c <= 'Z')
+		return c - 'A' + 'a';
+	return c;
+}
+
+
+static int32
+sort_trigrams(uint32* trigrams, int32 count)
+{
+	std::sort(trigrams, trigrams + count);
+	return std::unique(trigrams, trigrams + count) - trigrams;
+}
+
+
+/*!	Parses the character set at \a _pattern, which must point to the opening
+	bracket, and moves \a _pattern behind it.
+	Returns the case folded character the set stands for if all of its
+	members are the same ASCII character regardless of case, as in "[Hh]",
+	or -1 otherwise.
+*/
+static int32
+folded_set_character(const char** _pattern)
+{
+	const char* pattern = *_pattern + 1;
+	int32 folded = -1;
+	bool valid = pattern[0] != '^' && pattern[0] != '!';
+
+	while (pattern[0] != ']') {
+		if (pattern[0] == '\\')
+			pattern++;
+		if (pattern[0] == '\0') {
+			*_pattern = pattern;
+			return -1;
+		}
+
+		uint32 c = utf8ToUnicode(&pattern);
+		if (pattern[0] == '-' && pattern[1] != ']' && pattern[1] != '\0') {
+			// ranges never stand for a single character
+			pattern++;
+			if (pattern[0] == '\\' && pattern[1] != '\0')
+				pattern++;
+			utf8ToUnicode(&pattern);
+			valid = false;
+			continue;
+		}
+
+		if (c >= 0x80 || (folded >= 0 && fold_case(c) != folded))
+			valid = false;
+		folded = fold_case(c);
+	}
+
+	*_pattern = pattern + 1;
+	return valid ? folded : -1;
+}
+
+
 // #pragma mark -
 
 
@@ -322,4 +385,128 @@ matchString(const char* pattern, const char* string)
 }
 
 
+// #pragma mark - trigrams
+
+
+/*!	Writes the name of the trigram index of \a attribute into \a buffer. */
+status_t
+getTrigramIndexName(const char* attribute, char* buffer, size_t bufferSize)
+{
+	size_t length = strlen(attribute);
+	if (length + sizeof(TRIGRAM_INDEX_SUFFIX) > bufferSize)
+		return B_NAME_TOO_LONG;
+
+	memcpy(buffer, attribute, length);
+	memcpy(buffer + length, TRIGRAM_INDEX_SUFFIX, sizeof(TRIGRAM_INDEX_SUFFIX));
+	return B_OK;
+}
+
+
+/*!	Writes the name of the attribute the trigram index \a indexName belongs
+	to into \a buffer. Returns \c B_BAD_VALUE if \a indexName is not the name
+	of a trigram index.
+*/
+status_t
+getTrigramAttributeName(const char* indexName, char* buffer,
+	size_t bufferSize)
+{
+	size_t length = strlen(indexName);
+	const size_t suffixLength = sizeof(TRIGRAM_INDEX_SUFFIX) - 1;
+	if (length <= suffixLength
+		|| strcmp(indexName + length - suffixLength, TRIGRAM_INDEX_SUFFIX))
+		return B_BAD_VALUE;
+
+	length -= suffixLength;
+	if (length >= bufferSize)
+		return B_NAME_TOO_LONG;
+
+	memcpy(buffer, indexName, length);
+	buffer[length] = '\0';
+	return B_OK;
+}
+
+
+/*!	Fills \a trigrams with the sorted, case folded trigrams that appear in
+	the first \a length bytes of \a string, and returns their number.
+	Strings shorter than three bytes don't have any trigrams.
+*/
+int32
+getTrigrams(const char* string, size_t length, uint32* trigrams,
+	int32 maxCount)
+{
+	const uint8* bytes = (const uint8*)string;
+	length = strnlen(string, length);
+	int32 count = 0;
+
+	for (size_t i = 0; i + kTrigramLength <= length && count < maxCount; i++) {
+		trigrams[count++] = (fold_case(bytes[i]) << 16)
+			| (fold_case(bytes[i + 1]) << 8) | fold_case(bytes[i + 2]);
+	}
+
+	return sort_trigrams(trigrams, count);
+}
+
+
+/*!	Fills \a trigrams with the sorted, case folded trigrams every string
+	matching \a pattern must contain, and returns their number. Since they
+	are case folded, this also works for patterns that ignore case the way
+	Tracker builds them, like "*[Hh][Oo][Ww]*".
+	Returns 0 if the pattern doesn't contain at least three consecutive
+	fixed characters.
+*/
+int32
+getPatternTrigrams(const char* pattern, uint32* trigrams, int32 maxCount)
+{
+	uint32 window = 0;
+	int32 runLength = 0;
+	int32 count = 0;
+
+	while (pattern[0] != '\0' && count < maxCount) {
+		int32 c;
+		switch (pattern[0]) {
+			case '*':
+			case '?':
+				c = -1;
+				pattern++;
+				break;
+
+			case '[':
+				c = folded_set_character(&pattern);
+				break;
+
+			case '\\':
+				pattern++;
+				if (pattern[0] == '\0')
+					return sort_trigrams(trigrams, count);
+				// supposed to fall through
+			default:
+				c = fold_case(pattern[0]);
+				pattern++;
+				break;
+		}
+
+		if (c < 0) {
+			runLength = 0;
+			continue;
+		}
+
+		window = ((window << 8) | c) & 0xffffff;
+		if (++runLength >= kTrigramLength)
+			trigrams[count++] = window;
+	}
+
+	return sort_trigrams(trigrams, count);
+}
+
+
+/*!	Converts a trigram into the key it is stored under in a trigram index. */
+void
+trigramToKey(uint32 trigram, uint8* key)
+{
+	key[0] = (uint8)(trigram >> 16);
+	key[1] = (uint8)(trigram >> 8);
+	key[2] = (uint8)trigram;
+}
+
+
 }	// namespace QueryParser
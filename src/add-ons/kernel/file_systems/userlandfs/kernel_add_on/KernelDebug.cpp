@@ -80,6 +80,11 @@ KernelDebug::DebugPort(int argc, char** argv)
 	kprintf("  size:         %" B_PRId32 "\n", port->fPort.fInfo.size);
 	kprintf("  capacity:     %" B_PRId32 "\n", port->fPort.fCapacity);
 	kprintf("  buffer:       %p\n", port->fPort.fBuffer);
+	kprintf("  channel area: %" B_PRId32 " (%" B_PRId32 ")\n",
+		port->fPort.fInfo.area, port->fPort.fChannelArea);
+	kprintf("  channel:      %p\n", port->fPort.fChannel);
+	kprintf("  shared data:  %" B_PRId32 " of %" B_PRId32 " bytes reserved\n",
+		port->fPort.fSharedDataReserved, port->fPort.fSharedDataSize);
 	return 0;
 }
 
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2009, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -7,8 +8,13 @@
 
 #include <AutoDeleter.h>
 
+#ifdef _KERNEL_MODE
+#	include <smp.h>
+#endif
+
 #include "AreaSupport.h"
 #include "Compatibility.h"
+#include "Debug.h"
 #include "Port.h"
 
 
@@ -18,6 +24,49 @@ using std::nothrow;
 static const int32 kMinPortSize = 1024;			// 1 kB
 static const int32 kMaxPortSize = 64 * 1024;	// 64 kB
 
+// The channel area shared by both sides of a port starts with the
+// ChannelHeader, followed by the rings for both directions, and the shared
+// data for both directions. The owner sends through the first ring and
+// allocates from the first data range.
+static const int32 kMinRingSize = 16 * 1024;		// 16 kB
+static const int32 kSharedDataSize = 256 * 1024;	// 256 kB
+
+// code of the messages that wake up a consumer waiting for its ring
+static const int32 kRingWakeUpCode = 'rgwu';
+
+// time a receiver polls its ring before blocking, if there is more than one
+// CPU, so that quick replies don't require a reschedule
+static const bigtime_t kRingSpinTime = 10;			// 10 µs
+
+// time a sender waits before checking a full ring again
+static const bigtime_t kRingFullDelay = 1000;		// 1 ms
+
+
+struct Port::ChannelHeader {
+	RequestRing::Header	rings[2];
+	int32				ring_size;
+	int32				shared_data_size;
+};
+
+
+static bool
+is_multi_processor()
+{
+#ifdef _KERNEL_MODE
+	return smp_get_num_cpus() > 1;
+#else
+	static int32 sCPUCount = 0;
+	if (sCPUCount == 0) {
+		system_info info;
+		if (get_system_info(&info) == B_OK)
+			sCPUCount = info.cpu_count;
+		else
+			sCPUCount = 1;
+	}
+	return sCPUCount > 1;
+#endif
+}
+
 
 // constructor
 Port::Port(int32 size)
@@ -25,9 +74,16 @@ Port::Port(int32 size)
 	fBuffer(NULL),
 	fCapacity(0),
 	fReservedSize(0),
+	fChannelArea(-1),
+	fChannel(NULL),
+	fSharedDataOffset(0),
+	fSharedDataSize(0),
+	fSharedDataReserved(0),
+	fPeerSharedDataOffset(0),
 	fInitStatus(B_NO_INIT),
 	fOwner(true)
 {
+	fInfo.area = -1;
 	// adjust size to be within the sane bounds
 	if (size < kMinPortSize)
 		size = kMinPortSize;
@@ -53,6 +109,14 @@ Port::Port(int32 size)
 	}
 	fInfo.size = size;
 	fCapacity = size;
+	// create the shared channel -- we can do without it, though
+	if (_CreateChannel() != B_OK) {
+		if (fChannelArea >= 0)
+			delete_area(fChannelArea);
+		fChannelArea = -1;
+		fChannel = NULL;
+		fInfo.area = -1;
+	}
 	fInitStatus = B_OK;
 }
 
@@ -63,9 +127,16 @@ Port::Port(const Info* info)
 	fBuffer(NULL),
 	fCapacity(0),
 	fReservedSize(0),
+	fChannelArea(-1),
+	fChannel(NULL),
+	fSharedDataOffset(0),
+	fSharedDataSize(0),
+	fSharedDataReserved(0),
+	fPeerSharedDataOffset(0),
 	fInitStatus(B_NO_INIT),
 	fOwner(false)
 {
+	fInfo.area = -1;
 	// check parameters
 	if (!info || info->owner_port < 0 || info->client_port < 0
 		|| info->size < kMinPortSize || info->size > kMaxPortSize) {
@@ -81,8 +152,16 @@ Port::Port(const Info* info)
 	fInfo.owner_port = info->owner_port;
 	fInfo.client_port = info->client_port;
 	fInfo.size = info->size;
+	fInfo.area = info->area;
 	// init the other members
 	fCapacity = info->size;
+	// map the shared channel -- if the owner has one, it will use it, so we
+	// have to, too
+	if (fInfo.area >= 0) {
+		fInitStatus = _CloneChannel();
+		if (fInitStatus != B_OK)
+			return;
+	}
 	fInitStatus = B_OK;
 }
 
@@ -92,6 +171,8 @@ Port::~Port()
 {
 	Close();
 	delete[] fBuffer;
+	if (fChannelArea >= 0)
+		delete_area(fChannelArea);
 }
 
 
@@ -148,6 +229,53 @@ Port::Unreserve(int32 endOffset)
 }
 
 
+// AllocateSharedData
+//
+// Allocates memory in our part of the shared data of the channel. Like the
+// port buffer, it is reserved until UnreserveSharedData() is called with the
+// previous SharedDataReservedSize(). Returns the address, and the offset of
+// the data within the channel, or NULL, if there is not enough room.
+void*
+Port::AllocateSharedData(int32 size, int32 align, int32* _offset)
+{
+	if (fChannel == NULL || size < 0 || align <= 0)
+		return NULL;
+
+	int32 offset = (fSharedDataReserved + align - 1) / align * align;
+	if (offset + size > fSharedDataSize)
+		return NULL;
+
+	fSharedDataReserved = offset + size;
+	*_offset = fSharedDataOffset + offset;
+	return fChannel + fSharedDataOffset + offset;
+}
+
+
+// UnreserveSharedData
+void
+Port::UnreserveSharedData(int32 endOffset)
+{
+	if (endOffset < fSharedDataReserved)
+		fSharedDataReserved = endOffset;
+}
+
+
+// GetPeerSharedData
+//
+// Returns our address of data the peer allocated in its part of the shared
+// data, or NULL, if the range is invalid.
+void*
+Port::GetPeerSharedData(int32 offset, int32 size) const
+{
+	if (fChannel == NULL || offset < fPeerSharedDataOffset || size < 0
+		|| offset - fPeerSharedDataOffset > fSharedDataSize - size) {
+		return NULL;
+	}
+
+	return fChannel + offset;
+}
+
+
 // Send
 status_t
 Port::Send(const void* message, int32 size)
@@ -159,6 +287,31 @@ Port::Send(const void* message, int32 size)
 
 	port_id port = (fOwner ? fInfo.client_port : fInfo.owner_port);
 	status_t error;
+
+	if (fSendRing.IsValid()) {
+		// put the message into the ring, and only bother the receiver, if it
+		// is waiting for it
+		while ((error = fSendRing.Push(message, size)) == B_WOULD_BLOCK) {
+			// The receiver doesn't keep up, which shouldn't happen with
+			// the request/reply scheme. Wait, unless it is gone.
+			port_info info;
+			if (get_port_info(port, &info) != B_OK)
+				return (fInitStatus = B_BAD_PORT_ID);
+			snooze(kRingFullDelay);
+		}
+		if (error != B_OK)
+			return (fInitStatus = error);
+
+		if (!fSendRing.NeedsWakeUp())
+			return B_OK;
+
+		do {
+			error = write_port(port, kRingWakeUpCode, NULL, 0);
+		} while (error == B_INTERRUPTED);
+
+		return (fInitStatus = error);
+	}
+
 	do {
 		error = write_port(port, 0, message, size);
 	} while (error == B_INTERRUPTED);
@@ -187,41 +340,218 @@ Port::Receive(void** _message, size_t* _size, bigtime_t timeout)
 
 	port_id port = (fOwner ? fInfo.owner_port : fInfo.client_port);
 
-	// wait for the next message
-	status_t error = B_OK;
-	ssize_t bufferSize;
-	do {
-		// TODO: When compiling for userland, we might want to save this syscall
-		// by using read_port_etc() directly, using a sufficiently large
-		// on-stack buffer and copying onto the heap.
-		bufferSize = port_buffer_size_etc(port, timeoutFlags, timeout);
-		if (bufferSize < 0)
-			error = bufferSize;
-	} while (error == B_INTERRUPTED);
+	while (true) {
+		bool waiting = false;
+		if (fReceiveRing.IsValid()) {
+			// all messages queued in the ring are received without any
+			// syscall
+			status_t error = fReceiveRing.Pop(_message, _size);
+			if (error != B_WOULD_BLOCK)
+				return error == B_OK ? B_OK : (fInitStatus = error);
+
+			// the reply to a quick request might be just around the corner
+			if (timeoutFlags != B_RELATIVE_TIMEOUT && is_multi_processor()) {
+				bigtime_t spinUntil = system_time() + kRingSpinTime;
+				while (fReceiveRing.IsEmpty() && system_time() < spinUntil)
+					;
+				if (!fReceiveRing.IsEmpty())
+					continue;
+			}
+
+			waiting = true;
+			if (!fReceiveRing.PrepareToWait()) {
+				if (fReceiveRing.CancelWait()) {
+					// the sender has seen us waiting already -- swallow the
+					// wake-up message
+					status_t error = _WaitForWakeUp(0, 0);
+					if (error != B_OK)
+						return (fInitStatus = error);
+				}
+				continue;
+			}
+		}
+
+		// wait for the next message
+		status_t error = B_OK;
+		ssize_t bufferSize;
+		do {
+			// TODO: When compiling for userland, we might want to save this
+			// syscall by using read_port_etc() directly, using a sufficiently
+			// large on-stack buffer and copying onto the heap.
+			bufferSize = port_buffer_size_etc(port, timeoutFlags, timeout);
+			if (bufferSize < 0)
+				error = bufferSize;
+		} while (error == B_INTERRUPTED);
+
+		if (error == B_TIMED_OUT || error == B_WOULD_BLOCK) {
+			if (waiting && fReceiveRing.CancelWait()) {
+				// we've been woken up just now after all
+				error = _WaitForWakeUp(0, 0);
+				if (error != B_OK)
+					return (fInitStatus = error);
+				continue;
+			}
+			return error;
+		}
+		if (error != B_OK)
+			return (fInitStatus = error);
+
+		if (bufferSize == 0) {
+			// must be a wake-up message
+			error = _WaitForWakeUp(B_RELATIVE_TIMEOUT, 0);
+			if (error != B_OK)
+				return (fInitStatus = error);
+			continue;
+		}
+
+		// allocate memory for the message
+		void* message = malloc(bufferSize);
+		if (message == NULL)
+			return (fInitStatus = B_NO_MEMORY);
+		MemoryDeleter messageDeleter(message);
+
+		// read the message
+		int32 code;
+		ssize_t bytesRead = read_port_etc(port, &code, message, bufferSize,
+			B_RELATIVE_TIMEOUT, 0);
+		if (bytesRead < 0)
+			return fInitStatus = bytesRead;
+		if (bytesRead != bufferSize)
+			return fInitStatus = B_BAD_DATA;
+
+		// the sender doesn't use the ring, so don't let it think we wait
+		if (waiting)
+			fReceiveRing.CancelWait();
+
+		messageDeleter.Detach();
+		*_message = message;
+		*_size = bytesRead;
+
+		return B_OK;
+	}
+}
 
-	if (error == B_TIMED_OUT || error == B_WOULD_BLOCK)
-		return error;
+
+// _CreateChannel
+status_t
+Port::_CreateChannel()
+{
+	// the ring must hold a few messages of the maximal size
+	int32 ringSize = kMinRingSize;
+	while (ringSize < 4 * fCapacity)
+		ringSize *= 2;
+
+	size_t areaSize = (sizeof(ChannelHeader) + B_PAGE_SIZE - 1)
+		/ B_PAGE_SIZE * B_PAGE_SIZE + 2 * ringSize + 2 * kSharedDataSize;
+
+	void* address;
+	fChannelArea = create_area("userlandfs channel", &address,
+#ifdef _KERNEL_MODE
+		B_ANY_KERNEL_ADDRESS,
+#else
+		B_ANY_ADDRESS,
+#endif
+		areaSize, B_NO_LOCK,
+#ifdef _KERNEL_MODE
+		B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA | B_CLONEABLE_AREA
+#else
+		B_READ_AREA | B_WRITE_AREA | B_CLONEABLE_AREA
+#endif
+		);
+	if (fChannelArea < 0)
+		RETURN_ERROR(fChannelArea);
+
+	fChannel = (uint8*)address;
+	ChannelHeader* header = (ChannelHeader*)fChannel;
+	header->ring_size = ringSize;
+	header->shared_data_size = kSharedDataSize;
+
+	fInfo.area = fChannelArea;
+	return _InitChannel(areaSize);
+}
+
+
+// _CloneChannel
+status_t
+Port::_CloneChannel()
+{
+	void* address;
+	fChannelArea = clone_area("userlandfs channel", &address,
+#ifdef _KERNEL_MODE
+		B_ANY_KERNEL_ADDRESS, B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA,
+#else
+		B_ANY_ADDRESS, B_READ_AREA | B_WRITE_AREA,
+#endif
+		fInfo.area);
+	if (fChannelArea < 0)
+		RETURN_ERROR(fChannelArea);
+
+	area_info areaInfo;
+	status_t error = get_area_info(fChannelArea, &areaInfo);
 	if (error != B_OK)
-		return (fInitStatus = error);
+		RETURN_ERROR(error);
 
-	// allocate memory for the message
-	void* message = malloc(bufferSize);
-	if (message == NULL)
-		return (fInitStatus = B_NO_MEMORY);
-	MemoryDeleter messageDeleter(message);
+	fChannel = (uint8*)address;
+	return _InitChannel(areaInfo.size);
+}
 
-	// read the message
-	int32 code;
-	ssize_t bytesRead = read_port_etc(port, &code, message, bufferSize,
-		B_RELATIVE_TIMEOUT, 0);
-	if (bytesRead < 0)
-		return fInitStatus = bytesRead;
-	if (bytesRead != bufferSize)
-		return fInitStatus = B_BAD_DATA;
 
-	messageDeleter.Detach();
-	*_message = message;
-	*_size = bytesRead;
+// _InitChannel
+status_t
+Port::_InitChannel(size_t areaSize)
+{
+	// read the layout only once, and check it, since the other side might
+	// change it any time
+	ChannelHeader* header = (ChannelHeader*)fChannel;
+	int32 ringSize = header->ring_size;
+	int32 sharedDataSize = header->shared_data_size;
+	int32 headerSize = (sizeof(ChannelHeader) + B_PAGE_SIZE - 1)
+		/ B_PAGE_SIZE * B_PAGE_SIZE;
+
+	if (ringSize < kMinRingSize || ringSize > 4 * kMaxPortSize
+		|| (ringSize & (ringSize - 1)) != 0 || ringSize < 4 * fCapacity
+		|| sharedDataSize < 0 || sharedDataSize > kSharedDataSize
+		|| (size_t)headerSize + 2 * ringSize + 2 * sharedDataSize
+			> areaSize) {
+		RETURN_ERROR(B_BAD_DATA);
+	}
+
+	uint8* rings = fChannel + headerSize;
+	int32 sharedData = headerSize + 2 * ringSize;
+	int32 sendIndex = fOwner ? 0 : 1;
+	int32 receiveIndex = 1 - sendIndex;
+
+	fSendRing.SetTo(&header->rings[sendIndex], rings + sendIndex * ringSize,
+		ringSize);
+	fReceiveRing.SetTo(&header->rings[receiveIndex],
+		rings + receiveIndex * ringSize, ringSize);
+
+	fSharedDataSize = sharedDataSize;
+	fSharedDataOffset = sharedData + sendIndex * sharedDataSize;
+	fPeerSharedDataOffset = sharedData + receiveIndex * sharedDataSize;
+	fSharedDataReserved = 0;
+	return B_OK;
+}
+
 
+// _WaitForWakeUp
+//
+// Reads the wake-up message a sender sent, because it saw us waiting.
+status_t
+Port::_WaitForWakeUp(uint32 timeoutFlags, bigtime_t timeout)
+{
+	port_id port = (fOwner ? fInfo.owner_port : fInfo.client_port);
+
+	int32 code;
+	ssize_t bytesRead;
+	do {
+		bytesRead = read_port_etc(port, &code, NULL, 0, timeoutFlags,
+			timeout);
+	} while (bytesRead == B_INTERRUPTED);
+
+	if (bytesRead < 0)
+		return bytesRead;
+	if (bytesRead != 0 || code != kRingWakeUpCode)
+		return B_BAD_DATA;
 	return B_OK;
 }
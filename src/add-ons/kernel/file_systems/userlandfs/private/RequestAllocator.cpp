@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2009, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -23,6 +24,7 @@ RequestAllocator::RequestAllocator(Port* port)
 	fRequest(NULL),
 	fRequestSize(0),
 	fPortReservedOffset(0),
+	fSharedDataReservedOffset(0),
 	fAllocatedAreaCount(0),
 	fDeferredInitInfoCount(0),
 	fRequestInPortBuffer(false)
@@ -45,6 +47,7 @@ RequestAllocator::Init(Port* port)
 		fPort = port;
 		fError = fPort->InitCheck();
 		fPortReservedOffset = fPort->ReservedSize();
+		fSharedDataReservedOffset = fPort->SharedDataReservedSize();
 	}
 	return fError;
 }
@@ -58,6 +61,9 @@ RequestAllocator::Uninit()
 	else
 		free(fRequest);
 
+	if (fPort != NULL)
+		fPort->UnreserveSharedData(fSharedDataReservedOffset);
+
 	for (int32 i = 0; i < fAllocatedAreaCount; i++)
 		delete_area(fAllocatedAreas[i]);
 	fAllocatedAreaCount = 0;
@@ -73,6 +79,7 @@ RequestAllocator::Uninit()
 	fRequest = NULL;
 	fRequestSize = 0;
 	fPortReservedOffset = 0;
+	fSharedDataReservedOffset = 0;
 }
 
 // Error
@@ -155,7 +162,7 @@ RequestAllocator::ReadRequest(bigtime_t timeout)
 
 	// relocate the request
 	fError = relocate_request(fRequest, fRequestSize, fAllocatedAreas,
-		&fAllocatedAreaCount);
+		&fAllocatedAreaCount, fPort);
 	RETURN_ERROR(fError);
 }
 
@@ -230,6 +237,23 @@ RequestAllocator::AllocateAddress(Address& address, int32 size, int32 align,
 			*data = (uint8*)fRequest + offset;
 			address.SetTo(-1, offset, size);
 		}
+	} else if (void* sharedData = fPort->AllocateSharedData(size, align,
+			&offset)) {
+		// not enough room in the port's buffer, but in the data shared with
+		// the other side -- no need to copy anything around
+		*data = sharedData;
+		if (deferredInit) {
+			DeferredInitInfo& info
+				= fDeferredInitInfos[fDeferredInitInfoCount];
+			info.data = NULL;
+			info.area = fPort->GetSharedArea();
+			info.offset = offset;
+			info.size = size;
+			info.inPortBuffer = false;
+			info.target = &address;
+			fDeferredInitInfoCount++;
+		} else
+			address.SetTo(fPort->GetSharedArea(), offset, size);
 	} else {
 		// not enough room in the port's buffer: we need to allocate an area
 		if (fAllocatedAreaCount >= MAX_REQUEST_ADDRESS_COUNT)
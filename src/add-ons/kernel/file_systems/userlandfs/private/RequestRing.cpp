@@ -0,0 +1,191 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "RequestRing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Compatibility.h"
+#include "Debug.h"
+
+
+// Every message is preceded by a record header and padded to 8 bytes. A
+// record header with a negative size marks the unused rest of the ring, when
+// a message didn't fit in anymore before the end.
+struct record_header {
+	int32	size;
+	int32	reserved;
+};
+
+static const int32 kRecordAlignment = 8;
+static const int32 kSkipRecord = -1;
+
+
+static inline uint32
+record_size(int32 messageSize)
+{
+	return (sizeof(record_header) + messageSize + kRecordAlignment - 1)
+		/ kRecordAlignment * kRecordAlignment;
+}
+
+
+// constructor
+RequestRing::RequestRing()
+	:
+	fHeader(NULL),
+	fData(NULL),
+	fSize(0),
+	fPosition(0)
+{
+}
+
+// SetTo
+//
+// The size must be a power of two. The shared memory must be zeroed, and
+// nothing must have been sent yet.
+void
+RequestRing::SetTo(Header* header, void* data, int32 size)
+{
+	fHeader = header;
+	fData = (uint8*)data;
+	fSize = size;
+	fPosition = 0;
+}
+
+// MaxMessageSize
+int32
+RequestRing::MaxMessageSize() const
+{
+	// leave room for a skip record, so that a message of this size always
+	// fits into an empty ring
+	return fSize / 2 - sizeof(record_header);
+}
+
+// Push
+status_t
+RequestRing::Push(const void* message, int32 size)
+{
+	if (fHeader == NULL)
+		return B_NO_INIT;
+	if (size < 0 || size > MaxMessageSize())
+		return B_BAD_VALUE;
+
+	uint32 tail = (uint32)atomic_get(&fHeader->tail);
+	uint32 used = fPosition - tail;
+	if (used > fSize)
+		RETURN_ERROR(B_BAD_DATA);
+
+	uint32 offset = fPosition & (fSize - 1);
+	uint32 recordSize = record_size(size);
+	uint32 skip = 0;
+	if (offset + recordSize > fSize)
+		skip = fSize - offset;
+	if (used + skip + recordSize > fSize)
+		return B_WOULD_BLOCK;
+
+	if (skip > 0) {
+		((record_header*)(fData + offset))->size = kSkipRecord;
+		offset = 0;
+	}
+
+	record_header* record = (record_header*)(fData + offset);
+	record->size = size;
+	record->reserved = 0;
+	memcpy(record + 1, message, size);
+
+	// publish the message
+	fPosition += skip + recordSize;
+	atomic_set(&fHeader->head, (int32)fPosition);
+	return B_OK;
+}
+
+// Pop
+//
+// Returns a copy of the next message allocated with malloc(), so that the
+// peer can neither change it while it is being examined, nor is the ring
+// space blocked while the message is handled.
+status_t
+RequestRing::Pop(void** _message, size_t* _size)
+{
+	if (fHeader == NULL)
+		return B_NO_INIT;
+
+	uint32 head = (uint32)atomic_get(&fHeader->head);
+	if (head == fPosition)
+		return B_WOULD_BLOCK;
+	uint32 available = head - fPosition;
+	if (available > fSize)
+		RETURN_ERROR(B_BAD_DATA);
+
+	uint32 offset = fPosition & (fSize - 1);
+	int32 size = ((record_header*)(fData + offset))->size;
+	uint32 skip = 0;
+	if (size == kSkipRecord) {
+		skip = fSize - offset;
+		offset = 0;
+		size = ((record_header*)fData)->size;
+	}
+
+	if (size < 0 || skip + record_size(size) > available
+		|| offset + record_size(size) > fSize) {
+		RETURN_ERROR(B_BAD_DATA);
+	}
+
+	void* message = malloc(size > 0 ? size : 1);
+	if (message == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+	memcpy(message, fData + offset + sizeof(record_header), size);
+
+	// free the space
+	fPosition += skip + record_size(size);
+	atomic_set(&fHeader->tail, (int32)fPosition);
+
+	*_message = message;
+	*_size = size;
+	return B_OK;
+}
+
+// IsEmpty
+bool
+RequestRing::IsEmpty() const
+{
+	return fHeader == NULL || (uint32)atomic_get(&fHeader->head) == fPosition;
+}
+
+// PrepareToWait
+//
+// Announces that the consumer is going to block on its port. Returns false,
+// if a message has arrived in the meantime; CancelWait() must be called then.
+bool
+RequestRing::PrepareToWait()
+{
+	// the exchange is a full barrier, so that either we see the new head, or
+	// the producer sees the flag
+	atomic_get_and_set(&fHeader->waiting, 1);
+	return IsEmpty();
+}
+
+// CancelWait
+//
+// Withdraws the announcement of PrepareToWait(). Returns true, if the
+// producer has already seen it, and a wake-up message is on its way, which
+// the consumer has to read from the port.
+bool
+RequestRing::CancelWait()
+{
+	return atomic_get_and_set(&fHeader->waiting, 0) == 0;
+}
+
+// NeedsWakeUp
+//
+// To be called by the producer after Push(). Returns true, if the consumer
+// waits, and needs to be woken up via its port. Only one wake-up is
+// requested per wait.
+bool
+RequestRing::NeedsWakeUp()
+{
+	return atomic_get_and_set(&fHeader->waiting, 0) != 0;
+}
@@ -3,6 +3,7 @@
 #include <limits.h>
 
 #include "Debug.h"
+#include "Port.h"
 #include "Requests.h"
 
 #define _ADD_ADDRESS(_address, _flags) do {			\
@@ -407,10 +408,12 @@ is_error_reply(ReplyRequest* request)
 
 // RequestRelocator
 struct RequestRelocator {
-	RequestRelocator(int32 requestBufferSize, area_id* areas, int32* count)
+	RequestRelocator(int32 requestBufferSize, area_id* areas, int32* count,
+		Port* port)
 		: fRequestBufferSize(requestBufferSize),
 		  fAreas(areas),
-		  fAreaCount(count)
+		  fAreaCount(count),
+		  fPort(port)
 	{
 		*fAreaCount = 0;
 	}
@@ -466,6 +469,12 @@ struct RequestRelocator {
 //PRINT(("    -> relocated address: %p\n", (uint8*)request + offset));
 					address->SetRelocatedAddress((uint8*)request + offset);
 				}
+			} else if (fPort != NULL && area == fPort->GetSharedArea()) {
+				// data shared by the port's peer, already mapped
+				void* data = fPort->GetPeerSharedData(offset, size);
+				if (data == NULL)
+					RETURN_ERROR(B_BAD_DATA);
+				address->SetRelocatedAddress(data);
 			} else {
 				// clone the area
 				void* data;
@@ -503,17 +512,18 @@ private:
 	int32		fRequestBufferSize;
 	area_id*	fAreas;
 	int32*		fAreaCount;
+	Port*		fPort;
 	bool		fSuccess;
 };
 
 // relocate_request
 status_t
 UserlandFSUtil::relocate_request(Request* request, int32 requestBufferSize,
-	area_id* areas, int32* count)
+	area_id* areas, int32* count, Port* port)
 {
 	if (!request || !areas || !count)
 		return B_BAD_VALUE;
-	RequestRelocator task(requestBufferSize, areas, count);
+	RequestRelocator task(requestBufferSize, areas, count, port);
 	return do_for_request(request, task);
 }
 
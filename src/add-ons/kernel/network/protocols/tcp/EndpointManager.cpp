@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2009, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -11,12 +11,14 @@
 #include "EndpointManager.h"
 
 #include <new>
+#include <string.h>
 #include <unistd.h>
 
 #include <KernelExport.h>
 
 #include <NetUtilities.h>
 #include <tracing.h>
+#include <util/Random.h>
 
 #include "TCPEndpoint.h"
 
@@ -133,6 +135,25 @@ protected:
 static const uint16 kLastReservedPort = 1023;
 static const uint16 kFirstEphemeralPort = 40000;
 
+static const bigtime_t kTimeWaitTimeout = TCP_MAX_SEGMENT_LIFETIME << 1;
+static const int32 kMaxTimeWaitEntries = 65536;
+
+static const int32 kMaxSynCacheEntries = 4096;
+static const bigtime_t kSynCacheInterval = 500000;		// 500 msecs
+static const uint8 kMaxSynRetransmits = 4;
+static const int32 kSynRetransmitBatchSize = 8;
+
+// SYN cookies are laid out as: 5 bits period, 3 bits MSS index, 24 bits hash
+static const bigtime_t kSynCookiePeriod = 64000000;	// 64 secs
+static const uint32 kSynCookiePeriodShift = 27;
+static const uint32 kSynCookiePeriodMask = 0x1f;
+static const uint32 kSynCookieMaxSegmentSizeShift = 24;
+static const uint32 kSynCookieMaxSegmentSizeMask = 0x7;
+static const uint32 kSynCookieHashMask = 0xffffff;
+static const uint16 kSynCookieMaxSegmentSizes[] = {
+	216, 536, 1200, 1220, 1440, 1460, 4312, 8960
+};
+
 
 ConnectionHashDefinition::ConnectionHashDefinition(EndpointManager* manager)
 	:
@@ -175,6 +196,35 @@ ConnectionHashDefinition::GetLink(TCPEndpoint* endpoint) const
 //	#pragma mark -
 
 
+template<typename Entry> size_t
+AddressPairHashDefinition<Entry>::HashKey(const KeyType& key) const
+{
+	return ConstSocketAddress(fManager->AddressModule(),
+		key.first).HashPair(key.second);
+}
+
+
+template<typename Entry> size_t
+AddressPairHashDefinition<Entry>::Hash(Entry* entry) const
+{
+	return ConstSocketAddress(fManager->AddressModule(),
+		&entry->local.address).HashPair(&entry->peer.address);
+}
+
+
+template<typename Entry> bool
+AddressPairHashDefinition<Entry>::Compare(const KeyType& key,
+	Entry* entry) const
+{
+	net_address_module_info* module = fManager->AddressModule();
+	return module->equal_addresses_and_ports(&entry->local.address, key.first)
+		&& module->equal_addresses_and_ports(&entry->peer.address, key.second);
+}
+
+
+//	#pragma mark -
+
+
 size_t
 EndpointHashDefinition::HashKey(uint16 port) const
 {
@@ -218,14 +268,47 @@ EndpointManager::EndpointManager(net_domain* domain)
 	:
 	fDomain(domain),
 	fConnectionHash(this),
-	fLastPort(kFirstEphemeralPort)
+	fLastPort(kFirstEphemeralPort),
+	fTimeWaitHash(this),
+	fTimeWaitCount(0),
+	fTimeWaitTotal(0),
+	fTimeWaitRecycled(0),
+	fTimeWaitOverflows(0),
+	fSynCacheHash(this),
+	fSynCacheCount(0),
+	fSynCacheTotal(0),
+	fSynCacheCompleted(0),
+	fSynCacheExpired(0),
+	fSynCookiesSent(0),
+	fSynCookiesAccepted(0),
+	fLastSynCookieSent(0)
 {
 	rw_lock_init(&fLock, "TCP endpoint manager");
+	rw_lock_init(&fTimeWaitLock, "TCP endpoint manager time wait");
+	mutex_init(&fCacheLock, "TCP endpoint manager caches");
+
+	gStackModule->init_timer(&fTimeWaitTimer, &_TimeWaitTimer, this);
+	gStackModule->init_timer(&fSynCacheTimer, &_SynCacheTimer, this);
+
+	fSynCookieSecret[0] = secure_get_random<uint32>();
+	fSynCookieSecret[1] = secure_get_random<uint32>();
 }
 
 
 EndpointManager::~EndpointManager()
 {
+	gStackModule->cancel_timer(&fTimeWaitTimer);
+	gStackModule->cancel_timer(&fSynCacheTimer);
+	gStackModule->wait_for_timer(&fTimeWaitTimer);
+	gStackModule->wait_for_timer(&fSynCacheTimer);
+
+	while (TimeWaitEntry* entry = fTimeWaitList.Head())
+		_RemoveTimeWait(entry);
+	while (SynCacheEntry* entry = fSynCacheList.Head())
+		_RemoveSynCacheEntry(entry);
+
+	mutex_destroy(&fCacheLock);
+	rw_lock_destroy(&fTimeWaitLock);
 	rw_lock_destroy(&fLock);
 }
 
@@ -236,6 +319,12 @@ EndpointManager::Init()
 	status_t status = fConnectionHash.Init();
 	if (status == B_OK)
 		status = fEndpointHash.Init();
+	if (status == B_OK)
+		status = fTimeWaitHash.Init();
+	if (status == B_OK)
+		status = fTimeWaitPortHash.Init();
+	if (status == B_OK)
+		status = fSynCacheHash.Init();
 
 	return status;
 }
@@ -277,6 +366,12 @@ EndpointManager::SetConnection(TCPEndpoint* endpoint, const sockaddr* _local,
 	if (_LookupConnection(*local, peer) != NULL)
 		return EADDRINUSE;
 
+	{
+		ReadLocker timeWaitLocker(fTimeWaitLock);
+		if (fTimeWaitHash.Lookup(std::make_pair(*local, peer)) != NULL)
+			return EADDRINUSE;
+	}
+
 	endpoint->LocalAddress().SetTo(*local);
 	endpoint->PeerAddress().SetTo(peer);
 	T(Connect(endpoint));
@@ -319,8 +414,22 @@ EndpointManager::SetPassive(TCPEndpoint* endpoint)
 	SocketAddressStorage passive(AddressModule());
 	passive.SetToEmpty();
 
-	if (_LookupConnection(*endpoint->LocalAddress(), *passive))
-		return EADDRINUSE;
+	TCPEndpoint* listener = _LookupConnection(*endpoint->LocalAddress(),
+		*passive);
+	if (listener != NULL) {
+		if ((endpoint->socket->options & SO_REUSEPORT) == 0
+			|| (listener->socket->options & SO_REUSEPORT) == 0
+			|| endpoint->fOwner != listener->fOwner)
+			return EADDRINUSE;
+
+		// Join the group of listeners sharing this address; only the first
+		// one of them is in the connection hash, and incoming connections
+		// are distributed among all of them by _SelectListener().
+		endpoint->PeerAddress().SetTo(*passive);
+		endpoint->fReusePortNext = listener->fReusePortNext;
+		listener->fReusePortNext = endpoint;
+		return B_OK;
+	}
 
 	endpoint->PeerAddress().SetTo(*passive);
 	fConnectionHash.Insert(endpoint);
@@ -348,6 +457,7 @@ EndpointManager::FindConnection(sockaddr* local, sockaddr* peer)
 
 	endpoint = _LookupConnection(local, *wildcard);
 	if (endpoint != NULL) {
+		endpoint = _SelectListener(endpoint, local, peer);
 		TRACE(("TCP: Received packet corresponds to wildcard endpoint %p\n",
 			endpoint));
 		if (gSocketModule->acquire_socket(endpoint->socket))
@@ -360,6 +470,7 @@ EndpointManager::FindConnection(sockaddr* local, sockaddr* peer)
 
 	endpoint = _LookupConnection(*localWildcard, *wildcard);
 	if (endpoint != NULL) {
+		endpoint = _SelectListener(endpoint, local, peer);
 		TRACE(("TCP: Received packet corresponds to local wildcard endpoint "
 			"%p\n", endpoint));
 		if (gSocketModule->acquire_socket(endpoint->socket))
@@ -373,6 +484,68 @@ EndpointManager::FindConnection(sockaddr* local, sockaddr* peer)
 }
 
 
+/*!	Chooses the listener that should handle a new connection from \a peer to
+	\a local, in case several listeners share their address via
+	SO_REUSEPORT. \a listener is the one found in the connection hash.
+	All segments of a connection are given to the same listener, as long as
+	the group does not change.
+	You must have fLock at least read locked when calling this method.
+*/
+TCPEndpoint*
+EndpointManager::_SelectListener(TCPEndpoint* listener, const sockaddr* local,
+	const sockaddr* peer)
+{
+	if (listener->fReusePortNext == NULL)
+		return listener;
+
+	uint32 count = 0;
+	for (TCPEndpoint* member = listener; member != NULL;
+			member = member->fReusePortNext) {
+		count++;
+	}
+
+	uint32 index = reuse_port_index(
+		AddressModule()->hash_address_pair(local, peer), count);
+	while (index-- > 0)
+		listener = listener->fReusePortNext;
+
+	return listener;
+}
+
+
+/*!	Removes \a endpoint from the connection hash. If it is one of several
+	listeners sharing their address via SO_REUSEPORT, it is only removed from
+	its group; if it was the one in the hash, the next member replaces it
+	there.
+	You must have fLock write locked when calling this method.
+*/
+void
+EndpointManager::_RemoveConnection(TCPEndpoint* endpoint)
+{
+	TCPEndpoint* listener = _LookupConnection(*endpoint->LocalAddress(),
+		*endpoint->PeerAddress());
+	if (listener != NULL && listener != endpoint) {
+		for (TCPEndpoint* member = listener; member->fReusePortNext != NULL;
+				member = member->fReusePortNext) {
+			if (member->fReusePortNext == endpoint) {
+				member->fReusePortNext = endpoint->fReusePortNext;
+				break;
+			}
+		}
+
+		endpoint->fReusePortNext = NULL;
+		return;
+	}
+
+	fConnectionHash.Remove(endpoint);
+
+	if (endpoint->fReusePortNext != NULL) {
+		fConnectionHash.Insert(endpoint->fReusePortNext);
+		endpoint->fReusePortNext = NULL;
+	}
+}
+
+
 //	#pragma mark - endpoints
 
 
@@ -448,6 +621,14 @@ EndpointManager::_BindToAddress(WriteLocker& locker, TCPEndpoint* endpoint,
 					break;
 				}
 
+				if ((endpoint->socket->options & SO_REUSEPORT) != 0
+					&& (user->socket->options & SO_REUSEPORT) != 0
+					&& endpoint->fOwner == user->fOwner) {
+					// both agreed to share the address, and belong to the
+					// same user
+					continue;
+				}
+
 				if ((endpoint->socket->options & SO_REUSEADDR) == 0)
 					return EADDRINUSE;
 
@@ -457,6 +638,12 @@ EndpointManager::_BindToAddress(WriteLocker& locker, TCPEndpoint* endpoint,
 		}
 	} while (retry-- > 0);
 
+	// Connections in the TIME_WAIT table are no longer bound, but must
+	// still keep their port in use
+	if ((endpoint->socket->options & SO_REUSEADDR) == 0
+		&& _IsTimeWaitPort(port, *address))
+		return EADDRINUSE;
+
 	return _Bind(endpoint, *address);
 }
 
@@ -483,7 +670,8 @@ EndpointManager::_BindToEphemeral(TCPEndpoint* endpoint,
 			fLastPort = port;
 			port = htons(port);
 
-			if (!fEndpointHash.Lookup(port).HasNext()) {
+			if (!fEndpointHash.Lookup(port).HasNext()
+				&& !_IsTimeWaitPort(port, NULL)) {
 				// found a port
 				SocketAddressStorage newAddress(AddressModule());
 				newAddress.SetTo(address);
@@ -537,7 +725,12 @@ EndpointManager::Unbind(TCPEndpoint* endpoint)
 	if (!fEndpointHash.Remove(endpoint))
 		panic("bound endpoint %p not in hash!", endpoint);
 
-	fConnectionHash.Remove(endpoint);
+	_RemoveConnection(endpoint);
+
+	// A listener may leave half-open connections behind that no one could
+	// accept anymore
+	if (endpoint->PeerAddress().IsEmpty(false))
+		_PurgeSynCache(*endpoint->LocalAddress());
 
 	(*endpoint->LocalAddress())->sa_len = 0;
 
@@ -583,6 +776,608 @@ EndpointManager::ReplyWithReset(tcp_segment_header& segment, net_buffer* buffer)
 }
 
 
+//	#pragma mark - TIME_WAIT table
+
+
+/*!	Adds a connection in TIME_WAIT state to the TIME_WAIT table. If this
+	succeeds, the endpoint the \a state has been taken from may be deleted
+	right away; the table answers retransmitted FINs, and keeps the
+	connection's address pair in use for the remaining 2 MSL.
+*/
+status_t
+EndpointManager::AddTimeWait(const TimeWaitEntry& state)
+{
+	WriteLocker locker(fTimeWaitLock);
+
+	if (fTimeWaitCount >= kMaxTimeWaitEntries) {
+		fTimeWaitOverflows++;
+		return B_NO_MEMORY;
+	}
+
+	if (fTimeWaitHash.Lookup(std::make_pair(&state.local.address,
+			&state.peer.address)) != NULL)
+		return B_NAME_IN_USE;
+
+	TimeWaitEntry* entry = new(std::nothrow) TimeWaitEntry(state);
+	if (entry == NULL)
+		return B_NO_MEMORY;
+
+	entry->expires = system_time() + kTimeWaitTimeout;
+
+	fTimeWaitHash.Insert(entry);
+	fTimeWaitPortHash.Insert(entry);
+	fTimeWaitList.Add(entry);
+	fTimeWaitCount++;
+	fTimeWaitTotal++;
+
+	if (!gStackModule->is_timer_active(&fTimeWaitTimer))
+		_ScheduleTimeWaitTimer();
+
+	return B_OK;
+}
+
+
+/*!	Handles a segment that belongs to a connection in the TIME_WAIT table.
+	Returns \c false if there is no such connection, and the segment should
+	be processed normally.
+	The table is only read locked, unless the segment changes the entry.
+*/
+bool
+EndpointManager::TimeWaitReceived(tcp_segment_header& segment,
+	net_buffer* buffer, int32& _segmentAction)
+{
+	if (atomic_get(&fTimeWaitCount) == 0)
+		return false;
+
+	ReadLocker readLocker(fTimeWaitLock);
+
+	TimeWaitEntry* entry = fTimeWaitHash.Lookup(
+		std::make_pair(buffer->destination, buffer->source));
+	if (entry == NULL)
+		return false;
+
+	_segmentAction = DROP;
+
+	// We generally ignore resets in time wait state (see RFC 1337)
+	if ((segment.flags & TCP_FLAG_RESET) != 0)
+		return true;
+
+	// The peer may open a new incarnation of this connection that cannot
+	// be confused with the old one (RFC 1122, 4.2.2.13)
+	bool recycle = (segment.flags
+			& (TCP_FLAG_SYNCHRONIZE | TCP_FLAG_ACKNOWLEDGE))
+				== TCP_FLAG_SYNCHRONIZE
+		&& tcp_sequence(segment.sequence)
+			> tcp_sequence(entry->receive_next);
+
+	TimeWaitEntry reply;
+	if (recycle || (segment.flags & TCP_FLAG_FINISH) != 0) {
+		readLocker.Unlock();
+		WriteLocker writeLocker(fTimeWaitLock);
+
+		// the entry may have expired in the mean time
+		entry = fTimeWaitHash.Lookup(
+			std::make_pair(buffer->destination, buffer->source));
+		if (entry == NULL)
+			return false;
+
+		if (recycle) {
+			fTimeWaitRecycled++;
+			_RemoveTimeWait(entry);
+			return false;
+		}
+
+		// The peer did not get our acknowledge, restart the 2MSL timer
+		entry->expires = system_time() + kTimeWaitTimeout;
+		fTimeWaitList.Remove(entry);
+		fTimeWaitList.Add(entry);
+
+		reply = *entry;
+	} else {
+		if (buffer->size == 0
+			&& (segment.flags & TCP_FLAG_SYNCHRONIZE) == 0)
+			return true;
+
+		reply = *entry;
+		readLocker.Unlock();
+	}
+
+	_SendTimeWaitAcknowledge(&reply);
+	return true;
+}
+
+
+/*!	Returns whether or not a connection in the TIME_WAIT table is still
+	using the local \a port. If \a address is not \c NULL, only connections
+	using that address (or any address, if it is empty) are considered.
+	You must hold fLock when calling this method.
+*/
+bool
+EndpointManager::_IsTimeWaitPort(uint16 port, const sockaddr* address)
+{
+	ReadLocker locker(fTimeWaitLock);
+
+	TimeWaitPortTable::ValueIterator iterator = fTimeWaitPortHash.Lookup(port);
+	if (address == NULL || AddressModule()->is_empty_address(address, false))
+		return iterator.HasNext();
+
+	while (iterator.HasNext()) {
+		TimeWaitEntry* entry = iterator.Next();
+		if (AddressModule()->equal_addresses(&entry->local.address, address))
+			return true;
+	}
+
+	return false;
+}
+
+
+/*! You must have fTimeWaitLock write locked when calling this method. */
+void
+EndpointManager::_RemoveTimeWait(TimeWaitEntry* entry)
+{
+	fTimeWaitHash.Remove(entry);
+	fTimeWaitPortHash.Remove(entry);
+	fTimeWaitList.Remove(entry);
+	fTimeWaitCount--;
+
+	delete entry;
+}
+
+
+status_t
+EndpointManager::_SendTimeWaitAcknowledge(const TimeWaitEntry* entry)
+{
+	net_buffer* reply = gBufferModule->create(256);
+	if (reply == NULL)
+		return B_NO_MEMORY;
+
+	AddressModule()->set_to(reply->source, &entry->local.address);
+	AddressModule()->set_to(reply->destination, &entry->peer.address);
+
+	tcp_segment_header segment(TCP_FLAG_ACKNOWLEDGE);
+	segment.sequence = entry->send_next;
+	segment.acknowledge = entry->receive_next;
+	segment.advertised_window = entry->advertised_window;
+	segment.urgent_offset = 0;
+
+	if (entry->has_timestamps) {
+		segment.options |= TCP_HAS_TIMESTAMPS;
+		segment.timestamp_value = tcp_now();
+		segment.timestamp_reply = entry->received_timestamp;
+	}
+
+	status_t status = add_tcp_header(AddressModule(), segment, reply);
+	if (status == B_OK)
+		status = Domain()->module->send_data(NULL, reply);
+
+	if (status != B_OK)
+		gBufferModule->free(reply);
+
+	return status;
+}
+
+
+/*! You must have fTimeWaitLock write locked when calling this method. */
+void
+EndpointManager::_ScheduleTimeWaitTimer()
+{
+	TimeWaitEntry* entry = fTimeWaitList.Head();
+	if (entry == NULL)
+		return;
+
+	bigtime_t delay = entry->expires - system_time();
+	gStackModule->set_timer(&fTimeWaitTimer, max_c(delay, 0));
+}
+
+
+/*static*/ void
+EndpointManager::_TimeWaitTimer(net_timer* timer, void* _manager)
+{
+	EndpointManager* manager = (EndpointManager*)_manager;
+
+	WriteLocker locker(manager->fTimeWaitLock);
+
+	// the list is ordered by expiration time
+	bigtime_t now = system_time();
+	while (TimeWaitEntry* entry = manager->fTimeWaitList.Head()) {
+		if (entry->expires > now)
+			break;
+
+		manager->_RemoveTimeWait(entry);
+	}
+
+	manager->_ScheduleTimeWaitTimer();
+}
+
+
+//	#pragma mark - SYN cache
+
+
+/*!	Remembers the SYN \a segment received by a listening endpoint, and
+	answers it with a SYN-ACK. If the cache is full, a SYN cookie is sent
+	instead.
+*/
+status_t
+EndpointManager::AddSynCacheEntry(tcp_segment_header& segment,
+	net_buffer* buffer, uint16 maxSegmentSize, uint32 receiveWindow,
+	uint8 receiveWindowShift, bool useOptions)
+{
+	const sockaddr* local = buffer->destination;
+	const sockaddr* peer = buffer->source;
+	if (local->sa_len > sizeof(tcp_address)
+		|| peer->sa_len > sizeof(tcp_address))
+		return B_BAD_VALUE;
+
+	MutexLocker locker(fCacheLock);
+
+	SynCacheEntry* entry = fSynCacheHash.Lookup(std::make_pair(local, peer));
+	if (entry == NULL) {
+		if (fSynCacheCount < kMaxSynCacheEntries)
+			entry = new(std::nothrow) SynCacheEntry;
+		if (entry == NULL) {
+			// We are probably being flooded with SYNs - answer with a SYN
+			// cookie, as that doesn't need any state on our side
+			fSynCookiesSent++;
+			atomic_set64(&fLastSynCookieSent, system_time());
+			locker.Unlock();
+
+			return _SendSynCookie(segment, buffer, maxSegmentSize,
+				receiveWindow);
+		}
+
+		memcpy(&entry->local, local, local->sa_len);
+		memcpy(&entry->peer, peer, peer->sa_len);
+		entry->initial_send_sequence = system_time() >> 4;
+
+		fSynCacheHash.Insert(entry);
+		fSynCacheList.Add(entry);
+		fSynCacheCount++;
+		fSynCacheTotal++;
+
+		if (!gStackModule->is_timer_active(&fSynCacheTimer))
+			gStackModule->set_timer(&fSynCacheTimer, kSynCacheInterval);
+	}
+
+	// (re-)initialize the entry from the most recent SYN
+	entry->next_retransmit = system_time() + TCP_SYN_RETRANSMIT_TIMEOUT;
+	entry->retransmits = 0;
+	entry->initial_receive_sequence = segment.sequence;
+	entry->received_timestamp = segment.timestamp_value;
+	entry->advertised_window = receiveWindow;
+	entry->max_segment_size = maxSegmentSize;
+	entry->peer_max_segment_size = segment.max_segment_size;
+	entry->peer_advertised_window = segment.advertised_window;
+	entry->send_window_shift = segment.window_shift;
+	entry->options = useOptions ? segment.options
+		& (TCP_HAS_WINDOW_SCALE | TCP_HAS_TIMESTAMPS | TCP_SACK_PERMITTED)
+		: 0;
+	entry->receive_window_shift = (entry->options & TCP_HAS_WINDOW_SCALE) != 0
+		? receiveWindowShift : 0;
+
+	SynCacheEntry reply(*entry);
+	locker.Unlock();
+
+	return _SendSynAcknowledge(&reply);
+}
+
+
+/*!	Looks up the handshake the acknowledge \a segment completes, either in
+	the SYN cache, or by validating it as a reply to a SYN cookie. The entry
+	stays in the cache until RemoveSynCacheEntry() is called.
+*/
+status_t
+EndpointManager::LookupSynCacheEntry(const sockaddr* local,
+	const sockaddr* peer, tcp_segment_header& segment, SynCacheEntry& entry)
+{
+	MutexLocker locker(fCacheLock);
+
+	SynCacheEntry* cached = fSynCacheHash.Lookup(std::make_pair(local, peer));
+	if (cached != NULL) {
+		if (segment.acknowledge != cached->initial_send_sequence + 1)
+			return B_BAD_VALUE;
+
+		entry = *cached;
+		return B_OK;
+	}
+
+	locker.Unlock();
+
+	if (_CheckSynCookie(local, peer, segment, entry))
+		return B_OK;
+
+	return B_ENTRY_NOT_FOUND;
+}
+
+
+void
+EndpointManager::RemoveSynCacheEntry(const sockaddr* local,
+	const sockaddr* peer)
+{
+	MutexLocker locker(fCacheLock);
+
+	SynCacheEntry* entry = fSynCacheHash.Lookup(std::make_pair(local, peer));
+	if (entry == NULL)
+		return;
+
+	fSynCacheCompleted++;
+	_RemoveSynCacheEntry(entry);
+}
+
+
+/*!	Removes the entry the reset \a segment refers to, if any. */
+void
+EndpointManager::ResetSynCacheEntry(const sockaddr* local,
+	const sockaddr* peer, tcp_segment_header& segment)
+{
+	MutexLocker locker(fCacheLock);
+
+	SynCacheEntry* entry = fSynCacheHash.Lookup(std::make_pair(local, peer));
+	if (entry != NULL && segment.sequence == entry->initial_receive_sequence + 1)
+		_RemoveSynCacheEntry(entry);
+}
+
+
+/*! You must hold fCacheLock when calling this method. */
+void
+EndpointManager::_RemoveSynCacheEntry(SynCacheEntry* entry)
+{
+	fSynCacheHash.Remove(entry);
+	fSynCacheList.Remove(entry);
+	fSynCacheCount--;
+
+	delete entry;
+}
+
+
+/*!	Removes all entries for the \a local address of a listener that has
+	just been unbound, unless another listener is able to accept them.
+	You must have fLock write locked when calling this method.
+*/
+void
+EndpointManager::_PurgeSynCache(const sockaddr* local)
+{
+	if (atomic_get(&fSynCacheCount) == 0)
+		return;
+
+	SocketAddressStorage wildcard(AddressModule());
+	wildcard.SetToEmpty();
+
+	SocketAddressStorage localWildcard(AddressModule());
+	localWildcard.SetToEmpty();
+	localWildcard.SetPort(AddressModule()->get_port(local));
+
+	if (_LookupConnection(*localWildcard, *wildcard) != NULL)
+		return;
+
+	bool anyAddress = AddressModule()->is_empty_address(local, false);
+
+	MutexLocker locker(fCacheLock);
+
+	SynCacheEntry* entry = fSynCacheList.Head();
+	while (entry != NULL) {
+		SynCacheEntry* next = fSynCacheList.GetNext(entry);
+		const sockaddr* entryLocal = &entry->local.address;
+
+		if (AddressModule()->get_port(entryLocal) == localWildcard.Port()
+			&& (anyAddress
+				|| AddressModule()->equal_addresses(entryLocal, local))
+			&& _LookupConnection(entryLocal, *wildcard) == NULL)
+			_RemoveSynCacheEntry(entry);
+
+		entry = next;
+	}
+}
+
+
+status_t
+EndpointManager::_SendSynAcknowledge(const SynCacheEntry* entry)
+{
+	net_buffer* reply = gBufferModule->create(256);
+	if (reply == NULL)
+		return B_NO_MEMORY;
+
+	AddressModule()->set_to(reply->source, &entry->local.address);
+	AddressModule()->set_to(reply->destination, &entry->peer.address);
+
+	tcp_segment_header segment(TCP_FLAG_SYNCHRONIZE | TCP_FLAG_ACKNOWLEDGE);
+	segment.sequence = entry->initial_send_sequence;
+	segment.acknowledge = entry->initial_receive_sequence + 1;
+	segment.urgent_offset = 0;
+	segment.max_segment_size = entry->max_segment_size;
+	segment.SetAdvertisedWindow(entry->advertised_window,
+		entry->receive_window_shift);
+
+	if ((entry->options & TCP_HAS_WINDOW_SCALE) != 0) {
+		segment.options |= TCP_HAS_WINDOW_SCALE;
+		segment.window_shift = entry->receive_window_shift;
+	}
+	if ((entry->options & TCP_SACK_PERMITTED) != 0)
+		segment.options |= TCP_SACK_PERMITTED;
+	if ((entry->options & TCP_HAS_TIMESTAMPS) != 0) {
+		segment.options |= TCP_HAS_TIMESTAMPS;
+		segment.timestamp_value = tcp_now();
+		segment.timestamp_reply = entry->received_timestamp;
+	}
+
+	status_t status = add_tcp_header(AddressModule(), segment, reply);
+	if (status == B_OK)
+		status = Domain()->module->send_data(NULL, reply);
+
+	if (status != B_OK)
+		gBufferModule->free(reply);
+
+	return status;
+}
+
+
+/*!	Answers a SYN without remembering it. All information needed to create
+	the connection later is encoded in our initial sequence number; options
+	other than the maximum segment size cannot be used for it, though.
+*/
+status_t
+EndpointManager::_SendSynCookie(tcp_segment_header& segment,
+	net_buffer* buffer, uint16 maxSegmentSize, uint32 receiveWindow)
+{
+	uint16 peerMaxSegmentSize = segment.max_segment_size != 0
+		? segment.max_segment_size : TCP_DEFAULT_MAX_SEGMENT_SIZE;
+
+	uint32 index = 0;
+	for (uint32 i = B_COUNT_OF(kSynCookieMaxSegmentSizes); i-- > 0;) {
+		if (kSynCookieMaxSegmentSizes[i] <= peerMaxSegmentSize) {
+			index = i;
+			break;
+		}
+	}
+
+	uint32 period = (system_time() / kSynCookiePeriod) & kSynCookiePeriodMask;
+
+	SynCacheEntry entry;
+	memcpy(&entry.local, buffer->destination, buffer->destination->sa_len);
+	memcpy(&entry.peer, buffer->source, buffer->source->sa_len);
+	entry.initial_receive_sequence = segment.sequence;
+	entry.initial_send_sequence = _SynCookie(buffer->destination,
+		buffer->source, segment.sequence, period, index);
+	entry.advertised_window = receiveWindow;
+	entry.max_segment_size = maxSegmentSize;
+	entry.receive_window_shift = 0;
+	entry.options = 0;
+
+	return _SendSynAcknowledge(&entry);
+}
+
+
+static inline uint32
+syn_cookie_rotate(uint32 value, uint32 bits)
+{
+	return (value << bits) | (value >> (32 - bits));
+}
+
+
+uint32
+EndpointManager::_SynCookie(const sockaddr* local, const sockaddr* peer,
+	uint32 sequence, uint32 period, uint32 maxSegmentSizeIndex)
+{
+	// Bob Jenkins' final mix of the address pair, the peer's initial
+	// sequence, and the time period, keyed with our secret
+	uint32 a = AddressModule()->hash_address_pair(local, peer)
+		^ fSynCookieSecret[0];
+	uint32 b = sequence + fSynCookieSecret[1];
+	uint32 c = period;
+
+	c ^= b; c -= syn_cookie_rotate(b, 14);
+	a ^= c; a -= syn_cookie_rotate(c, 11);
+	b ^= a; b -= syn_cookie_rotate(a, 25);
+	c ^= b; c -= syn_cookie_rotate(b, 16);
+	a ^= c; a -= syn_cookie_rotate(c, 4);
+	b ^= a; b -= syn_cookie_rotate(a, 14);
+	c ^= b; c -= syn_cookie_rotate(b, 24);
+
+	return (period << kSynCookiePeriodShift)
+		| (maxSegmentSizeIndex << kSynCookieMaxSegmentSizeShift)
+		| (c & kSynCookieHashMask);
+}
+
+
+bool
+EndpointManager::_CheckSynCookie(const sockaddr* local, const sockaddr* peer,
+	tcp_segment_header& segment, SynCacheEntry& entry)
+{
+	// Only accept cookies if we actually sent some recently
+	bigtime_t now = system_time();
+	bigtime_t lastSent = atomic_get64(&fLastSynCookieSent);
+	if (lastSent == 0 || now - lastSent > 2 * kSynCookiePeriod)
+		return false;
+
+	if (local->sa_len > sizeof(tcp_address)
+		|| peer->sa_len > sizeof(tcp_address))
+		return false;
+
+	uint32 cookie = segment.acknowledge - 1;
+	uint32 sequence = segment.sequence - 1;
+	uint32 period = (cookie >> kSynCookiePeriodShift) & kSynCookiePeriodMask;
+	uint32 currentPeriod = (now / kSynCookiePeriod) & kSynCookiePeriodMask;
+	if (((currentPeriod - period) & kSynCookiePeriodMask) > 1)
+		return false;
+
+	uint32 index = (cookie >> kSynCookieMaxSegmentSizeShift)
+		& kSynCookieMaxSegmentSizeMask;
+	if (_SynCookie(local, peer, sequence, period, index) != cookie)
+		return false;
+
+	memcpy(&entry.local, local, local->sa_len);
+	memcpy(&entry.peer, peer, peer->sa_len);
+	entry.initial_receive_sequence = sequence;
+	entry.initial_send_sequence = cookie;
+	entry.received_timestamp = 0;
+	entry.advertised_window = 0;
+	entry.max_segment_size = 0;
+	entry.peer_max_segment_size = kSynCookieMaxSegmentSizes[index];
+	entry.peer_advertised_window = segment.advertised_window;
+	entry.send_window_shift = 0;
+	entry.receive_window_shift = 0;
+	entry.options = 0;
+	entry.retransmits = 0;
+
+	atomic_add((int32*)&fSynCookiesAccepted, 1);
+	return true;
+}
+
+
+/*static*/ void
+EndpointManager::_SynCacheTimer(net_timer* timer, void* _manager)
+{
+	EndpointManager* manager = (EndpointManager*)_manager;
+
+	// The SYN-ACKs are sent without holding the cache lock, as the receive
+	// path needs it; they are collected in batches for this.
+	SynCacheEntry retransmits[kSynRetransmitBatchSize];
+	bool more;
+
+	do {
+		MutexLocker locker(manager->fCacheLock);
+
+		bigtime_t now = system_time();
+		int32 count = 0;
+		more = false;
+
+		SynCacheEntry* entry = manager->fSynCacheList.Head();
+		while (entry != NULL) {
+			SynCacheEntry* next = manager->fSynCacheList.GetNext(entry);
+
+			if (entry->next_retransmit <= now) {
+				if (entry->retransmits >= kMaxSynRetransmits) {
+					manager->fSynCacheExpired++;
+					manager->_RemoveSynCacheEntry(entry);
+				} else if (count == kSynRetransmitBatchSize) {
+					more = true;
+					break;
+				} else {
+					entry->retransmits++;
+					entry->next_retransmit = now
+						+ (TCP_SYN_RETRANSMIT_TIMEOUT << entry->retransmits);
+					retransmits[count++] = *entry;
+				}
+			}
+
+			entry = next;
+		}
+
+		if (!more && manager->fSynCacheCount > 0) {
+			gStackModule->set_timer(&manager->fSynCacheTimer,
+				kSynCacheInterval);
+		}
+
+		locker.Unlock();
+
+		for (int32 i = 0; i < count; i++)
+			manager->_SendSynAcknowledge(&retransmits[i]);
+	} while (more);
+}
+
+
+//	#pragma mark -
+
+
 void
 EndpointManager::Dump() const
 {
@@ -593,15 +1388,35 @@ EndpointManager::Dump() const
 	ConnectionTable::Iterator iterator = fConnectionHash.GetIterator();
 
 	while (iterator.HasNext()) {
-		TCPEndpoint *endpoint = iterator.Next();
-
-		char localBuf[64], peerBuf[64];
-		endpoint->LocalAddress().AsString(localBuf, sizeof(localBuf), true);
-		endpoint->PeerAddress().AsString(peerBuf, sizeof(peerBuf), true);
-
-		kprintf("%p %21s %21s %8lu %8lu %12s\n", endpoint, localBuf, peerBuf,
-			endpoint->fReceiveQueue.Available(), endpoint->fSendQueue.Used(),
-			name_for_state(endpoint->State()));
+		// also list the other listeners sharing an address via SO_REUSEPORT
+		for (TCPEndpoint *endpoint = iterator.Next(); endpoint != NULL;
+				endpoint = endpoint->fReusePortNext) {
+			char localBuf[64], peerBuf[64];
+			endpoint->LocalAddress().AsString(localBuf, sizeof(localBuf),
+				true);
+			endpoint->PeerAddress().AsString(peerBuf, sizeof(peerBuf), true);
+
+			kprintf("%p %21s %21s %8lu %8lu %12s\n", endpoint, localBuf,
+				peerBuf, endpoint->fReceiveQueue.Available(),
+				endpoint->fSendQueue.Used(),
+				name_for_state(endpoint->State()));
+		}
 	}
+
+	// Every entry in the TIME_WAIT table or SYN cache would otherwise have
+	// kept a TCPEndpoint and its socket alive
+	size_t endpointSize = sizeof(TCPEndpoint) + sizeof(net_socket);
+
+	kprintf("time-wait table: %" B_PRId32 " entries (%" B_PRIu32 " total, %"
+		B_PRIu32 " recycled, %" B_PRIu32 " overflows), saving %" B_PRIuSIZE
+		" KB\n", fTimeWaitCount, fTimeWaitTotal, fTimeWaitRecycled,
+		fTimeWaitOverflows, fTimeWaitCount
+			* (endpointSize - sizeof(TimeWaitEntry)) / 1024);
+	kprintf("SYN cache: %" B_PRId32 " entries (%" B_PRIu32 " total, %" B_PRIu32
+		" completed, %" B_PRIu32 " expired), saving %" B_PRIuSIZE " KB\n",
+		fSynCacheCount, fSynCacheTotal, fSynCacheCompleted, fSynCacheExpired,
+		fSynCacheCount * (endpointSize - sizeof(SynCacheEntry)) / 1024);
+	kprintf("SYN cookies: %" B_PRIu32 " sent, %" B_PRIu32 " accepted\n",
+		fSynCookiesSent, fSynCookiesAccepted);
 }
 
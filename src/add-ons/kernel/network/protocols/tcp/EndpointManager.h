@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2009, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -20,6 +20,9 @@
 #include <util/MultiHashTable.h>
 #include <util/OpenHashTable.h>
 
+#include <netinet/in.h>
+#include <netinet6/in6.h>
+
 #include <utility>
 
 
@@ -29,6 +32,103 @@ class EndpointManager;
 class TCPEndpoint;
 
 
+/*!	Large enough to hold any address the TCP domains use, but much smaller
+	than a sockaddr_storage.
+*/
+union tcp_address {
+	sockaddr		address;
+	sockaddr_in		inet;
+	sockaddr_in6	inet6;
+};
+
+
+/*!	Compact replacement for a TCPEndpoint in TIME_WAIT state whose socket has
+	already been closed. It only keeps what is needed to acknowledge a
+	retransmitted FIN, and to protect the connection's 4-tuple for 2 MSL.
+*/
+struct TimeWaitEntry : DoublyLinkedListLinkImpl<TimeWaitEntry> {
+	TimeWaitEntry*	hash_link;
+	TimeWaitEntry*	port_link;
+	bigtime_t		expires;
+	tcp_address		local;
+	tcp_address		peer;
+	uint32			send_next;
+	uint32			receive_next;
+	uint32			received_timestamp;
+	uint16			advertised_window;
+	bool			has_timestamps;
+};
+
+
+/*!	A half-open connection received by a listening endpoint. Only once the
+	peer acknowledges our SYN-ACK, a real TCPEndpoint is created from it.
+*/
+struct SynCacheEntry : DoublyLinkedListLinkImpl<SynCacheEntry> {
+	SynCacheEntry*	hash_link;
+	bigtime_t		next_retransmit;
+	tcp_address		local;
+	tcp_address		peer;
+	uint32			initial_receive_sequence;
+	uint32			initial_send_sequence;
+	uint32			received_timestamp;
+	uint32			advertised_window;
+	uint16			max_segment_size;
+	uint16			peer_max_segment_size;
+	uint16			peer_advertised_window;
+	uint8			send_window_shift;
+	uint8			receive_window_shift;
+	uint8			options;
+	uint8			retransmits;
+};
+
+
+template<typename Entry>
+struct AddressPairHashDefinition {
+public:
+	typedef std::pair<const sockaddr*, const sockaddr*> KeyType;
+	typedef Entry ValueType;
+
+							AddressPairHashDefinition(EndpointManager* manager)
+								: fManager(manager)
+							{
+							}
+							AddressPairHashDefinition(
+									const AddressPairHashDefinition& definition)
+								: fManager(definition.fManager)
+							{
+							}
+
+			size_t			HashKey(const KeyType& key) const;
+			size_t			Hash(Entry* entry) const;
+			bool			Compare(const KeyType& key, Entry* entry) const;
+			Entry*&			GetLink(Entry* entry) const
+								{ return entry->hash_link; }
+
+private:
+	EndpointManager*		fManager;
+};
+
+
+class TimeWaitPortHashDefinition {
+public:
+	typedef uint16 KeyType;
+	typedef TimeWaitEntry ValueType;
+
+			size_t			HashKey(uint16 port) const
+								{ return port; }
+			size_t			Hash(TimeWaitEntry* entry) const
+								{ return entry->local.inet.sin_port; }
+			bool			Compare(uint16 port, TimeWaitEntry* entry) const
+								{ return entry->local.inet.sin_port == port; }
+			bool			CompareValues(TimeWaitEntry* first,
+								TimeWaitEntry* second) const
+								{ return first->local.inet.sin_port
+									== second->local.inet.sin_port; }
+			TimeWaitEntry*&	GetLink(TimeWaitEntry* entry) const
+								{ return entry->port_link; }
+};
+
+
 struct ConnectionHashDefinition {
 public:
 	typedef std::pair<const sockaddr*, const sockaddr*> KeyType;
@@ -89,6 +189,26 @@ public:
 			status_t		ReplyWithReset(tcp_segment_header& segment,
 								net_buffer* buffer);
 
+			// TIME_WAIT table
+			status_t		AddTimeWait(const TimeWaitEntry& state);
+			bool			TimeWaitReceived(tcp_segment_header& segment,
+								net_buffer* buffer, int32& _segmentAction);
+
+			// SYN cache
+			status_t		AddSynCacheEntry(tcp_segment_header& segment,
+								net_buffer* buffer, uint16 maxSegmentSize,
+								uint32 receiveWindow, uint8 receiveWindowShift,
+								bool useOptions);
+			status_t		LookupSynCacheEntry(const sockaddr* local,
+								const sockaddr* peer,
+								tcp_segment_header& segment,
+								SynCacheEntry& entry);
+			void			RemoveSynCacheEntry(const sockaddr* local,
+								const sockaddr* peer);
+			void			ResetSynCacheEntry(const sockaddr* local,
+								const sockaddr* peer,
+								tcp_segment_header& segment);
+
 			net_domain*		Domain() const { return fDomain; }
 			net_address_module_info* AddressModule() const
 								{ return Domain()->address_module; }
@@ -98,6 +218,9 @@ public:
 private:
 			TCPEndpoint*	_LookupConnection(const sockaddr* local,
 								const sockaddr* peer);
+			TCPEndpoint*	_SelectListener(TCPEndpoint* listener,
+								const sockaddr* local, const sockaddr* peer);
+			void			_RemoveConnection(TCPEndpoint* endpoint);
 			status_t		_Bind(TCPEndpoint* endpoint,
 								const sockaddr* address);
 			status_t		_BindToAddress(WriteLocker& locker,
@@ -105,14 +228,74 @@ private:
 			status_t		_BindToEphemeral(TCPEndpoint* endpoint,
 								const sockaddr* address);
 
+			bool			_IsTimeWaitPort(uint16 port,
+								const sockaddr* address);
+			void			_RemoveTimeWait(TimeWaitEntry* entry);
+			status_t		_SendTimeWaitAcknowledge(
+								const TimeWaitEntry* entry);
+			void			_ScheduleTimeWaitTimer();
+
+			void			_RemoveSynCacheEntry(SynCacheEntry* entry);
+			void			_PurgeSynCache(const sockaddr* local);
+			status_t		_SendSynAcknowledge(const SynCacheEntry* entry);
+			status_t		_SendSynCookie(tcp_segment_header& segment,
+								net_buffer* buffer, uint16 maxSegmentSize,
+								uint32 receiveWindow);
+			uint32			_SynCookie(const sockaddr* local,
+								const sockaddr* peer, uint32 sequence,
+								uint32 period, uint32 maxSegmentSizeIndex);
+			bool			_CheckSynCookie(const sockaddr* local,
+								const sockaddr* peer,
+								tcp_segment_header& segment,
+								SynCacheEntry& entry);
+
+	static	void			_TimeWaitTimer(net_timer* timer, void* _manager);
+	static	void			_SynCacheTimer(net_timer* timer, void* _manager);
+
 	typedef BOpenHashTable<ConnectionHashDefinition> ConnectionTable;
 	typedef MultiHashTable<EndpointHashDefinition> EndpointTable;
+	typedef BOpenHashTable<AddressPairHashDefinition<TimeWaitEntry> >
+		TimeWaitTable;
+	typedef MultiHashTable<TimeWaitPortHashDefinition> TimeWaitPortTable;
+	typedef DoublyLinkedList<TimeWaitEntry> TimeWaitList;
+	typedef BOpenHashTable<AddressPairHashDefinition<SynCacheEntry> >
+		SynCacheTable;
+	typedef DoublyLinkedList<SynCacheEntry> SynCacheList;
 
 	rw_lock					fLock;
 	net_domain*				fDomain;
 	ConnectionTable			fConnectionHash;
 	EndpointTable			fEndpointHash;
 	uint16					fLastPort;
+
+	// The TIME_WAIT table and the SYN cache have locks of their own, so
+	// that their timers never need to acquire fLock. If both are needed,
+	// fLock has to be acquired first. The TIME_WAIT table is looked up for
+	// every received segment, and thus only read locked for that.
+	rw_lock					fTimeWaitLock;
+	mutex					fCacheLock;
+
+	TimeWaitTable			fTimeWaitHash;
+	TimeWaitPortTable		fTimeWaitPortHash;
+	TimeWaitList			fTimeWaitList;
+		// ordered by expiration time
+	net_timer				fTimeWaitTimer;
+	int32					fTimeWaitCount;
+	uint32					fTimeWaitTotal;
+	uint32					fTimeWaitRecycled;
+	uint32					fTimeWaitOverflows;
+
+	SynCacheTable			fSynCacheHash;
+	SynCacheList			fSynCacheList;
+	net_timer				fSynCacheTimer;
+	int32					fSynCacheCount;
+	uint32					fSynCacheTotal;
+	uint32					fSynCacheCompleted;
+	uint32					fSynCacheExpired;
+	uint32					fSynCookiesSent;
+	uint32					fSynCookiesAccepted;
+	bigtime_t				fLastSynCookieSent;
+	uint32					fSynCookieSecret[2];
 };
 
 #endif	// ENDPOINT_MANAGER_H
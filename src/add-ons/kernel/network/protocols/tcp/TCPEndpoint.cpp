@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2010, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <unistd.h>
 
 #include <KernelExport.h>
 #include <Select.h>
@@ -52,9 +53,7 @@
 //
 // Things this implementation currently doesn't implement:
 //	- Explicit Congestion Notification (ECN), RFC 3168
-//	- SYN-Cache
 //	- Forward RTO-Recovery, RFC 4138
-//	- Time-Wait hash instead of keeping sockets alive
 
 #define PrintAddress(address) \
 	AddressString(Domain(), address, true).Data()
@@ -323,14 +322,11 @@ enum {
 	FLAG_RECOVERY				= 0x40,
 	FLAG_OPTION_SACK_PERMITTED	= 0x80,
 	FLAG_AUTO_RECEIVE_BUFFER_SIZE = 0x100,
-	FLAG_CAN_NOTIFY 			= 0x200
+	FLAG_CAN_NOTIFY 			= 0x200,
+	FLAG_TIME_WAIT_TABLE		= 0x400
 };
 
 
-static const int kTimestampFactor = 1000;
-	// conversion factor between usec system time and msec tcp time
-
-
 static inline bigtime_t
 absolute_timeout(bigtime_t timeout)
 {
@@ -391,13 +387,6 @@ is_establishing(tcp_state state)
 }
 
 
-static inline uint32
-tcp_now()
-{
-	return system_time() / kTimestampFactor;
-}
-
-
 static inline uint32
 tcp_diff_timestamp(uint32 base)
 {
@@ -417,12 +406,32 @@ state_needs_finish(int32 state)
 }
 
 
+/*!	Computes the window shift we advertise to our peer for a receive buffer
+	of the given size.
+*/
+static inline uint8
+receive_window_shift(size_t bufferSize, bool local)
+{
+	uint8 shift = 0;
+	while (shift < TCP_MAX_WINDOW_SHIFT && (0xffffUL << shift) < bufferSize)
+		shift++;
+
+	// Increase to a default of 8 (window minimum 256 bytes, maximum 15 MB.)
+	if (shift < 8 && !local)
+		shift = 8;
+
+	return shift;
+}
+
+
 //	#pragma mark -
 
 
 TCPEndpoint::TCPEndpoint(net_socket* socket)
 	:
 	ProtocolSocket(socket),
+	fReusePortNext(NULL),
+	fOwner(geteuid()),
 	fManager(NULL),
 	fOptions(0),
 	fSendWindowShift(0),
@@ -595,11 +604,16 @@ TCPEndpoint::Free()
 
 	fFlags |= FLAG_CLOSED;
 	if ((fFlags & FLAG_DELETE_ON_CLOSE) == 0) {
+		if (fState == TIME_WAIT && _MoveToTimeWaitTable())
+			return;
+
 		// we'll be freed later when the 2MSL timer expires
 		gSocketModule->acquire_socket(socket);
 
 		// we are only interested in the timer, not in changing state
-		_EnterTimeWait();
+		if (fState == TIME_WAIT)
+			_CancelConnectionTimers();
+		_UpdateTimeWait();
 	}
 }
 
@@ -1187,13 +1201,55 @@ TCPEndpoint::_EnterTimeWait()
 {
 	TRACE("_EnterTimeWait()");
 
-	if (fState == TIME_WAIT)
+	if (fState == TIME_WAIT) {
 		_CancelConnectionTimers();
 
+		// Once the socket is closed, there is no need to keep the whole
+		// endpoint around
+		if ((fFlags & FLAG_CLOSED) != 0 && _MoveToTimeWaitTable())
+			return;
+	}
+
 	_UpdateTimeWait();
 }
 
 
+/*!	Hands the remainder of the TIME_WAIT state over to the endpoint manager.
+	If this succeeds, the endpoint will be deleted as soon as its last
+	reference is gone.
+*/
+bool
+TCPEndpoint::_MoveToTimeWaitTable()
+{
+	const sockaddr* local = *LocalAddress();
+	const sockaddr* peer = *PeerAddress();
+	if (local->sa_len > sizeof(tcp_address)
+		|| peer->sa_len > sizeof(tcp_address))
+		return false;
+
+	TimeWaitEntry state;
+	memcpy(&state.local, local, local->sa_len);
+	memcpy(&state.peer, peer, peer->sa_len);
+	state.send_next = fSendMax.Number();
+	state.receive_next = fReceiveNext.Number();
+	state.received_timestamp = fReceivedTimestamp;
+	state.has_timestamps = (fFlags & FLAG_OPTION_TIMESTAMP) != 0;
+
+	tcp_segment_header segment(TCP_FLAG_ACKNOWLEDGE);
+	segment.SetAdvertisedWindow(fReceiveQueue.Free(), fReceiveWindowShift);
+	state.advertised_window = segment.advertised_window;
+
+	if (fManager->AddTimeWait(state) != B_OK)
+		return false;
+
+	gStackModule->cancel_timer(&fTimeWaitTimer);
+	T(TimerSet(this, "time-wait", -1));
+
+	fFlags |= FLAG_TIME_WAIT_TABLE | FLAG_DELETE_ON_CLOSE;
+	return true;
+}
+
+
 void
 TCPEndpoint::_UpdateTimeWait()
 {
@@ -1550,9 +1606,13 @@ TCPEndpoint::_ShouldReceive() const
 }
 
 
+/*!	Creates the connection for a handshake that has been completed in the
+	SYN cache of the endpoint manager. The SYN-ACK has already been sent, so
+	this continues with the sequence numbers used for it.
+*/
 int32
-TCPEndpoint::_Spawn(TCPEndpoint* parent, tcp_segment_header& segment,
-	net_buffer* buffer)
+TCPEndpoint::_Spawn(TCPEndpoint* parent, const SynCacheEntry& entry,
+	tcp_segment_header& segment, net_buffer* buffer)
 {
 	MutexLocker _(fLock);
 
@@ -1568,6 +1628,8 @@ TCPEndpoint::_Spawn(TCPEndpoint* parent, tcp_segment_header& segment,
 	T(Spawn(parent, this));
 
 	fManager = parent->fManager;
+	fOwner = parent->fOwner;
+		// this runs in the receiving thread, not in the listener's team
 
 	if (fManager->BindChild(this, buffer->destination) != B_OK) {
 		T(Error(this, "binding failed", __LINE__));
@@ -1581,16 +1643,28 @@ TCPEndpoint::_Spawn(TCPEndpoint* parent, tcp_segment_header& segment,
 	fOptions = parent->fOptions;
 	fAcceptSemaphore = parent->fAcceptSemaphore;
 
-	_PrepareReceivePath(segment);
-
-	// send SYN+ACK
-	if (_SendAcknowledge() != B_OK) {
-		T(Error(this, "sending failed", __LINE__));
-		return DROP;
-	}
-
-	segment.flags &= ~TCP_FLAG_SYNCHRONIZE;
-		// we handled this flag now, it must not be set for further processing
+	fInitialSendSequence = entry.initial_send_sequence;
+	fSendUnacknowledged = fInitialSendSequence;
+	fSendNext = fInitialSendSequence + 1;
+		// count the SYN we sent
+	fSendMax = fSendNext;
+	fSendUrgentOffset = fInitialSendSequence;
+	fRecover = fInitialSendSequence.Number();
+	fSendQueue.SetInitialSequence(fSendNext);
+	fReceiveWindowShift = entry.receive_window_shift;
+
+	tcp_segment_header synchronize(TCP_FLAG_SYNCHRONIZE);
+	synchronize.sequence = entry.initial_receive_sequence;
+	synchronize.advertised_window = entry.peer_advertised_window;
+	synchronize.max_segment_size = entry.peer_max_segment_size;
+	synchronize.window_shift = entry.send_window_shift;
+	synchronize.timestamp_value = entry.received_timestamp;
+	synchronize.options = entry.options;
+	_PrepareReceivePath(synchronize);
+
+	fLastAcknowledgeSent = fReceiveNext;
+	fReceiveMaxAdvertised = fReceiveNext + min_c(fReceiveQueue.Free(),
+		(size_t)TCP_MAX_WINDOW << fReceiveWindowShift);
 
 	return _Receive(segment, buffer);
 }
@@ -1602,25 +1676,54 @@ TCPEndpoint::_ListenReceive(tcp_segment_header& segment, net_buffer* buffer)
 	TRACE("ListenReceive()");
 
 	// Essentially, we accept only TCP_FLAG_SYNCHRONIZE in this state,
-	// but the error behaviour differs
-	if (segment.flags & TCP_FLAG_RESET)
+	// but the error behaviour differs. Until the peer acknowledges our
+	// SYN-ACK, the connection only lives in the SYN cache.
+	if (segment.flags & TCP_FLAG_RESET) {
+		fManager->ResetSynCacheEntry(buffer->destination, buffer->source,
+			segment);
 		return DROP;
-	if (segment.flags & TCP_FLAG_ACKNOWLEDGE)
-		return DROP | RESET;
+	}
+	if (segment.flags & TCP_FLAG_ACKNOWLEDGE) {
+		SynCacheEntry entry;
+		if ((segment.flags & TCP_FLAG_SYNCHRONIZE) != 0
+			|| fManager->LookupSynCacheEntry(buffer->destination,
+				buffer->source, segment, entry) != B_OK)
+			return DROP | RESET;
+
+		// spawn new endpoint for accept()
+		net_socket* newSocket;
+		if (gSocketModule->spawn_pending_socket(socket, &newSocket) < B_OK) {
+			// keep the entry, the peer will retransmit
+			T(Error(this, "spawning failed", __LINE__));
+			return DROP;
+		}
+
+		fManager->RemoveSynCacheEntry(buffer->destination, buffer->source);
+
+		return ((TCPEndpoint *)newSocket->first_protocol)->_Spawn(this,
+			entry, segment, buffer);
+	}
 	if ((segment.flags & TCP_FLAG_SYNCHRONIZE) == 0)
 		return DROP;
 
 	// TODO: drop broadcast/multicast
 
-	// spawn new endpoint for accept()
-	net_socket* newSocket;
-	if (gSocketModule->spawn_pending_socket(socket, &newSocket) < B_OK) {
-		T(Error(this, "spawning failed", __LINE__));
+	net_route* route = gDatalinkModule->get_route(Domain(), buffer->source);
+	if (route == NULL)
 		return DROP;
+
+	bool local = (route->flags & RTF_LOCAL) != 0;
+	gDatalinkModule->put_route(Domain(), route);
+
+	size_t receiveWindow = socket->receive.buffer_size;
+	if (fManager->AddSynCacheEntry(segment, buffer,
+			_MaxSegmentSize(buffer->source), receiveWindow,
+			receive_window_shift(receiveWindow, local),
+			(fOptions & TCP_NOOPT) == 0) != B_OK) {
+		T(Error(this, "adding to SYN cache failed", __LINE__));
 	}
 
-	return ((TCPEndpoint *)newSocket->first_protocol)->_Spawn(this,
-		segment, buffer);
+	return DROP;
 }
 
 
@@ -2418,15 +2521,8 @@ TCPEndpoint::_PrepareSendPath(const sockaddr* peer)
 
 	// Compute the window shift we advertise to our peer - if it doesn't support
 	// this option, this will be reset to 0 (when its SYN is received)
-	fReceiveWindowShift = 0;
-	while (fReceiveWindowShift < TCP_MAX_WINDOW_SHIFT
-			&& (0xffffUL << fReceiveWindowShift) < socket->receive.buffer_size) {
-		fReceiveWindowShift++;
-	}
-
-	// Increase to a default of 8 (window minimum 256 bytes, maximum 15 MB.)
-	if (fReceiveWindowShift < 8 && !IsLocal())
-		fReceiveWindowShift = 8;
+	fReceiveWindowShift = receive_window_shift(socket->receive.buffer_size,
+		IsLocal());
 
 	return B_OK;
 }
@@ -2655,6 +2751,10 @@ TCPEndpoint::_TimeWaitTimer(net_timer* timer, void* _endpoint)
 	if (!locker.IsLocked())
 		return;
 
+	// the TIME_WAIT table took over, and the timer was canceled too late
+	if ((endpoint->fFlags & FLAG_TIME_WAIT_TABLE) != 0)
+		return;
+
 	if ((endpoint->fFlags & FLAG_CLOSED) == 0) {
 		endpoint->fFlags |= FLAG_DELETE_ON_CLOSE;
 		return;
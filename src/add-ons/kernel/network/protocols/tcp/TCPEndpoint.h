@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2010, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -71,6 +71,7 @@ private:
 			void		_StartPersistTimer();
 			void		_EnterTimeWait();
 			void		_UpdateTimeWait();
+			bool		_MoveToTimeWaitTable();
 			void		_Close();
 			void		_CancelConnectionTimers();
 
@@ -88,8 +89,9 @@ private:
 			void		_NotifyReader();
 			bool		_ShouldReceive() const;
 			void		_HandleReset(status_t error);
-			int32		_Spawn(TCPEndpoint* parent, tcp_segment_header& segment,
-							net_buffer* buffer);
+			int32		_Spawn(TCPEndpoint* parent,
+							const SynCacheEntry& entry,
+							tcp_segment_header& segment, net_buffer* buffer);
 			int32		_ListenReceive(tcp_segment_header& segment,
 							net_buffer* buffer);
 			int32		_SynchronizeSentReceive(tcp_segment_header& segment,
@@ -127,6 +129,10 @@ private:
 private:
 	TCPEndpoint*	fConnectionHashLink;
 	TCPEndpoint*	fEndpointHashLink;
+	TCPEndpoint*	fReusePortNext;
+		// the next listener sharing our local address via SO_REUSEPORT
+	uid_t			fOwner;
+		// only sockets of the same user may share an address
 	friend class	EndpointManager;
 	friend struct	ConnectionHashDefinition;
 	friend class	EndpointHashDefinition;
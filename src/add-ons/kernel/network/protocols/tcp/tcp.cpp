@@ -731,19 +731,24 @@ tcp_receive_data(net_buffer* buffer)
 
 	int32 segmentAction = DROP;
 
-	TCPEndpoint* endpoint = endpointManager->FindConnection(
-		buffer->destination, buffer->source);
-	if (endpoint != NULL) {
-		segmentAction = endpoint->SegmentReceived(segment, buffer);
-
-		// There are some states in which the socket could have been deleted
-		// while handling a segment. If this flag is set in segmentAction
-		// then we know the socket has been freed and can skip releasing
-		// the reference acquired in EndpointManager::FindConnection().
-		if ((segmentAction & DELETED_ENDPOINT) == 0)
-			gSocketModule->release_socket(endpoint->socket);
-	} else if ((segment.flags & TCP_FLAG_RESET) == 0)
-		segmentAction = DROP | RESET;
+	if (endpointManager->TimeWaitReceived(segment, buffer, segmentAction)) {
+		// the connection has been moved to the TIME_WAIT table
+	} else {
+		TCPEndpoint* endpoint = endpointManager->FindConnection(
+			buffer->destination, buffer->source);
+		if (endpoint != NULL) {
+			segmentAction = endpoint->SegmentReceived(segment, buffer);
+
+			// There are some states in which the socket could have been
+			// deleted while handling a segment. If this flag is set in
+			// segmentAction then we know the socket has been freed and can
+			// skip releasing the reference acquired in
+			// EndpointManager::FindConnection().
+			if ((segmentAction & DELETED_ENDPOINT) == 0)
+				gSocketModule->release_socket(endpoint->socket);
+		} else if ((segment.flags & TCP_FLAG_RESET) == 0)
+			segmentAction = DROP | RESET;
+	}
 
 	if ((segmentAction & RESET) != 0) {
 		// send reset
@@ -17,6 +17,7 @@
 #include <net_stack.h>
 
 #include <ByteOrder.h>
+#include <OS.h>
 
 #include <sys/socket.h>
 
@@ -170,6 +171,17 @@ operator==(tcp_sequence a, tcp_sequence b)
 }
 
 
+static const int kTimestampFactor = 1000;
+	// conversion factor between usec system time and msec tcp time
+
+
+static inline uint32
+tcp_now()
+{
+	return system_time() / kTimestampFactor;
+}
+
+
 // TCP flag constants
 #define TCP_FLAG_FINISH					0x01
 #define TCP_FLAG_SYNCHRONIZE			0x02
@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2021, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -28,9 +28,11 @@
 #include <algorithm>
 #include <netinet/in.h>
 #include <netinet/ip.h>
+#include <netinet/udp.h>
 #include <new>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <utility>
 
 
@@ -79,8 +81,13 @@ class UdpDomainSupport;
 enum {
 	FLAG_NO_RECEIVE				= 0x01,
 	FLAG_NO_SEND				= 0x02,
+	FLAG_GRO					= 0x04,
 };
 
+static const size_t kMaxCoalescedSize = 0xffff - sizeof(udp_header)
+	- sizeof(struct ip);
+	// the largest payload a single UDP datagram could carry
+
 
 class UdpEndpoint : public net_protocol, public DatagramSocket<> {
 public:
@@ -91,6 +98,11 @@ public:
 			status_t			Connect(const sockaddr* newAddr);
 			status_t			Shutdown(int direction);
 
+			status_t			SetOption(int option, const void* value,
+									int length);
+			status_t			GetOption(int option, void* value,
+									int* _length);
+
 			status_t			Open();
 			status_t			Close();
 			status_t			Free();
@@ -98,11 +110,15 @@ public:
 			status_t			SendRoutedData(net_buffer* buffer,
 									net_route* route);
 			status_t			SendData(net_buffer* buffer);
+			ssize_t				SendDataBatch(net_buffer** buffers,
+									size_t count);
 			ssize_t				SendAvailable();
 
 			ssize_t				BytesAvailable();
 			status_t			FetchData(size_t numBytes, uint32 flags,
 									net_buffer** _buffer);
+			ssize_t				FetchDataBatch(size_t count, uint32 flags,
+									bigtime_t deadline, net_buffer** _buffers);
 
 			status_t			StoreData(net_buffer* buffer);
 			status_t			DeliverData(net_buffer* buffer);
@@ -113,9 +129,13 @@ public:
 			void				SetActive(bool newValue) { fActive = newValue; }
 
 			UdpEndpoint*&		HashTableLink() { return fLink; }
+			uid_t				Owner() const { return fOwner; }
 
 			void				Dump() const;
 
+private:
+			bool				_Coalesce(net_buffer* buffer);
+
 private:
 			UdpDomainSupport*	fManager;
 			bool				fActive;
@@ -125,6 +145,7 @@ private:
 
 			UdpEndpoint*		fLink;
 			uint32				fFlags;
+			uid_t				fOwner;
 };
 
 
@@ -204,6 +225,11 @@ private:
 		const sockaddr *peerAddress, uint32 index = 0);
 	status_t _DemuxBroadcast(net_buffer *buffer);
 	status_t _DemuxUnicast(net_buffer *buffer);
+	UdpEndpoint *_SelectReusePortEndpoint(UdpEndpoint *endpoint,
+		net_buffer *buffer);
+	static bool _IsReusePortMember(UdpEndpoint *endpoint,
+		const sockaddr *localAddress, const sockaddr *peerAddress,
+		uint32 index);
 
 	uint16 _GetNextEphemeral();
 	UdpEndpoint *_EndpointWithPort(uint16 port) const;
@@ -473,10 +499,12 @@ UdpDomainSupport::_Bind(UdpEndpoint *endpoint, const sockaddr *address)
 				|| (socketOptions & (SO_REUSEADDR | SO_REUSEPORT)) == 0)
 				return EADDRINUSE;
 
-			// if both addresses are the same, SO_REUSEPORT is required:
+			// if both addresses are the same, SO_REUSEPORT is required, and
+			// both sockets must belong to the same user:
 			if (otherEndpoint->LocalAddress().EqualTo(address, false)
 				&& ((otherEndpoint->Socket()->options & SO_REUSEPORT) == 0
-					|| (socketOptions & SO_REUSEPORT) == 0))
+					|| (socketOptions & SO_REUSEPORT) == 0
+					|| otherEndpoint->Owner() != endpoint->Owner()))
 				return EADDRINUSE;
 		}
 	}
@@ -626,11 +654,66 @@ UdpDomainSupport::_DemuxUnicast(net_buffer* buffer)
 		return B_NAME_NOT_FOUND;
 	}
 
+	endpoint = _SelectReusePortEndpoint(endpoint, buffer);
 	endpoint->StoreData(buffer);
 	return B_OK;
 }
 
 
+/*!	If several endpoints share the address of \a endpoint via SO_REUSEPORT,
+	this chooses one of them by the hash of the datagram's addresses, so that
+	all datagrams of a flow end up in the same socket.
+*/
+UdpEndpoint*
+UdpDomainSupport::_SelectReusePortEndpoint(UdpEndpoint* endpoint,
+	net_buffer* buffer)
+{
+	ASSERT_LOCKED_MUTEX(&fLock);
+
+	if ((endpoint->socket->options & SO_REUSEPORT) == 0)
+		return endpoint;
+
+	const sockaddr* localAddress = *endpoint->LocalAddress();
+	const sockaddr* peerAddress = *endpoint->PeerAddress();
+	uint32 count = 0;
+
+	// Endpoints with the same addresses are in the same hash chain
+	for (UdpEndpoint* member = endpoint; member != NULL;
+			member = member->HashTableLink()) {
+		if (_IsReusePortMember(member, localAddress, peerAddress,
+				buffer->index))
+			count++;
+	}
+
+	if (count < 2)
+		return endpoint;
+
+	uint32 index = reuse_port_index(AddressModule()->hash_address_pair(
+		buffer->destination, buffer->source), count);
+
+	for (UdpEndpoint* member = endpoint; member != NULL;
+			member = member->HashTableLink()) {
+		if (_IsReusePortMember(member, localAddress, peerAddress,
+				buffer->index) && index-- == 0)
+			return member;
+	}
+
+	return endpoint;
+}
+
+
+bool
+UdpDomainSupport::_IsReusePortMember(UdpEndpoint* endpoint,
+	const sockaddr* localAddress, const sockaddr* peerAddress, uint32 index)
+{
+	return (endpoint->socket->options & SO_REUSEPORT) != 0
+		&& (endpoint->socket->bound_to_device == 0
+			|| endpoint->socket->bound_to_device == index)
+		&& endpoint->LocalAddress().EqualTo(localAddress, true)
+		&& endpoint->PeerAddress().EqualTo(peerAddress, true);
+}
+
+
 uint16
 UdpDomainSupport::_GetNextEphemeral()
 {
@@ -957,7 +1040,8 @@ UdpEndpoint::UdpEndpoint(net_socket *socket)
 	:
 	DatagramSocket<>("udp endpoint", socket),
 	fActive(false),
-	fFlags(0)
+	fFlags(0),
+	fOwner(geteuid())
 {
 }
 
@@ -1006,6 +1090,38 @@ UdpEndpoint::Shutdown(int direction)
 }
 
 
+status_t
+UdpEndpoint::SetOption(int option, const void* value, int length)
+{
+	if (option != UDP_GRO)
+		return ENOPROTOOPT;
+	if (length != sizeof(int))
+		return B_BAD_VALUE;
+
+	AutoLocker _(fLock);
+
+	if (*(const int*)value != 0)
+		fFlags |= FLAG_GRO;
+	else
+		fFlags &= ~FLAG_GRO;
+	return B_OK;
+}
+
+
+status_t
+UdpEndpoint::GetOption(int option, void* value, int* _length)
+{
+	if (option != UDP_GRO)
+		return ENOPROTOOPT;
+	if (*_length < (int)sizeof(int))
+		return B_BAD_VALUE;
+
+	*(int*)value = (fFlags & FLAG_GRO) != 0 ? 1 : 0;
+	*_length = sizeof(int);
+	return B_OK;
+}
+
+
 status_t
 UdpEndpoint::Open()
 {
@@ -1105,6 +1221,76 @@ UdpEndpoint::SendData(net_buffer *buffer)
 }
 
 
+/*!	Sends the \a buffers in order, and returns how many of them have been
+	sent. Consecutive datagrams to the same destination share a single route
+	lookup, and the socket state is only checked once for the whole batch.
+	The buffers that could not be sent remain owned by the caller.
+*/
+ssize_t
+UdpEndpoint::SendDataBatch(net_buffer** buffers, size_t count)
+{
+	TRACE_EP("SendDataBatch(%p, %" B_PRIuSIZE ")", buffers, count);
+
+	if ((fFlags & FLAG_NO_SEND) != 0)
+		return EPIPE;
+	status_t status = fSocket->error;
+	fSocket->error = 0;
+	if (status != B_OK)
+		return status;
+
+	sockaddr_storage routeDestination;
+	sockaddr_storage routeSource;
+	net_route* route = NULL;
+	size_t sent = 0;
+
+	for (; sent < count; sent++) {
+		net_buffer* buffer = buffers[sent];
+
+		if (fSocket->bound_to_device != 0) {
+			// the route depends on the device only
+			status = gDatalinkModule->send_data(this, NULL, buffer);
+			if (status != B_OK)
+				break;
+			continue;
+		}
+
+		if (route != NULL && AddressModule()->equal_addresses(
+				(sockaddr*)&routeDestination, buffer->destination)) {
+			// same destination as before, use the source address the route
+			// lookup has chosen back then
+			status = AddressModule()->update_to(buffer->source,
+				(sockaddr*)&routeSource);
+		} else {
+			if (route != NULL)
+				gDatalinkModule->put_route(Domain(), route);
+
+			route = NULL;
+			status = gDatalinkModule->get_buffer_route(Domain(), buffer,
+				&route);
+			if (status == B_OK) {
+				memcpy(&routeDestination, buffer->destination,
+					buffer->destination->sa_len);
+				memcpy(&routeSource, buffer->source, buffer->source->sa_len);
+			}
+		}
+		if (status != B_OK)
+			break;
+
+		status = SendRoutedData(buffer, route);
+		if (status != B_OK)
+			break;
+	}
+
+	if (route != NULL)
+		gDatalinkModule->put_route(Domain(), route);
+
+	if (sent == 0 && status != B_OK)
+		return status;
+
+	return sent;
+}
+
+
 ssize_t
 UdpEndpoint::SendAvailable()
 {
@@ -1149,12 +1335,41 @@ UdpEndpoint::FetchData(size_t numBytes, uint32 flags, net_buffer **_buffer)
 }
 
 
+ssize_t
+UdpEndpoint::FetchDataBatch(size_t count, uint32 flags, bigtime_t deadline,
+	net_buffer** _buffers)
+{
+	TRACE_EP("FetchDataBatch(%" B_PRIuSIZE ", 0x%" B_PRIx32 ")", count,
+		flags);
+	if ((fFlags & FLAG_NO_RECEIVE) != 0)
+		return 0;
+
+	return DequeueBatch(flags, deadline, _buffers, count);
+}
+
+
 status_t
 UdpEndpoint::StoreData(net_buffer *buffer)
 {
 	TRACE_EP("StoreData(%p [%" B_PRIu32 " bytes])", buffer, buffer->size);
 
-	return EnqueueClone(buffer);
+	if ((fFlags & FLAG_GRO) == 0)
+		return EnqueueClone(buffer);
+
+	AutoLocker _(fLock);
+
+	if (_Coalesce(buffer))
+		return B_OK;
+
+	net_buffer* clone = gBufferModule->clone(buffer, false);
+	if (clone == NULL)
+		return B_NO_MEMORY;
+
+	status_t status = _Enqueue(clone);
+	if (status != B_OK)
+		gBufferModule->free(clone);
+
+	return status;
 }
 
 
@@ -1189,6 +1404,85 @@ UdpEndpoint::Dump() const
 }
 
 
+/*!	Appends a copy of the datagram in \a buffer to the last one in the queue,
+	if both belong to the same flow, and the queued one consists only of
+	datagrams of at least that size. A reader then gets them all at once,
+	together with the size of the segments as a UDP_GRO control message.
+	The endpoint lock must be held.
+*/
+bool
+UdpEndpoint::_Coalesce(net_buffer* buffer)
+{
+	net_buffer* tail = fBuffers.Tail();
+	if (tail == NULL || buffer->size == 0
+		|| tail->size + buffer->size > kMaxCoalescedSize
+		|| (fSocket->receive.buffer_size > 0
+			&& fCurrentBytes + buffer->size > fSocket->receive.buffer_size)
+		|| gBufferModule->get_ancillary_data(buffer) != NULL
+		|| tail->index != buffer->index
+		|| !AddressModule()->equal_addresses_and_ports(tail->source,
+			buffer->source)
+		|| !AddressModule()->equal_addresses_and_ports(tail->destination,
+			buffer->destination)) {
+		return false;
+	}
+
+	// the first datagram of a coalesced buffer determines the segment size
+	int segmentSize = tail->size;
+	ancillary_data_container* container
+		= gBufferModule->get_ancillary_data(tail);
+	if (container != NULL) {
+		ancillary_data_header header;
+		int* data = (int*)gStackModule->next_ancillary_data(container, NULL,
+			&header);
+		if (data == NULL || header.level != IPPROTO_UDP
+			|| header.type != UDP_GRO) {
+			return false;
+		}
+
+		segmentSize = *data;
+	}
+
+	// only the last segment may be shorter than the others
+	if (buffer->size > (uint32)segmentSize
+		|| tail->size % segmentSize != 0) {
+		return false;
+	}
+
+	net_buffer* clone = gBufferModule->clone(buffer, false);
+	if (clone == NULL)
+		return false;
+
+	if (container == NULL) {
+		container = gStackModule->create_ancillary_data_container();
+		if (container == NULL) {
+			gBufferModule->free(clone);
+			return false;
+		}
+
+		ancillary_data_header header = { IPPROTO_UDP, UDP_GRO, sizeof(int) };
+		if (gStackModule->add_ancillary_data(container, &header, &segmentSize,
+				NULL, NULL) != B_OK) {
+			gStackModule->delete_ancillary_data_container(container);
+			gBufferModule->free(clone);
+			return false;
+		}
+
+		gBufferModule->set_ancillary_data(tail, container);
+	}
+
+	size_t size = clone->size;
+	if (gBufferModule->merge(tail, clone, true) != B_OK) {
+		gBufferModule->free(clone);
+		return false;
+	}
+
+	fCurrentBytes += size;
+	gStackModule->notify_socket(fSocket, B_SELECT_READ, fCurrentBytes);
+	return true;
+}
+
+
 // #pragma mark - protocol interface
 
 
@@ -1263,6 +1557,9 @@ status_t
 udp_getsockopt(net_protocol *protocol, int level, int option, void *value,
 	int *length)
 {
+	if (level == IPPROTO_UDP)
+		return ((UdpEndpoint *)protocol)->GetOption(option, value, length);
+
 	return protocol->next->module->getsockopt(protocol->next, level, option,
 		value, length);
 }
@@ -1272,6 +1569,9 @@ status_t
 udp_setsockopt(net_protocol *protocol, int level, int option,
 	const void *value, int length)
 {
+	if (level == IPPROTO_UDP)
+		return ((UdpEndpoint *)protocol)->SetOption(option, value, length);
+
 	return protocol->next->module->setsockopt(protocol->next, level, option,
 		value, length);
 }
@@ -1320,6 +1620,14 @@ udp_send_data(net_protocol *protocol, net_buffer *buffer)
 }
 
 
+ssize_t
+udp_send_data_batch(net_protocol *protocol, net_buffer **buffers,
+	size_t count)
+{
+	return ((UdpEndpoint *)protocol)->SendDataBatch(buffers, count);
+}
+
+
 ssize_t
 udp_send_avail(net_protocol *protocol)
 {
@@ -1335,6 +1643,15 @@ udp_read_data(net_protocol *protocol, size_t numBytes, uint32 flags,
 }
 
 
+ssize_t
+udp_read_data_batch(net_protocol *protocol, size_t count, uint32 flags,
+	bigtime_t deadline, net_buffer **_buffers)
+{
+	return ((UdpEndpoint *)protocol)->FetchDataBatch(count, flags, deadline,
+		_buffers);
+}
+
+
 ssize_t
 udp_read_avail(net_protocol *protocol)
 {
@@ -1426,6 +1743,38 @@ udp_error_reply(net_protocol *protocol, net_buffer *cause, net_error error,
 }
 
 
+ssize_t
+udp_process_ancillary_data(net_protocol *protocol,
+	const ancillary_data_container *container, void *_buffer,
+	size_t bufferSize, int flags)
+{
+	// the only ancillary data attached to received buffers is the segment
+	// size of coalesced datagrams
+	uint8* buffer = (uint8*)_buffer;
+	size_t bytesWritten = 0;
+
+	ancillary_data_header header;
+	void* data = NULL;
+	while ((data = gStackModule->next_ancillary_data(container, data, &header))
+			!= NULL) {
+		if (header.level != IPPROTO_UDP || header.type != UDP_GRO)
+			continue;
+		if (bufferSize - bytesWritten < CMSG_SPACE(header.len))
+			break;
+
+		cmsghdr* messageHeader = (cmsghdr*)(buffer + bytesWritten);
+		messageHeader->cmsg_level = header.level;
+		messageHeader->cmsg_type = header.type;
+		messageHeader->cmsg_len = CMSG_LEN(header.len);
+		memcpy(CMSG_DATA(messageHeader), data, header.len);
+
+		bytesWritten += CMSG_SPACE(header.len);
+	}
+
+	return bytesWritten;
+}
+
+
 ssize_t
 udp_process_ancillary_data_no_container(net_protocol *protocol,
 	net_buffer* buffer, void *data, size_t dataSize)
@@ -1567,10 +1916,12 @@ net_protocol_module_info sUDPModule = {
 	udp_error_received,
 	udp_error_reply,
 	NULL,		// add_ancillary_data()
-	NULL,		// process_ancillary_data()
+	udp_process_ancillary_data,
 	udp_process_ancillary_data_no_container,
 	NULL,		// send_data_no_buffer()
-	NULL		// read_data_no_buffer()
+	NULL,		// read_data_no_buffer()
+	udp_send_data_batch,
+	udp_read_data_batch
 };
 
 module_dependency module_dependencies[] = {
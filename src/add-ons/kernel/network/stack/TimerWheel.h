@@ -0,0 +1,291 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+
+#include <util/list.h>
+
+
+/*!	A hierarchical timer wheel, as described by Varghese and Lauck.
+
+	Timers are sorted into slots by their expiration tick. The first level
+	covers the next kSlotCount ticks with one slot each; every further level
+	covers kSlotCount times the range of the previous one, and its slots are
+	moved down ("cascaded") whenever the level below wraps around. Adding and
+	removing a timer is O(1), and expiring timers skips over all ticks that
+	have neither timers to expire, nor slots to cascade.
+
+	\a Timer must begin with a list_link named \c link, and store its
+	absolute expiration time in a bigtime_t named \c due.
+	The wheel does not do any locking on its own.
+*/
+template<typename Timer>
+class TimerWheel {
+public:
+	static const bigtime_t	kResolution = 1000;
+		// length of a tick in usecs
+	static const uint32		kSlotBits = 6;
+	static const uint32		kSlotCount = 1 << kSlotBits;
+	static const uint32		kSlotMask = kSlotCount - 1;
+	static const uint32		kLevelCount = 4;
+	static const uint64		kMaxTicks
+		= (uint64)1 << (kSlotBits * kLevelCount);
+
+	typedef void (*visitor_func)(Timer* timer);
+
+public:
+			void				Init(bigtime_t now);
+
+			void				Add(Timer* timer, bigtime_t now);
+			void				Remove(Timer* timer);
+
+			bool				Advance(bigtime_t now, struct list* expired);
+			bigtime_t			NextTimeout();
+
+			int32				Count() const { return fCount; }
+			void				Visit(visitor_func visitor);
+
+private:
+			void				_Insert(Timer* timer);
+			void				_Cascade(uint32 level, uint32 index);
+			uint64				_NextEventTick(uint64 limit);
+
+private:
+			struct list			fSlots[kLevelCount][kSlotCount];
+			uint64				fCurrentTick;
+				// the next tick that has not been processed yet
+			int32				fCount;
+};
+
+
+/*!	Initializes the wheel, and sets its current time to \a now. This must be
+	called before the wheel can be used. There is no constructor, as the wheel
+	is usually a static object of a kernel module.
+*/
+template<typename Timer>
+void
+TimerWheel<Timer>::Init(bigtime_t now)
+{
+	for (uint32 level = 0; level < kLevelCount; level++) {
+		for (uint32 index = 0; index < kSlotCount; index++)
+			list_init(&fSlots[level][index]);
+	}
+
+	fCurrentTick = now / kResolution;
+	fCount = 0;
+}
+
+
+/*!	Adds the \a timer to the wheel, so that Advance() will return it once
+	its due time has passed. \a now is the current time.
+*/
+template<typename Timer>
+void
+TimerWheel<Timer>::Add(Timer* timer, bigtime_t now)
+{
+	if (fCount == 0) {
+		// Nobody called Advance() while the wheel was empty; skip the ticks
+		// that have passed since then, so that it does not have to walk
+		// through all of them
+		uint64 nowTick = now / kResolution;
+		if (nowTick > fCurrentTick)
+			fCurrentTick = nowTick;
+	}
+
+	_Insert(timer);
+	fCount++;
+}
+
+
+/*!	Removes the \a timer from the wheel, or from the list of expired timers
+	Advance() put it in.
+*/
+template<typename Timer>
+void
+TimerWheel<Timer>::Remove(Timer* timer)
+{
+	list_remove_link(&timer->link);
+	fCount--;
+}
+
+
+/*!	Processes all ticks up to \a now, and moves the timers that have become
+	due into the \a expired list. Those timers are still counted as part
+	of the wheel until they are removed from that list via Remove().
+	Returns whether or not any timers have expired.
+*/
+template<typename Timer>
+bool
+TimerWheel<Timer>::Advance(bigtime_t now, struct list* expired)
+{
+	uint64 nowTick = now / kResolution;
+	bool hasExpired = false;
+
+	while (fCurrentTick <= nowTick) {
+		fCurrentTick = _NextEventTick(nowTick + 1);
+		if (fCurrentTick > nowTick)
+			break;
+
+		uint32 index = fCurrentTick & kSlotMask;
+		if (index == 0) {
+			// the first level wrapped around, refill it from the next one
+			for (uint32 level = 1; level < kLevelCount; level++) {
+				uint32 levelIndex
+					= (fCurrentTick >> (kSlotBits * level)) & kSlotMask;
+				_Cascade(level, levelIndex);
+				if (levelIndex != 0)
+					break;
+			}
+		}
+
+		struct list* slot = &fSlots[0][index];
+		while (list_link* link = (list_link*)list_remove_head_item(slot)) {
+			list_add_link_to_tail(expired, link);
+			hasExpired = true;
+		}
+
+		fCurrentTick++;
+	}
+
+	return hasExpired;
+}
+
+
+/*!	Returns the time at which Advance() has to be called next, which is
+	the due time of the earliest timer. Returns \c B_INFINITE_TIMEOUT if
+	the wheel is empty.
+*/
+template<typename Timer>
+bigtime_t
+TimerWheel<Timer>::NextTimeout()
+{
+	uint64 next = 0;
+	bool found = false;
+
+	// The slots of each level are looked at in the order of their ticks,
+	// so only the first one that is not empty matters. The timers of a
+	// later level may still be due before those of an earlier one, though,
+	// as they are only cascaded down once the level below wraps around.
+	for (uint32 level = 0; level < kLevelCount; level++) {
+		uint32 shift = kSlotBits * level;
+		uint64 block = (fCurrentTick + ((uint64)1 << shift) - 1) >> shift;
+
+		for (uint32 offset = 0; offset < kSlotCount; offset++, block++) {
+			if (found && (block << shift) >= next)
+				break;
+
+			struct list* slot = &fSlots[level][block & kSlotMask];
+			if (list_is_empty(slot))
+				continue;
+
+			Timer* timer = NULL;
+			while ((timer = (Timer*)list_get_next_item(slot, timer)) != NULL) {
+				uint64 expires = (timer->due + kResolution - 1) / kResolution;
+				if (!found || expires < next)
+					next = expires;
+				found = true;
+			}
+			break;
+		}
+	}
+
+	if (!found)
+		return B_INFINITE_TIMEOUT;
+	if (next < fCurrentTick)
+		next = fCurrentTick;
+
+	return next * kResolution;
+}
+
+
+template<typename Timer>
+void
+TimerWheel<Timer>::Visit(visitor_func visitor)
+{
+	for (uint32 level = 0; level < kLevelCount; level++) {
+		for (uint32 index = 0; index < kSlotCount; index++) {
+			Timer* timer = NULL;
+			while ((timer = (Timer*)list_get_next_item(&fSlots[level][index],
+					timer)) != NULL) {
+				visitor(timer);
+			}
+		}
+	}
+}
+
+
+template<typename Timer>
+void
+TimerWheel<Timer>::_Insert(Timer* timer)
+{
+	// round up, so that a timer never expires too early
+	uint64 expires = (timer->due + kResolution - 1) / kResolution;
+	if (expires < fCurrentTick)
+		expires = fCurrentTick;
+
+	uint64 delta = expires - fCurrentTick;
+	if (delta >= kMaxTicks) {
+		// Too far in the future; it will be reinserted whenever the last
+		// level is cascaded
+		expires = fCurrentTick + kMaxTicks - 1;
+		delta = kMaxTicks - 1;
+	}
+
+	uint32 level = 0;
+	while (delta >= ((uint64)1 << (kSlotBits * (level + 1))))
+		level++;
+
+	uint32 index = (expires >> (kSlotBits * level)) & kSlotMask;
+	list_add_link_to_tail(&fSlots[level][index], &timer->link);
+}
+
+
+template<typename Timer>
+void
+TimerWheel<Timer>::_Cascade(uint32 level, uint32 index)
+{
+	struct list timers;
+	list_init(&timers);
+	list_move_to_list(&fSlots[level][index], &timers);
+
+	while (Timer* timer = (Timer*)list_remove_head_item(&timers))
+		_Insert(timer);
+}
+
+
+/*!	Returns the first tick from the current one on at which Advance() has
+	anything to do: either expire the timers of a slot of the first level,
+	or cascade a slot of a later level. If there is nothing to do before
+	\a limit, \a limit is returned.
+*/
+template<typename Timer>
+uint64
+TimerWheel<Timer>::_NextEventTick(uint64 limit)
+{
+	uint64 next = limit;
+
+	for (uint32 level = 0; level < kLevelCount; level++) {
+		// the slots of a level start with the first tick of a block that
+		// has not been processed yet
+		uint32 shift = kSlotBits * level;
+		uint64 block = (fCurrentTick + ((uint64)1 << shift) - 1) >> shift;
+
+		for (uint32 offset = 0; offset < kSlotCount; offset++, block++) {
+			if ((block << shift) >= next)
+				break;
+
+			if (!list_is_empty(&fSlots[level][block & kSlotMask])) {
+				next = block << shift;
+				break;
+			}
+		}
+	}
+
+	return next;
+}
+
+
+#endif	// TIMER_WHEEL_H
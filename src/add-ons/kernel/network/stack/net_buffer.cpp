@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2016, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -42,6 +42,8 @@
 
 #define BUFFER_SIZE 2048
 	// maximum implementation derived buffer size is 65536
+#define MAX_EXTERNAL_NODE_SIZE 32768
+	// data_node::used is only 16 bit wide
 
 #define ENABLE_DEBUGGER_COMMANDS	1
 #define ENABLE_STATS				1
@@ -66,6 +68,9 @@ struct free_data {
 struct data_header {
 	int32			ref_count;
 	addr_t			physical_address;
+	net_buffer_release_func release;
+	void*			release_cookie;
+		// only set for headers of external data, see append_external_data()
 	free_data*		first_free;
 	uint8*			data_end;
 	header_space	space;
@@ -808,6 +813,8 @@ create_data_header(size_t headerSpace)
 	header->ref_count = 1;
 	header->physical_address = 0;
 		// TODO: initialize this correctly
+	header->release = NULL;
+	header->release_cookie = NULL;
 	header->space.size = headerSpace;
 	header->space.free = headerSpace;
 	header->data_end = (uint8*)header + DATA_HEADER_SIZE;
@@ -830,6 +837,9 @@ release_data_header(data_header* header)
 		return;
 
 	TRACE(("%d:   free header %p\n", find_thread(NULL), header));
+	if (header->release != NULL)
+		header->release(header->release_cookie);
+
 	free_data_header(header);
 }
 
@@ -2011,6 +2021,73 @@ append_cloned_data(net_buffer* _buffer, net_buffer* _source, uint32 offset,
 }
 
 
+/*!	Appends \a bytes of memory at \a data to the \a buffer without copying
+	it, for example pages of the file cache that are to be sent out. The
+	memory must stay valid until \a release is called with \a cookie, which
+	happens as soon as no buffer references any part of it anymore.
+	This function takes over the memory in any case: if it fails, \a release
+	has already been called when it returns.
+*/
+static status_t
+append_external_data(net_buffer* _buffer, const void* data, size_t bytes,
+	net_buffer_release_func release, void* cookie)
+{
+	net_buffer_private* buffer = (net_buffer_private*)_buffer;
+	TRACE(("%d: append_external_data(buffer %p, data %p, bytes = %ld)\n",
+		find_thread(NULL), buffer, data, bytes));
+
+	ParanoiaChecker _(buffer);
+
+	if (bytes == 0) {
+		release(cookie);
+		return B_OK;
+	}
+
+	// The data header does not contain any data, it only keeps track of
+	// the references to the external memory.
+	data_header* header = create_data_header(0);
+	if (header == NULL) {
+		release(cookie);
+		return ENOBUFS;
+	}
+
+	header->release = release;
+	header->release_cookie = cookie;
+
+	status_t status = B_OK;
+	size_t sizeAppended = 0;
+
+	while (sizeAppended < bytes) {
+		data_node* node = add_data_node(buffer, header);
+		if (node == NULL) {
+			remove_trailer(buffer, sizeAppended);
+			status = ENOBUFS;
+			break;
+		}
+
+		node->offset = buffer->size;
+		node->start = (uint8*)data + sizeAppended;
+		node->used = min_c(bytes - sizeAppended, MAX_EXTERNAL_NODE_SIZE);
+		node->flags = DATA_NODE_READ_ONLY;
+
+		list_add_item(&buffer->buffers, node);
+
+		buffer->size += node->used;
+		sizeAppended += node->used;
+	}
+
+	// release our initial reference; if no node could be added, this also
+	// releases the external memory
+	release_data_header(header);
+
+	CHECK_BUFFER(buffer);
+	SET_PARANOIA_CHECK(PARANOIA_SUSPICIOUS, buffer, &buffer->size,
+		sizeof(buffer->size));
+
+	return status;
+}
+
+
 void
 set_ancillary_data(net_buffer* buffer, ancillary_data_container* container)
 {
@@ -2380,6 +2457,7 @@ net_buffer_module_info gNetBufferModule = {
 	remove_trailer,
 	trim_data,
 	append_cloned_data,
+	append_external_data,
 
 	NULL,	// associate_data
 
@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2010, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -45,6 +45,10 @@
 #endif
 
 
+#define MAX_BATCH_BUFFERS	32
+	// the number of buffers handed to a protocol's batch hooks at once
+
+
 struct net_socket_private;
 typedef DoublyLinkedList<net_socket_private> SocketList;
 
@@ -1132,37 +1136,16 @@ socket_listen(net_socket* socket, int backlog)
 }
 
 
-ssize_t
-socket_receive(net_socket* socket, msghdr* header, void* data, size_t length,
-	int flags)
+/*!	Copies the contents of a \a buffer the protocol returned from its
+	read_data() hook into \a data and the other iovecs of \a header, and
+	fills in the address, and the ancillary data. The buffer is freed in any
+	case.
+*/
+static ssize_t
+receive_buffer(net_socket* socket, net_buffer* buffer, msghdr* header,
+	void* data, size_t length, int flags, int originalFlags)
 {
-	const int originalFlags = flags;
-
-	// MSG_NOSIGNAL is only meaningful for send(), not receive(), but it is
-	// sometimes specified anyway. Mask it off to avoid unnecessary errors.
-	flags &= ~MSG_NOSIGNAL;
-
-	// If the protocol sports read_data_no_buffer() we use it.
-	if (socket->first_info->read_data_no_buffer != NULL)
-		return socket_receive_no_buffer(socket, header, data, length, flags);
-
-	// Mask off flags handled in this function.
-	flags &= ~(MSG_TRUNC);
-
-	size_t totalLength = length;
-	if (header != NULL) {
-		ASSERT(data == header->msg_iov[0].iov_base);
-
-		// calculate the length considering all of the extra buffers
-		for (int i = 1; i < header->msg_iovlen; i++)
-			totalLength += header->msg_iov[i].iov_len;
-	}
-
-	net_buffer* buffer;
-	status_t status = socket->first_info->read_data(
-		socket->first_protocol, totalLength, flags, &buffer);
-	if (status != B_OK)
-		return status;
+	status_t status;
 
 	// process ancillary data
 	if (header != NULL) {
@@ -1244,6 +1227,73 @@ socket_receive(net_socket* socket, msghdr* header, void* data, size_t length,
 }
 
 
+ssize_t
+socket_receive(net_socket* socket, msghdr* header, void* data, size_t length,
+	int flags)
+{
+	const int originalFlags = flags;
+
+	// MSG_NOSIGNAL is only meaningful for send(), not receive(), but it is
+	// sometimes specified anyway. Mask it off to avoid unnecessary errors.
+	flags &= ~MSG_NOSIGNAL;
+
+	// If the protocol sports read_data_no_buffer() we use it.
+	if (socket->first_info->read_data_no_buffer != NULL)
+		return socket_receive_no_buffer(socket, header, data, length, flags);
+
+	// Mask off flags handled in this function.
+	flags &= ~(MSG_TRUNC);
+
+	size_t totalLength = length;
+	if (header != NULL) {
+		ASSERT(data == header->msg_iov[0].iov_base);
+
+		// calculate the length considering all of the extra buffers
+		for (int i = 1; i < header->msg_iovlen; i++)
+			totalLength += header->msg_iov[i].iov_len;
+	}
+
+	net_buffer* buffer;
+	status_t status = socket->first_info->read_data(
+		socket->first_protocol, totalLength, flags, &buffer);
+	if (status != B_OK)
+		return status;
+
+	return receive_buffer(socket, buffer, header, data, length, flags,
+		originalFlags);
+}
+
+
+/*!	Determines where data sent via \a socket should go to: this is either
+	the \a address passed in, or the peer of a connected socket.
+*/
+static status_t
+get_send_address(net_socket* socket, const sockaddr*& address,
+	socklen_t& addressLength)
+{
+	if (addressLength == 0)
+		address = NULL;
+	else if (address == NULL)
+		return B_BAD_VALUE;
+
+	if (socket->peer.ss_len != 0) {
+		if (address != NULL)
+			return EISCONN;
+
+		// socket is connected, we use that address
+		address = (struct sockaddr*)&socket->peer;
+		addressLength = socket->peer.ss_len;
+	}
+
+	if (address == NULL || addressLength == 0) {
+		// don't know where to send to:
+		return EDESTADDRREQ;
+	}
+
+	return B_OK;
+}
+
+
 ssize_t
 socket_send(net_socket* socket, msghdr* header, const void* data, size_t length,
 	int flags)
@@ -1280,24 +1330,9 @@ socket_send(net_socket* socket, msghdr* header, const void* data, size_t length,
 		}
 	}
 
-	if (addressLength == 0)
-		address = NULL;
-	else if (address == NULL)
-		return B_BAD_VALUE;
-
-	if (socket->peer.ss_len != 0) {
-		if (address != NULL)
-			return EISCONN;
-
-		// socket is connected, we use that address
-		address = (struct sockaddr*)&socket->peer;
-		addressLength = socket->peer.ss_len;
-	}
-
-	if (address == NULL || addressLength == 0) {
-		// don't know where to send to:
-		return EDESTADDRREQ;
-	}
+	status_t addressStatus = get_send_address(socket, address, addressLength);
+	if (addressStatus != B_OK)
+		return addressStatus;
 
 	if ((socket->first_info->flags & NET_PROTOCOL_ATOMIC_MESSAGES) != 0
 		&& bytesLeft > socket->send.buffer_size)
@@ -1422,6 +1457,331 @@ socket_send(net_socket* socket, msghdr* header, const void* data, size_t length,
 }
 
 
+/*!	Sends the \a length bytes at \a data without copying them into buffers
+	of the stack, if the protocol allows for this; the memory is released
+	by calling \a release with \a cookie once it is no longer needed. This
+	also happens when the call fails, so the caller must not touch the
+	memory anymore after it returned.
+	Protocols that need to copy the data anyway, or preserve message
+	boundaries, fall back to a regular socket_send().
+*/
+ssize_t
+socket_send_external(net_socket* socket, const void* data, size_t length,
+	int flags, net_buffer_release_func release, void* cookie)
+{
+	if (socket->peer.ss_len == 0
+		|| socket->first_info->send_data_no_buffer != NULL
+		|| (socket->first_info->flags & NET_PROTOCOL_ATOMIC_MESSAGES) != 0) {
+		ssize_t bytesSent = socket_send(socket, NULL, data, length, flags);
+		release(cookie);
+		return bytesSent;
+	}
+
+	const bool nosignal = ((flags & MSG_NOSIGNAL) != 0);
+	flags &= ~MSG_NOSIGNAL;
+
+	if (length > SSIZE_MAX) {
+		release(cookie);
+		return B_BAD_VALUE;
+	}
+
+	net_buffer* buffer = gNetBufferModule.create(256);
+	if (buffer == NULL) {
+		release(cookie);
+		return ENOBUFS;
+	}
+
+	status_t status = gNetBufferModule.append_external(buffer, data, length,
+		release, cookie);
+	if (status != B_OK) {
+		gNetBufferModule.free(buffer);
+		return status;
+	}
+
+	buffer->msg_flags = flags;
+	memcpy(buffer->source, &socket->address, socket->address.ss_len);
+	memcpy(buffer->destination, &socket->peer, socket->peer.ss_len);
+
+	status = socket->first_info->send_data(socket->first_protocol, buffer);
+	if (status != B_OK) {
+		// we only send signals when called from userland
+		if (status == EPIPE && is_syscall() && !nosignal)
+			send_signal(find_thread(NULL), SIGPIPE);
+
+		size_t sizeAfterSend = buffer->size;
+		gNetBufferModule.free(buffer);
+
+		if (sizeAfterSend != length
+			&& (status == B_INTERRUPTED || status == B_WOULD_BLOCK)) {
+			// this appears to be a partial write
+			return length - sizeAfterSend;
+		}
+		return status;
+	}
+
+	return length;
+}
+
+
+/*!	Creates a buffer containing the datagram described by \a header, with
+	its ancillary data attached, ready to be passed to the protocol.
+	This is only used for protocols that preserve message boundaries.
+*/
+static status_t
+create_datagram(net_socket* socket, const msghdr& header, int flags,
+	net_buffer** _buffer)
+{
+	const sockaddr* address = (const sockaddr*)header.msg_name;
+	socklen_t addressLength = header.msg_namelen;
+	status_t status = get_send_address(socket, address, addressLength);
+	if (status != B_OK)
+		return status;
+
+	size_t length = 0;
+	for (int i = 0; i < header.msg_iovlen; i++)
+		length += header.msg_iov[i].iov_len;
+	if (length > socket->send.buffer_size)
+		return EMSGSIZE;
+
+	if (socket->address.ss_len == 0) {
+		// try to bind first
+		status = socket_bind(socket, NULL, 0);
+		if (status != B_OK)
+			return status;
+	}
+
+	net_buffer* buffer = gNetBufferModule.create(256);
+	if (buffer == NULL)
+		return ENOBUFS;
+
+	for (int i = 0; i < header.msg_iovlen; i++) {
+		const iovec& vec = header.msg_iov[i];
+		if (vec.iov_len == 0)
+			continue;
+
+		if (gNetBufferModule.append(buffer, vec.iov_base, vec.iov_len)
+				!= B_OK) {
+			gNetBufferModule.free(buffer);
+			return ENOBUFS;
+		}
+	}
+
+	if (header.msg_control != NULL) {
+		ancillary_data_container* ancillaryData
+			= create_ancillary_data_container();
+		if (ancillaryData == NULL) {
+			gNetBufferModule.free(buffer);
+			return B_NO_MEMORY;
+		}
+
+		// the buffer owns the container from now on
+		gNetBufferModule.set_ancillary_data(buffer, ancillaryData);
+
+		status = add_ancillary_data(socket, ancillaryData,
+			(cmsghdr*)header.msg_control, header.msg_controllen);
+		if (status != B_OK) {
+			gNetBufferModule.free(buffer);
+			return status;
+		}
+	}
+
+	buffer->msg_flags = flags;
+	memcpy(buffer->source, &socket->address, socket->address.ss_len);
+	memcpy(buffer->destination, address, addressLength);
+	buffer->destination->sa_len = addressLength;
+
+	*_buffer = buffer;
+	return B_OK;
+}
+
+
+/*!	Sends up to \a count messages, and stores the number of bytes sent for
+	each of them in its \c msg_len field.
+	If the protocol supports it, the datagrams are handed over in batches,
+	so that it can share the work that would otherwise be done per datagram.
+	Returns the number of messages sent; an error is only returned if not
+	even the first message could be sent.
+*/
+ssize_t
+socket_send_batch(net_socket* socket, struct mmsghdr* messages,
+	size_t count, int flags)
+{
+	if (socket->first_info->send_data_batch == NULL
+		|| socket->first_info->send_data_no_buffer != NULL
+		|| (socket->first_info->flags & NET_PROTOCOL_ATOMIC_MESSAGES) == 0) {
+		// send the messages one by one
+		size_t sent = 0;
+		for (; sent < count; sent++) {
+			msghdr& header = messages[sent].msg_hdr;
+			void* data = NULL;
+			size_t length = 0;
+			if (header.msg_iovlen > 0) {
+				data = header.msg_iov[0].iov_base;
+				length = header.msg_iov[0].iov_len;
+			}
+
+			ssize_t bytesSent = socket_send(socket, &header, data, length,
+				flags);
+			if (bytesSent < 0) {
+				if (sent > 0)
+					break;
+				return bytesSent;
+			}
+
+			messages[sent].msg_len = bytesSent;
+		}
+
+		return sent;
+	}
+
+	const bool nosignal = ((flags & MSG_NOSIGNAL) != 0);
+	flags &= ~MSG_NOSIGNAL;
+
+	size_t sent = 0;
+	status_t status = B_OK;
+
+	while (sent < count && status == B_OK) {
+		net_buffer* buffers[MAX_BATCH_BUFFERS];
+		uint32 sizes[MAX_BATCH_BUFFERS];
+
+		size_t prepared = 0;
+		while (prepared < MAX_BATCH_BUFFERS && sent + prepared < count) {
+			status = create_datagram(socket,
+				messages[sent + prepared].msg_hdr, flags, &buffers[prepared]);
+			if (status != B_OK)
+				break;
+
+			sizes[prepared] = buffers[prepared]->size;
+			prepared++;
+		}
+
+		if (prepared == 0)
+			break;
+
+		ssize_t batchSent = socket->first_info->send_data_batch(
+			socket->first_protocol, buffers, prepared);
+		if (batchSent < 0) {
+			status = batchSent;
+			batchSent = 0;
+		} else if ((size_t)batchSent < prepared && status == B_OK)
+			status = B_WOULD_BLOCK;
+
+		for (size_t i = 0; i < (size_t)batchSent; i++)
+			messages[sent + i].msg_len = sizes[i];
+		for (size_t i = batchSent; i < prepared; i++)
+			gNetBufferModule.free(buffers[i]);
+
+		sent += batchSent;
+	}
+
+	if (sent > 0)
+		return sent;
+
+	// we only send signals when called from userland
+	if (status == EPIPE && is_syscall() && !nosignal)
+		send_signal(find_thread(NULL), SIGPIPE);
+
+	return status;
+}
+
+
+/*!	Receives up to \a count messages, and stores the number of bytes
+	received for each of them in its \c msg_len field.
+	Unless \c MSG_WAITFORONE is given, this waits until either all messages
+	have been received, or the absolute \a deadline has passed. Protocols
+	that cannot return their buffers in batches only check the deadline in
+	between messages, though.
+	Returns the number of messages received; an error is only returned if
+	not even the first message could be received.
+*/
+ssize_t
+socket_receive_batch(net_socket* socket, struct mmsghdr* messages,
+	size_t count, int flags, bigtime_t deadline)
+{
+	const bool waitForOne = (flags & MSG_WAITFORONE) != 0;
+	flags &= ~(MSG_NOSIGNAL | MSG_WAITFORONE);
+
+	size_t received = 0;
+	status_t status = B_OK;
+
+	if (socket->first_info->read_data_batch == NULL
+		|| socket->first_info->read_data_no_buffer != NULL
+		|| (flags & MSG_PEEK) != 0) {
+		// receive the messages one by one
+		while (received < count) {
+			msghdr& header = messages[received].msg_hdr;
+			void* data = NULL;
+			size_t length = 0;
+			if (header.msg_iovlen > 0) {
+				data = header.msg_iov[0].iov_base;
+				length = header.msg_iov[0].iov_len;
+			}
+
+			ssize_t bytesReceived = socket_receive(socket, &header, data,
+				length, flags);
+			if (bytesReceived < 0) {
+				status = bytesReceived;
+				break;
+			}
+
+			messages[received++].msg_len = bytesReceived;
+
+			if (waitForOne)
+				flags |= MSG_DONTWAIT;
+			if (deadline != B_INFINITE_TIMEOUT && system_time() >= deadline)
+				break;
+		}
+
+		return received > 0 ? (ssize_t)received : (ssize_t)status;
+	}
+
+	const int originalFlags = flags;
+	flags &= ~MSG_TRUNC;
+
+	while (received < count) {
+		net_buffer* buffers[MAX_BATCH_BUFFERS];
+		ssize_t fetched = socket->first_info->read_data_batch(
+			socket->first_protocol, min_c(count - received, MAX_BATCH_BUFFERS),
+			flags, deadline, buffers);
+		if (fetched <= 0) {
+			// zero buffers means the receiving side has been shut down
+			status = fetched;
+			break;
+		}
+
+		for (ssize_t i = 0; i < fetched; i++) {
+			msghdr& header = messages[received].msg_hdr;
+			void* data = NULL;
+			size_t length = 0;
+			if (header.msg_iovlen > 0) {
+				data = header.msg_iov[0].iov_base;
+				length = header.msg_iov[0].iov_len;
+			}
+
+			ssize_t bytesReceived = receive_buffer(socket, buffers[i], &header,
+				data, length, flags, originalFlags);
+			if (bytesReceived < 0) {
+				for (ssize_t j = i + 1; j < fetched; j++)
+					gNetBufferModule.free(buffers[j]);
+
+				status = bytesReceived;
+				break;
+			}
+
+			messages[received++].msg_len = bytesReceived;
+		}
+
+		if (status != B_OK)
+			break;
+
+		if (waitForOne)
+			flags |= MSG_DONTWAIT;
+	}
+
+	return received > 0 ? (ssize_t)received : (ssize_t)status;
+}
+
+
 status_t
 socket_set_option(net_socket* socket, int level, int option, const void* value,
 	int length)
@@ -1704,6 +2064,9 @@ net_socket_module_info gNetSocketModule = {
 	socket_listen,
 	socket_receive,
 	socket_send,
+	socket_send_external,
+	socket_send_batch,
+	socket_receive_batch,
 	socket_setsockopt,
 	socket_shutdown,
 	socket_socketpair
@@ -119,6 +119,19 @@ stack_interface_recvmsg(net_socket* socket, struct msghdr* message, int flags)
 }
 
 
+static ssize_t
+stack_interface_recvmmsg(net_socket* socket, struct mmsghdr* messages,
+	size_t count, int flags, bigtime_t timeout)
+{
+	bigtime_t deadline = B_INFINITE_TIMEOUT;
+	if (timeout != B_INFINITE_TIMEOUT)
+		deadline = system_time() + timeout;
+
+	return gNetSocketModule.receive_batch(socket, messages, count, flags,
+		deadline);
+}
+
+
 static ssize_t
 stack_interface_send(net_socket* socket, const void* data, size_t length,
 	int flags)
@@ -161,6 +174,23 @@ stack_interface_sendmsg(net_socket* socket, const struct msghdr* message,
 }
 
 
+static ssize_t
+stack_interface_sendmmsg(net_socket* socket, struct mmsghdr* messages,
+	size_t count, int flags)
+{
+	return gNetSocketModule.send_batch(socket, messages, count, flags);
+}
+
+
+static ssize_t
+stack_interface_send_external(net_socket* socket, const void* data,
+	size_t length, int flags, void (*release)(void* cookie), void* cookie)
+{
+	return gNetSocketModule.send_external(socket, data, length, flags, release,
+		cookie);
+}
+
+
 static status_t
 stack_interface_getsockopt(net_socket* socket, int level, int option,
 	void* value, socklen_t* _length)
@@ -279,10 +309,13 @@ net_stack_interface_module_info gNetStackInterfaceModule = {
 	&stack_interface_recv,
 	&stack_interface_recvfrom,
 	&stack_interface_recvmsg,
+	&stack_interface_recvmmsg,
 
 	&stack_interface_send,
 	&stack_interface_sendto,
 	&stack_interface_sendmsg,
+	&stack_interface_sendmmsg,
+	&stack_interface_send_external,
 
 	&stack_interface_getsockopt,
 	&stack_interface_setsockopt,
@@ -1,5 +1,5 @@
 /*
- * Copyright 2006-2013, Haiku, Inc. All Rights Reserved.
+ * Copyright 2006-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -18,6 +18,7 @@
 #include <util/AutoLock.h>
 
 #include "stack_private.h"
+#include "TimerWheel.h"
 
 
 //#define TRACE_UTILITY
@@ -28,7 +29,7 @@
 #endif
 
 
-static struct list sTimers;
+static TimerWheel<net_timer> sTimerWheel;
 static mutex sTimerLock;
 static sem_id sTimerWaitSem;
 static ConditionVariable sWaitForTimerCondition;
@@ -330,37 +331,37 @@ timer_thread(void* /*data*/)
 		bigtime_t timeout = B_INFINITE_TIMEOUT;
 
 		if (status == B_TIMED_OUT || status == B_OK) {
-			// scan timers for new timeout and/or execute a timer
+			// collect expired timers, and execute them
 			mutex_lock(&sTimerLock);
 
-			struct net_timer* timer = NULL;
-			while (true) {
-				timer = (net_timer*)list_get_next_item(&sTimers, timer);
-				if (timer == NULL)
-					break;
+			struct list expired;
+			list_init(&expired);
 
-				if (timer->due < system_time()) {
-					// execute timer
-					list_remove_item(&sTimers, timer);
-					timer->due = -1;
-					sCurrentTimer = timer;
-
-					mutex_unlock(&sTimerLock);
-					timer->hook(timer, timer->data);
-					mutex_lock(&sTimerLock);
-
-					sCurrentTimer = NULL;
-					sWaitForTimerCondition.NotifyAll();
-
-					timer = NULL;
-						// restart scanning as we unlocked the list
-				} else {
-					// calculate new timeout
-					if (timer->due < timeout)
-						timeout = timer->due;
+			while (true) {
+				net_timer* timer = (net_timer*)list_get_first_item(&expired);
+				if (timer == NULL) {
+					if (!sTimerWheel.Advance(system_time(), &expired))
+						break;
+					continue;
 				}
+
+				// execute timer
+				sTimerWheel.Remove(timer);
+				timer->due = -1;
+				sCurrentTimer = timer;
+
+				mutex_unlock(&sTimerLock);
+				timer->hook(timer, timer->data);
+				mutex_lock(&sTimerLock);
+
+				sCurrentTimer = NULL;
+				sWaitForTimerCondition.NotifyAll();
+					// the remaining expired timers might have been canceled
+					// or rescheduled in the mean time, which removes them
+					// from the list
 			}
 
+			timeout = sTimerWheel.NextTimeout();
 			sTimerTimeout = timeout;
 			mutex_unlock(&sTimerLock);
 		}
@@ -407,18 +408,17 @@ set_timer(net_timer* timer, bigtime_t delay)
 
 	TRACE("set_timer %p, hook %p, data %p\n", timer, timer->hook, timer->data);
 
-	if (timer->due > 0 && delay < 0) {
+	if (timer->due > 0) {
 		// this timer is scheduled, cancel it
-		list_remove_item(&sTimers, timer);
+		sTimerWheel.Remove(timer);
 		timer->due = 0;
 	}
 
 	if (delay >= 0) {
 		// reschedule or add this timer
-		if (timer->due <= 0)
-			list_add_item(&sTimers, timer);
-
-		timer->due = system_time() + delay;
+		bigtime_t now = system_time();
+		timer->due = now + delay;
+		sTimerWheel.Add(timer, now);
 
 		// notify timer about the change if necessary
 		if (sTimerTimeout > timer->due)
@@ -439,7 +439,7 @@ cancel_timer(struct net_timer* timer)
 		return false;
 
 	// this timer is scheduled, cancel it
-	list_remove_item(&sTimers, timer);
+	sTimerWheel.Remove(timer);
 	timer->due = 0;
 	return true;
 }
@@ -486,21 +486,24 @@ is_timer_running(net_timer* timer)
 }
 
 
+static void
+dump_timer_entry(net_timer* timer)
+{
+	kprintf("%p  %p  %p  %" B_PRId64 "\n", timer, timer->hook, timer->data,
+		timer->due > 0 ? timer->due - system_time() : -1);
+}
+
+
 static int
 dump_timer(int argc, char** argv)
 {
 	kprintf("timer       hook        data        due in\n");
 
-	struct net_timer* timer = NULL;
-	while (true) {
-		timer = (net_timer*)list_get_next_item(&sTimers, timer);
-		if (timer == NULL)
-			break;
-
-		kprintf("%p  %p  %p  %" B_PRId64 "\n", timer, timer->hook, timer->data,
-			timer->due > 0 ? timer->due - system_time() : -1);
-	}
+	sTimerWheel.Visit(&dump_timer_entry);
 
+	kprintf("%" B_PRId32 " timers, next timeout in %" B_PRId64 "\n",
+		sTimerWheel.Count(), sTimerTimeout != B_INFINITE_TIMEOUT
+			? sTimerTimeout - system_time() : -1);
 	return 0;
 }
 
@@ -508,7 +511,7 @@ dump_timer(int argc, char** argv)
 status_t
 init_timers(void)
 {
-	list_init(&sTimers);
+	sTimerWheel.Init(system_time());
 	sTimerTimeout = B_INFINITE_TIMEOUT;
 
 	status_t status = B_OK;
@@ -1,5 +1,6 @@
 /*
  * Copyright 2009-2014, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -11,6 +12,7 @@
 #include "RemoteMessage.h"
 #include "RemoteView.h"
 #include "StreamingRingBuffer.h"
+#include "TileCodec.h"
 
 #include <Application.h>
 #include <Autolock.h>
@@ -67,6 +69,7 @@ RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort)
 	fStopThread(false),
 	fOffscreenBitmap(NULL),
 	fOffscreen(NULL),
+	fTileDecoder(NULL),
 	fViewCursor(kCursorData),
 	fCursorBitmap(NULL),
 	fCursorVisible(false)
@@ -142,6 +145,9 @@ RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort)
 	fOffscreenBitmap->AddChild(fOffscreen);
 	fOffscreen->SetDrawingMode(B_OP_COPY);
 
+	// without it, bitmaps are just not sent in tiles
+	fTileDecoder = new(std::nothrow) TileDecoder;
+
 	fDrawThread = spawn_thread(&_DrawEntry, "draw thread", B_NORMAL_PRIORITY,
 		this);
 	if (fDrawThread < 0) {
@@ -174,6 +180,8 @@ RemoteView::~RemoteView()
 
 	int32 result;
 	wait_for_thread(fDrawThread, &result);
+
+	delete fTileDecoder;
 }
 
 
@@ -476,6 +484,12 @@ RemoteView::_DrawThread()
 				if (reply.Flush() == B_OK)
 					fIsConnected = true;
 
+				if (fTileDecoder != NULL) {
+					fTileDecoder->Reset();
+					reply.Start(RP_ENABLE_TILE_ENCODING);
+					reply.Flush();
+				}
+
 				continue;
 			}
 
@@ -775,6 +789,33 @@ RemoteView::_DrawThread()
 				break;
 			}
 
+			case RP_DRAW_BITMAP_TILES:
+			{
+				BBitmap *bitmap;
+				BRect bitmapRect, viewRect;
+				uint32 options;
+
+				message.Read(bitmapRect);
+				message.Read(viewRect);
+				message.Read(options);
+				if (fTileDecoder == NULL)
+					continue;
+
+				if (fTileDecoder->ReadBitmap(message, &bitmap) != B_OK) {
+					// our tile cache no longer matches the server's, have
+					// both start over
+					fTileDecoder->Reset();
+					reply.Start(RP_ENABLE_TILE_ENCODING);
+					reply.Flush();
+					continue;
+				}
+
+				offscreen->DrawBitmap(bitmap, bitmapRect, viewRect, options);
+				invalidRegion.Include(viewRect);
+				delete bitmap;
+				break;
+			}
+
 			case RP_DRAW_BITMAP_RECTS:
 			{
 				color_space colorSpace;
@@ -1,5 +1,6 @@
 /*
  * Copyright 2009, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -17,6 +18,7 @@ class BBitmap;
 class NetReceiver;
 class NetSender;
 class StreamingRingBuffer;
+class TileDecoder;
 
 struct engine_state;
 
@@ -75,6 +77,7 @@ static	int32						_DrawEntry(void *data);
 
 		BBitmap *					fOffscreenBitmap;
 		BView *						fOffscreen;
+		TileDecoder *				fTileDecoder;
 
 		BCursor						fViewCursor;
 		BBitmap *					fCursorBitmap;
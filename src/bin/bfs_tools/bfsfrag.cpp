@@ -0,0 +1,220 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Released under the terms of the MIT license.
+ */
+
+
+//!	Reports how fragmented the data streams of files on BFS volumes are
+
+
+#include "Disk.h"
+#include "Inode.h"
+
+#include <fs_info.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+
+struct fragment_stats {
+	off_t	runs;
+	off_t	extents;
+		// runs that directly follow their predecessor on disk are counted
+		// as one extent
+	off_t	covered;
+	off_t	lastBlock;
+};
+
+
+static bool sVerbose = false;
+
+
+static void
+add_run(Disk& disk, const block_run& run, off_t size, fragment_stats& stats)
+{
+	if (run.IsZero() || stats.covered >= size)
+		return;
+
+	off_t block = disk.ToBlock(run);
+	if (stats.runs == 0 || block != stats.lastBlock)
+		stats.extents++;
+
+	if (sVerbose) {
+		printf("    %s%" B_PRId32 ".%u.%u\n",
+			block != stats.lastBlock ? "" : "  + ",
+			run.allocation_group, run.start, run.length);
+	}
+
+	stats.runs++;
+	stats.covered += (off_t)run.length << disk.BlockShift();
+	stats.lastBlock = block + run.length;
+}
+
+
+static status_t
+add_run_array(Disk& disk, const block_run& arrayRun, off_t size, int32 levels,
+	fragment_stats& stats)
+{
+	size_t bytes = (size_t)arrayRun.length << disk.BlockShift();
+	block_run* array = (block_run*)malloc(bytes);
+	if (array == NULL)
+		return B_NO_MEMORY;
+
+	if (disk.ReadAt(disk.ToOffset(arrayRun), array, bytes) != (ssize_t)bytes) {
+		free(array);
+		return B_IO_ERROR;
+	}
+
+	status_t status = B_OK;
+	int32 count = bytes / sizeof(block_run);
+	for (int32 i = 0; i < count && status == B_OK; i++) {
+		if (array[i].IsZero() || stats.covered >= size)
+			break;
+
+		if (levels > 1)
+			status = add_run_array(disk, array[i], size, levels - 1, stats);
+		else
+			add_run(disk, array[i], size, stats);
+	}
+
+	free(array);
+	return status;
+}
+
+
+static status_t
+get_stats(Disk& disk, Inode* inode, fragment_stats& stats)
+{
+	memset(&stats, 0, sizeof(stats));
+
+	const data_stream& data = inode->InodeBuffer()->data;
+	off_t size = data.size;
+
+	for (int32 i = 0; i < NUM_DIRECT_BLOCKS; i++)
+		add_run(disk, data.direct[i], size, stats);
+
+	status_t status = B_OK;
+	if (!data.indirect.IsZero())
+		status = add_run_array(disk, data.indirect, size, 1, stats);
+	if (status == B_OK && !data.double_indirect.IsZero())
+		status = add_run_array(disk, data.double_indirect, size, 2, stats);
+
+	return status;
+}
+
+
+static void
+print_usage(const char* tool)
+{
+	const char* name = strrchr(tool, '/');
+	fprintf(stderr, "usage: %s [-v] <file> ...\n"
+		"Shows how many block runs, and how many separate extents on disk\n"
+		"the data of the files on a BFS volume consists of.\n"
+		"  -v  also list all block runs; runs that continue the previous one\n"
+		"      are marked with a \"+\".\n", name != NULL ? name + 1 : tool);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 first = 1;
+	if (argc > 1 && !strcmp(argv[1], "-v")) {
+		sVerbose = true;
+		first++;
+	}
+	if (first >= argc || !strcmp(argv[1], "--help")) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	Disk* disk = NULL;
+	dev_t device = -1;
+
+	off_t files = 0;
+	off_t totalExtents = 0;
+	off_t totalRuns = 0;
+	off_t maxExtents = 0;
+	const char* worstFile = NULL;
+
+	for (int32 i = first; i < argc; i++) {
+		const char* path = argv[i];
+
+		struct stat st;
+		if (stat(path, &st) != 0) {
+			fprintf(stderr, "%s: %s\n", path, strerror(errno));
+			continue;
+		}
+		if (!S_ISREG(st.st_mode))
+			continue;
+
+		if (st.st_dev != device) {
+			fs_info info;
+			if (fs_stat_dev(st.st_dev, &info) != 0
+				|| strcmp(info.fsh_name, "bfs")) {
+				fprintf(stderr, "%s: not on a BFS volume\n", path);
+				continue;
+			}
+
+			delete disk;
+			disk = new Disk(info.device_name);
+			device = st.st_dev;
+
+			if (disk->InitCheck() != B_OK
+				|| disk->ValidateSuperBlock() != B_OK) {
+				fprintf(stderr, "%s: could not open device \"%s\"\n", path,
+					info.device_name);
+				delete disk;
+				disk = NULL;
+				device = -1;
+				continue;
+			}
+		}
+
+		Inode* inode = Inode::Factory(disk, disk->ToBlockRun(st.st_ino));
+		if (inode == NULL || inode->InitCheck() != B_OK) {
+			fprintf(stderr, "%s: could not read inode\n", path);
+			delete inode;
+			continue;
+		}
+
+		if (sVerbose)
+			printf("%s:\n", path);
+
+		fragment_stats stats;
+		status_t status = get_stats(*disk, inode, stats);
+		delete inode;
+
+		if (status != B_OK) {
+			fprintf(stderr, "%s: could not read block runs: %s\n", path,
+				strerror(status));
+			continue;
+		}
+
+		printf("%6" B_PRIdOFF " extents %6" B_PRIdOFF " runs %12" B_PRIdOFF
+			" bytes  %s\n", stats.extents, stats.runs, (off_t)st.st_size, path);
+
+		files++;
+		totalExtents += stats.extents;
+		totalRuns += stats.runs;
+		if (stats.extents > maxExtents) {
+			maxExtents = stats.extents;
+			worstFile = path;
+		}
+	}
+
+	delete disk;
+
+	if (files > 1) {
+		printf("\n%" B_PRIdOFF " files, %" B_PRIdOFF " extents, %" B_PRIdOFF
+			" runs, %.2f extents per file\n", files, totalExtents, totalRuns,
+			(double)totalExtents / files);
+		printf("most fragmented: %s (%" B_PRIdOFF " extents)\n", worstFile,
+			maxExtents);
+	}
+
+	return 0;
+}
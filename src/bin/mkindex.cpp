@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2003-2005, Haiku
+ * Copyright (c) 2003-2026, Haiku
  *
  * This software is part of the Haiku distribution and is covered
  * by the MIT license.
@@ -14,6 +14,7 @@
 
 #include <fs_info.h>
 #include <fs_index.h>
+#include <fs_query.h>
 #include <TypeConstants.h>
 #include <Directory.h>
 #include <Path.h>
@@ -24,12 +25,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include <file_systems/QueryParserUtils.h>
+
+#include "bfs_control.h"
 
 
 static struct option const kLongOptions[] = {
 	{"volume", required_argument, 0, 'd'},
 	{"type", required_argument, 0, 't'},
 	{"copy-from", required_argument, 0, 'f'},
+	{"trigram", no_argument, 0, 'T'},
 	{"verbose", no_argument, 0, 'v'},
 	{"help", no_argument, 0, 'h'},
 	{NULL}
@@ -75,6 +84,97 @@ copy_indexes(dev_t from, dev_t to, bool verbose)
 }
 
 
+static status_t
+add_to_trigram_index(int fd, const char* indexName, int64* inodes,
+	uint32 count, uint32 flags, int64& added)
+{
+	bfs_bulk_index bulk;
+	bulk.name = indexName;
+	bulk.inodes = inodes;
+	bulk.count = count;
+	bulk.flags = flags;
+	bulk.inserted = 0;
+	if (ioctl(fd, BFS_IOCTL_BULK_INDEX, &bulk, sizeof(bulk)) != 0)
+		return errno;
+
+	added += bulk.inserted;
+	return B_OK;
+}
+
+
+/*!	Adds all files that already have the \a attribute to its new trigram
+	index, and then marks the index as complete. Until then, queries won't
+	use it, as it would miss those files.
+	The files are found through the regular index of the attribute, so that
+	one has to be complete.
+*/
+static int
+fill_trigram_index(dev_t device, const char* attribute,
+	const char* indexName, bool verbose)
+{
+	BVolume volume(device);
+	BDirectory root;
+	volume.GetRootDirectory(&root);
+	BPath path(&root, NULL);
+
+	int fd = open(path.Path(), O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "%s: Could not open volume: %s\n", kProgramName,
+			strerror(errno));
+		return 1;
+	}
+
+	char predicate[B_FILE_NAME_LENGTH + 16];
+	snprintf(predicate, sizeof(predicate), "%s==\"*\"", attribute);
+
+	DIR* query = fs_open_query(device, predicate, 0);
+	if (query == NULL) {
+		fprintf(stderr, "%s: Could not look up the files with attribute "
+			"\"%s\": %s\n", kProgramName, attribute, strerror(errno));
+		close(fd);
+		return 1;
+	}
+
+	int64 inodes[BFS_BULK_INDEX_MAX_INODES];
+	uint32 count = 0;
+	int64 added = 0;
+	status_t status = B_OK;
+
+	while (dirent* entry = fs_read_query(query)) {
+		inodes[count++] = entry->d_ino;
+		if (count == BFS_BULK_INDEX_MAX_INODES) {
+			status = add_to_trigram_index(fd, indexName, inodes, count, 0,
+				added);
+			if (status != B_OK)
+				break;
+			count = 0;
+		}
+	}
+
+	if (status == B_OK) {
+		status = add_to_trigram_index(fd, indexName, inodes, count,
+			BFS_BULK_INDEX_COMPLETE, added);
+	}
+
+	fs_close_query(query);
+	close(fd);
+
+	if (status != B_OK) {
+		fprintf(stderr, "%s: Could not fill index \"%s\": %s\n"
+			"It will not be used until \"%s --trigram %s\" succeeds.\n",
+			kProgramName, indexName, strerror(status), kProgramName,
+			attribute);
+		return 1;
+	}
+
+	if (verbose) {
+		printf("Added %" B_PRId64 " files to index \"%s\".\n", added,
+			indexName);
+	}
+	return 0;
+}
+
+
 static void
 usage(int status)
 {
@@ -88,6 +188,11 @@ usage(int status)
 		"\t\t\t\"llong\", \"string\", \"float\", or \"double\".\n"
 		"\t\t\tDefaults to \"string\".\n"
 		"      --copy-from\tpath to volume to copy the indexes from.\n"
+		"  -T, --trigram\t\tcreate a trigram index for the attribute instead,\n"
+		"\t\t\twhich speeds up substring and case insensitive queries.\n"
+		"\t\t\tThe attribute must be of type \"string\", and already\n"
+		"\t\t\thave an index that the files are taken from. Running\n"
+		"\t\t\tthis again completes an index that could not be filled.\n"
 		"  -v, --verbose\t\tprint information about the index being created\n",
 		kProgramName);
 
@@ -102,10 +207,11 @@ main(int argc, char **argv)
 	int indexType = B_STRING_TYPE;
 	char *indexName = NULL;
 	bool verbose = false;
+	bool trigram = false;
 	dev_t device = -1, copyFromDevice = -1;
 
 	int c;
-	while ((c = getopt_long(argc, argv, "d:ht:v", kLongOptions, NULL)) != -1) {
+	while ((c = getopt_long(argc, argv, "d:ht:Tv", kLongOptions, NULL)) != -1) {
 		switch (c) {
 			case 0:
 				break;
@@ -143,6 +249,9 @@ main(int argc, char **argv)
 				else
 					usage(1);
 				break;
+			case 'T':
+				trigram = true;
+				break;
 			case 'v':
 				verbose = 1;
 				break;
@@ -174,6 +283,31 @@ main(int argc, char **argv)
 	} else
 		usage(1);
 
+	const char* attribute = indexName;
+	char trigramIndexName[B_FILE_NAME_LENGTH];
+	if (trigram) {
+		index_info info;
+		if (fs_stat_index(device, attribute, &info) != 0) {
+			fprintf(stderr, "%s: The attribute \"%s\" needs to be indexed "
+				"first\n", kProgramName, attribute);
+			return 1;
+		}
+		if (indexType != B_STRING_TYPE || (info.type != B_STRING_TYPE
+				&& info.type != B_MIME_STRING_TYPE)) {
+			fprintf(stderr, "%s: Trigram indices only work for strings\n",
+				kProgramName);
+			return 1;
+		}
+		if (snprintf(trigramIndexName, sizeof(trigramIndexName), "%s%s",
+				indexName, TRIGRAM_INDEX_SUFFIX)
+					>= (int)sizeof(trigramIndexName)) {
+			fprintf(stderr, "%s: Attribute name is too long\n", kProgramName);
+			return 1;
+		}
+		indexName = trigramIndexName;
+		indexTypeName = "trigram";
+	}
+
 	if (verbose) {
 		/* Get the mount point of the specified volume. */
 		BVolume volume(device);
@@ -185,8 +319,18 @@ main(int argc, char **argv)
 			indexName, indexTypeName, path.Path());
 	}
 
-	if (fs_create_index(device, indexName, indexType, 0) != 0)
-		fprintf(stderr, "%s: Could not create index: %s\n", kProgramName, strerror(errno));
+	if (fs_create_index(device, indexName, indexType, 0) != 0) {
+		// an existing trigram index is filled again, in case that failed
+		// the last time
+		if (!trigram || errno != B_FILE_EXISTS) {
+			fprintf(stderr, "%s: Could not create index: %s\n", kProgramName,
+				strerror(errno));
+			return 0;
+		}
+	}
+
+	if (trigram)
+		return fill_trigram_index(device, attribute, indexName, verbose);
 
 	return 0;
 }
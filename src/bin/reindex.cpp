@@ -1,15 +1,21 @@
 /*
  * Copyright 2001-2009, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * This file may be used under the terms of the MIT License.
  */
 
 
+#include <algorithm>
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <new>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <vector>
 
 #include <Directory.h>
 #include <Entry.h>
@@ -22,6 +28,10 @@
 #include <fs_index.h>
 #include <fs_info.h>
 
+#include <file_systems/QueryParserUtils.h>
+
+#include "bfs_control.h"
+
 
 extern const char *__progname;
 static const char *kProgramName = __progname;
@@ -32,6 +42,7 @@ char *gAttrPattern;
 bool gIsPattern = false;
 bool gFromVolume = false;	// copy indices from another volume
 BList gAttrList;				// list of indices of that volume
+bool gBulk = true;				// add files to the indices directly
 
 
 class Attribute {
@@ -162,6 +173,417 @@ isAttrInList(char *name)
 }
 
 
+//	#pragma mark - bulk indexing
+
+
+static const size_t kMaxKeyLength = 255;
+	// BFS only indexes that many bytes of an attribute
+static const size_t kSortBufferSize = 16 * 1024 * 1024;
+
+
+/*!	An index on a specific volume that files are added to; \c fd is any
+	file on that volume that can be used to issue the ioctl.
+*/
+struct index_target {
+	dev_t		device;
+	char		*name;
+	type_code	type;
+	int			fd;
+	int64		added;
+};
+
+struct index_entry {
+	uint32		target;
+	int64		inode;
+	uint16		length;
+	uint8		key[0];
+};
+
+
+BList gTargets;
+BList gUnsupportedDevices;
+
+
+static bool
+entryLess(const index_entry *a, const index_entry *b)
+{
+	if (a->target != b->target)
+		return a->target < b->target;
+
+	index_target *target = (index_target *)gTargets.ItemAt(a->target);
+	// this must sort the keys the same way BFS does
+	int compare = QueryParser::compareKeys(target->type, a->key, a->length,
+		b->key, b->length);
+	if (compare != 0)
+		return compare < 0;
+
+	return a->inode < b->inode;
+}
+
+
+/*!	Sorts the index entries of all files, using temporary files for the
+	sorted runs if they don't fit into memory, and merging them afterwards.
+*/
+class EntrySorter {
+public:
+	EntrySorter();
+	~EntrySorter();
+
+	status_t Add(uint32 target, int64 inode, const uint8 *key,
+		uint16 length);
+	status_t Finish();
+	const index_entry *Next();
+
+private:
+	status_t _WriteRun();
+	const index_entry *_ReadEntry(int32 run);
+
+	uint8		*fBuffer;
+	size_t		fUsed;
+	std::vector<index_entry *> fEntries;
+	size_t		fNext;
+	std::vector<FILE *> fRuns;
+	std::vector<index_entry *> fHeads;
+	index_entry	*fMergeEntry;
+};
+
+
+EntrySorter::EntrySorter()
+	:
+	fBuffer(NULL),
+	fUsed(0),
+	fNext(0),
+	fMergeEntry(NULL)
+{
+}
+
+
+EntrySorter::~EntrySorter()
+{
+	for (size_t i = 0; i < fRuns.size(); i++) {
+		fclose(fRuns[i]);
+		free(fHeads[i]);
+	}
+	free(fMergeEntry);
+	free(fBuffer);
+}
+
+
+status_t
+EntrySorter::Add(uint32 target, int64 inode, const uint8 *key, uint16 length)
+{
+	size_t size = (sizeof(index_entry) + length + 7) & ~7;
+	if (fBuffer == NULL) {
+		fBuffer = (uint8 *)malloc(kSortBufferSize);
+		if (fBuffer == NULL)
+			return B_NO_MEMORY;
+	}
+	if (fUsed + size > kSortBufferSize) {
+		status_t status = _WriteRun();
+		if (status != B_OK)
+			return status;
+	}
+
+	index_entry *entry = (index_entry *)(fBuffer + fUsed);
+	entry->target = target;
+	entry->inode = inode;
+	entry->length = length;
+	memcpy(entry->key, key, length);
+
+	try {
+		fEntries.push_back(entry);
+	} catch (...) {
+		return B_NO_MEMORY;
+	}
+
+	fUsed += size;
+	return B_OK;
+}
+
+
+/*!	Must be called after all entries have been added, before they can be
+	retrieved in sorted order via Next().
+*/
+status_t
+EntrySorter::Finish()
+{
+	if (fRuns.empty()) {
+		// everything fit into memory
+		std::sort(fEntries.begin(), fEntries.end(), entryLess);
+		fNext = 0;
+		return B_OK;
+	}
+
+	status_t status = _WriteRun();
+	if (status != B_OK)
+		return status;
+
+	fMergeEntry = (index_entry *)malloc(sizeof(index_entry) + kMaxKeyLength);
+	if (fMergeEntry == NULL)
+		return B_NO_MEMORY;
+
+	for (size_t i = 0; i < fRuns.size(); i++) {
+		rewind(fRuns[i]);
+		fHeads.push_back((index_entry *)malloc(sizeof(index_entry)
+			+ kMaxKeyLength));
+		if (fHeads[i] == NULL)
+			return B_NO_MEMORY;
+		if (_ReadEntry(i) == NULL)
+			fHeads[i]->length = 0;
+	}
+	return B_OK;
+}
+
+
+const index_entry *
+EntrySorter::Next()
+{
+	if (fRuns.empty()) {
+		if (fNext >= fEntries.size())
+			return NULL;
+		return fEntries[fNext++];
+	}
+
+	// merge the runs; there are usually only a few of them
+
+	int32 best = -1;
+	for (size_t i = 0; i < fRuns.size(); i++) {
+		if (fHeads[i]->length == 0)
+			continue;
+		if (best < 0 || entryLess(fHeads[i], fHeads[best]))
+			best = i;
+	}
+	if (best < 0)
+		return NULL;
+
+	memcpy(fMergeEntry, fHeads[best],
+		sizeof(index_entry) + fHeads[best]->length);
+	if (_ReadEntry(best) == NULL)
+		fHeads[best]->length = 0;
+
+	return fMergeEntry;
+}
+
+
+status_t
+EntrySorter::_WriteRun()
+{
+	std::sort(fEntries.begin(), fEntries.end(), entryLess);
+
+	FILE *file = tmpfile();
+	if (file == NULL)
+		return errno;
+
+	try {
+		fRuns.push_back(file);
+	} catch (...) {
+		fclose(file);
+		return B_NO_MEMORY;
+	}
+
+	for (size_t i = 0; i < fEntries.size(); i++) {
+		index_entry *entry = fEntries[i];
+		if (fwrite(entry, sizeof(index_entry) + entry->length, 1, file) != 1)
+			return errno;
+	}
+
+	if (gVerbose) {
+		printf("wrote %ld sorted entries to temporary file\n",
+			(long)fEntries.size());
+	}
+
+	fEntries.clear();
+	fUsed = 0;
+	return B_OK;
+}
+
+
+const index_entry *
+EntrySorter::_ReadEntry(int32 run)
+{
+	index_entry *entry = fHeads[run];
+	if (fread(entry, sizeof(index_entry), 1, fRuns[run]) != 1
+		|| entry->length == 0 || entry->length > kMaxKeyLength
+		|| fread(entry->key, entry->length, 1, fRuns[run]) != 1)
+		return NULL;
+
+	return entry;
+}
+
+
+EntrySorter gSorter;
+
+
+/*!	Returns the index of the target for the index \a name on the volume
+	of the \a node, creating it if necessary. Returns -1 if the volume
+	does not support adding files to its indices directly.
+*/
+int32
+getTarget(const struct stat &stat, BEntry *entry, const char *name)
+{
+	for (int32 i = 0; i < gTargets.CountItems(); i++) {
+		index_target *target = (index_target *)gTargets.ItemAt(i);
+		if (target->device == stat.st_dev && !strcmp(target->name, name))
+			return i;
+	}
+
+	if (gUnsupportedDevices.HasItem((void *)(addr_t)stat.st_dev))
+		return -1;
+
+	index_info info;
+	if (fs_stat_index(stat.st_dev, name, &info) != 0)
+		return -1;
+
+	BPath path;
+	if (entry->GetPath(&path) != B_OK)
+		return -1;
+
+	int fd = open(path.Path(), O_RDONLY | O_NOTRAVERSE);
+	if (fd < 0)
+		return -1;
+
+	// check if the file system supports the ioctl at all
+	bfs_bulk_index bulk;
+	bulk.name = name;
+	bulk.inodes = NULL;
+	bulk.count = 0;
+	bulk.flags = 0;
+	if (ioctl(fd, BFS_IOCTL_BULK_INDEX, &bulk, sizeof(bulk)) != 0) {
+		close(fd);
+		gUnsupportedDevices.AddItem((void *)(addr_t)stat.st_dev);
+		return -1;
+	}
+
+	index_target *target = new(std::nothrow) index_target;
+	if (target == NULL || (target->name = strdup(name)) == NULL) {
+		fprintf(stderr, "%s: out of memory.\n", kProgramName);
+		exit(1);
+	}
+	target->device = stat.st_dev;
+	target->type = info.type;
+	target->fd = fd;
+	target->added = 0;
+	gTargets.AddItem(target);
+
+	return gTargets.CountItems() - 1;
+}
+
+
+/*!	Adds the indexed attributes of the \a node to the list of entries that
+	will be added to the indices later.
+	Returns \c false if that is not possible, and the attributes need to be
+	rewritten instead.
+*/
+bool
+collectAttributes(BEntry *entry, BNode *node, const char *name)
+{
+	struct stat stat;
+	if (node->GetStat(&stat) != B_OK)
+		return false;
+
+	char attrName[B_ATTR_NAME_LENGTH];
+	node->RewindAttrs();
+	while (node->GetNextAttrName(attrName) == B_OK) {
+		if (gFromVolume) {
+			if (!isAttrInList(attrName))
+				continue;
+		} else if (!nameMatchesPattern(attrName))
+			continue;
+
+		attr_info info;
+		if (node->GetAttrInfo(attrName, &info) != B_OK)
+			continue;
+
+		if (!gFromVolume) {
+			// creates index to that attribute if necessary
+			index_info indexInfo;
+			if (fs_stat_index(stat.st_dev, attrName, &indexInfo) != B_OK)
+				fs_create_index(stat.st_dev, attrName, info.type, 0);
+		}
+
+		int32 target = getTarget(stat, entry, attrName);
+		if (target < 0)
+			return false;
+
+		uint8 key[kMaxKeyLength];
+		ssize_t bytesRead = node->ReadAttr(attrName, info.type, 0, key,
+			sizeof(key));
+		if (bytesRead <= 0)
+			continue;
+
+		status_t status = gSorter.Add(target, stat.st_ino, key, bytesRead);
+		if (status != B_OK) {
+			fprintf(stderr, "%s: could not store attribute \"%s\" of file "
+				"\"%s\": %s\n", kProgramName, attrName, name,
+				strerror(status));
+			exit(1);
+		}
+		if (gVerbose)
+			printf("%s: read attribute '%s'\n", name, attrName);
+	}
+
+	return true;
+}
+
+
+/*!	Adds all collected entries to their indices, sorted by key, so that
+	BFS can build densely packed index trees.
+*/
+void
+addCollectedEntries()
+{
+	status_t status = gSorter.Finish();
+	if (status != B_OK) {
+		fprintf(stderr, "%s: sorting the attributes failed: %s\n",
+			kProgramName, strerror(status));
+		exit(1);
+	}
+
+	int64 inodes[BFS_BULK_INDEX_MAX_INODES];
+	uint32 count = 0;
+	int32 current = -1;
+
+	while (true) {
+		const index_entry *entry = gSorter.Next();
+		if (count > 0 && (entry == NULL || (int32)entry->target != current
+				|| count == BFS_BULK_INDEX_MAX_INODES)) {
+			index_target *target = (index_target *)gTargets.ItemAt(current);
+
+			bfs_bulk_index bulk;
+			bulk.name = target->name;
+			bulk.inodes = inodes;
+			bulk.count = count;
+			bulk.flags = 0;
+			bulk.inserted = 0;
+			if (ioctl(target->fd, BFS_IOCTL_BULK_INDEX, &bulk,
+					sizeof(bulk)) != 0) {
+				fprintf(stderr, "%s: could not add files to index \"%s\": "
+					"%s\n", kProgramName, target->name, strerror(errno));
+			}
+			target->added += bulk.inserted;
+			count = 0;
+		}
+		if (entry == NULL)
+			break;
+
+		current = entry->target;
+		inodes[count++] = entry->inode;
+	}
+
+	for (int32 i = 0; i < gTargets.CountItems(); i++) {
+		index_target *target = (index_target *)gTargets.ItemAt(i);
+		if (gVerbose) {
+			printf("added %" B_PRId64 " files to index \"%s\"\n",
+				target->added, target->name);
+		}
+		close(target->fd);
+	}
+}
+
+
+//	#pragma mark -
+
+
 void
 handleFile(BEntry *entry, BNode *node)
 {
@@ -189,6 +611,10 @@ handleFile(BEntry *entry, BNode *node)
 		return;
 	}
 
+	// let the file system add the file to the indices later on, if possible
+	if (gBulk && collectAttributes(entry, node, name))
+		return;
+
 	// rewrite file attributes
 
 	char attrName[B_ATTR_NAME_LENGTH];
@@ -306,11 +732,13 @@ copyIndicesFromVolume(const char *path, BEntry &to)
 void
 printUsage(char *cmd)
 {
-	printf("usage: %s [-rvf] attr <list of filenames and/or directories>\n"
+	printf("usage: %s [-rvfs] attr <list of filenames and/or directories>\n"
 		"  -r\tenter directories recursively\n"
 		"  -v\tverbose output\n"
 		"  -f\tcreate/update all indices from the source volume,\n\t\"attr\" is "
-			"the path to the source volume\n", cmd);
+			"the path to the source volume\n"
+		"  -s\tdo not sort the files into the indices in one go, but rewrite\n"
+			"\tthe attributes of each file instead\n", cmd);
 }
 
 
@@ -333,6 +761,9 @@ main(int argc, char **argv)
 				case 'r':
 					gRecursive = true;
 					break;
+				case 's':
+					gBulk = false;
+					break;
 				case 'v':
 					gVerbose = true;
 					break;
@@ -358,5 +789,8 @@ main(int argc, char **argv)
 			fprintf(stderr, "%s: could not find \"%s\".\n", kProgramName, *argv);
 	}
 
+	if (gBulk)
+		addCollectedEntries();
+
 	return 0;
 }
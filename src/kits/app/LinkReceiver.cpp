@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2011, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -54,14 +55,16 @@ LinkReceiver::LinkReceiver(port_id port)
 	:
 	fReceivePort(port), fRecvBuffer(NULL), fRecvPosition(0), fRecvStart(0),
 	fRecvBufferSize(0), fDataSize(0),
-	fReplySize(0), fReadError(B_OK)
+	fReplySize(0), fReadError(B_OK),
+	fRing(NULL), fRingData(NULL), fRingSize(0), fPortBuffer(NULL),
+	fRingRelease(0)
 {
 }
 
 
 LinkReceiver::~LinkReceiver()
 {
-	free(fRecvBuffer);
+	free(fPortBuffer != NULL ? fPortBuffer : fRecvBuffer);
 }
 
 
@@ -72,6 +75,36 @@ LinkReceiver::SetPort(port_id port)
 }
 
 
+/*!	Accepts batches of messages that a LinkSender put into \a ring instead
+	of the port. The ring must stay valid until it is replaced, or until
+	the receiver is deleted.
+	Since the sender can still write to the ring, the messages in it must
+	not be trusted any more than those coming through the port.
+*/
+status_t
+LinkReceiver::SetRing(void* ring, size_t size)
+{
+	ReleaseRingBatch();
+	ResetBuffer();
+
+	fRing = NULL;
+	fRingData = NULL;
+	fRingSize = 0;
+
+	if (ring == NULL)
+		return B_OK;
+	if (size <= sizeof(link_ring_header))
+		return B_BAD_VALUE;
+
+	fRing = (link_ring_header*)ring;
+	fRingData = (char*)ring + sizeof(link_ring_header);
+	fRingSize = size - sizeof(link_ring_header);
+	memset(fRing, 0, sizeof(link_ring_header));
+
+	return B_OK;
+}
+
+
 status_t
 LinkReceiver::GetNextMessage(int32 &code, bigtime_t timeout)
 {
@@ -159,6 +192,22 @@ LinkReceiver::ResetBuffer()
 }
 
 
+/*!	Hands the space of the batch in the ring back to the sender, and goes
+	back to our own buffer.
+*/
+void
+LinkReceiver::ReleaseRingBatch()
+{
+	if (fPortBuffer == NULL)
+		return;
+
+	atomic_set(&fRing->released, (int32)fRingRelease);
+
+	fRecvBuffer = fPortBuffer;
+	fPortBuffer = NULL;
+}
+
+
 status_t
 LinkReceiver::AdjustReplyBuffer(bigtime_t timeout)
 {
@@ -219,6 +268,7 @@ LinkReceiver::ReadFromPort(bigtime_t timeout)
 {
 	// we are here so it means we finished reading the buffer contents
 	ResetBuffer();
+	ReleaseRingBatch();
 
 	status_t err = AdjustReplyBuffer(timeout);
 	if (err < B_OK)
@@ -247,6 +297,26 @@ LinkReceiver::ReadFromPort(bigtime_t timeout)
 
 		// we just ignore incorrect messages, and don't bother our caller
 
+		if (code == kLinkRingCode && fRing != NULL
+			&& bytesRead == sizeof(link_ring_batch)) {
+			link_ring_batch batch;
+			memcpy(&batch, fRecvBuffer, sizeof(batch));
+
+			if (batch.offset > fRingSize
+				|| batch.size > fRingSize - batch.offset
+				|| batch.size < sizeof(message_header)) {
+				STRACE(("invalid ring batch received.\n"));
+				continue;
+			}
+
+			// read the messages right from the ring
+			fPortBuffer = fRecvBuffer;
+			fRecvBuffer = fRingData + batch.offset;
+			fRingRelease = batch.end;
+			bytesRead = batch.size;
+			break;
+		}
+
 		if (code != kLinkCode) {
 			STRACE(("wrong port message %lx received.\n", code));
 			continue;
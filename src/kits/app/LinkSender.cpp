@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2005, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -40,6 +41,15 @@ LinkSender::LinkSender(port_id port)
 	fTargetTeam(-1),
 	fBuffer(NULL),
 	fBufferSize(0),
+	fHeapBuffer(NULL),
+	fHeapBufferSize(0),
+
+	fRing(NULL),
+	fRingData(NULL),
+	fRingSize(0),
+	fRingOffset(0),
+	fRingPosition(0),
+	fBufferInRing(false),
 
 	fCurrentEnd(0),
 	fCurrentStart(0),
@@ -50,17 +60,72 @@ LinkSender::LinkSender(port_id port)
 
 LinkSender::~LinkSender()
 {
-	free(fBuffer);
+	free(fHeapBuffer);
 }
 
 
 void
 LinkSender::SetPort(port_id port)
 {
+	if (port != fPort) {
+		// the ring is only known to the receiver of the old port
+		SetRing(NULL, 0);
+	}
+
 	fPort = port;
 }
 
 
+/*!	Lets the messages be written directly into \a ring, a memory area that
+	is shared with the receiver, who must have been told about it, too.
+	The port then only gets a short notice for each batch of messages, at
+	the same points a flush would have sent the messages themselves.
+	If the ring is full, the messages are sent through the port as usual.
+	Passing \c NULL goes back to sending everything through the port.
+*/
+status_t
+LinkSender::SetRing(void* ring, size_t size)
+{
+	if (fBufferInRing) {
+		// move what has not been sent yet out of the ring
+		char* pending = fBuffer;
+		fRing = NULL;
+		fBuffer = fHeapBuffer;
+		fBufferSize = fHeapBufferSize;
+		fBufferInRing = false;
+
+		if (fCurrentEnd > 0) {
+			status_t status = B_OK;
+			if (fCurrentEnd > fBufferSize)
+				status = AdjustBuffer(fCurrentEnd);
+			if (status != B_OK) {
+				fCurrentEnd = fCurrentStart = 0;
+				return fCurrentStatus = status;
+			}
+
+			memcpy(fBuffer, pending, fCurrentEnd);
+		}
+	}
+
+	fRing = NULL;
+	fRingData = NULL;
+	fRingSize = 0;
+
+	if (ring == NULL)
+		return B_OK;
+	if (size < sizeof(link_ring_header) + 2 * kInitialBufferSize)
+		return B_BAD_VALUE;
+
+	fRing = (link_ring_header*)ring;
+	fRingData = (char*)ring + sizeof(link_ring_header);
+	fRingSize = size - sizeof(link_ring_header);
+	fRingOffset = 0;
+	fRingPosition = (uint32)atomic_get(&fRing->released);
+
+	return B_OK;
+}
+
+
 status_t
 LinkSender::StartMessage(int32 code, size_t minSize)
 {
@@ -77,13 +142,21 @@ LinkSender::StartMessage(int32 code, size_t minSize)
 
 	// Eventually flush buffer to make space for the new message.
 	// Note, we do not take the actual buffer size into account to not
-	// delay the time between buffer flushes too much.
-	if (fBufferSize > 0 && (minSize > SpaceLeft() || fCurrentStart >= kWatermark)) {
+	// delay the time between buffer flushes too much. The ring can take
+	// larger batches, as it saves copying them through the port.
+	size_t watermark = fBufferInRing ? fRingSize / 4 : kWatermark;
+	if (fBufferSize > 0
+		&& (minSize > SpaceLeft() || fCurrentStart >= watermark)) {
 		status_t status = Flush();
 		if (status < B_OK)
 			return status;
 	}
 
+	if (fRing != NULL && !fBufferInRing && fCurrentEnd == 0) {
+		// the ring may have room again
+		ReserveRingBuffer(minSize);
+	}
+
 	if (minSize > fBufferSize) {
 		if (AdjustBuffer(minSize) != B_OK)
 			return fCurrentStatus = B_NO_MEMORY;
@@ -238,10 +311,18 @@ LinkSender::AdjustBuffer(size_t newSize, char **_oldBuffer)
 	else if (newSize > kInitialBufferSize)
 		newSize = (newSize + B_PAGE_SIZE - 1) & ~(B_PAGE_SIZE - 1);
 
-	if (newSize == fBufferSize) {
+	// the caller has to free the old buffer, if we pass one back
+	if (_oldBuffer)
+		*_oldBuffer = NULL;
+
+	if (fRing != NULL && ReserveRingBuffer(newSize))
+		return B_OK;
+
+	if (newSize == fHeapBufferSize) {
 		// keep existing buffer
-		if (_oldBuffer)
-			*_oldBuffer = fBuffer;
+		fBuffer = fHeapBuffer;
+		fBufferSize = fHeapBufferSize;
+		fBufferInRing = false;
 		return B_OK;
 	}
 
@@ -250,23 +331,61 @@ LinkSender::AdjustBuffer(size_t newSize, char **_oldBuffer)
 	if (buffer == NULL)
 		return B_NO_MEMORY;
 
-	if (_oldBuffer)
-		*_oldBuffer = fBuffer;
+	if (_oldBuffer && !fBufferInRing)
+		*_oldBuffer = fHeapBuffer;
 	else
-		free(fBuffer);
+		free(fHeapBuffer);
 
-	fBuffer = buffer;
-	fBufferSize = newSize;
+	fBuffer = fHeapBuffer = buffer;
+	fBufferSize = fHeapBufferSize = newSize;
+	fBufferInRing = false;
 	return B_OK;
 }
 
 
+/*!	Points the buffer to the free space of the ring that follows the last
+	batch, or to the start of the ring, if that is not large enough for
+	\a minSize bytes. Returns \c false if the receiver still uses too much
+	of the ring.
+*/
+bool
+LinkSender::ReserveRingBuffer(size_t minSize)
+{
+	uint32 used = fRingPosition - (uint32)atomic_get(&fRing->released);
+	if (used > fRingSize)
+		return false;
+
+	size_t available = fRingSize - used;
+	size_t contiguous = fRingSize - fRingOffset;
+
+	if (contiguous < minSize) {
+		// skip the end of the ring, it is too small
+		if (available < contiguous + minSize)
+			return false;
+
+		fRingPosition += contiguous;
+		fRingOffset = 0;
+		available -= contiguous;
+		contiguous = fRingSize;
+	}
+
+	if (available < minSize)
+		return false;
+
+	fBuffer = fRingData + fRingOffset;
+	fBufferSize = min_c(contiguous, available);
+	fBufferInRing = true;
+	return true;
+}
+
+
 status_t
 LinkSender::FlushCompleted(size_t newBufferSize)
 {
 	// we need to hide the incomplete message so that it's not flushed
 	int32 end = fCurrentEnd;
 	int32 start = fCurrentStart;
+	char *message = fBuffer + start;
 	fCurrentEnd = fCurrentStart;
 
 	status_t status = Flush();
@@ -280,13 +399,12 @@ LinkSender::FlushCompleted(size_t newBufferSize)
 	if (status != B_OK)
 		return status;
 
-	// move the incomplete message to the start of the buffer
+	// move the incomplete message to the start of the buffer; in the ring,
+	// it might already be there
 	fCurrentEnd = end - start;
-	if (oldBuffer != fBuffer) {
-		memcpy(fBuffer, oldBuffer + start, fCurrentEnd);
-		free(oldBuffer);
-	} else
-		memmove(fBuffer, fBuffer + start, fCurrentEnd);
+	if (message != fBuffer)
+		memmove(fBuffer, message, fCurrentEnd);
+	free(oldBuffer);
 
 	return B_OK;
 }
@@ -305,15 +423,31 @@ LinkSender::Flush(bigtime_t timeout, bool needsReply)
 	STRACE(("info: LinkSender Flush() waiting to send messages of %ld bytes on port %ld.\n",
 		fCurrentEnd, fPort));
 
+	int32 code = kLinkCode;
+	const void* data = fBuffer;
+	size_t size = fCurrentEnd;
+
+	link_ring_batch batch;
+	if (fBufferInRing) {
+		// the receiver finds the messages in the ring
+		batch.offset = fRingOffset;
+		batch.size = fCurrentEnd;
+		batch.end = fRingPosition + fCurrentEnd;
+
+		code = kLinkRingCode;
+		data = &batch;
+		size = sizeof(batch);
+	}
+
 	status_t err;
 	if (timeout != B_INFINITE_TIMEOUT) {
 		do {
-			err = write_port_etc(fPort, kLinkCode, fBuffer,
-				fCurrentEnd, B_RELATIVE_TIMEOUT, timeout);
+			err = write_port_etc(fPort, code, data, size,
+				B_RELATIVE_TIMEOUT, timeout);
 		} while (err == B_INTERRUPTED);
 	} else {
 		do {
-			err = write_port(fPort, kLinkCode, fBuffer, fCurrentEnd);
+			err = write_port(fPort, code, data, size);
 		} while (err == B_INTERRUPTED);
 	}
 
@@ -326,6 +460,14 @@ LinkSender::Flush(bigtime_t timeout, bool needsReply)
 	STRACE(("info: LinkSender Flush() messages total of %ld bytes on port %ld.\n",
 		fCurrentEnd, fPort));
 
+	if (fBufferInRing) {
+		// continue right after the batch
+		fBuffer += fCurrentEnd;
+		fBufferSize -= fCurrentEnd;
+		fRingOffset += fCurrentEnd;
+		fRingPosition += fCurrentEnd;
+	}
+
 	fCurrentEnd = 0;
 	fCurrentStart = 0;
 
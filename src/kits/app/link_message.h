@@ -1,5 +1,6 @@
 /*
  * Copyright 2005, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -26,4 +27,27 @@ struct message_header {
 
 static const uint32 kNeedsReply = 0x01;
 
+
+// Messages can also be passed through a ring in memory that is shared
+// between sender and receiver. The port then only gets a link_ring_batch
+// with kLinkRingCode that tells the receiver where the messages are.
+
+static const int32 kLinkRingCode = '_PTR';
+
+struct link_ring_header {
+	int32	released;
+		// ring position up to which the receiver is done, only written by
+		// the receiver
+	int32	reserved[15];
+		// keeps the messages off the cache line of the receiver
+};
+
+struct link_ring_batch {
+	uint32	offset;
+		// of the messages, relative to the end of the link_ring_header
+	uint32	size;
+	uint32	end;
+		// ring position after the messages, to be released by the receiver
+};
+
 #endif	/* _LINK_MESSAGE_H_ */
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2015, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -1655,6 +1656,38 @@ set_control_look(const BString& path)
 }
 
 
+/*!	\brief Queries the server whether it keeps the contents of windows, so
+		that exposed parts of them can be restored without a redraw.
+*/
+bool
+retain_window_contents()
+{
+	bool retain = false;
+
+	BPrivate::AppServerLink link;
+	link.StartMessage(AS_GET_RETAIN_WINDOW_CONTENTS);
+
+	int32 code;
+	if (link.FlushWithReply(code) == B_OK && code == B_OK)
+		link.Read<bool>(&retain);
+
+	return retain;
+}
+
+
+/*!	\brief Private function which sets whether the server keeps the contents
+		of windows. Only windows that are opened afterwards are affected.
+*/
+void
+set_retain_window_contents(bool retain)
+{
+	BPrivate::AppServerLink link;
+	link.StartMessage(AS_SET_RETAIN_WINDOW_CONTENTS);
+	link.Attach<bool>(retain);
+	link.Flush();
+}
+
+
 status_t
 get_application_order(int32 workspace, team_id** _applications,
 	int32* _count)
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2025 Haiku, Inc. All rights reserved
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -42,6 +43,7 @@
 #include <Roster.h>
 #include <RosterPrivate.h>
 #include <Screen.h>
+#include <ServerMemoryAllocator.h>
 #include <ServerProtocol.h>
 #include <String.h>
 #include <TextView.h>
@@ -222,6 +224,44 @@ _set_menu_sem_(BWindow* window, sem_id sem)
 }
 
 
+/*!	Reads the location of the ring the app_server set up for the drawing
+	commands of the window from the reply to AS_CREATE_WINDOW, and maps it.
+*/
+static void*
+read_command_ring(BPrivate::PortLink* link, size_t& _size)
+{
+	area_id serverArea;
+	if (link->Read<area_id>(&serverArea) != B_OK || serverArea < B_OK)
+		return NULL;
+
+	uint8 allocationFlags;
+	uint32 offset;
+	uint32 size;
+	link->Read<uint8>(&allocationFlags);
+	link->Read<uint32>(&offset);
+	if (link->Read<uint32>(&size) != B_OK)
+		return NULL;
+
+	BPrivate::ServerMemoryAllocator* allocator
+		= BApplication::Private::ServerAllocator();
+	if (allocator == NULL)
+		return NULL;
+
+	area_id area;
+	uint8* base;
+	status_t status;
+	if ((allocationFlags & kNewAllocatorArea) != 0)
+		status = allocator->AddArea(serverArea, area, base, offset + size);
+	else
+		status = allocator->AreaAndBaseFor(serverArea, area, base);
+	if (status != B_OK)
+		return NULL;
+
+	_size = size;
+	return base + offset;
+}
+
+
 //	#pragma mark -
 
 
@@ -754,6 +794,8 @@ BWindow::MessageReceived(BMessage* message)
 
 			port_id sendPort;
 			int32 code;
+			void* commandRing = NULL;
+			size_t commandRingSize = 0;
 			if (fLink->FlushWithReply(code) == B_OK
 				&& code == B_OK
 				&& fLink->Read<port_id>(&sendPort) == B_OK) {
@@ -768,11 +810,14 @@ BWindow::MessageReceived(BMessage* message)
 
 				fMaxZoomWidth = fMaxWidth;
 				fMaxZoomHeight = fMaxHeight;
+
+				commandRing = read_command_ring(fLink, commandRingSize);
 			} else
 				sendPort = -1;
 
 			// Redirect our link to the new window connection
 			fLink->SetSenderPort(sendPort);
+			fLink->Sender().SetRing(commandRing, commandRingSize);
 
 			// connect all views to the server again
 			fTopView->_CreateSelf();
@@ -2865,6 +2910,8 @@ BWindow::_InitData(BRect frame, const char* title, window_look look,
 
 		port_id sendPort;
 		int32 code;
+		void* commandRing = NULL;
+		size_t commandRingSize = 0;
 		if (fLink->FlushWithReply(code) == B_OK
 			&& code == B_OK
 			&& fLink->Read<port_id>(&sendPort) == B_OK) {
@@ -2879,11 +2926,15 @@ BWindow::_InitData(BRect frame, const char* title, window_look look,
 
 			fMaxZoomWidth = fMaxWidth;
 			fMaxZoomHeight = fMaxHeight;
+
+			commandRing = read_command_ring(fLink, commandRingSize);
 		} else
 			sendPort = -1;
 
-		// Redirect our link to the new window connection
+		// Redirect our link to the new window connection, and let the
+		// drawing commands go through the ring
 		fLink->SetSenderPort(sendPort);
+		fLink->Sender().SetRing(commandRing, commandRingSize);
 		STRACE(("Server says that our send port is %ld\n", sendPort));
 	}
 
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+
+#include <syscall_utils.h>
+#include <syscalls.h>
+
+
+ssize_t
+splice(int inFD, off_t* inOffset, int outFD, off_t* outOffset, size_t length,
+	unsigned int flags)
+{
+	if ((flags & ~(SPLICE_F_MOVE | SPLICE_F_NONBLOCK | SPLICE_F_MORE
+			| SPLICE_F_GIFT)) != 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	RETURN_AND_SET_ERRNO(_kern_splice(inFD, inOffset, outFD, outOffset, length,
+		(flags & SPLICE_F_NONBLOCK) != 0 ? MSG_DONTWAIT : 0));
+}
+
+
+ssize_t
+sendfile(int outFD, int inFD, off_t* offset, size_t count)
+{
+	RETURN_AND_SET_ERRNO(_kern_splice(inFD, offset, outFD, NULL, count, 0));
+}
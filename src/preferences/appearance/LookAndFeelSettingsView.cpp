@@ -1,5 +1,6 @@
 /*
  *  Copyright 2010-2020 Haiku, Inc. All rights reserved.
+ *  Copyright 2026, Haiku, Inc. All Rights Reserved.
  *  Distributed under the terms of the MIT license.
  *
  *	Authors:
@@ -60,7 +61,10 @@ static const int32 kMsgDoubleScrollBarArrows = 'dsba';
 static const int32 kMsgArrowStyleSingle = 'mass';
 static const int32 kMsgArrowStyleDouble = 'masd';
 
+static const int32 kMsgRetainWindowContents = 'rtwc';
+
 static const bool kDefaultDoubleScrollBarArrowsSetting = false;
+static const bool kDefaultRetainWindowContentsSetting = false;
 
 
 //	#pragma mark - LookAndFeelSettingsView
@@ -77,11 +81,13 @@ LookAndFeelSettingsView::LookAndFeelSettingsView(const char* name)
 	fControlLookMenu(NULL),
 	fArrowStyleSingle(NULL),
 	fArrowStyleDouble(NULL),
+	fRetainWindowContents(NULL),
 	fSavedDecor(NULL),
 	fCurrentDecor(NULL),
 	fSavedControlLook(NULL),
 	fCurrentControlLook(NULL),
-	fSavedDoubleArrowsValue(_DoubleScrollBarArrows())
+	fSavedDoubleArrowsValue(_DoubleScrollBarArrows()),
+	fSavedRetainWindowContents(BPrivate::retain_window_contents())
 {
 	fCurrentDecor = fDecorUtility.CurrentDecorator()->ShortcutName();
 	fSavedDecor = fCurrentDecor;
@@ -138,6 +144,14 @@ LookAndFeelSettingsView::LookAndFeelSettingsView(const char* name)
 	scrollBarLabel->SetExplicitAlignment(
 		BAlignment(B_ALIGN_LEFT, B_ALIGN_TOP));
 
+	fRetainWindowContents = new BCheckBox("retain window contents",
+		B_TRANSLATE("Retain window contents"),
+		new BMessage(kMsgRetainWindowContents));
+	fRetainWindowContents->SetToolTip(
+		B_TRANSLATE("Windows that are uncovered are restored without "
+			"redrawing them, at the cost of memory.\n"
+			"No effect on open windows"));
+
 	// control layout
 	BLayoutBuilder::Grid<>(this, B_USE_DEFAULT_SPACING, B_USE_DEFAULT_SPACING)
 		.Add(fDecorMenuField->CreateLabelLayoutItem(), 0, 0)
@@ -148,7 +162,8 @@ LookAndFeelSettingsView::LookAndFeelSettingsView(const char* name)
 		.Add(fControlLookInfoButton, 2, 1)
 		.Add(scrollBarLabel, 0, 2)
 		.Add(arrowStyleBox, 1, 2)
-		.AddGlue(0, 3)
+		.Add(fRetainWindowContents, 1, 3)
+		.AddGlue(0, 4)
 		.SetInsets(B_USE_WINDOW_SPACING);
 
 	// TODO : Decorator Preview Image?
@@ -174,11 +189,15 @@ LookAndFeelSettingsView::AttachedToWindow()
 	fControlLookInfoButton->SetTarget(this);
 	fArrowStyleSingle->SetTarget(this);
 	fArrowStyleDouble->SetTarget(this);
+	fRetainWindowContents->SetTarget(this);
 
 	if (fSavedDoubleArrowsValue)
 		fArrowStyleDouble->SetValue(B_CONTROL_ON);
 	else
 		fArrowStyleSingle->SetValue(B_CONTROL_ON);
+
+	fRetainWindowContents->SetValue(fSavedRetainWindowContents
+		? B_CONTROL_ON : B_CONTROL_OFF);
 }
 
 
@@ -270,6 +289,11 @@ LookAndFeelSettingsView::MessageReceived(BMessage* message)
 			_SetDoubleScrollBarArrows(true);
 			break;
 
+		case kMsgRetainWindowContents:
+			_SetRetainWindowContents(
+				fRetainWindowContents->Value() == B_CONTROL_ON);
+			break;
+
 		default:
 			BView::MessageReceived(message);
 			break;
@@ -429,12 +453,24 @@ LookAndFeelSettingsView::_SetDoubleScrollBarArrows(bool doubleArrows)
 }
 
 
+void
+LookAndFeelSettingsView::_SetRetainWindowContents(bool retain)
+{
+	BPrivate::set_retain_window_contents(retain);
+	fRetainWindowContents->SetValue(retain ? B_CONTROL_ON : B_CONTROL_OFF);
+
+	Window()->PostMessage(kMsgUpdate);
+}
+
+
 bool
 LookAndFeelSettingsView::IsDefaultable()
 {
 	return fCurrentDecor != fDecorUtility.DefaultDecorator()->ShortcutName()
 		|| fCurrentControlLook.Length() != 0
-		|| _DoubleScrollBarArrows() != false;
+		|| _DoubleScrollBarArrows() != false
+		|| (fRetainWindowContents->Value() == B_CONTROL_ON)
+			!= kDefaultRetainWindowContentsSetting;
 }
 
 
@@ -444,6 +480,7 @@ LookAndFeelSettingsView::SetDefaults()
 	_SetDecor(fDecorUtility.DefaultDecorator());
 	_SetControlLook(BString(""));
 	_SetDoubleScrollBarArrows(false);
+	_SetRetainWindowContents(kDefaultRetainWindowContentsSetting);
 }
 
 
@@ -452,7 +489,9 @@ LookAndFeelSettingsView::IsRevertable()
 {
 	return fCurrentDecor != fSavedDecor
 		|| fCurrentControlLook != fSavedControlLook
-		|| _DoubleScrollBarArrows() != fSavedDoubleArrowsValue;
+		|| _DoubleScrollBarArrows() != fSavedDoubleArrowsValue
+		|| (fRetainWindowContents->Value() == B_CONTROL_ON)
+			!= fSavedRetainWindowContents;
 }
 
 
@@ -463,5 +502,6 @@ LookAndFeelSettingsView::Revert()
 		_SetDecor(fSavedDecor);
 		_SetControlLook(fSavedControlLook);
 		_SetDoubleScrollBarArrows(fSavedDoubleArrowsValue);
+		_SetRetainWindowContents(fSavedRetainWindowContents);
 	}
 }
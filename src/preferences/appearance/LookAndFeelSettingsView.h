@@ -1,5 +1,6 @@
 /*
  *  Copyright 2010-2020 Haiku, Inc. All rights reserved.
+ *  Copyright 2026, Haiku, Inc. All Rights Reserved.
  *  Distributed under the terms of the MIT license.
  *
  *	Authors:
@@ -50,6 +51,8 @@ private:
 			bool				_DoubleScrollBarArrows();
 			void				_SetDoubleScrollBarArrows(bool doubleArrows);
 
+			void				_SetRetainWindowContents(bool retain);
+
 private:
 			DecorInfoUtility	fDecorUtility;
 
@@ -64,6 +67,8 @@ private:
 			FakeScrollBar*		fArrowStyleSingle;
 			FakeScrollBar*		fArrowStyleDouble;
 
+			BCheckBox*			fRetainWindowContents;
+
 			BString				fSavedDecor;
 			BString				fCurrentDecor;
 
@@ -71,6 +76,7 @@ private:
 			BString				fCurrentControlLook;
 
 			bool				fSavedDoubleArrowsValue : 1;
+			bool				fSavedRetainWindowContents : 1;
 };
 
 
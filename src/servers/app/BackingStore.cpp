@@ -0,0 +1,143 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "BackingStore.h"
+
+#include <stdlib.h>
+
+#include "DrawingEngine.h"
+
+
+BackingStore::BackingStore()
+	:
+	fBits(NULL),
+	fBytesPerRow(0),
+	fWidth(0),
+	fHeight(0)
+{
+}
+
+
+BackingStore::~BackingStore()
+{
+	free(fBits);
+}
+
+
+void
+BackingStore::SetSize(int32 width, int32 height)
+{
+	fValidRegion.MakeEmpty();
+
+	if (width == fWidth && height == fHeight)
+		return;
+
+	// the memory is only allocated again once something is stored
+	free(fBits);
+	fBits = NULL;
+	fWidth = width;
+	fHeight = height;
+}
+
+
+void
+BackingStore::MakeEmpty()
+{
+	fValidRegion.MakeEmpty();
+}
+
+
+void
+BackingStore::Invalidate(const BRegion& region, BPoint origin)
+{
+	if (fValidRegion.CountRects() == 0)
+		return;
+
+	BRegion local(region);
+	local.OffsetBy(-(int32)origin.x, -(int32)origin.y);
+	fValidRegion.Exclude(&local);
+}
+
+
+/*!	Copies \a region from the screen. The caller is responsible for it only
+	covering visible parts of the window that show up to date contents.
+*/
+void
+BackingStore::Store(DrawingEngine* engine, const BRegion& region,
+	BPoint origin)
+{
+	if (region.CountRects() == 0 || !_Allocate())
+		return;
+
+	const int32 left = (int32)origin.x;
+	const int32 top = (int32)origin.y;
+
+	BRegion bounds(BRect(left, top, left + fWidth - 1, top + fHeight - 1));
+	BRegion screen(region);
+	screen.IntersectWith(&bounds);
+
+	if (!engine->LockParallelAccess())
+		return;
+
+	status_t status = engine->ReadRegion(screen, fBits, fBytesPerRow, left,
+		top);
+
+	engine->UnlockParallelAccess();
+
+	if (status != B_OK)
+		return;
+
+	screen.OffsetBy(-left, -top);
+	fValidRegion.Include(&screen);
+}
+
+
+/*!	Copies the valid parts of \a region back to the screen, and returns them
+	in \a restored.
+*/
+void
+BackingStore::Restore(DrawingEngine* engine, const BRegion& region,
+	BPoint origin, BRegion& restored)
+{
+	restored.MakeEmpty();
+	if (fValidRegion.CountRects() == 0 || region.CountRects() == 0)
+		return;
+
+	const int32 left = (int32)origin.x;
+	const int32 top = (int32)origin.y;
+
+	BRegion screen(fValidRegion);
+	screen.OffsetBy(left, top);
+	screen.IntersectWith(&region);
+	if (screen.CountRects() == 0 || !engine->LockParallelAccess())
+		return;
+
+	bool copyToFrontEnabled = engine->CopyToFrontEnabled();
+	engine->SetCopyToFrontEnabled(true);
+
+	status_t status = engine->WriteRegion(screen, fBits, fBytesPerRow, left,
+		top);
+
+	engine->SetCopyToFrontEnabled(copyToFrontEnabled);
+	engine->UnlockParallelAccess();
+
+	if (status == B_OK)
+		restored = screen;
+}
+
+
+bool
+BackingStore::_Allocate()
+{
+	if (fBits != NULL)
+		return true;
+	if (fWidth <= 0 || fHeight <= 0)
+		return false;
+
+	fBytesPerRow = fWidth * 4;
+	fBits = (uint8*)malloc((size_t)fBytesPerRow * fHeight);
+	return fBits != NULL;
+}
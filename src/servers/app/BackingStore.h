@@ -0,0 +1,55 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef BACKING_STORE_H
+#define BACKING_STORE_H
+
+
+#include <Point.h>
+#include <Region.h>
+
+
+class DrawingEngine;
+
+
+/*!	Retains the contents of a window, so that parts of it that are exposed
+	again can be copied back to the screen without asking the client to
+	redraw them.
+
+	The contents are kept in window coordinates, so that they stay valid when
+	the window is moved. All regions passed in are in screen coordinates,
+	with \a origin being the left top corner of the window frame.
+*/
+class BackingStore {
+public:
+								BackingStore();
+								~BackingStore();
+
+			void				SetSize(int32 width, int32 height);
+
+			void				MakeEmpty();
+			void				Invalidate(const BRegion& region,
+									BPoint origin);
+
+			void				Store(DrawingEngine* engine,
+									const BRegion& region, BPoint origin);
+			void				Restore(DrawingEngine* engine,
+									const BRegion& region, BPoint origin,
+									BRegion& restored);
+
+private:
+			bool				_Allocate();
+
+private:
+			uint8*				fBits;
+			uint32				fBytesPerRow;
+			int32				fWidth;
+			int32				fHeight;
+
+			// what the buffer holds up to date contents for
+			BRegion				fValidRegion;
+};
+
+
+#endif	// BACKING_STORE_H
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2020, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -47,7 +48,9 @@
 #include "DecorManager.h"
 #include "DesktopSettingsPrivate.h"
 #include "DrawingEngine.h"
+#include "FontCache.h"
 #include "GlobalFontManager.h"
+#include "GlyphRunCache.h"
 #include "HWInterface.h"
 #include "InputManager.h"
 #include "Screen.h"
@@ -123,6 +126,54 @@ private:
 };
 
 
+/*!	Like AutoWriteLocker, but uses Desktop::LockAllWindows(), so that the
+	lock is profiled as well.
+*/
+class AutoAllWindowsLocker {
+public:
+	AutoAllWindowsLocker(Desktop* desktop)
+		:
+		fDesktop(desktop),
+		fLocked(desktop->LockAllWindows())
+	{
+	}
+
+	~AutoAllWindowsLocker()
+	{
+		Unlock();
+	}
+
+	void Unlock()
+	{
+		if (fLocked)
+			fDesktop->UnlockAllWindows();
+		fLocked = false;
+	}
+
+private:
+	Desktop*	fDesktop;
+	bool		fLocked;
+};
+
+
+static void
+include_stack_regions(Window* window, BRegion& region)
+{
+	BRegion full;
+	WindowStack* stack = window->GetWindowStack();
+	if (stack == NULL) {
+		window->GetFullRegion(&full);
+		region.Include(&full);
+		return;
+	}
+
+	for (int32 i = 0; i < stack->CountWindows(); i++) {
+		stack->WindowAt(i)->GetFullRegion(&full);
+		region.Include(&full);
+	}
+}
+
+
 //	#pragma mark -
 
 
@@ -434,6 +485,12 @@ Desktop::Desktop(uid_t userID, const char* targetScreen)
 
 	fWorkspacesLock("workspaces list"),
 	fWindowLock("window lock"),
+#ifdef PROFILE_WINDOW_LOCK
+	fReadLockProfile("window lock (read)"),
+	fWriteLockProfile("window lock (write)"),
+	fWriteLockNesting(0),
+	fWriteLockAcquired(0),
+#endif
 
 	fMouseEventWindow(NULL),
 	fWindowUnderMouse(NULL),
@@ -687,6 +744,51 @@ Desktop::KeyEvent(uint32 what, int32 key, int32 modifiers)
 }
 
 
+#ifdef PROFILE_WINDOW_LOCK
+
+
+bool
+Desktop::LockSingleWindow()
+{
+	bigtime_t start = system_time();
+	if (!fWindowLock.ReadLock())
+		return false;
+
+	if (!fWindowLock.IsWriteLocked())
+		fReadLockProfile.AddWaitTime(system_time() - start);
+	return true;
+}
+
+
+bool
+Desktop::LockAllWindows()
+{
+	bigtime_t start = system_time();
+	if (!fWindowLock.WriteLock())
+		return false;
+
+	// only the writer accesses these
+	if (fWriteLockNesting++ == 0) {
+		fWriteLockAcquired = system_time();
+		fWriteLockProfile.AddWaitTime(fWriteLockAcquired - start);
+	}
+	return true;
+}
+
+
+void
+Desktop::UnlockAllWindows()
+{
+	if (--fWriteLockNesting == 0)
+		fWriteLockProfile.AddHoldTime(system_time() - fWriteLockAcquired);
+
+	fWindowLock.WriteUnlock();
+}
+
+
+#endif	// PROFILE_WINDOW_LOCK
+
+
 // #pragma mark - Mouse and cursor methods
 
 
@@ -756,7 +858,7 @@ status_t
 Desktop::SetScreenMode(int32 workspace, int32 id, const display_mode& mode,
 	bool makeDefault)
 {
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	if (workspace == B_CURRENT_WORKSPACE_INDEX)
 		workspace = fCurrentWorkspace;
@@ -892,7 +994,7 @@ Desktop::RevertScreenModes(uint32 workspaces)
 	if (workspaces == 0)
 		return;
 
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	for (int32 workspace = 0; workspace < kMaxWorkspaces; workspace++) {
 		if ((workspaces & (1U << workspace)) == 0)
@@ -1154,7 +1256,7 @@ Desktop::ActivateWindow(Window* window)
 	if (window->Workspaces() == 0 && window->IsNormal())
 		return;
 
-	AutoWriteLocker allWindowLocker(fWindowLock);
+	AutoAllWindowsLocker allWindowLocker(this);
 
 	NotifyWindowActivated(window);
 
@@ -1345,7 +1447,7 @@ Desktop::ShowWindow(Window* window)
 	if (!window->IsHidden())
 		return;
 
-	AutoWriteLocker locker(fWindowLock);
+	AutoAllWindowsLocker locker(this);
 
 	window->SetHidden(false);
 	fFocusList.AddWindow(window);
@@ -1463,7 +1565,7 @@ Desktop::MoveWindowBy(Window* window, float x, float y, int32 workspace)
 	if (x == 0 && y == 0)
 		return;
 
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	Window* topWindow = window->TopLayerStackWindow();
 	if (topWindow != NULL)
@@ -1507,10 +1609,16 @@ Desktop::MoveWindowBy(Window* window, float x, float y, int32 workspace)
 		direct = true;
 	}
 
+	// only windows overlapping the old or the new position can change
+	BRegion changedRegion;
+	include_stack_regions(window, changedRegion);
+
 	window->MoveBy((int32)x, (int32)y);
 
+	include_stack_regions(window, changedRegion);
+
 	BRegion background;
-	_RebuildClippingForAllWindows(background);
+	_RebuildClippingForAllWindows(background, &changedRegion);
 
 	// construct the region that is possible to be blitted
 	// to move the contents of the window
@@ -1557,7 +1665,7 @@ Desktop::ResizeWindowBy(Window* window, float x, float y)
 	if (x == 0 && y == 0)
 		return;
 
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	Window* topWindow = window->TopLayerStackWindow();
 	if (topWindow)
@@ -1585,10 +1693,15 @@ Desktop::ResizeWindowBy(Window* window, float x, float y)
 		direct = true;
 	}
 
+	BRegion changedRegion;
+	include_stack_regions(window, changedRegion);
+
 	window->ResizeBy((int32)x, (int32)y, &newDirtyRegion);
 
+	include_stack_regions(window, changedRegion);
+
 	BRegion background;
-	_RebuildClippingForAllWindows(background);
+	_RebuildClippingForAllWindows(background, &changedRegion);
 
 	// we just care for the region outside the window
 	previouslyOccupiedRegion.Exclude(&window->VisibleRegion());
@@ -1624,7 +1737,7 @@ Desktop::ResizeWindowBy(Window* window, float x, float y)
 void
 Desktop::SetWindowOutlinesDelta(Window* window, BPoint delta)
 {
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	if (!window->IsVisible())
 		return;
@@ -1643,7 +1756,7 @@ Desktop::SetWindowOutlinesDelta(Window* window, BPoint delta)
 bool
 Desktop::SetWindowTabLocation(Window* window, float location, bool isShifting)
 {
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	BRegion dirty;
 	bool changed = window->SetTabLocation(location, isShifting, dirty);
@@ -1659,7 +1772,7 @@ Desktop::SetWindowTabLocation(Window* window, float location, bool isShifting)
 bool
 Desktop::SetWindowDecoratorSettings(Window* window, const BMessage& settings)
 {
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	BRegion dirty;
 	bool changed = window->SetDecoratorSettings(settings, dirty);
@@ -1770,7 +1883,7 @@ Desktop::RemoveWindowFromSubset(Window* subset, Window* window)
 void
 Desktop::FontsChanged(Window* window)
 {
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	BRegion dirty;
 	window->FontsChanged(&dirty);
@@ -1784,7 +1897,7 @@ Desktop::FontsChanged(Window* window)
 void
 Desktop::ColorUpdated(Window* window, color_which which, rgb_color color)
 {
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	window->TopView()->ColorUpdated(which, color);
 
@@ -1812,7 +1925,7 @@ Desktop::SetWindowLook(Window* window, window_look newLook)
 	if (window->Look() == newLook)
 		return;
 
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	BRegion dirty;
 	window->SetLook(newLook, &dirty);
@@ -1934,7 +2047,7 @@ Desktop::SetWindowFlags(Window *window, uint32 newFlags)
 	if (window->Flags() == newFlags)
 		return;
 
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	BRegion dirty;
 	window->SetFlags(newFlags, &dirty);
@@ -1948,7 +2061,7 @@ Desktop::SetWindowFlags(Window *window, uint32 newFlags)
 void
 Desktop::SetWindowTitle(Window *window, const char* title)
 {
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	BRegion dirty;
 	window->SetTitle(title, dirty);
@@ -2146,7 +2259,7 @@ Desktop::SetFocusWindow(Window* nextFocus)
 void
 Desktop::SetFocusLocked(const Window* window)
 {
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	if (window != NULL) {
 		// Don't allow this to be set when no mouse buttons
@@ -2255,7 +2368,7 @@ Desktop::RedrawBackground()
 bool
 Desktop::ReloadDecor(DecorAddOn* oldDecor)
 {
-	AutoWriteLocker _(fWindowLock);
+	AutoAllWindowsLocker _(this);
 
 	bool returnValue = true;
 
@@ -2296,7 +2409,7 @@ Desktop::ReloadDecor(DecorAddOn* oldDecor)
 void
 Desktop::MinimizeApplication(team_id team)
 {
-	AutoWriteLocker locker(fWindowLock);
+	AutoAllWindowsLocker locker(this);
 
 	// Just minimize all windows of that application
 
@@ -2313,7 +2426,7 @@ Desktop::MinimizeApplication(team_id team)
 void
 Desktop::BringApplicationToFront(team_id team)
 {
-	AutoWriteLocker locker(fWindowLock);
+	AutoAllWindowsLocker locker(this);
 
 	// TODO: for now, just maximize all windows of that application
 	// TODO: have the ability to lock the current workspace
@@ -2360,7 +2473,7 @@ Desktop::WindowAction(int32 windowToken, int32 action)
 void
 Desktop::WriteWindowList(team_id team, BPrivate::LinkSender& sender)
 {
-	AutoWriteLocker locker(fWindowLock);
+	AutoAllWindowsLocker locker(this);
 
 	// compute the number of windows
 
@@ -2403,7 +2516,7 @@ Desktop::WriteWindowList(team_id team, BPrivate::LinkSender& sender)
 void
 Desktop::WriteWindowInfo(int32 serverToken, BPrivate::LinkSender& sender)
 {
-	AutoWriteLocker locker(fWindowLock);
+	AutoAllWindowsLocker locker(this);
 	BAutolock tokenLocker(BPrivate::gDefaultTokens);
 
 	::ServerWindow* window;
@@ -2758,6 +2871,22 @@ Desktop::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 			break;
 		}
 
+		case AS_DUMP_FONT_CACHE:
+			FontCache::Default()->Dump();
+			GlyphRunCache::Default()->Dump();
+			break;
+
+		case AS_DUMP_REDRAWS:
+		{
+			AutoAllWindowsLocker _(this);
+
+			for (Window* window = fAllWindows.FirstWindow(); window != NULL;
+					window = window->NextWindow(kAllWindowList)) {
+				window->DumpRedrawStatistics();
+			}
+			break;
+		}
+
 		case AS_EVENT_STREAM_CLOSED:
 			_LaunchInputServer();
 			break;
@@ -2805,7 +2934,7 @@ Desktop::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 				break;
 
 			BPrivate::LinkSender reply(clientReplyPort);
-			AutoWriteLocker locker(fWindowLock);
+			AutoAllWindowsLocker locker(this);
 			if (MessageForListener(NULL, link, reply) != true) {
 				// unhandled message, at least send an error if needed
 				if (link.NeedsReply()) {
@@ -3449,8 +3578,13 @@ Desktop::_DetermineScreenFor(BRect frame)
 }
 
 
+/*!	Recomputes the visible regions of all windows. If only the windows
+	within \a changedRegion were moved or resized, the clipping of the
+	windows outside of it stays the same, and is left alone.
+*/
 void
-Desktop::_RebuildClippingForAllWindows(BRegion& stillAvailableOnScreen)
+Desktop::_RebuildClippingForAllWindows(BRegion& stillAvailableOnScreen,
+	const BRegion* changedRegion)
 {
 	// the available region on screen starts with the entire screen area
 	// each window on the screen will take a portion from that area
@@ -3458,9 +3592,19 @@ Desktop::_RebuildClippingForAllWindows(BRegion& stillAvailableOnScreen)
 	// figure out what the entire screen area is
 	stillAvailableOnScreen = fScreenRegion;
 
+	BRegion fullRegion;
+
 	// set clipping of each window
 	for (Window* window = CurrentWindows().LastWindow(); window != NULL;
 			window = window->PreviousWindow(fCurrentWorkspace)) {
+		if (changedRegion != NULL && !window->IsHidden()) {
+			window->GetFullRegion(&fullRegion);
+			if (!changedRegion->Intersects(fullRegion.Frame())) {
+				stillAvailableOnScreen.Exclude(&window->VisibleRegion());
+				continue;
+			}
+		}
+
 		if (!window->IsHidden()) {
 			window->SetClipping(&stillAvailableOnScreen);
 			window->SetScreen(_DetermineScreenFor(window->Frame()));
@@ -3594,7 +3738,7 @@ Desktop::_ResumeDirectFrameBufferAccess()
 void
 Desktop::ScreenChanged(Screen* screen)
 {
-	AutoWriteLocker windowLocker(fWindowLock);
+	AutoAllWindowsLocker windowLocker(this);
 
 	AutoWriteLocker screenLocker(fScreenLock);
 	screen->SetPreferredMode();
@@ -3651,7 +3795,7 @@ Desktop::_ActivateApp(team_id team)
 {
 	// search for an unhidden window in the current workspace
 
-	AutoWriteLocker locker(fWindowLock);
+	AutoAllWindowsLocker locker(this);
 
 	for (Window* window = CurrentWindows().LastWindow(); window != NULL;
 			window = window->PreviousWindow(fCurrentWorkspace)) {
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2020, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -36,6 +37,7 @@
 #include "EventDispatcher.h"
 #include "MessageLooper.h"
 #include "MultiLocker.h"
+#include "ProfileMessageSupport.h"
 #include "Screen.h"
 #include "ScreenManager.h"
 #include "ServerCursor.h"
@@ -89,6 +91,7 @@ public:
 			filter_result		KeyEvent(uint32 what, int32 key,
 									int32 modifiers);
 	// Locking
+#ifndef PROFILE_WINDOW_LOCK
 			bool				LockSingleWindow()
 									{ return fWindowLock.ReadLock(); }
 			void				UnlockSingleWindow()
@@ -98,6 +101,16 @@ public:
 									{ return fWindowLock.WriteLock(); }
 			void				UnlockAllWindows()
 									{ fWindowLock.WriteUnlock(); }
+#else
+			bool				LockSingleWindow();
+			void				UnlockSingleWindow()
+									{ fWindowLock.ReadUnlock(); }
+
+			bool				LockAllWindows();
+			void				UnlockAllWindows();
+#endif
+			bool				AllWindowsLockWanted() const
+									{ return fWindowLock.HasWaitingWriters(); }
 
 			const MultiLocker&	WindowLocker() { return fWindowLock; }
 
@@ -312,7 +325,8 @@ private:
 
 			Screen*				_DetermineScreenFor(BRect frame);
 			void				_RebuildClippingForAllWindows(
-									BRegion& stillAvailableOnScreen);
+									BRegion& stillAvailableOnScreen,
+									const BRegion* changedRegion = NULL);
 			void				_TriggerWindowRedrawing(
 									BRegion& dirtyRegion, BRegion& exposeRegion);
 			void				_SetBackground(BRegion& background);
@@ -367,6 +381,12 @@ private:
 			ServerCursorReference fManagementCursor;
 
 			MultiLocker			fWindowLock;
+#ifdef PROFILE_WINDOW_LOCK
+			LockProfile			fReadLockProfile;
+			LockProfile			fWriteLockProfile;
+			int32				fWriteLockNesting;
+			bigtime_t			fWriteLockAcquired;
+#endif
 
 			BRegion				fBackgroundRegion;
 			BRegion				fScreenRegion;
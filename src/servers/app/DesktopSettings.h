@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2015, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -78,6 +79,8 @@ public:
 
 			const BString&		ControlLook() const;
 
+			bool				RetainWindowContents() const;
+
 protected:
 			DesktopSettingsPrivate*	fSettings;
 };
@@ -113,6 +116,8 @@ public:
 
 			status_t			SetControlLook(const char* path);
 
+			void				SetRetainWindowContents(bool retain);
+
 private:
 			Desktop*			fDesktop;
 };
@@ -1,5 +1,6 @@
 /*
  * Copyright 2005-2015, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -97,6 +98,9 @@ public:
 			status_t			SetControlLook(const char* path);
 			const BString&		ControlLook() const;
 
+			void				SetRetainWindowContents(bool retain);
+			bool				RetainWindowContents() const;
+
 private:
 			void				_SetDefaults();
 			status_t			_Load();
@@ -120,6 +124,7 @@ private:
 			int32				fWorkspacesRows;
 			BMessage			fWorkspaceMessages[kMaxWorkspaces];
 			BString				fControlLook;
+			bool				fRetainWindowContents;
 
 			server_read_only_memory& fShared;
 };
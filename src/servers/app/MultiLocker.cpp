@@ -1,5 +1,6 @@
 /*
  * Copyright 2005-2009, Haiku, Inc. All Rights Reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT license.
  *
  * Copyright 1999, Be Incorporated.   All Rights Reserved.
@@ -31,7 +32,8 @@ MultiLocker::MultiLocker(const char* baseName)
 	fWriterNest(0),
 	fWriterThread(-1),
 #endif
-	fInit(B_NO_INIT)
+	fInit(B_NO_INIT),
+	fWaitingWriters(0)
 {
 #if !DEBUG
 	rw_lock_init_etc(&fLock, baseName != NULL ? baseName : "some MultiLocker",
@@ -156,7 +158,9 @@ MultiLocker::WriteLock()
 	bigtime_t start = system_time();
 #endif
 
+	atomic_add(&fWaitingWriters, 1);
 	bool locked = (rw_lock_write_lock(&fLock) == B_OK);
+	atomic_add(&fWaitingWriters, -1);
 
 #if TIMING
 	bigtime_t end = system_time();
@@ -281,10 +285,12 @@ MultiLocker::WriteLock()
 		if (IsReadLocked())
 			debugger("Reader wants to become writer!");
 
+		atomic_add(&fWaitingWriters, 1);
 		status_t status;
 		do {
 			status = acquire_sem_etc(fLock, LARGE_NUMBER, 0, 0);
 		} while (status == B_INTERRUPTED);
+		atomic_add(&fWaitingWriters, -1);
 
 		locked = status == B_OK;
 		if (locked) {
@@ -1,5 +1,6 @@
 /*
  * Copyright 2005-2009, Haiku, Inc. All Rights Reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT license.
  *
  * Copyright 1999, Be Incorporated. All Rights Reserved.
@@ -60,6 +61,11 @@ public:
 			// does the current thread hold a write lock?
 			bool				IsWriteLocked() const;
 
+			// is another thread waiting to become the writer? Readers
+			// holding the lock for a longer time should give it up then.
+			bool				HasWaitingWriters() const
+									{ return fWaitingWriters > 0; }
+
 #if MULTI_LOCKER_DEBUG
 			// in DEBUG mode returns whether the lock is held
 			// in non-debug mode returns true
@@ -87,6 +93,7 @@ private:
 #endif	// MULTI_LOCKER_DEBUG
 
 			status_t			fInit;
+			int32				fWaitingWriters;
 
 #if MULTI_LOCKER_TIMING
 			uint32 				rl_count;
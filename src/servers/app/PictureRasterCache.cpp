@@ -0,0 +1,892 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "PictureRasterCache.h"
+
+#include <math.h>
+#include <new>
+#include <stddef.h>
+#include <string.h>
+
+#include <AutoDeleter.h>
+#include <AutoLocker.h>
+#include <DataIO.h>
+#include <ObjectListPrivate.h>
+#include <PicturePlayer.h>
+
+#include "BitmapHWInterface.h"
+#include "Canvas.h"
+#include "DrawingEngine.h"
+#include "DrawState.h"
+#include "GlobalSubpixelSettings.h"
+#include "IntRect.h"
+#include "PictureBoundingBoxPlayer.h"
+#include "ServerBitmap.h"
+#include "ServerPicture.h"
+
+
+//#define PRINT_PICTURE_RASTER_CACHE_STATISTICS
+#ifdef PRINT_PICTURE_RASTER_CACHE_STATISTICS
+static uint32 sPictureRasterDrawCount = 0;
+#endif
+
+
+// Result of scanning a picture, as stored in ServerPicture::fRasterFlags
+enum {
+	RASTER_UNSUPPORTED		= 0x01,
+	RASTER_INITIAL_MODE		= 0x02,
+		// something is drawn before the picture sets the drawing mode
+	RASTER_PIXEL_ALPHA		= 0x04,
+	RASTER_CONSTANT_ALPHA	= 0x08,
+		// the alpha source modes the picture sets
+	RASTER_TEXT				= 0x10,
+
+	RASTER_CACHED			= 0x80
+		// there might be rasters of the picture in the cache
+};
+
+static const int32 kMaxScanDepth = 32;
+
+
+/*!	Everything that makes a difference in what the picture renders to, or
+	whether it can be cached at all: _IsSupported() is only asked on misses.
+	The integral part of the origin only moves the result, so it is left out.
+*/
+struct PictureRasterCache::Key {
+	ServerPicture*	picture;
+	off_t			length;
+
+	float			scale;
+	float			originFractionX;
+	float			originFractionY;
+	float			penX;
+	float			penY;
+	float			penSize;
+	rgb_color		highColor;
+	rgb_color		lowColor;
+	uint64			pattern;
+	int32			drawingMode;
+	int32			alphaSourceMode;
+	int32			capMode;
+	int32			joinMode;
+	float			miterLimit;
+	int32			fillRule;
+	bool			subPixelPrecise;
+	bool			forceFontAliasing;
+	bool			subpixelAntialiasing;
+
+	uint16			fontFamily;
+	uint16			fontStyle;
+	float			fontSize;
+	float			fontRotation;
+	float			fontShear;
+	float			fontFalseBoldWidth;
+	uint32			fontFlags;
+	uint16			fontFace;
+	uint8			fontSpacing;
+	uint8			fontEncoding;
+	uint8			hintingMode;
+
+	uint32			hash;
+
+	void SetTo(ServerPicture* picture, const DrawState* state)
+	{
+		// the padding has to be the same for memcmp() to work
+		memset(this, 0, sizeof(Key));
+
+		this->picture = picture;
+		length = picture->DataLength();
+
+		scale = state->CombinedScale();
+		BPoint origin = state->CombinedOrigin();
+		originFractionX = origin.x - floorf(origin.x);
+		originFractionY = origin.y - floorf(origin.y);
+		penX = state->PenLocation().x;
+		penY = state->PenLocation().y;
+		penSize = state->PenSize();
+		highColor = state->HighColor();
+		lowColor = state->LowColor();
+		pattern = state->GetPattern().GetInt64();
+		drawingMode = state->GetDrawingMode();
+		alphaSourceMode = state->AlphaSrcMode();
+		capMode = state->LineCapMode();
+		joinMode = state->LineJoinMode();
+		miterLimit = state->MiterLimit();
+		fillRule = state->FillRule();
+		subPixelPrecise = state->SubPixelPrecise();
+		forceFontAliasing = state->ForceFontAliasing();
+		subpixelAntialiasing = gSubpixelAntialiasing;
+
+		const ServerFont& font = state->Font();
+		fontFamily = font.FamilyID();
+		fontStyle = font.StyleID();
+		fontSize = font.Size();
+		fontRotation = font.Rotation();
+		fontShear = font.Shear();
+		fontFalseBoldWidth = font.FalseBoldWidth();
+		fontFlags = font.Flags();
+		fontFace = font.Face();
+		fontSpacing = font.Spacing();
+		fontEncoding = font.Encoding();
+		hintingMode = gDefaultHintingMode;
+
+		// FNV-1a
+		hash = 2166136261U;
+		const uint8* data = (const uint8*)this;
+		for (size_t i = 0; i < offsetof(Key, hash); i++)
+			hash = (hash ^ data[i]) * 16777619U;
+	}
+
+	bool operator==(const Key& other) const
+	{
+		return memcmp(this, &other, sizeof(Key)) == 0;
+	}
+};
+
+
+struct PictureRasterCache::Entry : DoublyLinkedListLinkImpl<Entry> {
+	Entry*			hashLink;
+	Key				key;
+	UtilityBitmap*	bitmap;
+	IntPoint		offset;
+		// of the bitmap, relative to the integral part of the origin
+	size_t			size;
+};
+
+
+struct PictureRasterCache::HashDefinition {
+	typedef Key		KeyType;
+	typedef	Entry	ValueType;
+
+	size_t HashKey(const Key& key) const
+	{
+		return key.hash;
+	}
+
+	size_t Hash(Entry* value) const
+	{
+		return value->key.hash;
+	}
+
+	bool Compare(const Key& key, Entry* value) const
+	{
+		return value->key == key;
+	}
+
+	Entry*& GetLink(Entry* value) const
+	{
+		return value->hashLink;
+	}
+};
+
+
+// #pragma mark - picture scan
+
+
+/*!	Follows the drawing mode through the state stack of a picture, to find
+	out whether everything is drawn in B_OP_ALPHA.
+*/
+struct scan_state {
+	uint32	flags;
+	int32	depth;
+	bool	modeSet[kMaxScanDepth];
+};
+
+
+static void
+scan_drawing(void* _state)
+{
+	scan_state* state = reinterpret_cast<scan_state*>(_state);
+	if (!state->modeSet[state->depth])
+		state->flags |= RASTER_INITIAL_MODE;
+}
+
+
+static void
+scan_unsupported(void* _state)
+{
+	reinterpret_cast<scan_state*>(_state)->flags |= RASTER_UNSUPPORTED;
+}
+
+
+static void
+scan_stroke_line(void* state, const BPoint&, const BPoint&)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_rect(void* state, const BRect&, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_round_rect(void* state, const BRect&, const BPoint&, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_bezier(void* state, const BPoint[4], bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_arc(void* state, const BPoint&, const BPoint&, float, float, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_ellipse(void* state, const BRect&, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_polygon(void* state, size_t, const BPoint[], bool, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_shape(void* state, const BShape&, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_string(void* state, const char*, size_t, float, float)
+{
+	scan_drawing(state);
+	reinterpret_cast<scan_state*>(state)->flags |= RASTER_TEXT;
+}
+
+
+static void
+scan_draw_pixels(void* state, const BRect&, const BRect&, uint32, uint32,
+	size_t, color_space, uint32, const void*, size_t)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_picture(void* state, const BPoint&, int32)
+{
+	// the token is resolved at the time it is played
+	scan_unsupported(state);
+}
+
+
+static void
+scan_clip_to_picture(void* state, int32, const BPoint&, bool)
+{
+	scan_unsupported(state);
+}
+
+
+static void
+scan_push_state(void* _state)
+{
+	scan_state* state = reinterpret_cast<scan_state*>(_state);
+	if (state->depth + 1 >= kMaxScanDepth) {
+		state->flags |= RASTER_UNSUPPORTED;
+		return;
+	}
+
+	state->depth++;
+	state->modeSet[state->depth] = state->modeSet[state->depth - 1];
+}
+
+
+static void
+scan_pop_state(void* _state)
+{
+	scan_state* state = reinterpret_cast<scan_state*>(_state);
+	if (state->depth > 0)
+		state->depth--;
+}
+
+
+static void
+scan_set_drawing_mode(void* _state, drawing_mode mode)
+{
+	scan_state* state = reinterpret_cast<scan_state*>(_state);
+	if (mode != B_OP_ALPHA)
+		state->flags |= RASTER_UNSUPPORTED;
+	state->modeSet[state->depth] = true;
+}
+
+
+static void
+scan_set_blending_mode(void* state, source_alpha alphaSrcMode,
+	alpha_function)
+{
+	reinterpret_cast<scan_state*>(state)->flags
+		|= alphaSrcMode == B_CONSTANT_ALPHA
+			? RASTER_CONSTANT_ALPHA : RASTER_PIXEL_ALPHA;
+}
+
+
+static void
+scan_blend_layer(void* state, Layer*)
+{
+	scan_unsupported(state);
+}
+
+
+static void
+scan_clip_to_rect(void* state, const BRect&, bool)
+{
+	// alpha masks are tied to the canvas they were made for
+	scan_unsupported(state);
+}
+
+
+static void
+scan_clip_to_shape(void* state, int32, const uint32[], int32, const BPoint[],
+	bool)
+{
+	scan_unsupported(state);
+}
+
+
+static void
+scan_draw_string_locations(void* state, const char*, size_t, const BPoint[],
+	size_t)
+{
+	scan_drawing(state);
+	reinterpret_cast<scan_state*>(state)->flags |= RASTER_TEXT;
+}
+
+
+static void
+scan_draw_rect_gradient(void* state, const BRect&, BGradient&, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_round_rect_gradient(void* state, const BRect&, const BPoint&,
+	BGradient&, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_bezier_gradient(void* state, const BPoint[4], BGradient&, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_arc_gradient(void* state, const BPoint&, const BPoint&, float,
+	float, BGradient&, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_ellipse_gradient(void* state, const BRect&, BGradient&, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_polygon_gradient(void* state, size_t, const BPoint[], bool,
+	BGradient&, bool)
+{
+	scan_drawing(state);
+}
+
+
+static void
+scan_draw_shape_gradient(void* state, const BShape&, BGradient&, bool)
+{
+	scan_drawing(state);
+}
+
+
+static const BPrivate::picture_player_callbacks kScanPlayerCallbacks = {
+	NULL, // move_pen_by
+	scan_stroke_line,
+	scan_draw_rect,
+	scan_draw_round_rect,
+	scan_draw_bezier,
+	scan_draw_arc,
+	scan_draw_ellipse,
+	scan_draw_polygon,
+	scan_draw_shape,
+	scan_draw_string,
+	scan_draw_pixels,
+	scan_draw_picture,
+	NULL, // set_clipping_rects
+	scan_clip_to_picture,
+	scan_push_state,
+	scan_pop_state,
+	NULL, // enter_state_change
+	NULL, // exit_state_change
+	NULL, // enter_font_state
+	NULL, // exit_font_state
+	NULL, // set_origin
+	NULL, // set_pen_location
+	scan_set_drawing_mode,
+	NULL, // set_line_mode
+	NULL, // set_pen_size
+	NULL, // set_fore_color
+	NULL, // set_back_color
+	NULL, // set_stipple_pattern
+	NULL, // set_scale
+	NULL, // set_font_family
+	NULL, // set_font_style
+	NULL, // set_font_spacing
+	NULL, // set_font_size
+	NULL, // set_font_rotation
+	NULL, // set_font_encoding
+	NULL, // set_font_flags
+	NULL, // set_font_shear
+	NULL, // set_font_face
+	scan_set_blending_mode,
+	NULL, // set_transform
+	NULL, // translate_by
+	NULL, // scale_by
+	NULL, // rotate_by
+	scan_blend_layer,
+	scan_clip_to_rect,
+	scan_clip_to_shape,
+	scan_draw_string_locations,
+	scan_draw_rect_gradient,
+	scan_draw_round_rect_gradient,
+	scan_draw_bezier_gradient,
+	scan_draw_arc_gradient,
+	scan_draw_ellipse_gradient,
+	scan_draw_polygon_gradient,
+	scan_draw_shape_gradient,
+	NULL // set_fill_rule
+};
+
+
+// #pragma mark - RasterCanvas
+
+
+class RasterCanvas : public OffscreenCanvas {
+public:
+	RasterCanvas(DrawingEngine* engine, const DrawState& state,
+		BRect bounds)
+		:
+		OffscreenCanvas(engine, state, bounds),
+		fBitmapBounds(bounds)
+	{
+	}
+
+	virtual void UpdateCurrentDrawingRegion()
+	{
+		// never draw outside of the bitmap
+		BRegion bitmapRegion(fBitmapBounds);
+		if (fDrawState->GetCombinedClippingRegion(&fDrawingRegion))
+			fDrawingRegion.IntersectWith(&bitmapRegion);
+		else
+			fDrawingRegion = bitmapRegion;
+
+		GetDrawingEngine()->ConstrainClippingRegion(&fDrawingRegion);
+	}
+
+private:
+	BRect			fBitmapBounds;
+	BRegion			fDrawingRegion;
+};
+
+
+// #pragma mark - PictureRasterCache
+
+
+PictureRasterCache PictureRasterCache::sDefaultInstance;
+
+
+PictureRasterCache::PictureRasterCache()
+	:
+	fLock("picture raster cache"),
+	fTable(new(std::nothrow) EntryTable),
+	fCurrentCacheBytes(0),
+	fNextRecentMiss(0),
+	fHitCount(0),
+	fMissCount(0),
+	fUnsupportedCount(0),
+	fReplacedCount(0)
+{
+	memset(fRecentMisses, 0, sizeof(fRecentMisses));
+}
+
+
+PictureRasterCache::~PictureRasterCache()
+{
+	Clear();
+	delete fTable;
+}
+
+
+/* static */ PictureRasterCache*
+PictureRasterCache::Default()
+{
+	return &sDefaultInstance;
+}
+
+
+/*!	Draws \a picture onto \a canvas from the cache, and returns \c true if
+	that was possible. Otherwise, the caller has to play the picture as
+	usual.
+	A picture is only rendered for the cache once it has been drawn with
+	the same state before, so that pictures which are only drawn once don't
+	cost anything extra.
+*/
+bool
+PictureRasterCache::Draw(ServerPicture* picture, Canvas* canvas)
+{
+	DrawState* state = canvas->CurrentState();
+	if (fTable == NULL || state->GetAlphaMask() != NULL
+		|| !state->CombinedTransform().IsIdentity()) {
+		return false;
+	}
+
+	AutoLocker<BLocker> locker(fLock);
+
+#ifdef PRINT_PICTURE_RASTER_CACHE_STATISTICS
+	if (sPictureRasterDrawCount++ > 200) {
+		_PrintAndResetStatistics();
+		sPictureRasterDrawCount = 0;
+	}
+#endif
+
+	Key key;
+	key.SetTo(picture, state);
+
+	BPoint origin = state->CombinedOrigin();
+	IntPoint leftTop((int32)floorf(origin.x), (int32)floorf(origin.y));
+
+	Entry* entry = fTable->Lookup(key);
+	if (entry != NULL) {
+		fHitCount++;
+		if (fUsageList.Head() != entry) {
+			fUsageList.Remove(entry);
+			fUsageList.Add(entry, false);
+		}
+
+		BReference<UtilityBitmap> bitmap(entry->bitmap);
+		leftTop += entry->offset;
+		locker.Unlock();
+
+		return _DrawBitmap(canvas, bitmap, leftTop);
+	}
+
+	fMissCount++;
+	if (!_IsSupported(picture, state)) {
+		fUnsupportedCount++;
+		return false;
+	}
+	if (!_MissedRecently(key.hash))
+		return false;
+
+	locker.Unlock();
+
+	IntPoint offset;
+	BReference<UtilityBitmap> bitmap(_Render(picture, canvas, offset), true);
+	if (bitmap == NULL)
+		return false;
+
+	locker.Lock();
+	_Insert(key, bitmap, offset);
+	locker.Unlock();
+
+	return _DrawBitmap(canvas, bitmap, leftTop + offset);
+}
+
+
+/*!	Removes all rasters of \a picture; it is about to go away.
+*/
+void
+PictureRasterCache::Remove(ServerPicture* picture)
+{
+	AutoLocker<BLocker> locker(fLock);
+
+	if ((picture->fRasterFlags & RASTER_CACHED) == 0)
+		return;
+
+	EntryList::Iterator iterator = fUsageList.GetIterator();
+	while (Entry* entry = iterator.Next()) {
+		if (entry->key.picture == picture) {
+			iterator.Remove();
+			_RemoveEntry(entry);
+		}
+	}
+
+	picture->fRasterFlags &= ~RASTER_CACHED;
+}
+
+
+void
+PictureRasterCache::Clear()
+{
+	AutoLocker<BLocker> locker(fLock);
+
+	while (Entry* entry = fUsageList.RemoveHead())
+		_RemoveEntry(entry);
+
+	fHitCount = 0;
+	fMissCount = 0;
+	fUnsupportedCount = 0;
+	fReplacedCount = 0;
+}
+
+
+bool
+PictureRasterCache::_IsSupported(ServerPicture* picture,
+	const DrawState* state)
+{
+	off_t length = picture->DataLength();
+	if (picture->fRasterFlagsLength != length) {
+		scan_state scanState;
+		memset(&scanState, 0, sizeof(scanState));
+
+		BMallocIO* mallocIO = dynamic_cast<BMallocIO*>(picture->fData.Get());
+		if (mallocIO != NULL) {
+			BPrivate::PicturePlayer player(mallocIO->Buffer(),
+				mallocIO->BufferLength(), ServerPicture::PictureList::Private(
+					picture->fPictures.Get()).AsBList());
+			player.Play(kScanPlayerCallbacks, sizeof(kScanPlayerCallbacks),
+				&scanState);
+		} else
+			scanState.flags |= RASTER_UNSUPPORTED;
+
+		picture->fRasterFlags = scanState.flags
+			| (picture->fRasterFlags & RASTER_CACHED);
+		picture->fRasterFlagsLength = length;
+	}
+
+	uint32 flags = picture->fRasterFlags;
+	if ((flags & RASTER_UNSUPPORTED) != 0)
+		return false;
+
+	// The drawing mode is locked to B_OP_ALPHA while rendering, and the
+	// alpha source mode to the one of the canvas.
+	if ((flags & RASTER_INITIAL_MODE) != 0
+		&& state->GetDrawingMode() != B_OP_ALPHA) {
+		return false;
+	}
+	if ((flags & (state->AlphaSrcMode() == B_CONSTANT_ALPHA
+			? RASTER_PIXEL_ALPHA : RASTER_CONSTANT_ALPHA)) != 0) {
+		return false;
+	}
+
+	// sub-pixel anti-aliased text does not survive the detour through an
+	// alpha channel
+	if ((flags & RASTER_TEXT) != 0 && gSubpixelAntialiasing)
+		return false;
+
+	return true;
+}
+
+
+bool
+PictureRasterCache::_MissedRecently(uint32 hash)
+{
+	for (int32 i = 0; i < kRecentMissCount; i++) {
+		if (fRecentMisses[i] == hash)
+			return true;
+	}
+
+	fRecentMisses[fNextRecentMiss] = hash;
+	fNextRecentMiss = (fNextRecentMiss + 1) % kRecentMissCount;
+	return false;
+}
+
+
+/*!	Renders the picture the same way Layer does, but with the drawing mode
+	locked to B_OP_ALPHA in composite mode, and without the clipping of the
+	canvas, which is applied when the result is drawn.
+*/
+UtilityBitmap*
+PictureRasterCache::_Render(ServerPicture* picture, Canvas* canvas,
+	IntPoint& _offset)
+{
+	DrawState* state = canvas->CurrentState();
+
+	BRect boundingBox;
+	PictureBoundingBoxPlayer::Play(picture, state, &boundingBox);
+	if (!boundingBox.IsValid())
+		return NULL;
+
+	// the same rounding as in Layer::_DetermineBoundingBox()
+	boundingBox.left = floorf(boundingBox.left);
+	boundingBox.right = ceilf(boundingBox.right) + 2;
+	boundingBox.top = floorf(boundingBox.top);
+	boundingBox.bottom = ceilf(boundingBox.bottom) + 2;
+
+	if ((boundingBox.Width() + 1) * (boundingBox.Height() + 1) * 4
+			> kMaxRasterBytes) {
+		return NULL;
+	}
+
+	BReference<UtilityBitmap> bitmap(new(std::nothrow) UtilityBitmap(
+		boundingBox, B_RGBA32, 0), true);
+	if (bitmap == NULL || !bitmap->IsValid())
+		return NULL;
+
+	memset(bitmap->Bits(), 0, bitmap->BitsLength());
+
+	BitmapHWInterface interface(bitmap);
+	ObjectDeleter<DrawingEngine> engine(interface.CreateDrawingEngine());
+	if (!engine.IsSet())
+		return NULL;
+
+	engine->SetRendererOffset(boundingBox.left, boundingBox.top);
+
+	RasterCanvas rasterCanvas(engine.Get(), *state, boundingBox);
+
+	DrawState* rasterState = rasterCanvas.CurrentState();
+	rasterState->SetDrawingModeLocked(false);
+	rasterState->SetDrawingMode(B_OP_ALPHA);
+	rasterState->SetBlendingMode(state->AlphaSrcMode(), B_ALPHA_COMPOSITE);
+	rasterState->SetDrawingModeLocked(true);
+	rasterCanvas.PushState();
+
+	rasterCanvas.ResyncDrawState();
+
+	if (engine->LockParallelAccess()) {
+		rasterCanvas.UpdateCurrentDrawingRegion();
+		picture->Play(&rasterCanvas);
+		engine->UnlockParallelAccess();
+	}
+
+	rasterCanvas.PopState();
+
+	BPoint origin = state->CombinedOrigin();
+	_offset.x = (int32)boundingBox.left - (int32)floorf(origin.x);
+	_offset.y = (int32)boundingBox.top - (int32)floorf(origin.y);
+
+	return bitmap.Detach();
+}
+
+
+void
+PictureRasterCache::_Insert(const Key& key, UtilityBitmap* bitmap,
+	const IntPoint& offset)
+{
+	if (fTable->Lookup(key) != NULL) {
+		// someone else was faster
+		return;
+	}
+
+	size_t size = bitmap->BitsLength() + sizeof(Entry);
+	while (fCurrentCacheBytes + size > kMaxCacheBytes) {
+		Entry* entry = fUsageList.RemoveTail();
+		if (entry == NULL)
+			return;
+
+		_RemoveEntry(entry);
+		fReplacedCount++;
+	}
+
+	Entry* entry = new(std::nothrow) Entry;
+	if (entry == NULL)
+		return;
+
+	entry->key = key;
+	entry->bitmap = bitmap;
+	entry->offset = offset;
+	entry->size = size;
+
+	if (fTable->Insert(entry) != B_OK) {
+		delete entry;
+		return;
+	}
+
+	bitmap->AcquireReference();
+	fUsageList.Add(entry, false);
+	fCurrentCacheBytes += size;
+	key.picture->fRasterFlags |= RASTER_CACHED;
+}
+
+
+/*!	Removes the entry from the table; it must already have been removed from
+	the usage list.
+*/
+void
+PictureRasterCache::_RemoveEntry(Entry* entry)
+{
+	fTable->RemoveUnchecked(entry);
+	fCurrentCacheBytes -= entry->size;
+
+	entry->bitmap->ReleaseReference();
+	delete entry;
+}
+
+
+/*!	Blends the bitmap onto the canvas like Canvas::BlendLayer() does, and
+	returns \c false if the canvas did not allow it.
+*/
+bool
+PictureRasterCache::_DrawBitmap(Canvas* canvas, UtilityBitmap* bitmap,
+	const IntPoint& leftTop)
+{
+	alpha_function alphaFncMode = canvas->CurrentState()->AlphaFncMode();
+
+	canvas->PushState();
+
+	DrawState* state = canvas->CurrentState();
+	if (!state->SetDrawingMode(B_OP_ALPHA)
+		|| !state->SetBlendingMode(B_PIXEL_ALPHA, alphaFncMode)) {
+		// the drawing mode is locked
+		canvas->PopState();
+		return false;
+	}
+	state->SetTransformEnabled(false);
+
+	BRect destination = bitmap->Bounds();
+	destination.OffsetBy(leftTop.x, leftTop.y);
+	canvas->LocalToScreenTransform().Apply(&destination);
+
+	canvas->ResyncDrawState();
+
+	canvas->GetDrawingEngine()->DrawBitmap(bitmap, bitmap->Bounds(),
+		destination, 0);
+
+	state->SetTransformEnabled(true);
+
+	canvas->PopState();
+	canvas->ResyncDrawState();
+	return true;
+}
+
+
+void
+PictureRasterCache::_PrintAndResetStatistics()
+{
+	debug_printf("PictureRasterCache statistics: rasters=%" B_PRIu32
+		" bytes=%" B_PRIuSIZE " hit=%4" B_PRIu32 " miss=%4" B_PRIu32
+		" unsupported=%4" B_PRIu32 " replaced=%4" B_PRIu32 "\n",
+		fTable->CountElements(), fCurrentCacheBytes, fHitCount, fMissCount,
+		fUnsupportedCount, fReplacedCount);
+	fHitCount = 0;
+	fMissCount = 0;
+	fUnsupportedCount = 0;
+	fReplacedCount = 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef PICTURE_RASTER_CACHE_H
+#define PICTURE_RASTER_CACHE_H
+
+
+#include <Locker.h>
+#include <Point.h>
+#include <util/DoublyLinkedList.h>
+#include <util/OpenHashTable.h>
+
+#include "IntPoint.h"
+
+
+class Canvas;
+class DrawState;
+class ServerPicture;
+class UtilityBitmap;
+
+
+/*!	Keeps the rendered result of pictures that are drawn over and over again
+	with the same drawing state, like the ones of picture buttons, so that
+	they only need to be blended onto the canvas instead of being played.
+
+	Only pictures that are entirely drawn in B_OP_ALPHA are cached, as only
+	those give the same result when they are rendered into a transparent
+	bitmap first, which is then composed onto the canvas.
+*/
+class PictureRasterCache {
+private:
+	enum {
+		kMaxCacheBytes = 8 * 1024 * 1024, // 8 MiB
+		kMaxRasterBytes = 512 * 1024,
+		kRecentMissCount = 32
+	};
+
+public:
+								PictureRasterCache();
+								~PictureRasterCache();
+
+	static	PictureRasterCache*	Default();
+
+			bool				Draw(ServerPicture* picture, Canvas* canvas);
+			void				Remove(ServerPicture* picture);
+
+			void				Clear();
+
+private:
+			struct Key;
+			struct Entry;
+			struct HashDefinition;
+
+			typedef BOpenHashTable<HashDefinition> EntryTable;
+			typedef DoublyLinkedList<Entry> EntryList;
+
+			bool				_IsSupported(ServerPicture* picture,
+									const DrawState* state);
+			bool				_MissedRecently(uint32 hash);
+			UtilityBitmap*		_Render(ServerPicture* picture,
+									Canvas* canvas, IntPoint& _offset);
+			void				_Insert(const Key& key,
+									UtilityBitmap* bitmap,
+									const IntPoint& offset);
+			void				_RemoveEntry(Entry* entry);
+			bool				_DrawBitmap(Canvas* canvas,
+									UtilityBitmap* bitmap,
+									const IntPoint& leftTop);
+			void				_PrintAndResetStatistics();
+
+private:
+	static	PictureRasterCache	sDefaultInstance;
+
+			BLocker				fLock;
+			EntryTable*			fTable;
+			EntryList			fUsageList;
+									// most recently used raster first
+			size_t				fCurrentCacheBytes;
+
+			uint32				fRecentMisses[kRecentMissCount];
+			int32				fNextRecentMiss;
+
+			// Statistics counters
+			uint32				fHitCount;
+			uint32				fMissCount;
+			uint32				fUnsupportedCount;
+			uint32				fReplacedCount;
+};
+
+
+#endif // PICTURE_RASTER_CACHE_H
@@ -1,5 +1,6 @@
 /*
  * Copyright 2007-2016, Haiku Inc. All rights reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -9,9 +10,16 @@
 
 #include "ProfileMessageSupport.h"
 
+#include <stdio.h>
+
+#include <OS.h>
+
 #include <ServerProtocol.h>
 
 
+static const bigtime_t kLockProfileInterval = 5000000;
+
+
 const char*
 string_for_message_code(uint32 code)
 {
@@ -327,3 +335,80 @@ string_for_message_code(uint32 code)
 }
 
 
+
+
+// #pragma mark - LockProfile
+
+
+LockProfile::LockProfile(const char* name)
+	:
+	fName(name),
+	fWaitCount(0),
+	fWaitTime(0),
+	fMaxWaitTime(0),
+	fHoldCount(0),
+	fHoldTime(0),
+	fMaxHoldTime(0),
+	fLastPrinted(system_time())
+{
+}
+
+
+void
+LockProfile::AddWaitTime(bigtime_t time)
+{
+	_Add(fWaitCount, fWaitTime, fMaxWaitTime, time);
+	_PrintIfDue();
+}
+
+
+void
+LockProfile::AddHoldTime(bigtime_t time)
+{
+	_Add(fHoldCount, fHoldTime, fMaxHoldTime, time);
+	_PrintIfDue();
+}
+
+
+void
+LockProfile::_Add(int32& count, int64& total, int64& maximum, bigtime_t time)
+{
+	atomic_add(&count, 1);
+	atomic_add64(&total, time);
+
+	int64 previous = atomic_get64(&maximum);
+	while (time > previous) {
+		int64 current = atomic_test_and_set64(&maximum, time, previous);
+		if (current == previous)
+			break;
+		previous = current;
+	}
+}
+
+
+void
+LockProfile::_PrintIfDue()
+{
+	bigtime_t now = system_time();
+	int64 lastPrinted = atomic_get64(&fLastPrinted);
+	if (now - lastPrinted < kLockProfileInterval
+		|| atomic_test_and_set64(&fLastPrinted, now, lastPrinted)
+			!= lastPrinted) {
+		return;
+	}
+
+	// the numbers of other threads may be off by one sample, that's good
+	// enough for statistics
+	int32 waitCount = atomic_get_and_set(&fWaitCount, 0);
+	int64 waitTime = atomic_get_and_set64(&fWaitTime, 0);
+	int32 holdCount = atomic_get_and_set(&fHoldCount, 0);
+	int64 holdTime = atomic_get_and_set64(&fHoldTime, 0);
+
+	printf("%s: %" B_PRId32 " locks in %" B_PRId64 " ms, wait avg %" B_PRId64
+		" us, max %" B_PRId64 " us, hold avg %" B_PRId64 " us, max %"
+		B_PRId64 " us\n", fName, waitCount, (now - lastPrinted) / 1000,
+		waitCount > 0 ? waitTime / waitCount : 0,
+		atomic_get_and_set64(&fMaxWaitTime, 0),
+		holdCount > 0 ? holdTime / holdCount : 0,
+		atomic_get_and_set64(&fMaxHoldTime, 0));
+}
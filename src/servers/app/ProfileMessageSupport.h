@@ -1,5 +1,6 @@
 /*
  * Copyright 2007, Haiku, Inc. All rights reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -12,7 +13,39 @@
 #include <String.h>
 
 
+// Collect how long the window lock of the Desktop is waited for and held
+//#define PROFILE_WINDOW_LOCK
+
+
 const char* string_for_message_code(uint32 code);
 
 
+/*!	Collects the times a lock is waited for and held, and prints a summary
+	every few seconds while it is in use. Can be used from several threads
+	at once.
+*/
+class LockProfile {
+public:
+								LockProfile(const char* name);
+
+			void				AddWaitTime(bigtime_t time);
+			void				AddHoldTime(bigtime_t time);
+
+private:
+			void				_Add(int32& count, int64& total,
+									int64& maximum, bigtime_t time);
+			void				_PrintIfDue();
+
+private:
+			const char*			fName;
+			int32				fWaitCount;
+			int64				fWaitTime;
+			int64				fMaxWaitTime;
+			int32				fHoldCount;
+			int64				fHoldTime;
+			int64				fMaxHoldTime;
+			int64				fLastPrinted;
+};
+
+
 #endif // PROFILE_MESSAGE_SUPPORT_H
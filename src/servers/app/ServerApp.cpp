@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2016, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -724,6 +725,41 @@ ServerApp::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 			break;
 		}
 
+		case AS_SET_RETAIN_WINDOW_CONTENTS:
+		{
+			STRACE(("ServerApp %s: Set Retain Window Contents\n",
+				Signature()));
+
+			// Attached Data:
+			// 1) bool retain
+
+			bool retain;
+			if (link.Read<bool>(&retain) == B_OK) {
+				LockedDesktopSettings settings(fDesktop);
+				settings.SetRetainWindowContents(retain);
+			}
+			break;
+		}
+
+		case AS_GET_RETAIN_WINDOW_CONTENTS:
+		{
+			STRACE(("ServerApp %s: Get Retain Window Contents\n",
+				Signature()));
+
+			if (fDesktop->LockSingleWindow()) {
+				DesktopSettings settings(fDesktop);
+
+				fLink.StartMessage(B_OK);
+				fLink.Attach<bool>(settings.RetainWindowContents());
+
+				fDesktop->UnlockSingleWindow();
+			} else
+				fLink.StartMessage(B_ERROR);
+
+			fLink.Flush();
+			break;
+		}
+
 		case AS_CREATE_BITMAP:
 		{
 			STRACE(("ServerApp %s: Received BBitmap creation request\n",
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2013, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -96,6 +97,9 @@ public:
 
 			BPrivate::BTokenSpace& ViewTokens() { return fViewTokens; }
 
+			ClientMemoryAllocator* MemoryAllocator() const
+									{ return fMemoryAllocator.Get(); }
+
 			void				NotifyDeleteClientArea(area_id serverArea);
 			AppFontManager*		FontManager() { return fAppFontManager; }
 
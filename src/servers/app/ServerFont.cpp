@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2016, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -15,6 +16,7 @@
 #include "Angle.h"
 #include "AppFontManager.h"
 #include "GlyphLayoutEngine.h"
+#include "GlyphRunCache.h"
 #include "GlobalFontManager.h"
 #include "truncate_string.h"
 #include "utf8_functions.h"
@@ -1061,13 +1063,14 @@ class StringWidthConsumer {
  public:
 	StringWidthConsumer()
 		:
-		width(0.0)
+		width(0.0),
+		height(0.0)
 	{
 	}
 
 	bool NeedsVector() { return false; }
 	void Start() {}
-	void Finish(double x, double y) { width = x; }
+	void Finish(double x, double y) { width = x; height = y; }
 	void ConsumeEmptyGlyph(int32 index, uint32 charCode, double x, double y) {}
 	bool ConsumeGlyph(int32 index, uint32 charCode, const GlyphCache* glyph,
 		FontCacheEntry* entry, double x, double y, double advanceX,
@@ -1076,7 +1079,8 @@ class StringWidthConsumer {
 		return true;
 	}
 
-	float width;
+	double width;
+	double height;
 };
 
 
@@ -1087,12 +1091,25 @@ ServerFont::StringWidth(const char *string, int32 numBytes,
 	if (!string || numBytes <= 0)
 		return 0.0;
 
+	GlyphRunCache::Key key;
+	GlyphRunCache::Run run;
+	bool cacheable = key.SetTo(*this, false, string, numBytes, deltaArray,
+		fSpacing);
+	if (cacheable && GlyphRunCache::Default()->Lookup(key, run))
+		return run.endX;
+
 	StringWidthConsumer consumer;
 	if (!GlyphLayoutEngine::LayoutGlyphs(consumer, *this, string, numBytes,
 			INT32_MAX, deltaArray, fSpacing)) {
 		return 0.0;
 	}
 
+	if (cacheable) {
+		run.endX = consumer.width;
+		run.endY = consumer.height;
+		GlyphRunCache::Default()->Put(key, run);
+	}
+
 	return consumer.width;
 }
 
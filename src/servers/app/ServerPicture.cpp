@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2019, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -21,6 +22,7 @@
 #include "DrawState.h"
 #include "GlobalFontManager.h"
 #include "Layer.h"
+#include "PictureRasterCache.h"
 #include "ServerApp.h"
 #include "ServerBitmap.h"
 #include "ServerFont.h"
@@ -1075,7 +1077,9 @@ static const BPrivate::picture_player_callbacks kPicturePlayerCallbacks = {
 ServerPicture::ServerPicture()
 	:
 	fFile(NULL),
-	fOwner(NULL)
+	fOwner(NULL),
+	fRasterFlags(0),
+	fRasterFlagsLength(-1)
 {
 	fToken = gTokenSpace.NewToken(kPictureToken, this);
 	fData.SetTo(new(std::nothrow) BMallocIO());
@@ -1088,7 +1092,9 @@ ServerPicture::ServerPicture(const ServerPicture& picture)
 	:
 	fFile(NULL),
 	fData(NULL),
-	fOwner(NULL)
+	fOwner(NULL),
+	fRasterFlags(0),
+	fRasterFlagsLength(-1)
 {
 	fToken = gTokenSpace.NewToken(kPictureToken, this);
 
@@ -1113,7 +1119,9 @@ ServerPicture::ServerPicture(const char* fileName, int32 offset)
 	:
 	fFile(NULL),
 	fData(NULL),
-	fOwner(NULL)
+	fOwner(NULL),
+	fRasterFlags(0),
+	fRasterFlagsLength(-1)
 {
 	fToken = gTokenSpace.NewToken(kPictureToken, this);
 
@@ -1140,6 +1148,8 @@ ServerPicture::~ServerPicture()
 
 	gTokenSpace.RemoveToken(fToken);
 
+	PictureRasterCache::Default()->Remove(this);
+
 	if (fPictures.IsSet()) {
 		for (int32 i = fPictures->CountItems(); i-- > 0;) {
 			ServerPicture* picture = fPictures->ItemAt(i);
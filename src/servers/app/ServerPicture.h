@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2019, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -69,6 +70,7 @@ public:
 
 private:
 	friend class PictureBoundingBoxPlayer;
+	friend class PictureRasterCache;
 
 			typedef BObjectList<ServerPicture> PictureList;
 
@@ -82,6 +84,10 @@ private:
 			BReference<ServerPicture>
 								fPushed;
 			ServerApp*			fOwner;
+
+			// owned by the PictureRasterCache, and protected by its lock
+			uint32				fRasterFlags;
+			off_t				fRasterFlagsLength;
 };
 
 
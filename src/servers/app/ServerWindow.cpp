@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2019, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -67,6 +68,7 @@
 #include "HWInterface.h"
 #include "Layer.h"
 #include "Overlay.h"
+#include "PictureRasterCache.h"
 #include "ProfileMessageSupport.h"
 #include "RenderingBuffer.h"
 #include "ServerApp.h"
@@ -80,6 +82,10 @@
 using std::nothrow;
 
 
+static const size_t kCommandRingSize = 64 * 1024;
+	// shared with the client, which writes its drawing commands into it
+
+
 //#define TRACE_SERVER_WINDOW
 #ifdef TRACE_SERVER_WINDOW
 #	include <stdio.h>
@@ -170,6 +176,7 @@ ServerWindow::ServerWindow(const char* title, ServerApp* app,
 	fMessagePort(-1),
 	fClientReplyPort(clientPort),
 	fClientLooperPort(looperPort),
+	fCommandRingIsNewArea(false),
 
 	fClientToken(clientToken),
 
@@ -277,6 +284,15 @@ ServerWindow::Init(BRect frame, window_look look, window_feel feel,
 	fLink.SetSenderPort(fClientReplyPort);
 	fLink.SetReceiverPort(fMessagePort);
 
+	// Let the client pass its messages through shared memory; if this
+	// fails, it just keeps using the port.
+	if (App()->MemoryAllocator() != NULL) {
+		void* ring = fCommandRing.Allocate(App()->MemoryAllocator(),
+			kCommandRingSize, fCommandRingIsNewArea);
+		if (ring != NULL)
+			fLink.Receiver().SetRing(ring, kCommandRingSize);
+	}
+
 	// We cannot call MakeWindow in the constructor, since it
 	// is a virtual function!
 	fWindow.SetTo(MakeWindow(frame, fTitle, look, feel, flags, workspace));
@@ -2482,6 +2498,9 @@ void
 ServerWindow::_DispatchViewDrawingMessage(int32 code,
 	BPrivate::LinkReceiver &link)
 {
+	if (!fWindow->InUpdate())
+		fWindow->ViewDrawn(fCurrentView);
+
 	if (!fCurrentView->IsVisible() || !fWindow->IsVisible()) {
 		if (link.NeedsReply()) {
 			debug_printf("ServerWindow::DispatchViewDrawingMessage() got "
@@ -3175,7 +3194,10 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 					fCurrentView->SetDrawingOrigin(where);
 
 					fCurrentView->PushState();
-					picture->Play(fCurrentView);
+					if (!PictureRasterCache::Default()->Draw(picture,
+							fCurrentView)) {
+						picture->Play(fCurrentView);
+					}
 					fCurrentView->PopState();
 
 					fCurrentView->PopState();
@@ -4148,6 +4170,14 @@ ServerWindow::_MessageLooper()
 	fLink.Attach<float>((float)maxWidth);
 	fLink.Attach<float>((float)minHeight);
 	fLink.Attach<float>((float)maxHeight);
+
+	area_id ringArea = fCommandRing.Area();
+	fLink.Attach<area_id>(ringArea);
+	if (ringArea >= B_OK) {
+		fLink.Attach<uint8>(fCommandRingIsNewArea ? kNewAllocatorArea : 0);
+		fLink.Attach<uint32>(fCommandRing.AreaOffset());
+		fLink.Attach<uint32>(kCommandRingSize);
+	}
 	fLink.Flush();
 
 	BPrivate::LinkReceiver& receiver = fLink.Receiver();
@@ -4269,9 +4299,19 @@ ServerWindow::_MessageLooper()
 				fDesktop->UnlockAllWindows();
 
 			// Only process up to 70 waiting messages at once (we have the
-			// Desktop locked), but don't hold the lock longer than 10 ms
+			// Desktop locked), but don't hold the lock longer than 10 ms,
+			// and let the Desktop go first when it waits for all windows
 			if (!receiver.HasMessages() || ++messagesProcessed > 70
-				|| system_time() - processingStart > 10000) {
+				|| system_time() - processingStart > 10000
+				|| fDesktop->AllWindowsLockWanted()) {
+				if (fWindow->HasPendingBackingStoreUpdate()) {
+					// store what has been drawn outside of updates
+					if (!lockedDesktopSingleWindow) {
+						fDesktop->LockSingleWindow();
+						lockedDesktopSingleWindow = true;
+					}
+					fWindow->UpdateBackingStore();
+				}
 				if (lockedDesktopSingleWindow)
 					fDesktop->UnlockSingleWindow();
 				break;
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2009, Haiku.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -26,6 +27,7 @@
 #include <PortLink.h>
 #include <TokenSpace.h>
 
+#include "ClientMemoryAllocator.h"
 #include "EventDispatcher.h"
 #include "MessageLooper.h"
 
@@ -162,6 +164,8 @@ private:
 			port_id				fMessagePort;
 			port_id				fClientReplyPort;
 			port_id				fClientLooperPort;
+			ClientMemory		fCommandRing;
+			bool				fCommandRingIsNewArea;
 			BMessenger			fFocusMessenger;
 			BMessenger			fHandlerMessenger;
 			::EventTarget		fEventTarget;
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2020, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT license.
  *
  * Authors:
@@ -27,6 +28,7 @@
 #include <ViewPrivate.h>
 #include <WindowPrivate.h>
 
+#include "BackingStore.h"
 #include "ClickTarget.h"
 #include "Decorator.h"
 #include "DecorManager.h"
@@ -55,6 +57,20 @@
 
 using std::nothrow;
 
+
+static int64
+region_area(const BRegion& region)
+{
+	int64 area = 0;
+	for (int32 i = 0; i < region.CountRects(); i++) {
+		clipping_rect rect = region.RectAtInt(i);
+		area += (int64)(rect.right - rect.left + 1)
+			* (rect.bottom - rect.top + 1);
+	}
+	return area;
+}
+
+
 // if the background clearing is delayed until
 // the client draws the view, we have less flickering
 // when contents have to be redrawn because of resizing
@@ -95,6 +111,13 @@ Window::Window(const BRect& frame, const char *name,
 	fDrawingEngine(drawingEngine),
 	fDesktop(window->Desktop()),
 
+	fLastDrawnView(NULL),
+	fUpdateMessageCount(0),
+	fExposeCount(0),
+	fRestoredExposeCount(0),
+	fRestoredPixelCount(0),
+	fRedrawnPixelCount(0),
+
 	fCurrentUpdateSession(&fUpdateSessions[0]),
 	fPendingUpdateSession(&fUpdateSessions[1]),
 	fUpdateRequested(false),
@@ -160,6 +183,18 @@ Window::Window(const BRect& frame, const char *name,
 		}
 	}
 
+	// offscreen windows draw into their bitmap anyway, and direct windows
+	// bypass us altogether
+	DesktopSettings settings(fDesktop);
+	if (settings.RetainWindowContents() && fFeel != kOffscreenWindowFeel
+		&& (fFlags & kWindowScreenFlag) == 0) {
+		fBackingStore.SetTo(new(nothrow) BackingStore);
+		if (fBackingStore.IsSet()) {
+			fBackingStore->SetSize(fFrame.IntegerWidth() + 1,
+				fFrame.IntegerHeight() + 1);
+		}
+	}
+
 	STRACE(("Window %p, %s:\n", this, Name()));
 	STRACE(("\tFrame: (%.1f, %.1f, %.1f, %.1f)\n", fFrame.left, fFrame.top,
 		fFrame.right, fFrame.bottom));
@@ -179,6 +214,22 @@ Window::~Window()
 }
 
 
+/*!	Prints how many update messages were sent to the client, and how much
+	of the exposed parts of the window could be restored from its backing
+	store.
+*/
+void
+Window::DumpRedrawStatistics() const
+{
+	debug_printf("Window \"%s\"%s: %" B_PRId32 " update messages, %"
+		B_PRId32 " exposes, %" B_PRId32 " of them restored, %" B_PRId64
+		" pixels restored, %" B_PRId64 " exposed to the client\n", Title(),
+		fBackingStore.IsSet() ? " (retained)" : "", fUpdateMessageCount,
+		fExposeCount, fRestoredExposeCount, fRestoredPixelCount,
+		fRedrawnPixelCount);
+}
+
+
 status_t
 Window::InitCheck() const
 {
@@ -368,6 +419,13 @@ Window::ResizeBy(int32 x, int32 y, BRegion* dirtyRegion, bool resizeStack)
 	fContentRegionValid = false;
 	fEffectiveDrawingRegionValid = false;
 
+	// views may follow the new size in any way, so nothing stays valid
+	if (fBackingStore.IsSet()) {
+		fBackingStore->SetSize(fFrame.IntegerWidth() + 1,
+			fFrame.IntegerHeight() + 1);
+		fBackingStoreUpdateRegion.MakeEmpty();
+	}
+
 	if (fTopView.IsSet()) {
 		fTopView->ResizeBy(x, y, dirtyRegion);
 		fTopView->UpdateOverlay();
@@ -446,6 +504,7 @@ Window::ScrollViewBy(View* view, int32 dx, int32 dy)
 		return;
 
 	view->ScrollBy(dx, dy, dirty);
+	_InvalidateContents(*dirty);
 
 //fDrawingEngine->FillRegion(*dirty, (rgb_color){ 255, 0, 255, 255 });
 //snooze(20000);
@@ -464,6 +523,17 @@ void
 Window::CopyContents(BRegion* region, int32 xOffset, int32 yOffset)
 {
 	// executed in ServerWindow thread with the read lock held
+	if (fBackingStore.IsSet()) {
+		// the whole destination changes, even where it is not visible
+		BRegion* destination = fRegionPool.GetRegion(*region);
+		if (destination != NULL) {
+			destination->OffsetBy(xOffset, yOffset);
+			_InvalidateContents(*destination);
+			fRegionPool.Recycle(destination);
+		} else
+			fBackingStore->MakeEmpty();
+	}
+
 	if (!IsVisible())
 		return;
 
@@ -517,6 +587,9 @@ Window::CopyContents(BRegion* region, int32 xOffset, int32 yOffset)
 					// ... and even exclude them from the pending dirty region!
 					if (fPendingUpdateSession->IsUsed())
 						fPendingUpdateSession->DirtyRegion().Exclude(copyRegion);
+
+					if (fBackingStore.IsSet())
+						_StoreContents(*copyRegion);
 				}
 
 				fRegionPool.Recycle(copyRegion);
@@ -548,6 +621,71 @@ Window::CopyContents(BRegion* region, int32 xOffset, int32 yOffset)
 }
 
 
+/*!	Called for every drawing command of the client outside of an update
+	session. The parts of the view that were drawn on screen are copied into
+	the backing store by UpdateBackingStore() later, the rest of it is no
+	longer valid.
+*/
+void
+Window::ViewDrawn(View* view)
+{
+	// executed in ServerWindow with the read lock held
+	if (!fBackingStore.IsSet() || fInUpdate)
+		return;
+
+	// consecutive drawing commands mostly go to the same view
+	if (view == fLastDrawnView && !DrawingRegionChanged(view))
+		return;
+
+	if (!fContentRegionValid)
+		_UpdateContentRegion();
+
+	BRegion* drawn = fRegionPool.GetRegion(
+		view->ScreenAndUserClipping(&fContentRegion));
+	if (drawn == NULL) {
+		fBackingStore->MakeEmpty();
+		return;
+	}
+
+	_InvalidateContents(*drawn);
+
+	if (IsVisible() && view->IsVisible()) {
+		drawn->IntersectWith(&VisibleContentRegion());
+		drawn->OffsetBy(-(int32)fFrame.left, -(int32)fFrame.top);
+		fBackingStoreUpdateRegion.Include(drawn);
+	}
+	fRegionPool.Recycle(drawn);
+
+	fLastDrawnView = view;
+}
+
+
+/*!	Stores what the client has drawn outside of update sessions since the
+	last call. ServerWindow calls this after processing a batch of messages.
+*/
+void
+Window::UpdateBackingStore()
+{
+	// executed in ServerWindow with the read lock held
+	if (!fBackingStore.IsSet() || !HasPendingBackingStoreUpdate())
+		return;
+
+	BRegion* region = fRegionPool.GetRegion(fBackingStoreUpdateRegion);
+	fBackingStoreUpdateRegion.MakeEmpty();
+	fLastDrawnView = NULL;
+	if (region == NULL)
+		return;
+
+	region->OffsetBy((int32)fFrame.left, (int32)fFrame.top);
+	if (IsVisible()) {
+		region->IntersectWith(&VisibleContentRegion());
+		_StoreContents(*region);
+	}
+
+	fRegionPool.Recycle(region);
+}
+
+
 // #pragma mark -
 
 
@@ -784,6 +922,8 @@ Window::RedrawDirtyRegion()
 		dirtyContentRegion->IntersectWith(&fDirtyRegion);
 		exposeContentRegion->IntersectWith(&fExposeRegion);
 
+		_RestoreContents(*dirtyContentRegion, *exposeContentRegion);
+
 		_TriggerContentRedraw(*dirtyContentRegion, *exposeContentRegion);
 
 		fRegionPool.Recycle(dirtyContentRegion);
@@ -821,8 +961,13 @@ Window::MarkContentDirty(BRegion& dirtyRegion, BRegion& exposeRegion)
 	// since this won't affect other windows, read locking
 	// is sufficient. If there was no dirty region before,
 	// an update message is triggered
-	if (fHidden || IsOffscreenWindow())
+	if (fHidden || IsOffscreenWindow()) {
+		if (fBackingStore.IsSet())
+			fBackingStore->MakeEmpty();
 		return;
+	}
+
+	_InvalidateContents(dirtyRegion);
 
 	dirtyRegion.IntersectWith(&VisibleContentRegion());
 	exposeRegion.IntersectWith(&VisibleContentRegion());
@@ -834,8 +979,13 @@ void
 Window::MarkContentDirtyAsync(BRegion& dirtyRegion)
 {
 	// NOTE: see comments in ProcessDirtyRegion()
-	if (fHidden || IsOffscreenWindow())
+	if (fHidden || IsOffscreenWindow()) {
+		if (fBackingStore.IsSet())
+			fBackingStore->MakeEmpty();
 		return;
+	}
+
+	_InvalidateContents(dirtyRegion);
 
 	dirtyRegion.IntersectWith(&VisibleContentRegion());
 
@@ -855,6 +1005,8 @@ Window::InvalidateView(View* view, BRegion& viewRegion)
 			_UpdateContentRegion();
 
 		view->LocalToScreenTransform().Apply(&viewRegion);
+		_InvalidateContents(viewRegion);
+
 		viewRegion.IntersectWith(&VisibleContentRegion());
 		if (viewRegion.CountRects() > 0) {
 			viewRegion.IntersectWith(
@@ -864,6 +1016,10 @@ Window::InvalidateView(View* view, BRegion& viewRegion)
 //snooze(10000);
 			_TriggerContentRedraw(viewRegion);
 		}
+	} else if (view != NULL && fBackingStore.IsSet()) {
+		// the client will not be asked to redraw the view before it
+		// is shown again
+		fBackingStore->MakeEmpty();
 	}
 }
 
@@ -1849,6 +2005,8 @@ Window::_TransferToUpdateSession(BRegion* contentDirtyRegion)
 //fDrawingEngine->FillRegion(*contentDirtyRegion, sPendingColor);
 //snooze(20000);
 
+	_InvalidateContents(*contentDirtyRegion);
+
 	// add to pending
 	fPendingUpdateSession->SetUsed(true);
 	fPendingUpdateSession->Include(contentDirtyRegion);
@@ -1879,6 +2037,71 @@ Window::_SendUpdateMessage()
 
 	fUpdateRequested = true;
 	fEffectiveDrawingRegionValid = false;
+	fUpdateMessageCount++;
+}
+
+
+void
+Window::_InvalidateContents(const BRegion& region)
+{
+	if (fBackingStore.IsSet())
+		fBackingStore->Invalidate(region, fFrame.LeftTop());
+}
+
+
+/*!	Stores the visible \a region of the window, which is expected to show
+	up to date contents, in the backing store, except for the parts that
+	are about to be redrawn anyway.
+*/
+void
+Window::_StoreContents(BRegion& region)
+{
+	fLastDrawnView = NULL;
+
+	if (fWindow->IsDirectlyAccessing()) {
+		fBackingStore->MakeEmpty();
+		return;
+	}
+
+	region.Exclude(&fDirtyRegion);
+	if (fPendingUpdateSession->IsUsed())
+		region.Exclude(&fPendingUpdateSession->DirtyRegion());
+	if (fInUpdate)
+		region.Exclude(&fCurrentUpdateSession->DirtyRegion());
+
+	fBackingStore->Store(fDrawingEngine.Get(), region, fFrame.LeftTop());
+}
+
+
+/*!	Copies what is available of the \a expose region from the backing
+	store, and removes it from the regions that need to be redrawn.
+*/
+void
+Window::_RestoreContents(BRegion& dirty, BRegion& expose)
+{
+	if (expose.CountRects() == 0)
+		return;
+
+	fExposeCount++;
+
+	if (fBackingStore.IsSet()) {
+		BRegion* restored = fRegionPool.GetRegion();
+		if (restored != NULL) {
+			fBackingStore->Restore(fDrawingEngine.Get(), expose,
+				fFrame.LeftTop(), *restored);
+
+			if (restored->CountRects() > 0) {
+				fRestoredExposeCount++;
+				fRestoredPixelCount += region_area(*restored);
+
+				dirty.Exclude(restored);
+				expose.Exclude(restored);
+			}
+			fRegionPool.Recycle(restored);
+		}
+	}
+
+	fRedrawnPixelCount += region_area(expose);
 }
 
 
@@ -1983,13 +2206,19 @@ Window::EndUpdate()
 			dirty->IntersectWith(&VisibleContentRegion());
 
 			fDrawingEngine->CopyToFront(*dirty);
-			fRegionPool.Recycle(dirty);
 		}
 
 		fCurrentUpdateSession->SetUsed(false);
 
 		fInUpdate = false;
 		fEffectiveDrawingRegionValid = false;
+
+		if (dirty) {
+			// the client is done drawing the update session
+			if (fBackingStore.IsSet())
+				_StoreContents(*dirty);
+			fRegionPool.Recycle(dirty);
+		}
 	}
 	if (fPendingUpdateSession->IsUsed()) {
 		// send this to client
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2020, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT license.
  *
  * Authors:
@@ -68,6 +69,7 @@ namespace BPrivate {
 	class PortLink;
 };
 
+class BackingStore;
 class ClickTarget;
 class ClientLooper;
 class Decorator;
@@ -187,6 +189,15 @@ public:
 			void				CopyContents(BRegion* region,
 									int32 xOffset, int32 yOffset);
 
+			// retaining the window contents
+			bool				HasBackingStore() const
+									{ return fBackingStore.IsSet(); }
+			void				ViewDrawn(View* view);
+			bool				HasPendingBackingStoreUpdate() const
+									{ return fBackingStoreUpdateRegion
+										.CountRects() > 0; }
+			void				UpdateBackingStore();
+
 			void				MouseDown(BMessage* message, BPoint where,
 									const ClickTarget& lastClickTarget,
 									int32& clickCount,
@@ -320,6 +331,9 @@ public:
 			bool				MoveToTopStackLayer();
 			bool				MoveToStackPosition(int32 index,
 									bool isMoving);
+
+			void				DumpRedrawStatistics() const;
+
 protected:
 			void				_ShiftPartOfRegion(BRegion* region,
 									BRegion* regionToShift, int32 xOffset,
@@ -335,6 +349,12 @@ protected:
 									BRegion* contentDirtyRegion);
 			void				_SendUpdateMessage();
 
+			// handling the backing store
+			void				_InvalidateContents(const BRegion& region);
+			void				_StoreContents(BRegion& region);
+			void				_RestoreContents(BRegion& dirty,
+									BRegion& expose);
+
 			void				_UpdateContentRegion();
 
 			void				_ObeySizeLimits();
@@ -387,6 +407,23 @@ protected:
 								fDrawingEngine;
 			::Desktop*			fDesktop;
 
+			// Only set in compositing mode, it keeps the contents of the
+			// window, so that exposed parts can be restored without a
+			// roundtrip to the client.
+			ObjectDeleter<BackingStore>
+								fBackingStore;
+			// Parts of the window that were drawn outside of an update
+			// session, and have yet to be stored, in window coordinates
+			BRegion				fBackingStoreUpdateRegion;
+			View*				fLastDrawnView;
+
+			// redraw statistics
+			int32				fUpdateMessageCount;
+			int32				fExposeCount;
+			int32				fRestoredExposeCount;
+			int64				fRestoredPixelCount;
+			int64				fRedrawnPixelCount;
+
 			// The synchronization, which client drawing commands
 			// belong to the redraw of which dirty region is handled
 			// through an UpdateSession. When the client has
@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2018, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -291,6 +292,13 @@ DrawingEngine::CopyToFront(/*const*/ BRegion& region)
 }
 
 
+void
+DrawingEngine::SetTiledRenderingEnabled(bool enable)
+{
+	fPainter->SetTiledRenderingEnabled(enable);
+}
+
+
 // #pragma mark -
 
 
@@ -1379,6 +1387,81 @@ DrawingEngine::ReadBitmap(ServerBitmap* bitmap, bool drawCursor, BRect bounds)
 }
 
 
+status_t
+DrawingEngine::ReadRegion(const BRegion& region, uint8* bits,
+	uint32 bytesPerRow, int32 left, int32 top)
+{
+	ASSERT_PARALLEL_LOCKED();
+
+	RenderingBuffer* buffer = fGraphicsCard->DrawingBuffer();
+	if (buffer == NULL)
+		return B_ERROR;
+	if (buffer->ColorSpace() != B_RGB32 && buffer->ColorSpace() != B_RGBA32)
+		return B_NOT_SUPPORTED;
+
+	BRegion clipped(region);
+	BRegion bounds(BRect(0, 0, buffer->Width() - 1, buffer->Height() - 1));
+	clipped.IntersectWith(&bounds);
+	if (clipped.CountRects() == 0)
+		return B_OK;
+
+	AutoFloatingOverlaysHider _(fGraphicsCard, clipped.Frame());
+
+	const uint8* source = (const uint8*)buffer->Bits();
+	uint32 sourceBytesPerRow = buffer->BytesPerRow();
+
+	int32 count = clipped.CountRects();
+	for (int32 i = 0; i < count; i++) {
+		clipping_rect rect = clipped.RectAtInt(i);
+		size_t length = (rect.right - rect.left + 1) * 4;
+		for (int32 y = rect.top; y <= rect.bottom; y++) {
+			memcpy(bits + (y - top) * bytesPerRow + (rect.left - left) * 4,
+				source + y * sourceBytesPerRow + rect.left * 4, length);
+		}
+	}
+
+	return B_OK;
+}
+
+
+status_t
+DrawingEngine::WriteRegion(const BRegion& region, const uint8* bits,
+	uint32 bytesPerRow, int32 left, int32 top)
+{
+	ASSERT_PARALLEL_LOCKED();
+
+	RenderingBuffer* buffer = fGraphicsCard->DrawingBuffer();
+	if (buffer == NULL)
+		return B_ERROR;
+	if (buffer->ColorSpace() != B_RGB32 && buffer->ColorSpace() != B_RGBA32)
+		return B_NOT_SUPPORTED;
+
+	BRegion clipped(region);
+	BRegion bounds(BRect(0, 0, buffer->Width() - 1, buffer->Height() - 1));
+	clipped.IntersectWith(&bounds);
+
+	DrawTransaction transaction(this, clipped);
+	if (!transaction.IsDirty())
+		return B_OK;
+
+	uint8* destination = (uint8*)buffer->Bits();
+	uint32 destinationBytesPerRow = buffer->BytesPerRow();
+
+	int32 count = clipped.CountRects();
+	for (int32 i = 0; i < count; i++) {
+		clipping_rect rect = clipped.RectAtInt(i);
+		size_t length = (rect.right - rect.left + 1) * 4;
+		for (int32 y = rect.top; y <= rect.bottom; y++) {
+			memcpy(destination + y * destinationBytesPerRow + rect.left * 4,
+				bits + (y - top) * bytesPerRow + (rect.left - left) * 4,
+				length);
+		}
+	}
+
+	return B_OK;
+}
+
+
 // #pragma mark -
 
 
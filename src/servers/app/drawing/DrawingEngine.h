@@ -1,5 +1,6 @@
 /*
  * Copyright 2001-2018, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -50,6 +51,9 @@ public:
 								{ return fCopyToFront; }
 	virtual	void			CopyToFront(/*const*/ BRegion& region);
 
+	// render large fills in parallel tiles
+			void			SetTiledRenderingEnabled(bool enable);
+
 	// locking
 			bool			LockParallelAccess();
 #if DEBUG
@@ -66,6 +70,14 @@ public:
 	virtual	status_t		ReadBitmap(ServerBitmap *bitmap, bool drawCursor,
 								BRect bounds);
 
+	// for the backing stores of windows, bits holds the pixels at the
+	// location (left, top) of the screen
+	virtual	status_t		ReadRegion(const BRegion& region, uint8* bits,
+								uint32 bytesPerRow, int32 left, int32 top);
+	virtual	status_t		WriteRegion(const BRegion& region,
+								const uint8* bits, uint32 bytesPerRow,
+								int32 left, int32 top);
+
 	// clipping for all drawing functions, passing a NULL region
 	// will remove any clipping (drawing allowed everywhere)
 	virtual	void			ConstrainClippingRegion(const BRegion* region);
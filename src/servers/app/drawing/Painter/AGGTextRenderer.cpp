@@ -1,6 +1,7 @@
 /*
  * Copyright 2005-2009, Stephan Aßmus <superstippi@gmx.de>.
  * Copyright 2008, Andrej Spielmann <andrej.spielmann@seh.ox.ac.uk>.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * All rights reserved. Distributed under the terms of the MIT License.
  */
 
@@ -24,6 +25,7 @@
 
 #include "GlobalSubpixelSettings.h"
 #include "GlyphLayoutEngine.h"
+#include "GlyphRunCache.h"
 #include "IntRect.h"
 
 
@@ -131,6 +133,8 @@ public:
 		fDryRun(dryRun),
 		fVector(false),
 		fBounds(INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN),
+		fEndX(0.0),
+		fEndY(0.0),
 		fNextCharPos(nextCharPos),
 
 		fTransformedGlyph(transformedGlyph),
@@ -155,6 +159,9 @@ public:
 
 	void Finish(double x, double y)
 	{
+		fEndX = x;
+		fEndY = y;
+
 		if (fVector) {
 			if (fRenderer.fMaskedScanline != NULL) {
 				agg::render_scanlines(fRenderer.fRasterizer,
@@ -324,6 +331,16 @@ public:
 		return fBounds;
 	}
 
+	double EndX() const
+	{
+		return fEndX;
+	}
+
+	double EndY() const
+	{
+		return fEndY;
+	}
+
 private:
 	void _DrawHorizontalLine(float y)
 	{
@@ -360,6 +377,8 @@ private:
 	bool				fSubpixelAntiAliased;
 	bool				fVector;
 	IntRect				fBounds;
+	double				fEndX;
+	double				fEndY;
 	BPoint*				fNextCharPos;
 
 	FontCacheEntry::TransformedOutline& fTransformedGlyph;
@@ -398,8 +417,31 @@ AGGTextRenderer::RenderString(const char* string, uint32 length,
 	StringRenderer renderer(clippingIntFrame, dryRun, transformedOutline, transformedContourOutline,
 		transform, transformOffset, nextCharPos, *this);
 
-	GlyphLayoutEngine::LayoutGlyphs(renderer, fFont, string, length, INT32_MAX,
-		delta, fFont.Spacing(), NULL, cacheReference);
+	// A dry run only computes the bounds and the pen position, which are
+	// the same every time the string is laid out
+	GlyphRunCache::Key key;
+	GlyphRunCache::Run run;
+	bool cacheable = dryRun && key.SetTo(fFont, renderer.NeedsVector(),
+		string, length, delta, fFont.Spacing());
+	if (cacheable && GlyphRunCache::Default()->Lookup(key, run)
+		&& run.hasBounds) {
+		if (nextCharPos != NULL) {
+			nextCharPos->x = run.endX;
+			nextCharPos->y = run.endY;
+			transform.Transform(nextCharPos);
+		}
+		return transform.TransformBounds(run.bounds);
+	}
+
+	if (GlyphLayoutEngine::LayoutGlyphs(renderer, fFont, string, length,
+			INT32_MAX, delta, fFont.Spacing(), NULL, cacheReference)
+		&& cacheable) {
+		run.endX = renderer.EndX();
+		run.endY = renderer.EndY();
+		run.bounds = renderer.Bounds();
+		run.hasBounds = true;
+		GlyphRunCache::Default()->Put(key, run);
+	}
 
 	return transform.TransformBounds(renderer.Bounds());
 }
@@ -3,6 +3,7 @@
  * Copyright 2008, Andrej Spielmann <andrej.spielmann@seh.ox.ac.uk>.
  * Copyright 2005-2014, Stephan Aßmus <superstippi@gmx.de>.
  * Copyright 2015, Julian Harnath <julian.harnath@rwth-aachen.de>
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * All rights reserved. Distributed under the terms of the MIT License.
  */
 
@@ -61,6 +62,7 @@
 #include "ServerBitmap.h"
 #include "ServerFont.h"
 #include "SystemPalette.h"
+#include "TileRenderer.h"
 
 #include "AppServer.h"
 
@@ -199,6 +201,82 @@ private:
 };
 
 
+class SolidRectFiller : public RectTileJob {
+public:
+	SolidRectFiller(renderer_base& baseRenderer,
+		agg::rendering_buffer& buffer, const BRect& rect, uint32 color)
+		:
+		RectTileJob(baseRenderer, buffer, (int32)rect.left, (int32)rect.top,
+			(int32)rect.right, (int32)rect.bottom),
+		fColor(color)
+	{
+	}
+
+protected:
+	virtual void FillRow(uint8* bits, int32 y, int32 width)
+	{
+		gfxset32(bits, fColor, width * 4);
+	}
+
+private:
+	uint32		fColor;
+};
+
+
+class BlendRectFiller : public RectTileJob {
+public:
+	BlendRectFiller(renderer_base& baseRenderer,
+		agg::rendering_buffer& buffer, const BRect& rect, const rgb_color& c)
+		:
+		RectTileJob(baseRenderer, buffer, (int32)rect.left, (int32)rect.top,
+			(int32)rect.right, (int32)rect.bottom),
+		fBlender(SpanBlender::Default()),
+		fColor(span_color(c.red, c.green, c.blue)),
+		fAlpha(c.alpha)
+	{
+	}
+
+protected:
+	virtual void FillRow(uint8* bits, int32 y, int32 width)
+	{
+		// the same result as B_OP_ALPHA with a full cover
+		if (fAlpha == 255)
+			fBlender->Fill(bits, width, fColor);
+		else
+			fBlender->Blend(bits, width, fColor, fAlpha * 255);
+	}
+
+private:
+	const SpanBlender*	fBlender;
+	uint32				fColor;
+	uint8				fAlpha;
+};
+
+
+class VerticalGradientRectFiller : public RectTileJob {
+public:
+	VerticalGradientRectFiller(renderer_base& baseRenderer,
+		agg::rendering_buffer& buffer, const BRect& rect, const uint32* colors)
+		:
+		RectTileJob(baseRenderer, buffer, (int32)rect.left, (int32)rect.top,
+			(int32)rect.right, (int32)rect.bottom),
+		fColors(colors),
+		fTop((int32)rect.top)
+	{
+	}
+
+protected:
+	virtual void FillRow(uint8* bits, int32 y, int32 width)
+	{
+		gfxset32(bits, fColors[y - fTop], width * 4);
+	}
+
+private:
+	const uint32*		fColors;
+	int32				fTop;
+};
+
+
 // #pragma mark -
 
 
@@ -207,6 +285,7 @@ Painter::Painter()
 	fSubpixelPrecise(false),
 	fValidClipping(false),
 	fAttached(false),
+	fTiledRendering(true),
 
 	fPenSize(1.0),
 	fClippingRegion(NULL),
@@ -216,6 +295,7 @@ Painter::Painter()
 	fLineCapMode(B_BUTT_CAP),
 	fLineJoinMode(B_MITER_JOIN),
 	fMiterLimit(B_DEFAULT_MITER_LIMIT),
+	fFillingRule(agg::fill_non_zero),
 
 	fPatternHandler(),
 	fTextRenderer(fSubpixRenderer, fRenderer, fRendererBin, fUnpackedScanline,
@@ -453,6 +533,7 @@ Painter::SetFillRule(int32 fillRule)
 	agg::filling_rule_e aggFillRule = fillRule == B_EVEN_ODD
 		? agg::fill_even_odd : agg::fill_non_zero;
 
+	fFillingRule = aggFillRule;
 	fRasterizer.filling_rule(aggFillRule);
 	fSubpixRasterizer.filling_rule(aggFillRule);
 }
@@ -995,36 +1076,15 @@ Painter::FillRect(const BRect& r, const rgb_color& c) const
 	if (!fValidClipping)
 		return;
 
-	uint8* dst = fBuffer.row_ptr(0);
-	uint32 bpr = fBuffer.stride();
-	int32 left = (int32)r.left;
-	int32 top = (int32)r.top;
-	int32 right = (int32)r.right;
-	int32 bottom = (int32)r.bottom;
 	// get a 32 bit pixel ready with the color
 	pixel32 color;
 	color.data8[0] = c.blue;
 	color.data8[1] = c.green;
 	color.data8[2] = c.red;
 	color.data8[3] = c.alpha;
-	// fill rects, iterate over clipping boxes
-	fBaseRenderer.first_clip_box();
-	do {
-		int32 x1 = max_c(fBaseRenderer.xmin(), left);
-		int32 x2 = min_c(fBaseRenderer.xmax(), right);
-		if (x1 <= x2) {
-			int32 y1 = max_c(fBaseRenderer.ymin(), top);
-			int32 y2 = min_c(fBaseRenderer.ymax(), bottom);
-			uint8* offset = dst + x1 * 4;
-			for (; y1 <= y2; y1++) {
-//					uint32* handle = (uint32*)(offset + y1 * bpr);
-//					for (int32 x = x1; x <= x2; x++) {
-//						*handle++ = color.data32;
-//					}
-				gfxset32(offset + y1 * bpr, color.data32, (x2 - x1 + 1) * 4);
-			}
-		}
-	} while (fBaseRenderer.next_clip_box());
+
+	SolidRectFiller filler(fBaseRenderer, fBuffer, r, color.data32);
+	_FillRect(filler, r);
 }
 
 
@@ -1053,31 +1113,9 @@ Painter::FillRectVerticalGradient(BRect r,
 	_MakeGradient(gradient, colorCount, gradientArray,
 		gradientTop - (int32)r.top, gradientArraySize);
 
-	uint8* dst = fBuffer.row_ptr(0);
-	uint32 bpr = fBuffer.stride();
-	int32 left = (int32)r.left;
-	int32 top = (int32)r.top;
-	int32 right = (int32)r.right;
-	int32 bottom = (int32)r.bottom;
-	// fill rects, iterate over clipping boxes
-	fBaseRenderer.first_clip_box();
-	do {
-		int32 x1 = max_c(fBaseRenderer.xmin(), left);
-		int32 x2 = min_c(fBaseRenderer.xmax(), right);
-		if (x1 <= x2) {
-			int32 y1 = max_c(fBaseRenderer.ymin(), top);
-			int32 y2 = min_c(fBaseRenderer.ymax(), bottom);
-			uint8* offset = dst + x1 * 4;
-			for (; y1 <= y2; y1++) {
-//					uint32* handle = (uint32*)(offset + y1 * bpr);
-//					for (int32 x = x1; x <= x2; x++) {
-//						*handle++ = gradientArray[y1 - top];
-//					}
-				gfxset32(offset + y1 * bpr, gradientArray[y1 - top],
-					(x2 - x1 + 1) * 4);
-			}
-		}
-	} while (fBaseRenderer.next_clip_box());
+	VerticalGradientRectFiller filler(fBaseRenderer, fBuffer, r,
+		gradientArray);
+	_FillRect(filler, r);
 }
 
 
@@ -1513,6 +1551,13 @@ Painter::SetRendererOffset(int32 offsetX, int32 offsetY)
 }
 
 
+void
+Painter::SetTiledRenderingEnabled(bool enabled)
+{
+	fTiledRendering = enabled;
+}
+
+
 // #pragma mark - private
 
 
@@ -1568,6 +1613,20 @@ Painter::_Clipped(const BRect& rect) const
 }
 
 
+/*!	Returns the number of tiles a fill of the already clipped \a clippedRect
+	is split into; fills below the size threshold use a single one.
+*/
+int32
+Painter::_CountTiles(const BRect& clippedRect, int32 tilesPerThread) const
+{
+	if (!fTiledRendering || !clippedRect.IsValid())
+		return 1;
+
+	return count_tiles(WorkerPool::Default(), clippedRect.IntegerWidth() + 1,
+		clippedRect.IntegerHeight() + 1, tilesPerThread);
+}
+
+
 // _UpdateDrawingMode
 void
 Painter::_UpdateDrawingMode()
@@ -1722,31 +1781,22 @@ Painter::_BlendRect32(const BRect& r, const rgb_color& c) const
 	if (!fValidClipping)
 		return;
 
-	uint8* dst = fBuffer.row_ptr(0);
-	uint32 bpr = fBuffer.stride();
+	BlendRectFiller filler(fBaseRenderer, fBuffer, r, c);
+	_FillRect(filler, r);
+}
 
-	int32 left = (int32)r.left;
-	int32 top = (int32)r.top;
-	int32 right = (int32)r.right;
-	int32 bottom = (int32)r.bottom;
-
-	// fill rects, iterate over clipping boxes
-	fBaseRenderer.first_clip_box();
-	do {
-		int32 x1 = max_c(fBaseRenderer.xmin(), left);
-		int32 x2 = min_c(fBaseRenderer.xmax(), right);
-		if (x1 <= x2) {
-			int32 y1 = max_c(fBaseRenderer.ymin(), top);
-			int32 y2 = min_c(fBaseRenderer.ymax(), bottom);
-
-			uint8* offset = dst + x1 * 4 + y1 * bpr;
-			for (; y1 <= y2; y1++) {
-				blend_line32(offset, x2 - x1 + 1, c.red, c.green, c.blue,
-					c.alpha);
-				offset += bpr;
-			}
-		}
-	} while (fBaseRenderer.next_clip_box());
+
+// _FillRect
+void
+Painter::_FillRect(RectTileJob& job, const BRect& rect) const
+{
+	// the tiles only fill their own rows, so more tiles than threads just
+	// even out the load
+	int32 tileCount = _CountTiles(_Clipped(rect), 2);
+	if (tileCount > 1)
+		WorkerPool::Default()->Execute(job, tileCount);
+	else
+		job.Fill(fBaseRenderer);
 }
 
 
@@ -1850,6 +1900,11 @@ template<class VertexSource>
 BRect
 Painter::_RasterizePath(VertexSource& path) const
 {
+	BRect bounds = _Clipped(_BoundingBox(path));
+	int32 tileCount = 1;
+	if (fMaskedUnpackedScanline == NULL && !gSubpixelAntialiasing)
+		tileCount = _CountTiles(bounds, 1);
+
 	if (fMaskedUnpackedScanline != NULL) {
 		// TODO: we can't do both alpha-masking and subpixel AA.
 		fRasterizer.reset();
@@ -1862,12 +1917,26 @@ Painter::_RasterizePath(VertexSource& path) const
 		agg::render_scanlines(fSubpixRasterizer,
 			fSubpixPackedScanline, fSubpixRenderer);
 	} else {
+		if (tileCount > 1) {
+			// every tile iterates the path on its own
+			agg::path_storage tilePath;
+			tilePath.concat_path(path);
+			tileCount = limit_path_tiles(tileCount, bounds.IntegerWidth() + 1,
+				bounds.IntegerHeight() + 1, tilePath.total_vertices());
+
+			PathTileJob<SolidTile> job(tilePath, fClippingRegion->FrameInt(),
+				fFillingRule, fBaseRenderer, fRenderer.color());
+			if (tileCount > 1
+				&& WorkerPool::Default()->TryExecute(job, tileCount))
+				return bounds;
+		}
+
 		fRasterizer.reset();
 		fRasterizer.add_path(path);
 		agg::render_scanlines(fRasterizer, fPackedScanline, fRenderer);
 	}
 
-	return _Clipped(_BoundingBox(path));
+	return bounds;
 }
 
 
@@ -2129,6 +2198,33 @@ Painter::_RasterizePath(VertexSource& path, const BGradient& gradient,
 	renderer_gradient_type gradientRenderer(fBaseRenderer, spanAllocator,
 		spanGradient);
 
+	BRect bounds = _Clipped(_BoundingBox(path));
+	int32 tileCount = 1;
+	if (fMaskedUnpackedScanline == NULL)
+		tileCount = _CountTiles(bounds, 1);
+
+	agg::path_storage tilePath;
+	if (tileCount > 1) {
+		// every tile iterates the path on its own
+		tilePath.concat_path(path);
+		tileCount = limit_path_tiles(tileCount, bounds.IntegerWidth() + 1,
+			bounds.IntegerHeight() + 1, tilePath.total_vertices());
+	}
+
+	if (tileCount > 1) {
+		typedef GradientTile<GradientFunction> tile_type;
+		typename tile_type::setup_type setup;
+		setup.transform = &gradientTransform;
+		setup.function = &function;
+		setup.colors = &colorArray;
+		setup.stop = gradientStop;
+
+		PathTileJob<tile_type> job(tilePath, fClippingRegion->FrameInt(),
+			fFillingRule, fBaseRenderer, setup);
+		if (WorkerPool::Default()->TryExecute(job, tileCount))
+			return;
+	}
+
 	fRasterizer.reset();
 	fRasterizer.add_path(path);
 	if (fMaskedUnpackedScanline == NULL)
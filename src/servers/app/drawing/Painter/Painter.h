@@ -2,6 +2,7 @@
  * Copyright 2005-2007, Stephan Aßmus <superstippi@gmx.de>.
  * Copyright 2008, Andrej Spielmann <andrej.spielmann@seh.ox.ac.uk>.
  * Copyright 2015, Julian Harnath <julian.harnath@rwth-aachen.de>
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * All rights reserved. Distributed under the terms of the MIT License.
  *
  * API to the Anti-Grain Geometry based "Painter" drawing backend. Manages
@@ -38,6 +39,7 @@ class BGradientDiamond;
 class BGradientConic;
 class DrawState;
 class FontCacheReference;
+class RectTileJob;
 class RenderingBuffer;
 class ServerBitmap;
 class ServerFont;
@@ -252,6 +254,11 @@ public:
 			void				SetRendererOffset(int32 offsetX,
 									int32 offsetY);
 
+								// render large fills in parallel tiles
+			void				SetTiledRenderingEnabled(bool enabled);
+	inline	bool				TiledRenderingEnabled() const
+									{ return fTiledRendering; }
+
 private:
 			float				_Align(float coord, bool round,
 									bool centerOffset) const;
@@ -262,6 +269,8 @@ private:
 			BPoint				_Align(const BPoint& point,
 									bool centerOffset = true) const;
 			BRect				_Clipped(const BRect& rect) const;
+			int32				_CountTiles(const BRect& clippedRect,
+									int32 tilesPerThread) const;
 
 			void				_UpdateFont() const;
 			void				_UpdateLineWidth();
@@ -279,6 +288,8 @@ private:
 									float viewScale) const;
 
 			void				_InvertRect32(BRect r) const;
+			void				_FillRect(RectTileJob& job,
+									const BRect& rect) const;
 			void				_BlendRect32(const BRect& r,
 									const rgb_color& c) const;
 
@@ -336,6 +347,7 @@ private:
 			bool				fValidClipping : 1;
 			bool				fAttached : 1;
 			bool				fIdentityTransform : 1;
+			bool				fTiledRendering : 1;
 
 			Transformable		fTransform;
 			float				fPenSize;
@@ -346,6 +358,7 @@ private:
 			cap_mode			fLineCapMode;
 			join_mode			fLineJoinMode;
 			float				fMiterLimit;
+			agg::filling_rule_e	fFillingRule;
 
 			PatternHandler		fPatternHandler;
 
@@ -0,0 +1,318 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef TILE_RENDERER_H
+#define TILE_RENDERER_H
+
+
+#include <agg_path_storage.h>
+
+#include "WorkerPool.h"
+#include "defines.h"
+
+
+/*!	Support for splitting large fills into horizontal tiles that are rendered
+	in parallel by the WorkerPool.
+
+	Each tile clips to its own rows, and works with its own copy of the base
+	renderer, which keeps the state of iterating the clipping region. Paths
+	are rasterized completely for each tile with the same settings as the
+	serial path, so that all tiles see the same cells, and the result is
+	identical to that of rendering the path in one go. Since that is repeated
+	for every tile, paths only use one tile per thread, and are only split
+	when the pool can actually run the tiles in parallel, and when each tile
+	still has enough pixels to render to make up for that.
+*/
+
+
+// Fills need to cover at least this many pixels to be split into tiles.
+static const int32 kMinTiledPixels = 256 * 1024;
+static const int32 kMinTileHeight = 16;
+// Each path tile needs to render at least this many pixels per unit of
+// rasterizing cost (vertices and the bounds' perimeter).
+static const int32 kMinPixelsPerPathCost = 16;
+
+
+static inline int32
+count_tiles(WorkerPool* pool, int32 width, int32 height,
+	int32 tilesPerThread)
+{
+	if (pool == NULL || pool->CountThreads() <= 1 || width <= 0
+		|| height <= 0 || (int64)width * height < kMinTiledPixels) {
+		return 1;
+	}
+
+	return max_c(1, min_c(pool->CountThreads() * tilesPerThread,
+		height / kMinTileHeight));
+}
+
+
+/*!	Limits the \a tileCount of a path with \a vertexCount vertices that
+	covers \a width x \a height pixels, as every tile rasterizes the whole
+	path once more.
+*/
+static inline int32
+limit_path_tiles(int32 tileCount, int32 width, int32 height,
+	uint32 vertexCount)
+{
+	int64 cost = (int64)vertexCount + 2 * ((int64)width + height);
+	int64 maxTiles = (int64)width * height / (cost * kMinPixelsPerPathCost);
+
+	return (int32)max_c(1, min_c(tileCount, maxTiles));
+}
+
+
+static inline void
+tile_rows(int32 top, int32 bottom, int32 index, int32 count, int32& first,
+	int32& last)
+{
+	const int32 rows = bottom - top + 1;
+	first = top + (int32)((int64)rows * index / count);
+	last = top + (int32)((int64)rows * (index + 1) / count) - 1;
+}
+
+
+// #pragma mark - RectTileJob
+
+
+/*!	Fills the rows of a rectangle within the clipping region, either serially
+	by Fill(), or one tile per Run().
+*/
+class RectTileJob : public WorkerPool::Job {
+public:
+	RectTileJob(renderer_base& baseRenderer,
+		agg::rendering_buffer& buffer, int32 left, int32 top, int32 right,
+		int32 bottom)
+		:
+		fBaseRenderer(baseRenderer),
+		fBuffer(buffer),
+		fLeft(left),
+		fTop(top),
+		fRight(right),
+		fBottom(bottom)
+	{
+	}
+
+	void Fill(renderer_base& baseRenderer)
+	{
+		_FillRows(baseRenderer, fTop, fBottom);
+	}
+
+	virtual void Run(int32 index, int32 count)
+	{
+		int32 first;
+		int32 last;
+		tile_rows(fTop, fBottom, index, count, first, last);
+
+		renderer_base baseRenderer(fBaseRenderer.ren());
+		baseRenderer.copy_clipping_from(fBaseRenderer);
+		_FillRows(baseRenderer, first, last);
+	}
+
+protected:
+	virtual void FillRow(uint8* bits, int32 y, int32 width) = 0;
+
+private:
+	void _FillRows(renderer_base& baseRenderer, int32 top, int32 bottom)
+	{
+		uint8* bits = fBuffer.row_ptr(0);
+		uint32 bytesPerRow = fBuffer.stride();
+
+		// iterate over clipping boxes
+		baseRenderer.first_clip_box();
+		do {
+			int32 x1 = max_c(baseRenderer.xmin(), fLeft);
+			int32 x2 = min_c(baseRenderer.xmax(), fRight);
+			if (x1 > x2)
+				continue;
+
+			int32 y1 = max_c(baseRenderer.ymin(), top);
+			int32 y2 = min_c(baseRenderer.ymax(), bottom);
+			for (; y1 <= y2; y1++)
+				FillRow(bits + x1 * 4 + y1 * bytesPerRow, y1, x2 - x1 + 1);
+		} while (baseRenderer.next_clip_box());
+	}
+
+private:
+	renderer_base&			fBaseRenderer;
+	agg::rendering_buffer&	fBuffer;
+	int32					fLeft;
+	int32					fTop;
+	int32					fRight;
+	int32					fBottom;
+};
+
+
+// #pragma mark - PathTileJob
+
+
+/*!	A vertex source reading an agg::path_storage by index, so that several
+	threads can iterate the same path at the same time.
+*/
+class PathStorageSource {
+public:
+	PathStorageSource(const agg::path_storage& path)
+		:
+		fPath(path),
+		fIndex(0)
+	{
+	}
+
+	void rewind(unsigned)
+	{
+		fIndex = 0;
+	}
+
+	unsigned vertex(double* x, double* y)
+	{
+		if (fIndex >= fPath.total_vertices())
+			return agg::path_cmd_stop;
+
+		return fPath.vertex(fIndex++, x, y);
+	}
+
+private:
+	const agg::path_storage&	fPath;
+	unsigned					fIndex;
+};
+
+
+/*!	Renders the tiles of a path. The \a Tile class sets up the scanline
+	renderer of a tile from the shared \c Tile::setup_type, and renders the
+	scanlines with it.
+*/
+template<class Tile>
+class PathTileJob : public WorkerPool::Job {
+public:
+	typedef typename Tile::setup_type setup_type;
+
+	PathTileJob(const agg::path_storage& path, const clipping_rect& clipBox,
+		agg::filling_rule_e fillingRule, renderer_base& baseRenderer,
+		const setup_type& setup)
+		:
+		fPath(path),
+		fClipBox(clipBox),
+		fFillingRule(fillingRule),
+		fBaseRenderer(baseRenderer),
+		fSetup(setup)
+	{
+	}
+
+	virtual void Run(int32 index, int32 count)
+	{
+		// the same settings as the rasterizer of the Painter
+		rasterizer_type rasterizer;
+#if ALIASED_DRAWING
+		rasterizer.gamma(agg::gamma_threshold(0.5));
+#endif
+		rasterizer.clip_box(fClipBox.left, fClipBox.top, fClipBox.right + 1,
+			fClipBox.bottom + 1);
+		rasterizer.filling_rule(fFillingRule);
+
+		PathStorageSource source(fPath);
+		rasterizer.add_path(source);
+		if (!rasterizer.rewind_scanlines())
+			return;
+
+		int32 first;
+		int32 last;
+		tile_rows(rasterizer.min_y(), rasterizer.max_y(), index, count, first,
+			last);
+
+		renderer_base baseRenderer(fBaseRenderer.ren());
+		baseRenderer.copy_clipping_from(fBaseRenderer);
+		Tile tile(baseRenderer, fSetup);
+
+		typename Tile::scanline_type scanline;
+		scanline.reset(rasterizer.min_x(), rasterizer.max_x());
+		while (rasterizer.sweep_scanline(scanline)) {
+			if (scanline.y() < first)
+				continue;
+			if (scanline.y() > last)
+				break;
+
+			tile.Render(scanline);
+		}
+	}
+
+private:
+	const agg::path_storage&	fPath;
+	clipping_rect				fClipBox;
+	agg::filling_rule_e			fFillingRule;
+	renderer_base&				fBaseRenderer;
+	const setup_type&			fSetup;
+};
+
+
+// #pragma mark - tiles
+
+
+class SolidTile {
+public:
+	typedef scanline_packed_type	scanline_type;
+	typedef agg::rgba8				setup_type;
+
+	SolidTile(renderer_base& baseRenderer, const agg::rgba8& color)
+		:
+		fRenderer(baseRenderer)
+	{
+		fRenderer.color(color);
+	}
+
+	template<class Scanline>
+	void Render(const Scanline& scanline)
+	{
+		fRenderer.render(scanline);
+	}
+
+private:
+	renderer_type	fRenderer;
+};
+
+
+template<class GradientFunction>
+class GradientTile {
+public:
+	typedef agg::span_interpolator_linear<> interpolator_type;
+	typedef agg::pod_auto_array<agg::rgba8, 256> color_array_type;
+	typedef agg::span_allocator<agg::rgba8> span_allocator_type;
+	typedef agg::span_gradient<agg::rgba8, interpolator_type,
+				GradientFunction, color_array_type> span_gradient_type;
+	typedef agg::renderer_scanline_aa<renderer_base, span_allocator_type,
+				span_gradient_type> renderer_gradient_type;
+
+	typedef scanline_unpacked_type	scanline_type;
+
+	struct setup_type {
+		agg::trans_affine*			transform;
+		const GradientFunction*		function;
+		const color_array_type*		colors;
+		int							stop;
+	};
+
+	GradientTile(renderer_base& baseRenderer, const setup_type& setup)
+		:
+		fInterpolator(*setup.transform),
+		fSpanGradient(fInterpolator, *setup.function, *setup.colors, 0,
+			setup.stop),
+		fRenderer(baseRenderer, fAllocator, fSpanGradient)
+	{
+		fRenderer.prepare();
+	}
+
+	template<class Scanline>
+	void Render(const Scanline& scanline)
+	{
+		fRenderer.render(scanline);
+	}
+
+private:
+	interpolator_type		fInterpolator;
+	span_allocator_type		fAllocator;
+	span_gradient_type		fSpanGradient;
+	renderer_gradient_type	fRenderer;
+};
+
+
+#endif	// TILE_RENDERER_H
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "WorkerPool.h"
+
+#include <new>
+#include <pthread.h>
+
+
+static const int32 kMaxThreads = 7;
+
+static pthread_once_t sDefaultInitOnce = PTHREAD_ONCE_INIT;
+static WorkerPool* sDefaultPool;
+
+
+static void
+init_default_pool()
+{
+	system_info info;
+	int32 threadCount = 0;
+	if (get_system_info(&info) == B_OK)
+		threadCount = min_c((int32)info.cpu_count - 1, kMaxThreads);
+
+	sDefaultPool = new(std::nothrow) WorkerPool(threadCount);
+}
+
+
+// #pragma mark -
+
+
+WorkerPool::Job::~Job()
+{
+}
+
+
+// #pragma mark -
+
+
+WorkerPool::WorkerPool(int32 threadCount)
+	:
+	fThreads(NULL),
+	fThreadCount(0),
+	fWorkSemaphore(-1),
+	fDoneSemaphore(-1),
+	fBusy(0),
+	fQuitting(false),
+	fJob(NULL),
+	fPartCount(0),
+	fNextPart(0),
+	fActiveHelpers(0)
+{
+	if (threadCount <= 0)
+		return;
+
+	fThreads = new(std::nothrow) thread_id[threadCount];
+	fWorkSemaphore = create_sem(0, "worker pool work");
+	fDoneSemaphore = create_sem(0, "worker pool done");
+	if (fThreads == NULL || fWorkSemaphore < 0 || fDoneSemaphore < 0)
+		return;
+
+	for (int32 i = 0; i < threadCount; i++) {
+		thread_id thread = spawn_thread(&_WorkerThread, "render worker",
+			B_DISPLAY_PRIORITY, this);
+		if (thread < 0)
+			break;
+
+		fThreads[fThreadCount++] = thread;
+		resume_thread(thread);
+	}
+}
+
+
+WorkerPool::~WorkerPool()
+{
+	fQuitting = true;
+	delete_sem(fWorkSemaphore);
+	delete_sem(fDoneSemaphore);
+
+	for (int32 i = 0; i < fThreadCount; i++) {
+		status_t result;
+		wait_for_thread(fThreads[i], &result);
+	}
+	delete[] fThreads;
+}
+
+
+/*static*/ WorkerPool*
+WorkerPool::Default()
+{
+	if (sDefaultPool == NULL)
+		pthread_once(&sDefaultInitOnce, &init_default_pool);
+
+	return sDefaultPool;
+}
+
+
+void
+WorkerPool::Execute(Job& job, int32 count)
+{
+	if (TryExecute(job, count))
+		return;
+
+	for (int32 i = 0; i < count; i++)
+		job.Run(i, count);
+}
+
+
+/*!	Runs the \a count parts of the \a job with the help of the pool's
+	threads. Returns \c false without running any part if there are no
+	threads to help, or if they are busy with the job of another thread.
+*/
+bool
+WorkerPool::TryExecute(Job& job, int32 count)
+{
+	int32 helpers = min_c(fThreadCount, count - 1);
+	if (helpers <= 0 || atomic_test_and_set(&fBusy, 1, 0) != 0)
+		return false;
+
+	fJob = &job;
+	fPartCount = count;
+	fActiveHelpers = helpers;
+	atomic_set(&fNextPart, 0);
+
+	release_sem_etc(fWorkSemaphore, helpers, B_DO_NOT_RESCHEDULE);
+
+	_RunParts();
+
+	// Wait until all helpers have left _RunParts(), not only until all parts
+	// are done, so that no late helper can pick up a part of the next job.
+	while (acquire_sem(fDoneSemaphore) == B_INTERRUPTED)
+		;
+
+	fJob = NULL;
+	atomic_set(&fBusy, 0);
+	return true;
+}
+
+
+/*static*/ status_t
+WorkerPool::_WorkerThread(void* data)
+{
+	WorkerPool* pool = (WorkerPool*)data;
+
+	while (true) {
+		status_t status = acquire_sem(pool->fWorkSemaphore);
+		if (status == B_INTERRUPTED)
+			continue;
+		if (status != B_OK || pool->fQuitting)
+			break;
+
+		pool->_RunParts();
+
+		if (atomic_add(&pool->fActiveHelpers, -1) == 1)
+			release_sem(pool->fDoneSemaphore);
+	}
+
+	return B_OK;
+}
+
+
+void
+WorkerPool::_RunParts()
+{
+	while (true) {
+		int32 index = atomic_add(&fNextPart, 1);
+		if (index >= fPartCount)
+			break;
+
+		fJob->Run(index, fPartCount);
+	}
+}
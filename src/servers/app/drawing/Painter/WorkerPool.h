@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+
+#include <OS.h>
+
+
+/*!	A small pool of rendering threads that helps the calling thread with
+	splitting up a large drawing operation into independent parts.
+
+	Only one job runs at a time. When the pool is busy with the job of another
+	thread, Execute() simply runs all parts in the calling thread, so that
+	drawing never waits for other windows. TryExecute() leaves that to the
+	caller, for jobs whose parts are more expensive than doing it in one go.
+*/
+class WorkerPool {
+public:
+			class Job {
+			public:
+				virtual					~Job();
+
+				virtual	void			Run(int32 index, int32 count) = 0;
+											// may be called in parallel for
+											// different indices
+			};
+
+public:
+								WorkerPool(int32 threadCount);
+								~WorkerPool();
+
+	static	WorkerPool*			Default();
+
+			int32				CountThreads() const
+									{ return fThreadCount + 1; }
+									// including the calling thread
+
+			void				Execute(Job& job, int32 count);
+			bool				TryExecute(Job& job, int32 count);
+
+private:
+	static	status_t			_WorkerThread(void* data);
+			void				_RunParts();
+
+private:
+			thread_id*			fThreads;
+			int32				fThreadCount;
+			sem_id				fWorkSemaphore;
+			sem_id				fDoneSemaphore;
+			int32				fBusy;
+			bool				fQuitting;
+
+			Job*				fJob;
+			int32				fPartCount;
+			int32				fNextPart;
+			int32				fActiveHelpers;
+};
+
+
+#endif	// WORKER_POOL_H
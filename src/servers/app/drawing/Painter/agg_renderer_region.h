@@ -2,6 +2,7 @@
  * Copyright 2005-2006, Stephan Aßmus <superstippi@gmx.de>.
  * Copyright 2008, Andrej Spielmann <andrej.spielmann@seh.ox.ac.uk>.
  * Copyright 2015, Julian Harnath <julian.harnath@rwth-aachen.de>
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * All rights reserved. Distributed under the terms of the MIT License.
  *
  * Copyright 2002-2004 Maxim Shemanarev (http://www.antigrain.com)
@@ -135,6 +136,18 @@ namespace agg
 			}
 		}
 
+		//--------------------------------------------------------------------
+		// Takes over the clipping region and offset of another renderer, so
+		// that several threads can iterate the same region at the same time.
+		void copy_clipping_from(const renderer_region<PixelFormat>& other)
+		{
+			m_region = other.m_region;
+			m_curr_cb = 0;
+			m_bounds = other.m_bounds;
+			m_offset_x = other.m_offset_x;
+			m_offset_y = other.m_offset_y;
+		}
+
 		//--------------------------------------------------------------------
 		void set_offset(int offset_x, int offset_y)
 		{
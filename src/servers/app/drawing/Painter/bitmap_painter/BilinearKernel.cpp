@@ -0,0 +1,344 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "BilinearKernel.h"
+
+#include <string.h>
+
+#if (defined(__i386__) || defined(__x86_64__)) && __GNUC__ >= 5
+#	define BILINEAR_KERNEL_X86 1
+#	include <immintrin.h>
+#	define SSE2_FUNCTION __attribute__((target("sse2")))
+#	define AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+
+#if defined(__ARM_NEON) && __GNUC__ >= 5
+#	define BILINEAR_KERNEL_NEON 1
+#	include <arm_neon.h>
+#endif
+
+
+namespace BitmapPainterPrivate {
+
+
+// All versions compute the same weighted sum of the four source pixels,
+//
+//	((tl * wLeft + tr * wRight) * wTop + (bl * wLeft + br * wRight) * wBottom)
+//		>> 16
+//
+// the SIMD versions just add up the products in a different order.
+
+
+static inline void
+store_pixel(uint8* dst, uint32 pixel, bool keepAlpha)
+{
+	if (keepAlpha) {
+		uint32 destination;
+		memcpy(&destination, dst, 4);
+		uint8* d = (uint8*)&destination;
+		const uint8* p = (const uint8*)&pixel;
+		d[0] = p[0];
+		d[1] = p[1];
+		d[2] = p[2];
+		pixel = destination;
+	}
+	memcpy(dst, &pixel, 4);
+}
+
+
+// #pragma mark - generic
+
+
+template<bool kKeepAlpha>
+static void
+interpolate_generic(uint8* dst, const uint8* src, uint32 srcBytesPerRow,
+	const FilterInfo* weights, int32 count, uint16 wTop)
+{
+	const uint16 wBottom = 255 - wTop;
+	const int32 channels = kKeepAlpha ? 3 : 4;
+
+	for (; count > 0; count--, weights++, dst += 4) {
+		const uint8* s = src + weights->index;
+		const uint8* sBottom = s + srcBytesPerRow;
+		const uint16 wLeft = weights->weight;
+		const uint16 wRight = 255 - wLeft;
+
+		for (int32 i = 0; i < channels; i++) {
+			dst[i] = ((s[i] * wLeft + s[i + 4] * wRight) * wTop
+				+ (sBottom[i] * wLeft + sBottom[i + 4] * wRight) * wBottom)
+					>> 16;
+		}
+	}
+}
+
+
+static const BilinearKernel kGenericKernel = {
+	"generic",
+	interpolate_generic<false>,
+	interpolate_generic<true>
+};
+
+
+#if BILINEAR_KERNEL_X86
+
+// #pragma mark - SSE2
+
+
+/*!	Computes the four channels of a destination pixel in the 32 bit lanes.
+	The source pixels are unpacked to 16 bit channels, the left pixel in the
+	low half. \a vertical holds wTop and wBottom in each 32 bit lane, and
+	\a horizontal wLeft and wRight.
+*/
+static inline SSE2_FUNCTION __m128i
+interpolate_lanes_sse2(__m128i top, __m128i bottom, __m128i vertical,
+	__m128i horizontal)
+{
+	// top and bottom next to each other: (tl * wTop + bl * wBottom), ...
+	__m128i left = _mm_madd_epi16(_mm_unpacklo_epi16(top, bottom), vertical);
+	__m128i right = _mm_madd_epi16(_mm_unpackhi_epi16(top, bottom),
+		vertical);
+
+	// The vertical sums fit into 16 bits, but not into signed ones, which
+	// _mm_madd_epi16() expects; values >= 32768 make the sum smaller by
+	// 65536 * weight each, which is added back after the shift.
+	__m128i pair = _mm_or_si128(left, _mm_slli_epi32(right, 16));
+	__m128i sum = _mm_srai_epi32(_mm_madd_epi16(pair, horizontal), 16);
+	return _mm_add_epi32(sum,
+		_mm_madd_epi16(_mm_srli_epi16(pair, 15), horizontal));
+}
+
+
+static inline SSE2_FUNCTION __m128i
+weight_pair_sse2(uint16 weight)
+{
+	return _mm_set1_epi32(weight | ((255 - weight) << 16));
+}
+
+
+template<bool kKeepAlpha>
+static SSE2_FUNCTION void
+interpolate_sse2(uint8* dst, const uint8* src, uint32 srcBytesPerRow,
+	const FilterInfo* weights, int32 count, uint16 wTop)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i vertical = weight_pair_sse2(wTop);
+
+	for (; count > 0; count--, weights++, dst += 4) {
+		const uint8* s = src + weights->index;
+		__m128i top = _mm_unpacklo_epi8(
+			_mm_loadl_epi64((const __m128i*)s), zero);
+		__m128i bottom = _mm_unpacklo_epi8(
+			_mm_loadl_epi64((const __m128i*)(s + srcBytesPerRow)), zero);
+
+		__m128i sum = interpolate_lanes_sse2(top, bottom, vertical,
+			weight_pair_sse2(weights->weight));
+		sum = _mm_packs_epi32(sum, sum);
+		store_pixel(dst, _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum)),
+			kKeepAlpha);
+	}
+}
+
+
+static const BilinearKernel kSSE2Kernel = {
+	"sse2",
+	interpolate_sse2<false>,
+	interpolate_sse2<true>
+};
+
+
+static bool
+sse2_supported()
+{
+#ifdef __x86_64__
+	return true;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+
+
+// #pragma mark - AVX2
+
+
+// Two destination pixels at once, one in each 128 bit lane.
+
+
+static inline AVX2_FUNCTION __m256i
+interpolate_lanes_avx2(__m256i top, __m256i bottom, __m256i vertical,
+	__m256i horizontal)
+{
+	__m256i left = _mm256_madd_epi16(_mm256_unpacklo_epi16(top, bottom),
+		vertical);
+	__m256i right = _mm256_madd_epi16(_mm256_unpackhi_epi16(top, bottom),
+		vertical);
+
+	__m256i pair = _mm256_or_si256(left, _mm256_slli_epi32(right, 16));
+	__m256i sum = _mm256_srai_epi32(_mm256_madd_epi16(pair, horizontal), 16);
+	return _mm256_add_epi32(sum,
+		_mm256_madd_epi16(_mm256_srli_epi16(pair, 15), horizontal));
+}
+
+
+static inline AVX2_FUNCTION __m256i
+load_pixel_pairs_avx2(const uint8* first, const uint8* second)
+{
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(
+			_mm_loadl_epi64((const __m128i*)first)),
+		_mm_loadl_epi64((const __m128i*)second), 1);
+}
+
+
+template<bool kKeepAlpha>
+static AVX2_FUNCTION void
+interpolate_avx2(uint8* dst, const uint8* src, uint32 srcBytesPerRow,
+	const FilterInfo* weights, int32 count, uint16 wTop)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i vertical = _mm256_set1_epi32(wTop | ((255 - wTop) << 16));
+
+	for (; count >= 2; count -= 2, weights += 2, dst += 8) {
+		const uint8* first = src + weights[0].index;
+		const uint8* second = src + weights[1].index;
+		__m256i top = _mm256_unpacklo_epi8(
+			load_pixel_pairs_avx2(first, second), zero);
+		__m256i bottom = _mm256_unpacklo_epi8(
+			load_pixel_pairs_avx2(first + srcBytesPerRow,
+				second + srcBytesPerRow), zero);
+		__m256i horizontal = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(weight_pair_sse2(weights[0].weight)),
+			weight_pair_sse2(weights[1].weight), 1);
+
+		__m256i sum = interpolate_lanes_avx2(top, bottom, vertical,
+			horizontal);
+		sum = _mm256_packs_epi32(sum, sum);
+		sum = _mm256_packus_epi16(sum, sum);
+		store_pixel(dst, _mm_cvtsi128_si32(_mm256_castsi256_si128(sum)),
+			kKeepAlpha);
+		store_pixel(dst + 4,
+			_mm_cvtsi128_si32(_mm256_extracti128_si256(sum, 1)), kKeepAlpha);
+	}
+
+	interpolate_sse2<kKeepAlpha>(dst, src, srcBytesPerRow, weights, count,
+		wTop);
+}
+
+
+static const BilinearKernel kAVX2Kernel = {
+	"avx2",
+	interpolate_avx2<false>,
+	interpolate_avx2<true>
+};
+
+
+static bool
+avx2_supported()
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+#endif	// BILINEAR_KERNEL_X86
+
+
+#if BILINEAR_KERNEL_NEON
+
+// #pragma mark - NEON
+
+
+template<bool kKeepAlpha>
+static void
+interpolate_neon(uint8* dst, const uint8* src, uint32 srcBytesPerRow,
+	const FilterInfo* weights, int32 count, uint16 wTop)
+{
+	const uint16 wBottom = 255 - wTop;
+
+	for (; count > 0; count--, weights++, dst += 4) {
+		const uint8* s = src + weights->index;
+		uint16x8_t top = vmovl_u8(vld1_u8(s));
+		uint16x8_t bottom = vmovl_u8(vld1_u8(s + srcBytesPerRow));
+
+		uint32x4_t left = vmlal_n_u16(vmull_n_u16(vget_low_u16(top), wTop),
+			vget_low_u16(bottom), wBottom);
+		uint32x4_t right = vmlal_n_u16(
+			vmull_n_u16(vget_high_u16(top), wTop), vget_high_u16(bottom),
+			wBottom);
+		uint32x4_t sum = vmlaq_n_u32(vmulq_n_u32(left, weights->weight),
+			right, 255 - weights->weight);
+
+		uint16x4_t sum16 = vshrn_n_u32(sum, 16);
+		uint8x8_t pixel = vmovn_u16(vcombine_u16(sum16, sum16));
+		store_pixel(dst, vget_lane_u32(vreinterpret_u32_u8(pixel), 0),
+			kKeepAlpha);
+	}
+}
+
+
+static const BilinearKernel kNEONKernel = {
+	"neon",
+	interpolate_neon<false>,
+	interpolate_neon<true>
+};
+
+#endif	// BILINEAR_KERNEL_NEON
+
+
+// #pragma mark - BilinearKernel
+
+
+struct implementation_info {
+	const BilinearKernel*	kernel;
+	bool					(*supported)();
+};
+
+static const implementation_info kImplementations[] = {
+	{ &kGenericKernel, NULL },
+#if BILINEAR_KERNEL_X86
+	{ &kSSE2Kernel, sse2_supported },
+	{ &kAVX2Kernel, avx2_supported },
+#endif
+#if BILINEAR_KERNEL_NEON
+	{ &kNEONKernel, NULL },
+#endif
+};
+
+static const int32 kImplementationCount
+	= sizeof(kImplementations) / sizeof(kImplementations[0]);
+
+
+/*static*/ const BilinearKernel*
+BilinearKernel::Default()
+{
+	static const BilinearKernel* sDefault = NULL;
+
+	// racing threads would all pick the same implementation
+	if (sDefault == NULL) {
+		const BilinearKernel* kernel = NULL;
+		for (int32 i = 0; ImplementationAt(i) != NULL; i++)
+			kernel = ImplementationAt(i);
+		sDefault = kernel;
+	}
+
+	return sDefault;
+}
+
+
+/*static*/ const BilinearKernel*
+BilinearKernel::ImplementationAt(int32 index)
+{
+	for (int32 i = 0; i < kImplementationCount; i++) {
+		const implementation_info& info = kImplementations[i];
+		if (info.supported != NULL && !info.supported())
+			continue;
+		if (index-- == 0)
+			return info.kernel;
+	}
+
+	return NULL;
+}
+
+
+}	// namespace BitmapPainterPrivate
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef BILINEAR_KERNEL_H
+#define BILINEAR_KERNEL_H
+
+
+#include <SupportDefs.h>
+
+
+namespace BitmapPainterPrivate {
+
+
+struct FilterInfo {
+	uint16 index;	// index into source bitmap row/column
+	uint16 weight;	// weight of the pixel at index [0..255]
+};
+
+
+/*!	Scalar and SIMD versions of the inner loop of the bilinear bitmap
+	scaling, selected at runtime.
+
+	Both functions interpolate \a count destination pixels from the source
+	row \a src and the one below it, using \a weights for the horizontal and
+	\a wTop for the vertical direction. The results are the same as those of
+	ColorTypeRgba::Interpolate() in DrawBitmapBilinear.h. The source pixels
+	to the right and below of each one must be accessible.
+*/
+struct BilinearKernel {
+	typedef void (*interpolate_func)(uint8* dst, const uint8* src,
+		uint32 srcBytesPerRow, const FilterInfo* weights, int32 count,
+		uint16 wTop);
+
+	const char*			name;
+
+	interpolate_func	Interpolate;
+							// writes all four channels
+	interpolate_func	InterpolateRgb;
+							// leaves the alpha channel of dst alone
+
+	static	const BilinearKernel*	Default();
+										// the fastest one for this CPU
+	static	const BilinearKernel*	ImplementationAt(int32 index);
+										// the generic one first
+};
+
+
+}	// namespace BitmapPainterPrivate
+
+
+#endif	// BILINEAR_KERNEL_H
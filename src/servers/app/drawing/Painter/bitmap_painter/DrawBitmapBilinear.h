@@ -3,6 +3,7 @@
  * Copyright 2008, Andrej Spielmann <andrej.spielmann@seh.ox.ac.uk>.
  * Copyright 2005-2014, Stephan Aßmus <superstippi@gmx.de>.
  * Copyright 2015, Julian Harnath <julian.harnath@rwth-aachen.de>
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * All rights reserved. Distributed under the terms of the MIT License.
  */
 #ifndef DRAW_BITMAP_BILINEAR_H
@@ -12,6 +13,9 @@
 
 #include <typeinfo>
 
+#include "BilinearKernel.h"
+#include "WorkerPool.h"
+
 
 // Prototypes for assembler routines
 extern "C" {
@@ -26,12 +30,6 @@ extern uint32 gSIMDFlags;
 namespace BitmapPainterPrivate {
 
 
-struct FilterInfo {
-	uint16 index;	// index into source bitmap row/column
-	uint16 weight;	// weight of the pixel at index [0..255]
-};
-
-
 struct FilterData {
 	FilterInfo* fWeightsX;
 	FilterInfo* fWeightsY;
@@ -40,11 +38,19 @@ struct FilterData {
 };
 
 
+// Clipping rects with at least this many pixels are split into bands of rows
+// that are drawn in parallel.
+static const int32 kMinParallelPixels = 128 * 1024;
+static const int32 kMinBandHeight = 16;
+
+
 template<class OptimizedVersion>
 struct DrawBitmapBilinearOptimized {
 	void Draw(PainterAggInterface& aggInterface, const BRect& destinationRect,
 		agg::rendering_buffer* bitmap, const FilterData& filterData)
 	{
+		WorkerPool* workerPool = WorkerPool::Default();
+
 		fSource = bitmap;
 		fSourceBytesPerRow = bitmap->stride();
 		fDestination = NULL;
@@ -73,7 +79,7 @@ struct DrawBitmapBilinearOptimized {
 				continue;
 
 			// buffer offset into destination
-			fDestination = aggInterface.fBuffer.row_ptr(y1) + x1 * 4;
+			uint8* destination = aggInterface.fBuffer.row_ptr(y1) + x1 * 4;
 
 			// x and y are needed as indices into the weight arrays, so the
 			// offset into the target buffer needs to be compensated
@@ -85,12 +91,65 @@ struct DrawBitmapBilinearOptimized {
 			//printf("x: %ld - %ld\n", xIndexL, xIndexR);
 			//printf("y: %ld - %ld\n", y1, y2);
 
-			static_cast<OptimizedVersion*>(this)->DrawToClipRect(
-				xIndexL, xIndexR, y1, y2);
+			int32 bands = 1;
+			if (workerPool != NULL
+				&& (x2 - x1 + 1) * (y2 - y1 + 1) >= kMinParallelPixels) {
+				bands = min_c(workerPool->CountThreads() * 2,
+					(y2 - y1 + 1) / kMinBandHeight);
+			}
+
+			if (bands > 1) {
+				BandJob job(static_cast<OptimizedVersion*>(this), destination,
+					xIndexL, xIndexR, y1, y2);
+				workerPool->Execute(job, bands);
+			} else {
+				fDestination = destination;
+				static_cast<OptimizedVersion*>(this)->DrawToClipRect(
+					xIndexL, xIndexR, y1, y2, true);
+			}
 
 		} while (baseRenderer.next_clip_box());
 	}
 
+private:
+	// Draws a band of rows of a clipping rect with its own copy of the
+	// painter, as DrawToClipRect() advances fDestination. Only the last band
+	// contains the last row of the clipping rect, which may need special
+	// handling.
+	struct BandJob : WorkerPool::Job {
+		BandJob(OptimizedVersion* painter, uint8* destination,
+			int32 xIndexL, int32 xIndexR, int32 y1, int32 y2)
+			:
+			fPainter(painter),
+			fDestination(destination),
+			fXIndexL(xIndexL),
+			fXIndexR(xIndexR),
+			fY1(y1),
+			fY2(y2)
+		{
+		}
+
+		virtual void Run(int32 index, int32 count)
+		{
+			const int32 rows = fY2 - fY1 + 1;
+			const int32 first = fY1 + rows * index / count;
+			const int32 last = fY1 + rows * (index + 1) / count - 1;
+
+			OptimizedVersion painter(*fPainter);
+			painter.fDestination = fDestination
+				+ (first - fY1) * painter.fDestinationBytesPerRow;
+			painter.DrawToClipRect(fXIndexL, fXIndexR, first, last,
+				index == count - 1);
+		}
+
+		OptimizedVersion*	fPainter;
+		uint8*				fDestination;
+		int32				fXIndexL;
+		int32				fXIndexR;
+		int32				fY1;
+		int32				fY2;
+	};
+
 protected:
 	agg::rendering_buffer*	fSource;
 	uint32					fSourceBytesPerRow;
@@ -198,6 +257,16 @@ struct DrawModeCopy {
 		d[2] = t[2];
 		d += 4;
 	}
+
+	static void
+	InterpolateRow(const BilinearKernel* kernel, uint8*& d, const uint8* src,
+		uint32 sourceBytesPerRow, const FilterInfo* weights, int32 count,
+		uint16 wTop)
+	{
+		kernel->InterpolateRgb(d, src, sourceBytesPerRow, weights, count,
+			wTop);
+		d += count * 4;
+	}
 };
 
 
@@ -222,6 +291,29 @@ struct DrawModeAlphaOverlay {
 
 		d += 4;
 	}
+
+	static void
+	InterpolateRow(const BilinearKernel* kernel, uint8*& d, const uint8* src,
+		uint32 sourceBytesPerRow, const FilterInfo* weights, int32 count,
+		uint16 wTop)
+	{
+		// interpolate chunks of the row into a buffer, and blend them
+		uint8 buffer[256 * 4];
+		while (count > 0) {
+			int32 chunk = min_c(count, 256);
+			kernel->Interpolate(buffer, src, sourceBytesPerRow, weights,
+				chunk, wTop);
+
+			const uint8* p = buffer;
+			for (int32 i = 0; i < chunk; i++, p += 4) {
+				uint32 t[4] = { p[0], p[1], p[2], p[3] };
+				Blend(d, t);
+			}
+
+			weights += chunk;
+			count -= chunk;
+		}
+	}
 };
 
 
@@ -229,7 +321,8 @@ template<class ColorType, class DrawMode>
 struct BilinearDefault :
 	DrawBitmapBilinearOptimized<BilinearDefault<ColorType, DrawMode> > {
 
-	void DrawToClipRect(int32 xIndexL, int32 xIndexR, int32 y1, int32 y2)
+	void DrawToClipRect(int32 xIndexL, int32 xIndexR, int32 y1, int32 y2,
+		bool lastBand)
 	{
 		// In this mode we anticipate many pixels wich need filtering,
 		// there are no special cases for direct hit pixels except for
@@ -238,7 +331,7 @@ struct BilinearDefault :
 		// The last column/row handling does not need to be performed
 		// for all clipping rects!
 		int32 yMax = y2;
-		if (this->fWeightsY[yMax].weight == 255)
+		if (lastBand && this->fWeightsY[yMax].weight == 255)
 			yMax--;
 		int32 xIndexMax = xIndexR;
 		if (this->fWeightsX[xIndexMax].weight == 255)
@@ -318,7 +411,8 @@ struct BilinearDefault :
 
 struct BilinearLowFilterRatio :
 	DrawBitmapBilinearOptimized<BilinearLowFilterRatio> {
-	void DrawToClipRect(int32 xIndexL, int32 xIndexR, int32 y1, int32 y2)
+	void DrawToClipRect(int32 xIndexL, int32 xIndexR, int32 y1, int32 y2,
+		bool lastBand)
 	{
 		// In this mode, we anticipate to hit many destination pixels
 		// that map directly to a source pixel, we have more branches
@@ -405,10 +499,83 @@ struct BilinearLowFilterRatio :
 };
 
 
+template<class ColorType, class DrawMode>
+struct BilinearVectorized :
+	DrawBitmapBilinearOptimized<BilinearVectorized<ColorType, DrawMode> > {
+
+	void DrawToClipRect(int32 xIndexL, int32 xIndexR, int32 y1, int32 y2,
+		bool lastBand)
+	{
+		// The same as the default version, but the rows are interpolated by
+		// the BilinearKernel, which requires the source to have more than
+		// one row.
+		const BilinearKernel* kernel = BilinearKernel::Default();
+
+		int32 yMax = y2;
+		if (lastBand && this->fWeightsY[yMax].weight == 255)
+			yMax--;
+		int32 xIndexMax = xIndexR;
+		if (this->fWeightsX[xIndexMax].weight == 255)
+			xIndexMax--;
+
+		for (; y1 <= yMax; y1++) {
+			const uint16 wTop = this->fWeightsY[y1].weight;
+			const uint16 wBottom = 255 - this->fWeightsY[y1].weight;
+
+			const uint8* src = this->fSource->row_ptr(
+				this->fWeightsY[y1].index);
+			uint8* d = this->fDestination;
+
+			if (xIndexMax >= xIndexL) {
+				DrawMode::InterpolateRow(kernel, d, src,
+					this->fSourceBytesPerRow, this->fWeightsX + xIndexL,
+					xIndexMax - xIndexL + 1, wTop);
+			}
+
+			// last column of pixels if necessary
+			if (xIndexMax < xIndexR) {
+				const uint8* s = src + this->fWeightsX[xIndexR].index;
+				const uint8* sBottom = s + this->fSourceBytesPerRow;
+
+				uint32 t[4];
+				ColorType::InterpolateLastColumn(&t[0], s, sBottom, wTop,
+					wBottom);
+				DrawMode::Blend(d, &t[0]);
+			}
+
+			this->fDestination += this->fDestinationBytesPerRow;
+		}
+
+		// last row of pixels if necessary
+		const uint8* src
+			= this->fSource->row_ptr(this->fWeightsY[y2].index);
+		uint8* d = this->fDestination;
+
+		if (yMax < y2) {
+			for (int32 x = xIndexL; x <= xIndexMax; x++) {
+				const uint8* s = src + this->fWeightsX[x].index;
+				const uint16 wLeft = this->fWeightsX[x].weight;
+				const uint16 wRight = 255 - wLeft;
+				uint32 t[4];
+				ColorType::InterpolateLastRow(&t[0], s, wLeft, wRight);
+				DrawMode::Blend(d, &t[0]);
+			}
+		}
+
+		// pixel in bottom right corner if necessary
+		if (yMax < y2 && xIndexMax < xIndexR) {
+			const uint8* s = src + this->fWeightsX[xIndexR].index;
+			*(uint32*)d = *(uint32*)s;
+		}
+	}
+};
+
+
 #ifdef __i386__
 
 struct BilinearSimd : DrawBitmapBilinearOptimized<BilinearSimd> {
-	void DrawToClipRect(int32 xIndexL, int32 xIndexR, int32 y1, int32 y2)
+	void DrawToClipRect(int32 xIndexL, int32 xIndexR, int32 y1, int32 y2,
+		bool lastBand)
 	{
 		// Basically the same as the "standard" mode, but we use SIMD
 		// routines for the processing of the single display lines.
@@ -416,7 +583,7 @@ struct BilinearSimd : DrawBitmapBilinearOptimized<BilinearSimd> {
 		// The last column/row handling does not need to be performed
 		// for all clipping rects!
 		int32 yMax = y2;
-		if (fWeightsY[yMax].weight == 255)
+		if (lastBand && fWeightsY[yMax].weight == 255)
 			yMax--;
 		int32 xIndexMax = xIndexR;
 		if (fWeightsX[xIndexMax].weight == 255)
@@ -591,12 +758,17 @@ struct DrawBitmapBilinear {
 		enum {
 			kOptimizeForLowFilterRatio = 0,
 			kUseDefaultVersion,
-			kUseSIMDVersion
+			kUseSIMDVersion,
+			kUseVectorizedVersion
 		};
 
 		int codeSelect = kUseDefaultVersion;
 
-		if (typeid(ColorType) == typeid(ColorTypeRgb)
+		if (BilinearKernel::Default() != BilinearKernel::ImplementationAt(0)
+			&& bitmap.height() > 1) {
+			// there is a SIMD kernel for this CPU
+			codeSelect = kUseVectorizedVersion;
+		} else if (typeid(ColorType) == typeid(ColorTypeRgb)
 			&& typeid(DrawMode) == typeid(DrawModeCopy)) {
 			uint32 neededSIMDFlags = APPSERVER_SIMD_MMX | APPSERVER_SIMD_SSE;
 			if ((gSIMDFlags & neededSIMDFlags) == neededSIMDFlags)
@@ -618,6 +790,14 @@ struct DrawBitmapBilinear {
 				break;
 			}
 
+			case kUseVectorizedVersion:
+			{
+				BilinearVectorized<ColorType, DrawMode> bilinearPainter;
+				bilinearPainter.Draw(aggInterface, destinationRect, &bitmap,
+					filterData);
+				break;
+			}
+
 			case kOptimizeForLowFilterRatio:
 			{
 				BilinearLowFilterRatio bilinearPainter;
@@ -1,6 +1,7 @@
 /*
  * Copyright 2005, Stephan Aßmus <superstippi@gmx.de>.
  * Copyright 2008, Andrej Spielmann <andrej.spielmann@seh.ox.ac.uk>.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * All rights reserved. Distributed under the terms of the MIT License.
  *
  * Base class for different drawing modes.
@@ -14,6 +15,7 @@
 
 #include "PatternHandler.h"
 #include "PixelFormat.h"
+#include "SpanBlender.h"
 
 class PatternHandler;
 
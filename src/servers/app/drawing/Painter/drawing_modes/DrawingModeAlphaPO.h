@@ -1,5 +1,6 @@
 /*
  * Copyright 2005, Stephan Aßmus <superstippi@gmx.de>. All rights reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * DrawingMode implementing B_OP_ALPHA in "Pixel Overlay" mode on B_RGBA32.
@@ -122,19 +123,8 @@ blend_color_hspan_alpha_po(int x, int y, unsigned len,
 	uint8* p = buffer->row_ptr(y) + (x << 2);
 	if (covers) {
 		// non-solid opacity
-		do {
-			uint16 alpha = colors->a * *covers;
-			if (alpha) {
-				if (alpha == 255 * 255) {
-					ASSIGN_ALPHA_PO(p, colors->r, colors->g, colors->b);
-				} else {
-					BLEND_ALPHA_PO(p, colors->r, colors->g, colors->b, alpha);
-				}
-			}
-			covers++;
-			p += 4;
-			++colors;
-		} while(--len);
+		SpanBlender::Default()->BlendColors(p, len, (const uint8*)colors,
+			covers);
 	} else {
 		// solid full opcacity
 		uint16 alpha = colors->a * cover;
@@ -1,5 +1,6 @@
 /*
  * Copyright 2005, Stephan Aßmus <superstippi@gmx.de>. All rights reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * DrawingMode implementing B_OP_ALPHA in "Pixel Overlay" mode on B_RGBA32.
@@ -32,33 +33,12 @@ blend_hline_alpha_po_solid(int x, int y, unsigned len,
 						   agg_buffer* buffer, const PatternHandler* pattern)
 {
 	uint16 alpha = c.a * cover;
+	uint8* p = buffer->row_ptr(y) + (x << 2);
 	if (alpha == 255 * 255) {
-		// cache the color as 32bit values
-		uint32 v;
-		uint8* p8 = (uint8*)&v;
-		p8[0] = c.b;
-		p8[1] = c.g;
-		p8[2] = c.r;
-		p8[3] = 255;
-		// row offset as 32bit pointer
-		uint32* p32 = (uint32*)(buffer->row_ptr(y)) + x;
-		do {
-			*p32 = v;
-			p32++;
-			x++;
-		} while(--len);
+		SpanBlender::Default()->Fill(p, len, span_color(c.r, c.g, c.b));
 	} else {
-		uint8* p = buffer->row_ptr(y) + (x << 2);
-		if (len < 4) {
-			do {
-				BLEND_ALPHA_CO(p, c.r, c.g, c.b, alpha);
-				x++;
-				p += 4;
-			} while(--len);
-		} else {
-			alpha = alpha >> 8;
-			blend_line32(p, len, c.r, c.g, c.b, alpha);
-		}
+		SpanBlender::Default()->Blend(p, len, span_color(c.r, c.g, c.b),
+			alpha);
 	}
 }
 
@@ -69,19 +49,8 @@ blend_solid_hspan_alpha_po_solid(int x, int y, unsigned len,
 						 		 agg_buffer* buffer, const PatternHandler* pattern)
 {
 	uint8* p = buffer->row_ptr(y) + (x << 2);
-	do {
-		uint16 alpha = c.a * *covers;
-		if (alpha) {
-			if(alpha == 255 * 255) {
-				ASSIGN_ALPHA_PO(p, c.r, c.g, c.b);
-			} else {
-				BLEND_ALPHA_PO(p, c.r, c.g, c.b, alpha);
-			}
-		}
-		covers++;
-		p += 4;
-		x++;
-	} while(--len);
+	SpanBlender::Default()->BlendCovers(p, len, span_color(c.r, c.g, c.b),
+		c.a, 255 * 255, covers);
 }
 
 
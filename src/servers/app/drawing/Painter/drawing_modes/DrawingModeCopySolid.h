@@ -1,5 +1,6 @@
 /*
  * Copyright 2005, Stephan Aßmus <superstippi@gmx.de>. All rights reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * DrawingMode implementing B_OP_COPY ignoring the pattern (solid) on B_RGBA32.
@@ -30,26 +31,12 @@ blend_hline_copy_solid(int x, int y, unsigned len,
 					   const color_type& c, uint8 cover,
 					   agg_buffer* buffer, const PatternHandler* pattern)
 {
+	uint8* p = buffer->row_ptr(y) + (x << 2);
 	if (cover == 255) {
-		uint32 v;
-		uint8* p8 = (uint8*)&v;
-		p8[0] = (uint8)c.b;
-		p8[1] = (uint8)c.g;
-		p8[2] = (uint8)c.r;
-		p8[3] = 255;
-		uint32* p32 = (uint32*)(buffer->row_ptr(y)) + x;
-		do {
-			*p32 = v;
-			p32++;
-			x++;
-		} while(--len);
+		SpanBlender::Default()->Fill(p, len, span_color(c.r, c.g, c.b));
 	} else {
-		uint8* p = buffer->row_ptr(y) + (x << 2);
-		do {
-			BLEND_OVER(p, c.r, c.g, c.b, cover);
-			x++;
-			p += 4;
-		} while(--len);
+		SpanBlender::Default()->Blend(p, len, span_color(c.r, c.g, c.b),
+			cover << 8);
 	}
 }
 
@@ -61,18 +48,8 @@ blend_solid_hspan_copy_solid(int x, int y, unsigned len,
 							 const PatternHandler* pattern)
 {
 	uint8* p = buffer->row_ptr(y) + (x << 2);
-	do {
-		if (*covers) {
-			if (*covers == 255) {
-				ASSIGN_OVER(p, c.r, c.g, c.b);
-			} else {
-				BLEND_OVER(p, c.r, c.g, c.b, *covers);
-			}
-		}
-		covers++;
-		p += 4;
-		x++;
-	} while(--len);
+	SpanBlender::Default()->BlendCovers(p, len, span_color(c.r, c.g, c.b),
+		256, 255 * 256, covers);
 }
 
 
@@ -0,0 +1,681 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Scalar, SSE2, AVX2 and NEON implementations of the span functions.
+ *
+ */
+
+#include "SpanBlender.h"
+
+#include <string.h>
+
+#if (defined(__i386__) || defined(__x86_64__)) && __GNUC__ >= 5
+#	define SPAN_BLENDER_X86 1
+#	include <immintrin.h>
+#	define SSE2_FUNCTION __attribute__((target("sse2")))
+#	define AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+
+#if defined(__ARM_NEON) && __GNUC__ >= 5
+#	define SPAN_BLENDER_NEON 1
+#	include <arm_neon.h>
+#endif
+
+
+// #pragma mark - generic
+
+
+static inline void
+blend_pixel(uint8* d, const uint8* s, int32 alpha)
+{
+	// (s - d) * alpha + (d << 16) is never negative for alpha < 65536
+	d[0] = ((s[0] - d[0]) * alpha + (d[0] << 16)) >> 16;
+	d[1] = ((s[1] - d[1]) * alpha + (d[1] << 16)) >> 16;
+	d[2] = ((s[2] - d[2]) * alpha + (d[2] << 16)) >> 16;
+	d[3] = 255;
+}
+
+
+static inline void
+assign_pixel(uint8* d, const uint8* s)
+{
+	d[0] = s[0];
+	d[1] = s[1];
+	d[2] = s[2];
+	d[3] = 255;
+}
+
+
+static void
+fill_generic(uint8* dst, uint32 count, uint32 color)
+{
+	uint32* p32 = (uint32*)dst;
+	while (count-- > 0)
+		*p32++ = color;
+}
+
+
+static void
+blend_generic(uint8* dst, uint32 count, uint32 color, uint16 alpha)
+{
+	const uint8* s = (const uint8*)&color;
+	for (; count > 0; count--, dst += 4)
+		blend_pixel(dst, s, alpha);
+}
+
+
+static void
+blend_covers_generic(uint8* dst, uint32 count, uint32 color, uint16 scale,
+	uint16 opaque, const uint8* covers)
+{
+	const uint8* s = (const uint8*)&color;
+	for (; count > 0; count--, dst += 4) {
+		uint16 alpha = *covers++ * scale;
+		if (alpha == 0)
+			continue;
+		if (alpha == opaque)
+			assign_pixel(dst, s);
+		else
+			blend_pixel(dst, s, alpha);
+	}
+}
+
+
+static void
+blend_colors_generic(uint8* dst, uint32 count, const uint8* colors,
+	const uint8* covers)
+{
+	for (; count > 0; count--, dst += 4, colors += 4) {
+		uint16 alpha = colors[3] * *covers++;
+		if (alpha == 0)
+			continue;
+		uint8 s[4] = { colors[2], colors[1], colors[0], 255 };
+		if (alpha == 255 * 255)
+			assign_pixel(dst, s);
+		else
+			blend_pixel(dst, s, alpha);
+	}
+}
+
+
+static const SpanBlender kGenericBlender = {
+	"generic",
+	fill_generic,
+	blend_generic,
+	blend_covers_generic,
+	blend_colors_generic
+};
+
+
+#if SPAN_BLENDER_X86
+
+// #pragma mark - SSE2
+
+
+// All x86 implementations work on pixels unpacked to 16 bit channels.
+
+
+/*!	Returns d + ((s - d) * alpha) >> 16 for each 16 bit lane.
+	_mm_mulhi_epi16() treats alpha as signed, which is off by (s - d) for
+	alpha >= 32768; that is added back where the sign bit is set.
+*/
+static inline SSE2_FUNCTION __m128i
+blend_lanes_sse2(__m128i d, __m128i s, __m128i alpha)
+{
+	__m128i diff = _mm_sub_epi16(s, d);
+	__m128i high = _mm_mulhi_epi16(diff, alpha);
+	high = _mm_add_epi16(high,
+		_mm_and_si128(diff, _mm_srai_epi16(alpha, 15)));
+	return _mm_add_epi16(d, high);
+}
+
+
+static inline SSE2_FUNCTION __m128i
+select_sse2(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+
+/*!	Blends two unpacked pixels, with the alpha of each pixel spread over its
+	channels, leaving those with an alpha of 0 alone, and assigning those
+	with an alpha of \a opaque.
+*/
+static inline SSE2_FUNCTION __m128i
+blend_covered_sse2(__m128i d, __m128i s, __m128i alpha, __m128i opaque,
+	__m128i alphaChannel)
+{
+	__m128i result = _mm_or_si128(blend_lanes_sse2(d, s, alpha),
+		alphaChannel);
+	result = select_sse2(_mm_cmpeq_epi16(alpha, opaque), s, result);
+	return select_sse2(_mm_cmpeq_epi16(alpha, _mm_setzero_si128()), d,
+		result);
+}
+
+
+/*!	Spreads the 16 bit alpha values in the low halves of four 32 bit lanes
+	over the channels of the unpacked pixels.
+*/
+static inline SSE2_FUNCTION void
+spread_alpha_sse2(__m128i alpha, __m128i& _low, __m128i& _high)
+{
+	alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+	_low = _mm_unpacklo_epi32(alpha, alpha);
+	_high = _mm_unpackhi_epi32(alpha, alpha);
+}
+
+
+/*!	Converts four agg::rgba8 colors into B_RGBA32 pixels with an alpha of
+	255, and returns their alpha values in the 32 bit lanes of \a _alpha.
+*/
+static inline SSE2_FUNCTION __m128i
+convert_colors_sse2(__m128i colors, __m128i& _alpha)
+{
+	_alpha = _mm_srli_epi32(colors, 24);
+	__m128i redBlue = _mm_and_si128(colors, _mm_set1_epi32(0x00ff00ff));
+	redBlue = _mm_or_si128(_mm_slli_epi32(redBlue, 16),
+		_mm_srli_epi32(redBlue, 16));
+	return _mm_or_si128(_mm_or_si128(redBlue,
+		_mm_and_si128(colors, _mm_set1_epi32(0x0000ff00))),
+		_mm_set1_epi32(0xff000000));
+}
+
+
+static SSE2_FUNCTION void
+fill_sse2(uint8* dst, uint32 count, uint32 color)
+{
+	__m128i s = _mm_set1_epi32(color);
+	for (; count >= 4; count -= 4, dst += 16)
+		_mm_storeu_si128((__m128i*)dst, s);
+
+	fill_generic(dst, count, color);
+}
+
+
+static SSE2_FUNCTION void
+blend_sse2(uint8* dst, uint32 count, uint32 color, uint16 alpha)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i s = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+	__m128i a = _mm_set1_epi16(alpha);
+	__m128i alphaChannel = _mm_set1_epi32(0xff000000);
+
+	for (; count >= 4; count -= 4, dst += 16) {
+		__m128i d = _mm_loadu_si128((__m128i*)dst);
+		__m128i low = blend_lanes_sse2(_mm_unpacklo_epi8(d, zero), s, a);
+		__m128i high = blend_lanes_sse2(_mm_unpackhi_epi8(d, zero), s, a);
+		_mm_storeu_si128((__m128i*)dst,
+			_mm_or_si128(_mm_packus_epi16(low, high), alphaChannel));
+	}
+
+	blend_generic(dst, count, color, alpha);
+}
+
+
+static SSE2_FUNCTION void
+blend_covers_sse2(uint8* dst, uint32 count, uint32 color, uint16 scale,
+	uint16 opaque, const uint8* covers)
+{
+	color |= 0xff000000;
+	bool fullIsOpaque = 255 * scale == opaque;
+
+	__m128i zero = _mm_setzero_si128();
+	__m128i fill = _mm_set1_epi32(color);
+	__m128i s = _mm_unpacklo_epi8(fill, zero);
+	__m128i scale16 = _mm_set1_epi16(scale);
+	__m128i opaque16 = _mm_set1_epi16(opaque);
+	__m128i alphaChannel = _mm_set1_epi64x(0x00ff000000000000LL);
+
+	for (; count >= 4; count -= 4, dst += 16, covers += 4) {
+		uint32 coverBits;
+		memcpy(&coverBits, covers, 4);
+		if (coverBits == 0)
+			continue;
+		if (coverBits == 0xffffffff && fullIsOpaque) {
+			_mm_storeu_si128((__m128i*)dst, fill);
+			continue;
+		}
+
+		__m128i alpha = _mm_unpacklo_epi16(
+			_mm_unpacklo_epi8(_mm_cvtsi32_si128(coverBits), zero), zero);
+		__m128i alphaLow;
+		__m128i alphaHigh;
+		spread_alpha_sse2(alpha, alphaLow, alphaHigh);
+		alphaLow = _mm_mullo_epi16(alphaLow, scale16);
+		alphaHigh = _mm_mullo_epi16(alphaHigh, scale16);
+
+		__m128i d = _mm_loadu_si128((__m128i*)dst);
+		__m128i low = blend_covered_sse2(_mm_unpacklo_epi8(d, zero), s,
+			alphaLow, opaque16, alphaChannel);
+		__m128i high = blend_covered_sse2(_mm_unpackhi_epi8(d, zero), s,
+			alphaHigh, opaque16, alphaChannel);
+		_mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(low, high));
+	}
+
+	blend_covers_generic(dst, count, color, scale, opaque, covers);
+}
+
+
+static SSE2_FUNCTION void
+blend_colors_sse2(uint8* dst, uint32 count, const uint8* colors,
+	const uint8* covers)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i opaque16 = _mm_set1_epi16((short)(255 * 255));
+	__m128i alphaChannel = _mm_set1_epi64x(0x00ff000000000000LL);
+
+	for (; count >= 4; count -= 4, dst += 16, colors += 16, covers += 4) {
+		uint32 coverBits;
+		memcpy(&coverBits, covers, 4);
+		if (coverBits == 0)
+			continue;
+
+		__m128i alpha;
+		__m128i s = convert_colors_sse2(
+			_mm_loadu_si128((const __m128i*)colors), alpha);
+		__m128i cover = _mm_unpacklo_epi16(
+			_mm_unpacklo_epi8(_mm_cvtsi32_si128(coverBits), zero), zero);
+		// the products fit into the low halves of the 32 bit lanes
+		alpha = _mm_mullo_epi16(alpha, cover);
+		__m128i alphaLow;
+		__m128i alphaHigh;
+		spread_alpha_sse2(alpha, alphaLow, alphaHigh);
+
+		__m128i d = _mm_loadu_si128((__m128i*)dst);
+		__m128i low = blend_covered_sse2(_mm_unpacklo_epi8(d, zero),
+			_mm_unpacklo_epi8(s, zero), alphaLow, opaque16, alphaChannel);
+		__m128i high = blend_covered_sse2(_mm_unpackhi_epi8(d, zero),
+			_mm_unpackhi_epi8(s, zero), alphaHigh, opaque16, alphaChannel);
+		_mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(low, high));
+	}
+
+	blend_colors_generic(dst, count, colors, covers);
+}
+
+
+static const SpanBlender kSSE2Blender = {
+	"sse2",
+	fill_sse2,
+	blend_sse2,
+	blend_covers_sse2,
+	blend_colors_sse2
+};
+
+
+static bool
+sse2_supported()
+{
+#ifdef __x86_64__
+	return true;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+
+
+// #pragma mark - AVX2
+
+
+// The same as the SSE2 functions; the 256 bit unpack and pack instructions
+// work on the two 128 bit lanes separately, so that the pixels stay in order.
+
+
+static inline AVX2_FUNCTION __m256i
+blend_lanes_avx2(__m256i d, __m256i s, __m256i alpha)
+{
+	__m256i diff = _mm256_sub_epi16(s, d);
+	__m256i high = _mm256_mulhi_epi16(diff, alpha);
+	high = _mm256_add_epi16(high,
+		_mm256_and_si256(diff, _mm256_srai_epi16(alpha, 15)));
+	return _mm256_add_epi16(d, high);
+}
+
+
+static inline AVX2_FUNCTION __m256i
+blend_covered_avx2(__m256i d, __m256i s, __m256i alpha, __m256i opaque,
+	__m256i alphaChannel)
+{
+	__m256i result = _mm256_or_si256(blend_lanes_avx2(d, s, alpha),
+		alphaChannel);
+	result = _mm256_blendv_epi8(result, s, _mm256_cmpeq_epi16(alpha, opaque));
+	return _mm256_blendv_epi8(result, d,
+		_mm256_cmpeq_epi16(alpha, _mm256_setzero_si256()));
+}
+
+
+static inline AVX2_FUNCTION void
+spread_alpha_avx2(__m256i alpha, __m256i& _low, __m256i& _high)
+{
+	alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 16));
+	_low = _mm256_unpacklo_epi32(alpha, alpha);
+	_high = _mm256_unpackhi_epi32(alpha, alpha);
+}
+
+
+static inline AVX2_FUNCTION __m256i
+load_covers_avx2(const uint8* covers)
+{
+	return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)covers));
+}
+
+
+static AVX2_FUNCTION void
+fill_avx2(uint8* dst, uint32 count, uint32 color)
+{
+	__m256i s = _mm256_set1_epi32(color);
+	for (; count >= 8; count -= 8, dst += 32)
+		_mm256_storeu_si256((__m256i*)dst, s);
+
+	fill_generic(dst, count, color);
+}
+
+
+static AVX2_FUNCTION void
+blend_avx2(uint8* dst, uint32 count, uint32 color, uint16 alpha)
+{
+	__m256i zero = _mm256_setzero_si256();
+	__m256i s = _mm256_unpacklo_epi8(_mm256_set1_epi32(color), zero);
+	__m256i a = _mm256_set1_epi16(alpha);
+	__m256i alphaChannel = _mm256_set1_epi32(0xff000000);
+
+	for (; count >= 8; count -= 8, dst += 32) {
+		__m256i d = _mm256_loadu_si256((__m256i*)dst);
+		__m256i low = blend_lanes_avx2(_mm256_unpacklo_epi8(d, zero), s, a);
+		__m256i high = blend_lanes_avx2(_mm256_unpackhi_epi8(d, zero), s, a);
+		_mm256_storeu_si256((__m256i*)dst,
+			_mm256_or_si256(_mm256_packus_epi16(low, high), alphaChannel));
+	}
+
+	blend_generic(dst, count, color, alpha);
+}
+
+
+static AVX2_FUNCTION void
+blend_covers_avx2(uint8* dst, uint32 count, uint32 color, uint16 scale,
+	uint16 opaque, const uint8* covers)
+{
+	color |= 0xff000000;
+	bool fullIsOpaque = 255 * scale == opaque;
+
+	__m256i zero = _mm256_setzero_si256();
+	__m256i fill = _mm256_set1_epi32(color);
+	__m256i s = _mm256_unpacklo_epi8(fill, zero);
+	__m256i scale16 = _mm256_set1_epi16(scale);
+	__m256i opaque16 = _mm256_set1_epi16(opaque);
+	__m256i alphaChannel = _mm256_set1_epi64x(0x00ff000000000000LL);
+
+	for (; count >= 8; count -= 8, dst += 32, covers += 8) {
+		uint64 coverBits;
+		memcpy(&coverBits, covers, 8);
+		if (coverBits == 0)
+			continue;
+		if (coverBits == ~(uint64)0 && fullIsOpaque) {
+			_mm256_storeu_si256((__m256i*)dst, fill);
+			continue;
+		}
+
+		__m256i alphaLow;
+		__m256i alphaHigh;
+		spread_alpha_avx2(load_covers_avx2(covers), alphaLow, alphaHigh);
+		alphaLow = _mm256_mullo_epi16(alphaLow, scale16);
+		alphaHigh = _mm256_mullo_epi16(alphaHigh, scale16);
+
+		__m256i d = _mm256_loadu_si256((__m256i*)dst);
+		__m256i low = blend_covered_avx2(_mm256_unpacklo_epi8(d, zero), s,
+			alphaLow, opaque16, alphaChannel);
+		__m256i high = blend_covered_avx2(_mm256_unpackhi_epi8(d, zero), s,
+			alphaHigh, opaque16, alphaChannel);
+		_mm256_storeu_si256((__m256i*)dst, _mm256_packus_epi16(low, high));
+	}
+
+	blend_covers_generic(dst, count, color, scale, opaque, covers);
+}
+
+
+static AVX2_FUNCTION void
+blend_colors_avx2(uint8* dst, uint32 count, const uint8* colors,
+	const uint8* covers)
+{
+	__m256i zero = _mm256_setzero_si256();
+	__m256i opaque16 = _mm256_set1_epi16((short)(255 * 255));
+	__m256i alphaChannel = _mm256_set1_epi64x(0x00ff000000000000LL);
+	__m256i redBlueMask = _mm256_set1_epi32(0x00ff00ff);
+	__m256i greenMask = _mm256_set1_epi32(0x0000ff00);
+
+	for (; count >= 8; count -= 8, dst += 32, colors += 32, covers += 8) {
+		uint64 coverBits;
+		memcpy(&coverBits, covers, 8);
+		if (coverBits == 0)
+			continue;
+
+		__m256i c = _mm256_loadu_si256((const __m256i*)colors);
+		__m256i alpha = _mm256_mullo_epi16(_mm256_srli_epi32(c, 24),
+			load_covers_avx2(covers));
+		__m256i redBlue = _mm256_and_si256(c, redBlueMask);
+		redBlue = _mm256_or_si256(_mm256_slli_epi32(redBlue, 16),
+			_mm256_srli_epi32(redBlue, 16));
+		__m256i s = _mm256_or_si256(_mm256_or_si256(redBlue,
+			_mm256_and_si256(c, greenMask)), _mm256_set1_epi32(0xff000000));
+
+		__m256i alphaLow;
+		__m256i alphaHigh;
+		spread_alpha_avx2(alpha, alphaLow, alphaHigh);
+
+		__m256i d = _mm256_loadu_si256((__m256i*)dst);
+		__m256i low = blend_covered_avx2(_mm256_unpacklo_epi8(d, zero),
+			_mm256_unpacklo_epi8(s, zero), alphaLow, opaque16, alphaChannel);
+		__m256i high = blend_covered_avx2(_mm256_unpackhi_epi8(d, zero),
+			_mm256_unpackhi_epi8(s, zero), alphaHigh, opaque16,
+			alphaChannel);
+		_mm256_storeu_si256((__m256i*)dst, _mm256_packus_epi16(low, high));
+	}
+
+	blend_colors_generic(dst, count, colors, covers);
+}
+
+
+static const SpanBlender kAVX2Blender = {
+	"avx2",
+	fill_avx2,
+	blend_avx2,
+	blend_covers_avx2,
+	blend_colors_avx2
+};
+
+
+static bool
+avx2_supported()
+{
+	// this also checks whether the OS saves the AVX state
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+#endif	// SPAN_BLENDER_X86
+
+
+#if SPAN_BLENDER_NEON
+
+// #pragma mark - NEON
+
+
+// The NEON functions load eight pixels at once split into their channels, so
+// that each 16 bit lane holds a different pixel.
+
+
+static inline uint8x8_t
+blend_channel_neon(uint8x8_t d8, uint16x8_t s, uint16x8_t alpha)
+{
+	uint16x8_t d = vmovl_u8(d8);
+	int16x8_t diff = vreinterpretq_s16_u16(vsubq_u16(s, d));
+	int32x4_t low = vmulq_s32(vmovl_s16(vget_low_s16(diff)),
+		vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(alpha))));
+	int32x4_t high = vmulq_s32(vmovl_s16(vget_high_s16(diff)),
+		vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(alpha))));
+	int16x8_t product = vcombine_s16(vshrn_n_s32(low, 16),
+		vshrn_n_s32(high, 16));
+	return vmovn_u16(vaddq_u16(d, vreinterpretq_u16_s16(product)));
+}
+
+
+static inline void
+blend_covered_neon(uint8x8x4_t& d, const uint8x8_t* s, uint16x8_t alpha,
+	uint16x8_t opaque)
+{
+	uint8x8_t isOpaque = vmovn_u16(vceqq_u16(alpha, opaque));
+	uint8x8_t isEmpty = vmovn_u16(vceqq_u16(alpha, vdupq_n_u16(0)));
+	for (int i = 0; i < 3; i++) {
+		uint8x8_t result = blend_channel_neon(d.val[i], vmovl_u8(s[i]),
+			alpha);
+		result = vbsl_u8(isOpaque, s[i], result);
+		d.val[i] = vbsl_u8(isEmpty, d.val[i], result);
+	}
+	d.val[3] = vbsl_u8(isEmpty, d.val[3], vdup_n_u8(255));
+}
+
+
+static void
+fill_neon(uint8* dst, uint32 count, uint32 color)
+{
+	uint32x4_t s = vdupq_n_u32(color);
+	for (; count >= 4; count -= 4, dst += 16)
+		vst1q_u8(dst, vreinterpretq_u8_u32(s));
+
+	fill_generic(dst, count, color);
+}
+
+
+static void
+blend_neon(uint8* dst, uint32 count, uint32 color, uint16 alpha)
+{
+	const uint8* c = (const uint8*)&color;
+	uint16x8_t s[3] = { vdupq_n_u16(c[0]), vdupq_n_u16(c[1]),
+		vdupq_n_u16(c[2]) };
+	uint16x8_t a = vdupq_n_u16(alpha);
+
+	for (; count >= 8; count -= 8, dst += 32) {
+		uint8x8x4_t d = vld4_u8(dst);
+		for (int i = 0; i < 3; i++)
+			d.val[i] = blend_channel_neon(d.val[i], s[i], a);
+		d.val[3] = vdup_n_u8(255);
+		vst4_u8(dst, d);
+	}
+
+	blend_generic(dst, count, color, alpha);
+}
+
+
+static void
+blend_covers_neon(uint8* dst, uint32 count, uint32 color, uint16 scale,
+	uint16 opaque, const uint8* covers)
+{
+	const uint8* c = (const uint8*)&color;
+	uint8x8_t s[3] = { vdup_n_u8(c[0]), vdup_n_u8(c[1]), vdup_n_u8(c[2]) };
+	uint16x8_t opaque16 = vdupq_n_u16(opaque);
+
+	for (; count >= 8; count -= 8, dst += 32, covers += 8) {
+		uint64 coverBits;
+		memcpy(&coverBits, covers, 8);
+		if (coverBits == 0)
+			continue;
+
+		uint16x8_t alpha = vmulq_n_u16(vmovl_u8(vld1_u8(covers)), scale);
+		uint8x8x4_t d = vld4_u8(dst);
+		blend_covered_neon(d, s, alpha, opaque16);
+		vst4_u8(dst, d);
+	}
+
+	blend_covers_generic(dst, count, color, scale, opaque, covers);
+}
+
+
+static void
+blend_colors_neon(uint8* dst, uint32 count, const uint8* colors,
+	const uint8* covers)
+{
+	uint16x8_t opaque16 = vdupq_n_u16(255 * 255);
+
+	for (; count >= 8; count -= 8, dst += 32, colors += 32, covers += 8) {
+		uint64 coverBits;
+		memcpy(&coverBits, covers, 8);
+		if (coverBits == 0)
+			continue;
+
+		uint8x8x4_t c = vld4_u8(colors);
+		uint8x8_t s[3] = { c.val[2], c.val[1], c.val[0] };
+		uint16x8_t alpha = vmull_u8(c.val[3], vld1_u8(covers));
+		uint8x8x4_t d = vld4_u8(dst);
+		blend_covered_neon(d, s, alpha, opaque16);
+		vst4_u8(dst, d);
+	}
+
+	blend_colors_generic(dst, count, colors, covers);
+}
+
+
+static const SpanBlender kNEONBlender = {
+	"neon",
+	fill_neon,
+	blend_neon,
+	blend_covers_neon,
+	blend_colors_neon
+};
+
+#endif	// SPAN_BLENDER_NEON
+
+
+// #pragma mark - SpanBlender
+
+
+struct implementation_info {
+	const SpanBlender*	blender;
+	bool				(*supported)();
+};
+
+static const implementation_info kImplementations[] = {
+	{ &kGenericBlender, NULL },
+#if SPAN_BLENDER_X86
+	{ &kSSE2Blender, sse2_supported },
+	{ &kAVX2Blender, avx2_supported },
+#endif
+#if SPAN_BLENDER_NEON
+	{ &kNEONBlender, NULL },
+#endif
+};
+
+static const int32 kImplementationCount
+	= sizeof(kImplementations) / sizeof(kImplementations[0]);
+
+
+/*static*/ const SpanBlender*
+SpanBlender::Default()
+{
+	static const SpanBlender* sDefault = NULL;
+
+	// racing threads would all pick the same implementation
+	if (sDefault == NULL) {
+		const SpanBlender* blender = NULL;
+		for (int32 i = 0; ImplementationAt(i) != NULL; i++)
+			blender = ImplementationAt(i);
+		sDefault = blender;
+	}
+
+	return sDefault;
+}
+
+
+/*static*/ const SpanBlender*
+SpanBlender::ImplementationAt(int32 index)
+{
+	for (int32 i = 0; i < kImplementationCount; i++) {
+		const implementation_info& info = kImplementations[i];
+		if (info.supported != NULL && !info.supported())
+			continue;
+		if (index-- == 0)
+			return info.blender;
+	}
+
+	return NULL;
+}
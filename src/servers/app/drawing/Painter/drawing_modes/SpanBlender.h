@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Span functions shared by the drawing modes, with scalar and SIMD
+ * implementations that are selected at runtime.
+ *
+ */
+
+#ifndef SPAN_BLENDER_H
+#define SPAN_BLENDER_H
+
+#include <SupportDefs.h>
+
+// All functions operate on B_RGBA32 spans (BGRA byte order). Colors are
+// passed as a B_RGBA32 pixel value, see span_color().
+//
+// The results are bit identical to the BLEND (with alpha << 8) and BLEND16
+// macros in DrawingMode.h, in all implementations: a blended channel becomes
+//
+//	d + (((s - d) * alpha) >> 16)
+//
+// with alpha in range 0..65535, and the alpha channel of every written pixel
+// becomes 255.
+struct SpanBlender {
+	typedef void (*fill_func)(uint8* dst, uint32 count, uint32 color);
+	typedef void (*blend_func)(uint8* dst, uint32 count, uint32 color,
+		uint16 alpha);
+	typedef void (*blend_covers_func)(uint8* dst, uint32 count, uint32 color,
+		uint16 scale, uint16 opaque, const uint8* covers);
+	typedef void (*blend_colors_func)(uint8* dst, uint32 count,
+		const uint8* colors, const uint8* covers);
+
+	const char*			name;
+
+	// sets count pixels to color
+	fill_func			Fill;
+
+	// blends color with a constant alpha onto count pixels
+	blend_func			Blend;
+
+	// blends color with alpha = covers[i] * scale onto each pixel; pixels
+	// with an alpha of 0 are left untouched, and those with an alpha equal
+	// to opaque are set to the color
+	blend_covers_func	BlendCovers;
+
+	// blends agg::rgba8 colors (RGBA byte order) with
+	// alpha = colors[i].a * covers[i] onto each pixel, like BlendCovers()
+	// with an opaque value of 255 * 255
+	blend_colors_func	BlendColors;
+
+	static	const SpanBlender*	Default();
+									// the fastest one for this CPU
+	static	const SpanBlender*	ImplementationAt(int32 index);
+									// all implementations usable on this
+									// CPU, the generic one first
+};
+
+
+static inline uint32
+span_color(uint8 r, uint8 g, uint8 b)
+{
+	uint32 color;
+	uint8* p = (uint8*)&color;
+	p[0] = b;
+	p[1] = g;
+	p[2] = r;
+	p[3] = 255;
+	return color;
+}
+
+
+#endif // SPAN_BLENDER_H
@@ -1,5 +1,6 @@
 /*
  * Copyright 2009-2010, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -13,6 +14,7 @@
 #include "DrawState.h"
 #include "ServerTokenSpace.h"
 
+#include <Autolock.h>
 #include <Bitmap.h>
 #include <utf8_functions.h>
 
@@ -362,25 +364,44 @@ RemoteDrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& _bitmapRect,
 			return;
 		}
 
-		RemoteMessage message(NULL, fHWInterface->SendBuffer());
-		message.Start(RP_DRAW_BITMAP_RECTS);
-		message.Add(fToken);
-		message.Add(options);
-		message.Add(bitmap->ColorSpace());
-		message.Add(bitmap->Flags());
-		message.Add(rectCount);
-
+		// the rects don't overlap, so the ones that can go as tiles may be
+		// drawn first
+		int32 remainingCount = 0;
 		for (int32 i = 0; i < rectCount; i++) {
-			message.Add(clippedRegion.RectAt(i));
-			message.AddBitmap(*bitmaps[i], true);
-			delete bitmaps[i];
+			if (_DrawBitmapTiles(*bitmaps[i], bitmaps[i]->Bounds(),
+					clippedRegion.RectAt(i), options)) {
+				delete bitmaps[i];
+				bitmaps[i] = NULL;
+			} else
+				remainingCount++;
+		}
+
+		if (remainingCount > 0) {
+			RemoteMessage message(NULL, fHWInterface->SendBuffer());
+			message.Start(RP_DRAW_BITMAP_RECTS);
+			message.Add(fToken);
+			message.Add(options);
+			message.Add(bitmap->ColorSpace());
+			message.Add(bitmap->Flags());
+			message.Add(remainingCount);
+
+			for (int32 i = 0; i < rectCount; i++) {
+				if (bitmaps[i] == NULL)
+					continue;
+
+				message.Add(clippedRegion.RectAt(i));
+				message.AddBitmap(*bitmaps[i], true);
+				delete bitmaps[i];
+			}
 		}
 
 		free(bitmaps);
 		return;
 	}
 
-	// TODO: we may want to cache/checksum bitmaps
+	if (_DrawBitmapTiles(*bitmap, bitmapRect, viewRect, options))
+		return;
+
 	RemoteMessage message(NULL, fHWInterface->SendBuffer());
 	message.Start(RP_DRAW_BITMAP);
 	message.Add(fToken);
@@ -1188,3 +1209,33 @@ RemoteDrawingEngine::_ExtractBitmapRegions(ServerBitmap& bitmap, uint32 options,
 
 	return B_OK;
 }
+
+
+/*!	Sends the bitmap in tiles, if the client supports them, and returns
+	whether it did.
+*/
+bool
+RemoteDrawingEngine::_DrawBitmapTiles(const ServerBitmap& bitmap,
+	const BRect& bitmapRect, const BRect& viewRect, uint32 options)
+{
+	TileEncoder& encoder = fHWInterface->GetTileEncoder();
+	BAutolock _(encoder);
+
+	if (!encoder.IsEnabled() || !TileEncoder::CanEncode(bitmap.ColorSpace(),
+			bitmap.Width(), bitmap.Height())) {
+		return false;
+	}
+
+	RemoteMessage message(NULL, fHWInterface->SendBuffer());
+	message.Start(RP_DRAW_BITMAP_TILES);
+	message.Add(fToken);
+	message.Add(bitmapRect);
+	message.Add(viewRect);
+	message.Add(options);
+	encoder.AddBitmap(message, bitmap.Bits(), bitmap.Width(), bitmap.Height(),
+		bitmap.BytesPerRow(), bitmap.ColorSpace(), bitmap.Flags());
+
+	// the client has to see the tiles in the order their slots were assigned
+	message.Flush();
+	return true;
+}
@@ -1,5 +1,6 @@
 /*
  * Copyright 2009, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -163,6 +164,9 @@ private:
 									const BRect& viewRect, double xScale,
 									double yScale, BRegion& region,
 									UtilityBitmap**& bitmaps);
+			bool				_DrawBitmapTiles(const ServerBitmap& bitmap,
+									const BRect& bitmapRect,
+									const BRect& viewRect, uint32 options);
 
 			RemoteHWInterface*	fHWInterface;
 			int32				fToken;
@@ -1,5 +1,6 @@
 /*
  * Copyright 2009, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -279,6 +280,14 @@ RemoteHWInterface::_EventThread()
 				break;
 			}
 
+			case RP_ENABLE_TILE_ENCODING:
+			{
+				// the client starts out with an empty tile cache
+				BAutolock _(fTileEncoder);
+				fTileEncoder.SetEnabled(true);
+				break;
+			}
+
 			case RP_GET_SYSTEM_PALETTE:
 			{
 				RemoteMessage reply(NULL, fSendBuffer.Get());
@@ -330,6 +339,12 @@ RemoteHWInterface::_NewConnection(BNetEndpoint &endpoint)
 
 	fSendBuffer->MakeEmpty();
 
+	{
+		// until the new client asks for them, there are no tiles
+		BAutolock _(fTileEncoder);
+		fTileEncoder.SetEnabled(false);
+	}
+
 	BNetEndpoint *sendEndpoint = new(std::nothrow) BNetEndpoint(endpoint);
 	if (sendEndpoint == NULL)
 		return B_NO_MEMORY;
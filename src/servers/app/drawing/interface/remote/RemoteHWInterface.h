@@ -1,5 +1,6 @@
 /*
  * Copyright 2009, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -9,6 +10,7 @@
 #define REMOTE_HW_INTERFACE_H
 
 #include "HWInterface.h"
+#include "TileCodec.h"
 
 #include <AutoDeleter.h>
 #include <Locker.h>
@@ -84,6 +86,7 @@ virtual	status_t					CopyBackToFront(const BRect& frame);
 		StreamingRingBuffer*		ReceiveBuffer()
 										{ return fReceiveBuffer.Get(); }
 		StreamingRingBuffer*		SendBuffer() { return fSendBuffer.Get(); }
+		TileEncoder&				GetTileEncoder() { return fTileEncoder; }
 
 typedef bool (*CallbackFunction)(void* cookie, RemoteMessage& message);
 
@@ -123,6 +126,7 @@ static	status_t					_NewConnectionCallback(void *cookie,
 									fSendBuffer;
 		ObjectDeleter<StreamingRingBuffer>
 									fReceiveBuffer;
+		TileEncoder					fTileEncoder;
 
 		ObjectDeleter<NetSender>	fSender;
 		ObjectDeleter<NetReceiver>	fReceiver;
@@ -1,5 +1,6 @@
 /*
  * Copyright 2009, Haiku, Inc.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -41,6 +42,7 @@ enum {
 	RP_CLOSE_CONNECTION,
 	RP_GET_SYSTEM_PALETTE,
 	RP_GET_SYSTEM_PALETTE_RESULT,
+	RP_ENABLE_TILE_ENCODING,
 
 	RP_CREATE_STATE = 20,
 	RP_DELETE_STATE,
@@ -65,6 +67,7 @@ enum {
 	RP_INVERT_RECT,
 	RP_DRAW_BITMAP,
 	RP_DRAW_BITMAP_RECTS,
+	RP_DRAW_BITMAP_TILES,
 
 	RP_STROKE_ARC = 80,
 	RP_STROKE_BEZIER,
@@ -146,6 +149,7 @@ public:
 		template<typename T>
 		void					Add(const T& value);
 
+		void					AddData(const void* data, size_t size);
 		void					AddString(const char* string, size_t length);
 		void					AddRegion(const BRegion& region);
 		void					AddGradient(const BGradient& gradient);
@@ -169,6 +173,7 @@ public:
 		template<typename T>
 		status_t				Read(T& value);
 
+		status_t				ReadData(void* data, size_t size);
 		status_t				ReadRegion(BRegion& region);
 		status_t				ReadFontState(BFont& font);
 									// sets font state
@@ -266,6 +271,18 @@ RemoteMessage::Add(const T& value)
 }
 
 
+inline void
+RemoteMessage::AddData(const void* data, size_t size)
+{
+	if (!_MakeSpace(size))
+		return;
+
+	memcpy(fBuffer + fWriteIndex, data, size);
+	fWriteIndex += size;
+	fAvailable -= size;
+}
+
+
 inline void
 RemoteMessage::AddString(const char* string, size_t length)
 {
@@ -321,6 +338,27 @@ RemoteMessage::Read(T& value)
 }
 
 
+inline status_t
+RemoteMessage::ReadData(void* data, size_t size)
+{
+	if (fDataLeft < size)
+		return B_ERROR;
+
+	if (fSource == NULL)
+		return B_NO_INIT;
+
+	int32 readSize = fSource->Read(data, size);
+	if (readSize < 0)
+		return readSize;
+
+	if ((size_t)readSize != size)
+		return B_ERROR;
+
+	fDataLeft -= size;
+	return B_OK;
+}
+
+
 inline status_t
 RemoteMessage::ReadRegion(BRegion& region)
 {
@@ -0,0 +1,597 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "TileCodec.h"
+
+#include "RemoteMessage.h"
+
+#include <Bitmap.h>
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+
+// Bitmaps smaller than this are not worth the overhead of the tiles.
+static const int32 kMinEncodedPixels = kTileSize * kTileSize;
+static const int32 kMaxBitmapSize = 16384;
+
+// Compressed tiles use these operations, as in QOI; each pixel is handled as
+// four bytes, no matter in what order the color space stores the channels.
+enum {
+	OP_INDEX	= 0x00,
+	OP_DIFF		= 0x40,
+	OP_LUMA		= 0x80,
+	OP_RUN		= 0xc0,
+	OP_RGB		= 0xfe,
+	OP_RGBA		= 0xff,
+
+	OP_MASK		= 0xc0
+};
+
+static const int32 kMaxRun = 62;
+static const size_t kMaxCompressedSize = kTileSize * kTileSize * 5;
+
+
+union pixel {
+	uint8	c[4];
+	uint32	value;
+};
+
+
+static inline uint32
+pixel_index(const pixel& pixel)
+{
+	return (pixel.c[0] * 3 + pixel.c[1] * 5 + pixel.c[2] * 7
+		+ pixel.c[3] * 11) % 64;
+}
+
+
+/*!	Compresses the tile at \a bits into \a buffer, which must be able to
+	hold kMaxCompressedSize bytes, and returns the size of the result.
+	The channels are numbered in memory order; c[1] is green in all 32 bit
+	color spaces, which is what the luma operation is based on.
+*/
+static size_t
+compress_tile(const uint8* bits, int32 bytesPerRow, int32 width,
+	int32 height, uint8* buffer)
+{
+	pixel index[64];
+	memset(index, 0, sizeof(index));
+
+	pixel previous;
+	previous.value = 0;
+	previous.c[3] = 255;
+
+	uint8* out = buffer;
+	int32 run = 0;
+
+	for (int32 y = 0; y < height; y++) {
+		const uint8* row = bits + y * bytesPerRow;
+		for (int32 x = 0; x < width; x++) {
+			pixel current;
+			memcpy(&current, row + x * 4, 4);
+
+			if (current.value == previous.value) {
+				if (++run == kMaxRun) {
+					*out++ = OP_RUN | (run - 1);
+					run = 0;
+				}
+				continue;
+			}
+
+			if (run > 0) {
+				*out++ = OP_RUN | (run - 1);
+				run = 0;
+			}
+
+			uint32 hash = pixel_index(current);
+			if (index[hash].value == current.value) {
+				*out++ = OP_INDEX | hash;
+			} else {
+				index[hash] = current;
+
+				if (current.c[3] == previous.c[3]) {
+					int8 d0 = current.c[0] - previous.c[0];
+					int8 d1 = current.c[1] - previous.c[1];
+					int8 d2 = current.c[2] - previous.c[2];
+					int8 d01 = d0 - d1;
+					int8 d21 = d2 - d1;
+
+					if (d0 >= -2 && d0 <= 1 && d1 >= -2 && d1 <= 1
+						&& d2 >= -2 && d2 <= 1) {
+						*out++ = OP_DIFF | (d2 + 2) << 4 | (d1 + 2) << 2
+							| (d0 + 2);
+					} else if (d01 >= -8 && d01 <= 7 && d1 >= -32 && d1 <= 31
+						&& d21 >= -8 && d21 <= 7) {
+						*out++ = OP_LUMA | (d1 + 32);
+						*out++ = (d21 + 8) << 4 | (d01 + 8);
+					} else {
+						*out++ = OP_RGB;
+						*out++ = current.c[0];
+						*out++ = current.c[1];
+						*out++ = current.c[2];
+					}
+				} else {
+					*out++ = OP_RGBA;
+					memcpy(out, current.c, 4);
+					out += 4;
+				}
+			}
+
+			previous = current;
+		}
+	}
+
+	if (run > 0)
+		*out++ = OP_RUN | (run - 1);
+
+	return out - buffer;
+}
+
+
+static status_t
+decompress_tile(const uint8* data, size_t size, uint8* bits, int32 pixelCount)
+{
+	pixel index[64];
+	memset(index, 0, sizeof(index));
+
+	pixel current;
+	current.value = 0;
+	current.c[3] = 255;
+
+	const uint8* end = data + size;
+	uint32* out = (uint32*)bits;
+	int32 run = 0;
+
+	for (int32 i = 0; i < pixelCount; i++) {
+		if (run > 0) {
+			run--;
+			out[i] = current.value;
+			continue;
+		}
+
+		if (data >= end)
+			return B_BAD_DATA;
+
+		uint8 op = *data++;
+		if (op == OP_RGB) {
+			if (end - data < 3)
+				return B_BAD_DATA;
+			current.c[0] = data[0];
+			current.c[1] = data[1];
+			current.c[2] = data[2];
+			data += 3;
+		} else if (op == OP_RGBA) {
+			if (end - data < 4)
+				return B_BAD_DATA;
+			memcpy(current.c, data, 4);
+			data += 4;
+		} else if ((op & OP_MASK) == OP_INDEX) {
+			current = index[op];
+		} else if ((op & OP_MASK) == OP_DIFF) {
+			current.c[0] += (op & 0x03) - 2;
+			current.c[1] += ((op >> 2) & 0x03) - 2;
+			current.c[2] += ((op >> 4) & 0x03) - 2;
+		} else if ((op & OP_MASK) == OP_LUMA) {
+			if (data >= end)
+				return B_BAD_DATA;
+			int32 d1 = (op & 0x3f) - 32;
+			uint8 next = *data++;
+			current.c[0] += d1 - 8 + (next & 0x0f);
+			current.c[1] += d1;
+			current.c[2] += d1 - 8 + (next >> 4);
+		} else {
+			// OP_RUN, this pixel is the first of it
+			run = op & 0x3f;
+		}
+
+		index[pixel_index(current)] = current;
+		out[i] = current.value;
+	}
+
+	return data == end && run == 0 ? B_OK : B_BAD_DATA;
+}
+
+
+static inline uint64
+hash_tile(const uint8* bits, int32 bytesPerRow, int32 width, int32 height)
+{
+	// FNV-1a over whole pixels
+	uint64 hash = 0xcbf29ce484222325ULL ^ ((uint64)width << 32 | height);
+	for (int32 y = 0; y < height; y++) {
+		const uint8* row = bits + y * bytesPerRow;
+		for (int32 x = 0; x < width; x++) {
+			uint32 value;
+			memcpy(&value, row + x * 4, 4);
+			hash = (hash ^ value) * 0x100000001b3ULL;
+		}
+	}
+
+	return hash;
+}
+
+
+// #pragma mark - TileEncoder
+
+
+struct TileEncoder::Slot : DoublyLinkedListLinkImpl<Slot> {
+	Slot*		hashLink;
+	uint64		hash;
+	uint16		index;
+	bool		used;
+};
+
+
+struct TileEncoder::SlotHashDefinition {
+	typedef uint64	KeyType;
+	typedef	Slot	ValueType;
+
+	size_t HashKey(uint64 key) const
+	{
+		return (size_t)(key ^ (key >> 32));
+	}
+
+	size_t Hash(Slot* value) const
+	{
+		return HashKey(value->hash);
+	}
+
+	bool Compare(uint64 key, Slot* value) const
+	{
+		return value->hash == key;
+	}
+
+	Slot*& GetLink(Slot* value) const
+	{
+		return value->hashLink;
+	}
+};
+
+
+TileEncoder::TileEncoder()
+	:
+	BLocker("tile encoder"),
+	fEnabled(false),
+	fSlots(new(std::nothrow) Slot[kTileCacheSlots]),
+	fSlotTable(new(std::nothrow) SlotTable),
+	fBuffer((uint8*)malloc(kMaxCompressedSize))
+{
+	memset(&fStatistics, 0, sizeof(fStatistics));
+
+	if (fSlotTable != NULL && fSlotTable->Init(kTileCacheSlots) != B_OK) {
+		delete fSlotTable;
+		fSlotTable = NULL;
+	}
+
+	if (fSlots != NULL) {
+		for (int32 i = 0; i < kTileCacheSlots; i++) {
+			fSlots[i].index = i;
+			fSlots[i].used = false;
+			fUsage.Add(&fSlots[i]);
+		}
+	}
+}
+
+
+TileEncoder::~TileEncoder()
+{
+	delete fSlotTable;
+	delete[] fSlots;
+	free(fBuffer);
+}
+
+
+/*!	Enabling the encoder always starts with an empty cache, as that is what
+	a new receiver has. The encoder must be locked.
+*/
+void
+TileEncoder::SetEnabled(bool enabled)
+{
+	_Reset();
+	fEnabled = enabled && fSlots != NULL && fSlotTable != NULL
+		&& fBuffer != NULL;
+}
+
+
+/*static*/ bool
+TileEncoder::CanEncode(color_space colorSpace, int32 width, int32 height)
+{
+	switch (colorSpace) {
+		case B_RGB32:
+		case B_RGBA32:
+		case B_RGB32_BIG:
+		case B_RGBA32_BIG:
+			break;
+
+		default:
+			return false;
+	}
+
+	return width > 0 && height > 0 && width <= kMaxBitmapSize
+		&& height <= kMaxBitmapSize && width * height >= kMinEncodedPixels;
+}
+
+
+/*!	Adds the bitmap to the message. The encoder must be locked until the
+	message has been flushed, so that the receiver learns about the slots
+	in the same order they were assigned in.
+*/
+void
+TileEncoder::AddBitmap(RemoteMessage& message, const uint8* bits,
+	int32 width, int32 height, int32 bytesPerRow, color_space colorSpace,
+	uint32 flags)
+{
+	bigtime_t startTime = system_time();
+
+	message.Add(width);
+	message.Add(height);
+	message.Add(colorSpace);
+	message.Add(flags);
+
+	for (int32 y = 0; y < height; y += kTileSize) {
+		int32 tileHeight = min_c(kTileSize, height - y);
+		for (int32 x = 0; x < width; x += kTileSize) {
+			_AddTile(message, bits + y * bytesPerRow + x * 4, bytesPerRow,
+				min_c(kTileSize, width - x), tileHeight);
+		}
+	}
+
+	fStatistics.bitmaps++;
+	fStatistics.rawBytes += (uint64)width * height * 4;
+	fStatistics.encodeTime += system_time() - startTime;
+}
+
+
+void
+TileEncoder::GetStatistics(tile_statistics& statistics)
+{
+	statistics = fStatistics;
+}
+
+
+void
+TileEncoder::_Reset()
+{
+	if (fSlotTable != NULL)
+		fSlotTable->Clear();
+
+	if (fSlots != NULL) {
+		for (int32 i = 0; i < kTileCacheSlots; i++)
+			fSlots[i].used = false;
+	}
+}
+
+
+void
+TileEncoder::_AddTile(RemoteMessage& message, const uint8* bits,
+	int32 bytesPerRow, int32 width, int32 height)
+{
+	uint64 hash = hash_tile(bits, bytesPerRow, width, height);
+
+	Slot* slot = fSlotTable->Lookup(hash);
+	if (slot != NULL) {
+		// the receiver still has this one
+		fUsage.Remove(slot);
+		fUsage.Add(slot, false);
+
+		message.Add((uint8)TILE_CACHED);
+		message.Add(slot->index);
+		fStatistics.cachedTiles++;
+		fStatistics.encodedBytes += sizeof(uint8) + sizeof(uint16);
+		return;
+	}
+
+	// replace the least recently used tile
+	slot = fUsage.RemoveTail();
+	if (slot->used)
+		fSlotTable->RemoveUnchecked(slot);
+
+	slot->hash = hash;
+	slot->used = true;
+	fSlotTable->InsertUnchecked(slot);
+	fUsage.Add(slot, false);
+
+	size_t rawSize = width * height * 4;
+	size_t size = compress_tile(bits, bytesPerRow, width, height, fBuffer);
+	if (size < rawSize) {
+		message.Add((uint8)TILE_COMPRESSED);
+		message.Add(slot->index);
+		message.Add((uint32)size);
+		message.AddData(fBuffer, size);
+		fStatistics.compressedTiles++;
+		fStatistics.encodedBytes += sizeof(uint8) + sizeof(uint16)
+			+ sizeof(uint32) + size;
+		return;
+	}
+
+	message.Add((uint8)TILE_RAW);
+	message.Add(slot->index);
+	for (int32 y = 0; y < height; y++)
+		message.AddData(bits + y * bytesPerRow, width * 4);
+	fStatistics.rawTiles++;
+	fStatistics.encodedBytes += sizeof(uint8) + sizeof(uint16) + rawSize;
+}
+
+
+// #pragma mark - TileDecoder
+
+
+struct TileDecoder::Slot {
+	uint8*		bits;
+	int32		width;
+	int32		height;
+};
+
+
+TileDecoder::TileDecoder()
+	:
+	fSlots(new(std::nothrow) Slot[kTileCacheSlots]),
+	fBuffer(NULL),
+	fBufferSize(0)
+{
+	if (fSlots != NULL)
+		memset(fSlots, 0, sizeof(Slot) * kTileCacheSlots);
+}
+
+
+TileDecoder::~TileDecoder()
+{
+	Reset();
+	delete[] fSlots;
+	free(fBuffer);
+}
+
+
+void
+TileDecoder::Reset()
+{
+	if (fSlots == NULL)
+		return;
+
+	for (int32 i = 0; i < kTileCacheSlots; i++) {
+		free(fSlots[i].bits);
+		fSlots[i].bits = NULL;
+		fSlots[i].width = fSlots[i].height = 0;
+	}
+}
+
+
+/*!	Reads all tiles of a bitmap into the tile cache, and composes them into
+	a new bitmap. The tiles are always decoded, even if the bitmap cannot be
+	created, so that the cache stays in sync with the encoder. If decoding
+	fails, the cache no longer matches the encoder's; the caller has to
+	Reset() the decoder, and ask the encoder to start over.
+*/
+status_t
+TileDecoder::ReadBitmap(RemoteMessage& message, BBitmap** _bitmap)
+{
+	int32 width, height;
+	color_space colorSpace;
+	uint32 flags;
+
+	message.Read(width);
+	message.Read(height);
+	message.Read(colorSpace);
+	status_t result = message.Read(flags);
+	if (result != B_OK)
+		return result;
+
+	if (fSlots == NULL)
+		return B_NO_MEMORY;
+	if (!TileEncoder::CanEncode(colorSpace, width, height))
+		return B_BAD_DATA;
+
+#ifndef CLIENT_COMPILE
+	flags = B_BITMAP_NO_SERVER_LINK;
+#endif
+
+	// the encoder may reuse slots within a bitmap, so every tile has to be
+	// copied out of its slot before the next one is read
+	BBitmap* bitmap = new(std::nothrow) BBitmap(
+		BRect(0, 0, width - 1, height - 1), flags, colorSpace);
+	status_t bitmapResult = bitmap != NULL ? bitmap->InitCheck() : B_NO_MEMORY;
+	if (bitmapResult != B_OK) {
+		delete bitmap;
+		bitmap = NULL;
+	}
+
+	uint8* bits = bitmap != NULL ? (uint8*)bitmap->Bits() : NULL;
+	int32 bytesPerRow = bitmap != NULL ? bitmap->BytesPerRow() : 0;
+
+	for (int32 y = 0; y < height; y += kTileSize) {
+		int32 tileHeight = min_c(kTileSize, height - y);
+		for (int32 x = 0; x < width; x += kTileSize) {
+			int32 tileWidth = min_c(kTileSize, width - x);
+
+			Slot* slot;
+			result = _ReadTile(message, tileWidth, tileHeight, slot);
+			if (result != B_OK) {
+				delete bitmap;
+				return result;
+			}
+
+			if (bitmap == NULL)
+				continue;
+
+			for (int32 row = 0; row < tileHeight; row++) {
+				memcpy(bits + (y + row) * bytesPerRow + x * 4,
+					slot->bits + row * tileWidth * 4, tileWidth * 4);
+			}
+		}
+	}
+
+	if (bitmap == NULL)
+		return bitmapResult;
+
+	*_bitmap = bitmap;
+	return B_OK;
+}
+
+
+status_t
+TileDecoder::_ReadTile(RemoteMessage& message, int32 width, int32 height,
+	Slot*& _slot)
+{
+	uint8 type;
+	uint16 index;
+	message.Read(type);
+	status_t result = message.Read(index);
+	if (result != B_OK)
+		return result;
+
+	if (index >= kTileCacheSlots)
+		return B_BAD_DATA;
+
+	Slot& slot = fSlots[index];
+	_slot = &slot;
+
+	if (type == TILE_CACHED) {
+		if (slot.bits == NULL || slot.width != width || slot.height != height)
+			return B_BAD_DATA;
+		return B_OK;
+	}
+
+	if (slot.bits == NULL) {
+		slot.bits = (uint8*)malloc(kTileSize * kTileSize * 4);
+		if (slot.bits == NULL)
+			return B_NO_MEMORY;
+	}
+
+	// the slot is only valid again once the tile has been read completely
+	slot.width = slot.height = 0;
+
+	size_t rawSize = width * height * 4;
+	if (type == TILE_RAW) {
+		result = message.ReadData(slot.bits, rawSize);
+	} else if (type == TILE_COMPRESSED) {
+		uint32 size;
+		result = message.Read(size);
+		if (result == B_OK && (size > kMaxCompressedSize || size == 0))
+			result = B_BAD_DATA;
+
+		if (result == B_OK && size > fBufferSize) {
+			uint8* buffer = (uint8*)realloc(fBuffer, kMaxCompressedSize);
+			if (buffer == NULL)
+				return B_NO_MEMORY;
+			fBuffer = buffer;
+			fBufferSize = kMaxCompressedSize;
+		}
+
+		if (result == B_OK)
+			result = message.ReadData(fBuffer, size);
+		if (result == B_OK)
+			result = decompress_tile(fBuffer, size, slot.bits, width * height);
+	} else
+		result = B_BAD_DATA;
+
+	if (result != B_OK)
+		return result;
+
+	slot.width = width;
+	slot.height = height;
+	return B_OK;
+}
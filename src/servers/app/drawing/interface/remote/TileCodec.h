@@ -0,0 +1,117 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef TILE_CODEC_H
+#define TILE_CODEC_H
+
+
+#include <GraphicsDefs.h>
+#include <Locker.h>
+#include <OS.h>
+#include <util/DoublyLinkedList.h>
+#include <util/OpenHashTable.h>
+
+
+class BBitmap;
+class RemoteMessage;
+
+
+/*!	Bitmaps are sent in tiles of kTileSize x kTileSize pixels. The receiver
+	keeps the last kTileCacheSlots tiles it got, so that a tile that did not
+	change since it was sent last time is only referenced by its slot.
+	The sender decides which slot a new tile goes to, the receiver just
+	follows.
+
+	New tiles are compressed with a QOI like scheme, or sent as they are if
+	that does not make them any smaller.
+*/
+static const int32 kTileSize = 64;
+static const int32 kTileCacheSlots = 512;
+
+enum {
+	TILE_CACHED = 0,
+	TILE_RAW,
+	TILE_COMPRESSED
+};
+
+
+struct tile_statistics {
+	uint64		bitmaps;
+	uint64		cachedTiles;
+	uint64		rawTiles;
+	uint64		compressedTiles;
+	uint64		rawBytes;
+		// the size of the bitmaps
+	uint64		encodedBytes;
+		// what was actually added to the messages
+	bigtime_t	encodeTime;
+};
+
+
+class TileEncoder : public BLocker {
+public:
+								TileEncoder();
+								~TileEncoder();
+
+			void				SetEnabled(bool enabled);
+			bool				IsEnabled() const
+									{ return fEnabled; }
+
+	static	bool				CanEncode(color_space colorSpace,
+									int32 width, int32 height);
+
+			void				AddBitmap(RemoteMessage& message,
+									const uint8* bits, int32 width,
+									int32 height, int32 bytesPerRow,
+									color_space colorSpace, uint32 flags);
+
+			void				GetStatistics(tile_statistics& statistics);
+
+private:
+			struct Slot;
+			struct SlotHashDefinition;
+
+			typedef BOpenHashTable<SlotHashDefinition> SlotTable;
+			typedef DoublyLinkedList<Slot> SlotList;
+
+			void				_Reset();
+			void				_AddTile(RemoteMessage& message,
+									const uint8* bits, int32 bytesPerRow,
+									int32 width, int32 height);
+
+private:
+			bool				fEnabled;
+			Slot*				fSlots;
+			SlotTable*			fSlotTable;
+			SlotList			fUsage;
+									// most recently used slot first
+			uint8*				fBuffer;
+			tile_statistics		fStatistics;
+};
+
+
+class TileDecoder {
+public:
+								TileDecoder();
+								~TileDecoder();
+
+			void				Reset();
+
+			status_t			ReadBitmap(RemoteMessage& message,
+									BBitmap** _bitmap);
+
+private:
+			struct Slot;
+
+			status_t			_ReadTile(RemoteMessage& message,
+									int32 width, int32 height, Slot*& _slot);
+
+private:
+			Slot*				fSlots;
+			uint8*				fBuffer;
+			size_t				fBufferSize;
+};
+
+
+#endif	// TILE_CODEC_H
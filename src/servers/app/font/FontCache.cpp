@@ -1,5 +1,6 @@
 /*
  * Copyright 2007, Haiku. All rights reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -12,6 +13,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <Autolock.h>
 #include <Entry.h>
 #include <Path.h>
 
@@ -24,12 +26,22 @@ using std::nothrow;
 FontCache
 FontCache::sDefaultInstance;
 
+// The memory used by the glyphs of all cached fonts is kept below this.
+static const int64 kMaxMemoryUsage = 8 * 1024 * 1024;
+// Each entry also keeps the font file open.
+static const int32 kMaxEntryCount = 128;
+
 // #pragma mark -
 
 // constructor
 FontCache::FontCache()
 	: MultiLocker("FontCache lock")
 	, fFontCacheEntries()
+	, fUsageList()
+	, fUsageLock("FontCache usage lock")
+	, fHits(0)
+	, fMisses(0)
+	, fEvictions(0)
 {
 }
 
@@ -61,6 +73,8 @@ FontCache::FontCacheEntryFor(const ServerFont& font, bool forceVector)
 	if (entry) {
 		// the entry was already there
 //printf("FontCacheEntryFor(%ld): %p\n", font.GetFamilyAndStyle(), entry);
+		atomic_add64(&fHits, 1);
+		_MarkUsed(entry);
 		return entry.Detach();
 	}
 
@@ -79,15 +93,24 @@ FontCache::FontCacheEntryFor(const ServerFont& font, bool forceVector)
 	entry = fFontCacheEntries.Get(signature);
 
 	if (!entry) {
-		// remove old entries, keep entries below certain count
-		_ConstrainEntryCount();
+		atomic_add64(&fMisses, 1);
+
+		// remove the least recently used entries to make room
+		_ConstrainMemoryUsage(1);
 		entry.SetTo(new (nothrow) FontCacheEntry(), true);
 		if (!entry || !entry->Init(font, forceVector)
+			|| !entry->fSignature.SetTo(signature)
 			|| fFontCacheEntries.Put(signature, entry) < B_OK) {
 			fprintf(stderr, "FontCache::FontCacheEntryFor() - "
 				"out of memory or no font file\n");
 			return NULL;
 		}
+
+		// we are the only ones accessing the list right now
+		fUsageList.Add(entry, false);
+	} else {
+		atomic_add64(&fHits, 1);
+		_MarkUsed(entry);
 	}
 //printf("FontCacheEntryFor(%ld): %p (insert)\n", font.GetFamilyAndStyle(), entry);
 
@@ -101,55 +124,95 @@ FontCache::Recycle(FontCacheEntry* entry)
 //printf("Recycle(%p)\n", entry);
 	if (!entry)
 		return;
-	entry->UpdateUsage();
 	entry->ReleaseReference();
 }
 
-static const int32 kMaxEntryCount = 30;
+// EntryGrown
+void
+FontCache::EntryGrown()
+{
+	// An entry needed another page for its glyphs. The entry is write
+	// locked by the caller, but no entry locks are ever acquired with the
+	// FontCache lock held.
+	AutoWriteLocker locker(this);
+	if (locker.IsLocked())
+		_ConstrainMemoryUsage(0);
+}
 
-static inline double
-usage_index(uint64 useCount, bigtime_t age)
+// Dump
+void
+FontCache::Dump()
 {
-	return 100.0 * useCount / age;
+	AutoReadLocker readLocker(this);
+	BAutolock usageLocker(fUsageLock);
+
+	int64 memoryUsage = 0;
+	EntryList::Iterator iterator = fUsageList.GetIterator();
+	while (FontCacheEntry* entry = iterator.Next())
+		memoryUsage += entry->MemoryUsage();
+
+	int64 hits = atomic_get64(&fHits);
+	int64 misses = atomic_get64(&fMisses);
+	int64 lookups = max_c(hits + misses, 1);
+
+	debug_printf("FontCache: %" B_PRId32 " entries, %" B_PRId64 " of %"
+		B_PRId64 " KB used\n", fFontCacheEntries.Size(), memoryUsage / 1024,
+		kMaxMemoryUsage / 1024);
+	debug_printf("  %" B_PRId64 " hits, %" B_PRId64 " misses (%" B_PRId64
+		"%% hit rate), %" B_PRId64 " evictions\n", hits, misses,
+		hits * 100 / lookups, atomic_get64(&fEvictions));
+
+	// most recently used first
+	iterator = fUsageList.GetIterator();
+	while (FontCacheEntry* entry = iterator.Next()) {
+		debug_printf("  [%s] %" B_PRId32 " glyphs, %" B_PRId64 " KB\n",
+			entry->fSignature.GetString(), entry->CountGlyphs(),
+			entry->MemoryUsage() / 1024);
+	}
 }
 
-// _ConstrainEntryCount
+// _MarkUsed
 void
-FontCache::_ConstrainEntryCount()
+FontCache::_MarkUsed(FontCacheEntry* entry)
 {
-	// this function is only ever called with the WriteLock held
-	if (fFontCacheEntries.Size() < kMaxEntryCount)
+	// this function is called with at least the ReadLock held, so that
+	// the entry is in the list
+	BAutolock _(fUsageLock);
+
+	if (fUsageList.Head() == entry)
 		return;
-//printf("FontCache::_ConstrainEntryCount()\n");
-
-	FontMap::Iterator iterator = fFontCacheEntries.GetIterator();
-
-	// NOTE: if kMaxEntryCount has a sane value, there has got to be
-	// some entries, so using the iterator like that should be ok
-	FontCacheEntry* leastUsedEntry = iterator.Next().value;
-	bigtime_t now = system_time();
-	bigtime_t age = now - leastUsedEntry->LastUsed();
-	uint64 useCount = leastUsedEntry->UsedCount();
-	double leastUsageIndex = usage_index(useCount, age);
-//printf("  leastUsageIndex: %f\n", leastUsageIndex);
-
-	while (iterator.HasNext()) {
-		FontCacheEntry* entry = iterator.Next().value;
-		age = now - entry->LastUsed();
-		useCount = entry->UsedCount();
-		double usageIndex = usage_index(useCount, age);
-//printf("  usageIndex: %f\n", usageIndex);
-		if (usageIndex < leastUsageIndex) {
-			leastUsedEntry = entry;
-			leastUsageIndex = usageIndex;
-		}
-	}
 
-	iterator = fFontCacheEntries.GetIterator();
-	while (iterator.HasNext()) {
-		if (iterator.Next().value.Get() == leastUsedEntry) {
-			fFontCacheEntries.Remove(iterator);
+	fUsageList.Remove(entry);
+	fUsageList.Add(entry, false);
+}
+
+// _ConstrainMemoryUsage
+void
+FontCache::_ConstrainMemoryUsage(int32 newEntries)
+{
+	// this function is only ever called with the WriteLock held
+
+	// The entries keep growing while they are in use, so their memory
+	// usage is summed up again whenever a new entry is about to be added,
+	// or an entry has allocated another page.
+	int64 memoryUsage = 0;
+	EntryList::Iterator iterator = fUsageList.GetIterator();
+	while (FontCacheEntry* entry = iterator.Next())
+		memoryUsage += entry->MemoryUsage();
+
+	while (FontCacheEntry* entry = fUsageList.Tail()) {
+		if (fFontCacheEntries.Size() + newEntries <= kMaxEntryCount
+			&& memoryUsage <= kMaxMemoryUsage) {
 			break;
 		}
+//printf("FontCache::_ConstrainMemoryUsage(): %s\n",
+//	entry->fSignature.GetString());
+
+		memoryUsage -= entry->MemoryUsage();
+		fUsageList.Remove(entry);
+		fEvictions++;
+
+		// this may delete the entry, if it is not in use anymore
+		fFontCacheEntries.Remove(entry->fSignature);
 	}
 }
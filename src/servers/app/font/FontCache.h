@@ -1,5 +1,6 @@
 /*
  * Copyright 2007, Haiku. All rights reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -9,6 +10,8 @@
 #ifndef FONT_CACHE_H
 #define FONT_CACHE_H
 
+#include <Locker.h>
+
 #include "FontCacheEntry.h"
 #include "HashMap.h"
 #include "HashString.h"
@@ -27,15 +30,29 @@ class FontCache : public MultiLocker {
 			FontCacheEntry*		FontCacheEntryFor(const ServerFont& font,
 									bool forceVector);
 			void				Recycle(FontCacheEntry* entry);
+			void				EntryGrown();
+
+			void				Dump();
 
  private:
-			void				_ConstrainEntryCount();
+			void				_MarkUsed(FontCacheEntry* entry);
+			void				_ConstrainMemoryUsage(int32 newEntries);
 
 	static	FontCache			sDefaultInstance;
 
 	typedef HashMap<HashString, BReference<FontCacheEntry> > FontMap;
+	typedef DoublyLinkedList<FontCacheEntry> EntryList;
 
 			FontMap				fFontCacheEntries;
+
+			EntryList			fUsageList;
+									// most recently used entry first
+			BLocker				fUsageLock;
+									// guards fUsageList for the readers
+
+			int64				fHits;
+			int64				fMisses;
+			int64				fEvictions;
 };
 
 #endif // FONT_CACHE_H
@@ -1,5 +1,6 @@
 /*
  * Copyright 2007-2009, Haiku. All rights reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -26,20 +27,23 @@
 
 #include "FontCacheEntry.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #include <new>
 
-#include <Autolock.h>
-
 #include <agg_array.h>
 #include <utf8_functions.h>
 #include <util/OpenHashTable.h>
 
+#include "FontCache.h"
 #include "GlobalSubpixelSettings.h"
 
 
-BLocker FontCacheEntry::sUsageUpdateLock("FontCacheEntry usage lock");
+// Glyphs are packed into pages of this size; larger ones get a page of
+// their own.
+static const size_t kGlyphPageSize = 16 * 1024;
+static const size_t kMaxPackedGlyphSize = kGlyphPageSize / 4;
 
 
 class FontCacheEntry::GlyphCachePool {
@@ -69,24 +73,41 @@ class FontCacheEntry::GlyphCachePool {
 			return value->hash_link;
 		}
 	};
+	struct GlyphPage {
+		GlyphPage*	next;
+		size_t		size;
+		size_t		used;
+	};
+
+	static const size_t kPageHeaderSize = (sizeof(GlyphPage) + 7) & ~7;
+
 public:
 	GlyphCachePool()
+		:
+		fPages(NULL),
+		fPageCount(0),
+		fMemoryUsage(0)
 	{
 	}
 
 	~GlyphCachePool()
 	{
-		GlyphCache* glyph = fGlyphTable.Clear(true);
-		while (glyph != NULL) {
-			GlyphCache* next = glyph->hash_link;
-			delete glyph;
-			glyph = next;
+		// the glyphs need no destruction, they just go away with the pages
+		fGlyphTable.Clear();
+
+		while (fPages != NULL) {
+			GlyphPage* next = fPages->next;
+			free(fPages);
+			fPages = next;
 		}
 	}
 
 	status_t Init()
 	{
-		return fGlyphTable.Init();
+		status_t status = fGlyphTable.Init();
+		if (status == B_OK)
+			fMemoryUsage = fGlyphTable.TableSize() * sizeof(GlyphCache*);
+		return status;
 	}
 
 	const GlyphCache* FindGlyph(uint32 glyphIndex) const
@@ -103,26 +124,86 @@ public:
 		if (glyph != NULL)
 			return NULL;
 
-		glyph = new(std::nothrow) GlyphCache(glyphIndex, dataSize, dataType,
-			bounds, advanceX, advanceY, preciseAdvanceX, preciseAdvanceY,
-			insetLeft, insetRight);
-		if (glyph == NULL || glyph->data == NULL) {
-			delete glyph;
+		// the glyph data directly follows the glyph
+		const size_t glyphSize = (sizeof(GlyphCache) + 7) & ~7;
+		uint8* buffer = _Allocate(glyphSize + dataSize);
+		if (buffer == NULL)
 			return NULL;
-		}
 
-		// TODO: The HashTable grows without bounds. We should cleanup
-		// older entries from time to time.
+		glyph = new(buffer) GlyphCache(glyphIndex, buffer + glyphSize,
+			dataSize, dataType, bounds, advanceX, advanceY, preciseAdvanceX,
+			preciseAdvanceY, insetLeft, insetRight);
+
+		// The glyphs are only freed together with the whole entry, the
+		// FontCache limits the memory used by all entries.
 
+		size_t tableSize = fGlyphTable.TableSize();
 		fGlyphTable.Insert(glyph);
+		atomic_add64(&fMemoryUsage,
+			(fGlyphTable.TableSize() - tableSize) * sizeof(GlyphCache*));
 
 		return glyph;
 	}
 
+	int32 CountGlyphs() const
+	{
+		return fGlyphTable.CountElements();
+	}
+
+	int32 CountPages() const
+	{
+		return fPageCount;
+	}
+
+	int64 MemoryUsage() const
+	{
+		return atomic_get64((int64*)&fMemoryUsage);
+	}
+
+private:
+	uint8* _Allocate(size_t size)
+	{
+		size = (size + 7) & ~7;
+
+		GlyphPage* page = fPages;
+		if (page != NULL && page->size - page->used >= size) {
+			uint8* buffer = (uint8*)page + page->used;
+			page->used += size;
+			return buffer;
+		}
+
+		size_t pageSize = kPageHeaderSize + size;
+		if (size <= kMaxPackedGlyphSize)
+			pageSize = kGlyphPageSize;
+
+		page = (GlyphPage*)malloc(pageSize);
+		if (page == NULL)
+			return NULL;
+
+		page->size = pageSize;
+		page->used = kPageHeaderSize + size;
+
+		// a page of its own is full already, keep filling the current one
+		if (pageSize != kGlyphPageSize && fPages != NULL) {
+			page->next = fPages->next;
+			fPages->next = page;
+		} else {
+			page->next = fPages;
+			fPages = page;
+		}
+
+		fPageCount++;
+		atomic_add64(&fMemoryUsage, pageSize);
+		return (uint8*)page + kPageHeaderSize;
+	}
+
 private:
 	typedef BOpenHashTable<GlyphHashTableDefinition> GlyphTable;
 
 	GlyphTable	fGlyphTable;
+	GlyphPage*	fPages;
+	int32		fPageCount;
+	int64		fMemoryUsage;
 };
 
 
@@ -133,9 +214,7 @@ FontCacheEntry::FontCacheEntry()
 	:
 	MultiLocker("FontCacheEntry lock"),
 	fGlyphCache(new(std::nothrow) GlyphCachePool()),
-	fEngine(),
-	fLastUsedTime(LONGLONG_MIN),
-	fUseCounter(0)
+	fEngine()
 {
 }
 
@@ -309,6 +388,8 @@ FontCacheEntry::CreateGlyph(uint32 glyphCode, FontCacheEntry* fallbackEntry)
 	if (glyph != NULL)
 		return glyph;
 
+	int32 pageCount = fGlyphCache->CountPages();
+
 	FontEngine* engine = &fEngine;
 	uint32 glyphIndex = engine->GlyphIndexForGlyphCode(glyphCode);
 	if (glyphIndex == 0 && fallbackEntry != NULL) {
@@ -318,30 +399,36 @@ FontCacheEntry::CreateGlyph(uint32 glyphCode, FontCacheEntry* fallbackEntry)
 		glyphIndex = engine->GlyphIndexForGlyphCode(glyphCode);
 	}
 
-	if (glyphIndex == 0) {
-		if (render_as_zero_width(glyphCode)) {
-			// cache and return a zero width glyph
-			return fGlyphCache->CacheGlyph(glyphCode, 0, glyph_data_invalid,
-				agg::rect_i(0, 0, -1, -1), 0, 0, 0, 0, 0, 0);
+	if (glyphIndex == 0 && render_as_zero_width(glyphCode)) {
+		// cache a zero width glyph
+		glyph = fGlyphCache->CacheGlyph(glyphCode, 0, glyph_data_invalid,
+			agg::rect_i(0, 0, -1, -1), 0, 0, 0, 0, 0, 0);
+	} else {
+		if (glyphIndex == 0) {
+			// reset to our engine
+			engine = &fEngine;
+			if (render_as_space(glyphCode)) {
+				// get the normal space glyph
+				glyphIndex = engine->GlyphIndexForGlyphCode(0x20 /* space */);
+			}
 		}
 
-		// reset to our engine
-		engine = &fEngine;
-		if (render_as_space(glyphCode)) {
-			// get the normal space glyph
-			glyphIndex = engine->GlyphIndexForGlyphCode(0x20 /* space */);
+		if (engine->PrepareGlyph(glyphIndex)) {
+			glyph = fGlyphCache->CacheGlyph(glyphCode,
+				engine->DataSize(), engine->DataType(), engine->Bounds(),
+				engine->AdvanceX(), engine->AdvanceY(),
+				engine->PreciseAdvanceX(), engine->PreciseAdvanceY(),
+				engine->InsetLeft(), engine->InsetRight());
+
+			if (glyph != NULL)
+				engine->WriteGlyphTo(glyph->data);
 		}
 	}
 
-	if (engine->PrepareGlyph(glyphIndex)) {
-		glyph = fGlyphCache->CacheGlyph(glyphCode,
-			engine->DataSize(), engine->DataType(), engine->Bounds(),
-			engine->AdvanceX(), engine->AdvanceY(),
-			engine->PreciseAdvanceX(), engine->PreciseAdvanceY(),
-			engine->InsetLeft(), engine->InsetRight());
-
-		if (glyph != NULL)
-			engine->WriteGlyphTo(glyph->data);
+	if (fGlyphCache->CountPages() != pageCount) {
+		// the entry has grown, the cache as a whole needs to stay within
+		// its memory budget
+		FontCache::Default()->EntryGrown();
 	}
 
 	return glyph;
@@ -405,18 +492,17 @@ FontCacheEntry::GenerateSignature(char* signature, size_t signatureSize,
 }
 
 
-void
-FontCacheEntry::UpdateUsage()
+int32
+FontCacheEntry::CountGlyphs() const
+{
+	return fGlyphCache->CountGlyphs();
+}
+
+
+int64
+FontCacheEntry::MemoryUsage() const
 {
-	// this is a static lock to prevent usage of too many semaphores,
-	// but on the other hand, it is not so nice to be using a lock
-	// here at all
-	// the hope is that the time is so short to hold this lock, that
-	// there is not much contention
-	BAutolock _(sUsageUpdateLock);
-
-	fLastUsedTime = system_time();
-	fUseCounter++;
+	return fGlyphCache->MemoryUsage();
 }
 
 
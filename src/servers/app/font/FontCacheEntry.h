@@ -1,5 +1,6 @@
 /*
  * Copyright 2007-2009, Haiku. All rights reserved.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  *
  * Authors:
@@ -33,7 +34,9 @@
 #include <agg_conv_curve.h>
 #include <agg_conv_contour.h>
 #include <agg_conv_transform.h>
+#include <util/DoublyLinkedList.h>
 
+#include "HashString.h"
 #include "ServerFont.h"
 #include "FontEngine.h"
 #include "MultiLocker.h"
@@ -41,14 +44,16 @@
 #include "Transformable.h"
 
 
+// The glyph and its data are allocated from the pages of the FontCacheEntry,
+// and stay valid as long as the entry itself.
 struct GlyphCache {
-	GlyphCache(uint32 glyphIndex, uint32 dataSize, glyph_data_type dataType,
-			const agg::rect_i& bounds, float advanceX, float advanceY,
-			float preciseAdvanceX, float preciseAdvanceY,
-			float insetLeft, float insetRight)
+	GlyphCache(uint32 glyphIndex, uint8* data, uint32 dataSize,
+			glyph_data_type dataType, const agg::rect_i& bounds,
+			float advanceX, float advanceY, float preciseAdvanceX,
+			float preciseAdvanceY, float insetLeft, float insetRight)
 		:
 		glyph_index(glyphIndex),
-		data((uint8*)malloc(dataSize)),
+		data(data),
 		data_size(dataSize),
 		data_type(dataType),
 		bounds(bounds),
@@ -62,11 +67,6 @@ struct GlyphCache {
 	{
 	}
 
-	~GlyphCache()
-	{
-		free(data);
-	}
-
 	uint32			glyph_index;
 	uint8*			data;
 	uint32			data_size;
@@ -84,7 +84,8 @@ struct GlyphCache {
 
 class FontCache;
 
-class FontCacheEntry : public MultiLocker, public BReferenceable {
+class FontCacheEntry : public MultiLocker, public BReferenceable,
+	public DoublyLinkedListLinkImpl<FontCacheEntry> {
  public:
 	typedef FontEngine::PathAdapter					GlyphPathAdapter;
 	typedef FontEngine::Gray8Adapter				GlyphGray8Adapter;
@@ -129,14 +130,13 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 									size_t signatureSize,
 									const ServerFont& font, bool forceVector);
 
-	// private to FontCache class:
-			void				UpdateUsage();
-			bigtime_t			LastUsed() const
-									{ return fLastUsedTime; }
-			uint64				UsedCount() const
-									{ return fUseCounter; }
+			int32				CountGlyphs() const;
+			int64				MemoryUsage() const;
+									// may be called without holding a lock
 
  private:
+	friend class FontCache;
+
 								FontCacheEntry(const FontCacheEntry&);
 			const FontCacheEntry& operator=(const FontCacheEntry&);
 
@@ -149,9 +149,8 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 								fGlyphCache;
 			FontEngine			fEngine;
 
-	static	BLocker				sUsageUpdateLock;
-			bigtime_t			fLastUsedTime;
-			uint64				fUseCounter;
+			// private to FontCache class
+			HashString			fSignature;
 };
 
 #endif // FONT_CACHE_ENTRY_H
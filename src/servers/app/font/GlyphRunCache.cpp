@@ -0,0 +1,288 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "GlyphRunCache.h"
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Autolock.h>
+#include <Font.h>
+
+#include "FontCacheEntry.h"
+
+
+// The memory used by all runs is kept below this.
+static const size_t kMaxMemoryUsage = 512 * 1024;
+
+
+struct GlyphRunCache::Entry : DoublyLinkedListLinkImpl<Entry> {
+	Entry*				hashLink;
+	uint32				hash;
+	size_t				keySize;
+	Run					run;
+
+	// the key data directly follows the entry
+	const char* KeyData() const
+	{
+		return (const char*)(this + 1);
+	}
+
+	size_t AllocationSize() const
+	{
+		return sizeof(Entry) + keySize;
+	}
+};
+
+
+struct GlyphRunCache::HashDefinition {
+	typedef Key		KeyType;
+	typedef	Entry	ValueType;
+
+	size_t HashKey(const Key& key) const
+	{
+		return key.Hash();
+	}
+
+	size_t Hash(Entry* value) const
+	{
+		return value->hash;
+	}
+
+	bool Compare(const Key& key, Entry* value) const
+	{
+		return value->hash == key.Hash() && value->keySize == key.Size()
+			&& memcmp(value->KeyData(), key.Data(), key.Size()) == 0;
+	}
+
+	Entry*& GetLink(Entry* value) const
+	{
+		return value->hashLink;
+	}
+};
+
+
+static inline int32
+utf8_char_length(uint8 c)
+{
+	if ((c & 0x80) == 0)
+		return 1;
+	if ((c & 0xe0) == 0xc0)
+		return 2;
+	if ((c & 0xf0) == 0xe0)
+		return 3;
+	if ((c & 0xf8) == 0xf0)
+		return 4;
+	return 1;
+}
+
+
+// #pragma mark - Key
+
+
+/*!	Returns \c false if the string cannot be cached; it is either too long,
+	or its last character does not end within \a length, in which case the
+	layout would depend on bytes that are not part of the key.
+*/
+bool
+GlyphRunCache::Key::SetTo(const ServerFont& font, bool forceVector,
+	const char* string, int32 length, const escapement_delta* delta,
+	uint8 spacing)
+{
+	if (string == NULL || length <= 0)
+		return false;
+
+	// the layout stops at the end of the string as well
+	length = strnlen(string, length);
+	if (length > kMaxStringLength)
+		return false;
+
+	int32 end = 0;
+	while (end < length)
+		end += utf8_char_length(string[end]);
+	if (end != length)
+		return false;
+
+	// everything that affects the glyphs
+	FontCacheEntry::GenerateSignature(fData, sizeof(fData) - kMaxStringLength
+		- 32, font, forceVector);
+	fSize = strlen(fData) + 1;
+
+	fData[fSize++] = spacing;
+
+	const float values[] = {
+		font.Size(),
+		font.Rotation(),
+		font.Shear(),
+		font.FalseBoldWidth(),
+		delta != NULL ? delta->space : 0.0f,
+		delta != NULL ? delta->nonspace : 0.0f
+	};
+	memcpy(fData + fSize, values, sizeof(values));
+	fSize += sizeof(values);
+
+	memcpy(fData + fSize, string, length);
+	fSize += length;
+
+	// FNV-1a
+	fHash = 2166136261U;
+	for (size_t i = 0; i < fSize; i++)
+		fHash = (fHash ^ (uint8)fData[i]) * 16777619U;
+
+	return true;
+}
+
+
+// #pragma mark - Run
+
+
+GlyphRunCache::Run::Run()
+	:
+	endX(0.0),
+	endY(0.0),
+	bounds(INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN),
+	hasBounds(false)
+{
+}
+
+
+// #pragma mark - GlyphRunCache
+
+
+GlyphRunCache GlyphRunCache::sDefaultInstance;
+
+
+GlyphRunCache::GlyphRunCache()
+	:
+	fLock("glyph run cache"),
+	fTable(new(std::nothrow) EntryTable),
+	fMemoryUsage(0),
+	fHits(0),
+	fMisses(0),
+	fEvictions(0)
+{
+}
+
+
+GlyphRunCache::~GlyphRunCache()
+{
+	while (Entry* entry = fUsageList.RemoveHead())
+		free(entry);
+
+	delete fTable;
+}
+
+
+/*static*/ GlyphRunCache*
+GlyphRunCache::Default()
+{
+	return &sDefaultInstance;
+}
+
+
+bool
+GlyphRunCache::Lookup(const Key& key, Run& run)
+{
+	BAutolock _(fLock);
+
+	Entry* entry = fTable != NULL ? fTable->Lookup(key) : NULL;
+	if (entry == NULL) {
+		fMisses++;
+		return false;
+	}
+
+	fHits++;
+	if (fUsageList.Head() != entry) {
+		fUsageList.Remove(entry);
+		fUsageList.Add(entry, false);
+	}
+
+	run = entry->run;
+	return true;
+}
+
+
+void
+GlyphRunCache::Put(const Key& key, const Run& run)
+{
+	BAutolock _(fLock);
+
+	if (fTable == NULL)
+		return;
+
+	Entry* entry = fTable->Lookup(key);
+	if (entry != NULL) {
+		// keep the bounds, if only the width was computed this time
+		if (run.hasBounds || !entry->run.hasBounds)
+			entry->run = run;
+		return;
+	}
+
+	entry = (Entry*)malloc(sizeof(Entry) + key.Size());
+	if (entry == NULL)
+		return;
+
+	new(entry) Entry;
+	entry->hash = key.Hash();
+	entry->keySize = key.Size();
+	entry->run = run;
+	memcpy((char*)entry->KeyData(), key.Data(), key.Size());
+
+	if (fTable->Insert(entry) != B_OK) {
+		free(entry);
+		return;
+	}
+
+	fUsageList.Add(entry, false);
+	fMemoryUsage += entry->AllocationSize();
+
+	_ConstrainMemoryUsage();
+}
+
+
+void
+GlyphRunCache::Dump()
+{
+	BAutolock _(fLock);
+
+	int64 lookups = max_c(fHits + fMisses, 1);
+
+	debug_printf("GlyphRunCache: %" B_PRIuSIZE " runs, %" B_PRIuSIZE " of %"
+		B_PRIuSIZE " KB used\n", fTable != NULL ? fTable->CountElements() : 0,
+		_MemoryUsage() / 1024, kMaxMemoryUsage / 1024);
+	debug_printf("  %" B_PRId64 " hits, %" B_PRId64 " misses (%" B_PRId64
+		"%% hit rate), %" B_PRId64 " evictions\n", fHits, fMisses,
+		fHits * 100 / lookups, fEvictions);
+}
+
+
+size_t
+GlyphRunCache::_MemoryUsage() const
+{
+	// the table of the hash table is part of the budget as well
+	if (fTable == NULL)
+		return fMemoryUsage;
+
+	return fMemoryUsage + fTable->TableSize() * sizeof(Entry*);
+}
+
+
+void
+GlyphRunCache::_ConstrainMemoryUsage()
+{
+	while (_MemoryUsage() > kMaxMemoryUsage) {
+		Entry* entry = fUsageList.RemoveTail();
+		if (entry == NULL)
+			break;
+
+		fTable->Remove(entry);
+		fMemoryUsage -= entry->AllocationSize();
+		fEvictions++;
+
+		free(entry);
+	}
+}
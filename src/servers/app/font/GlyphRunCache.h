@@ -0,0 +1,103 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef GLYPH_RUN_CACHE_H
+#define GLYPH_RUN_CACHE_H
+
+
+#include <Locker.h>
+#include <util/DoublyLinkedList.h>
+#include <util/OpenHashTable.h>
+
+#include "IntRect.h"
+
+
+class ServerFont;
+struct escapement_delta;
+
+
+/*!	Remembers the results of laying out short strings, so that the labels
+	which are measured and drawn over and over again, like menu items, list
+	rows, or file names, don't need to be laid out from their glyphs every
+	time.
+
+	The strings are laid out in untransformed coordinates; the transformation
+	only decides whether vector or bitmap glyphs are used, which is part of
+	the font signature in the key. Since the signature only contains a rounded
+	size, the exact size, and the rotation, shear, and false bold width of
+	the font, which all change the advances, are added to the key as well.
+*/
+class GlyphRunCache {
+public:
+	static	const int32			kMaxStringLength = 128;
+
+	class Key {
+	public:
+			bool				SetTo(const ServerFont& font,
+									bool forceVector, const char* string,
+									int32 length,
+									const escapement_delta* delta,
+									uint8 spacing);
+
+			uint32				Hash() const
+									{ return fHash; }
+			const char*			Data() const
+									{ return fData; }
+			size_t				Size() const
+									{ return fSize; }
+
+	private:
+			char				fData[512];
+			size_t				fSize;
+			uint32				fHash;
+	};
+
+	struct Run {
+								Run();
+
+			double				endX;
+			double				endY;
+				// pen position after the last glyph
+			IntRect				bounds;
+				// union of the glyph bounds, if hasBounds is set
+			bool				hasBounds;
+	};
+
+								GlyphRunCache();
+								~GlyphRunCache();
+
+	static	GlyphRunCache*		Default();
+
+			bool				Lookup(const Key& key, Run& run);
+			void				Put(const Key& key, const Run& run);
+
+			void				Dump();
+
+private:
+			struct Entry;
+			struct HashDefinition;
+
+			typedef BOpenHashTable<HashDefinition> EntryTable;
+			typedef DoublyLinkedList<Entry> EntryList;
+
+			size_t				_MemoryUsage() const;
+			void				_ConstrainMemoryUsage();
+
+private:
+	static	GlyphRunCache		sDefaultInstance;
+
+			BLocker				fLock;
+			EntryTable*			fTable;
+			EntryList			fUsageList;
+									// most recently used run first
+			size_t				fMemoryUsage;
+									// of the entries, without the table
+
+			int64				fHits;
+			int64				fMisses;
+			int64				fEvictions;
+};
+
+
+#endif	// GLYPH_RUN_CACHE_H
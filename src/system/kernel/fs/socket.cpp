@@ -9,6 +9,7 @@
 
 #include <errno.h>
 #include <limits.h>
+#include <new>
 
 #include <module.h>
 
@@ -32,6 +33,8 @@
 #define MAX_SOCKET_ADDRESS_LENGTH	(sizeof(sockaddr_storage))
 #define MAX_SOCKET_OPTION_LENGTH	128
 #define MAX_ANCILLARY_DATA_LENGTH	1024
+#define SPLICE_CHUNK_SIZE			(64 * 1024)
+#define MAX_MESSAGE_BATCH			32
 
 #define GET_SOCKET_FD_OR_RETURN(fd, kernel, descriptor)	\
 	do {												\
@@ -195,6 +198,118 @@ prepare_userland_msghdr(const msghdr* userMessage, msghdr& message,
 }
 
 
+struct userland_message {
+	iovec*			userVecs;
+	void*			userAddress;
+	void*			userAncillary;
+	MemoryDeleter	vecsDeleter;
+	MemoryDeleter	ancillaryDeleter;
+	char			address[MAX_SOCKET_ADDRESS_LENGTH];
+};
+
+struct userland_message_batch {
+	struct mmsghdr		messages[MAX_MESSAGE_BATCH];
+	userland_message	userland[MAX_MESSAGE_BATCH];
+};
+
+
+static status_t
+prepare_userland_send_message(const msghdr* userMessage, msghdr& message,
+	userland_message& userland)
+{
+	status_t error = prepare_userland_msghdr(userMessage, message,
+		userland.userVecs, userland.vecsDeleter, userland.userAddress,
+		userland.address);
+	if (error != B_OK)
+		return error;
+
+	// copy the address from userland
+	if (userland.userAddress != NULL
+			&& user_memcpy(userland.address, userland.userAddress,
+				message.msg_namelen) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	// copy ancillary data from userland
+	userland.userAncillary = message.msg_control;
+	if (userland.userAncillary != NULL) {
+		if (!IS_USER_ADDRESS(userland.userAncillary))
+			return B_BAD_ADDRESS;
+		if (message.msg_controllen < 0
+				|| message.msg_controllen > MAX_ANCILLARY_DATA_LENGTH) {
+			return B_BAD_VALUE;
+		}
+
+		message.msg_control = malloc(message.msg_controllen);
+		if (message.msg_control == NULL)
+			return B_NO_MEMORY;
+		userland.ancillaryDeleter.SetTo(message.msg_control);
+
+		if (user_memcpy(message.msg_control, userland.userAncillary,
+				message.msg_controllen) != B_OK) {
+			return B_BAD_ADDRESS;
+		}
+	}
+
+	return B_OK;
+}
+
+
+static status_t
+prepare_userland_receive_message(const msghdr* userMessage, msghdr& message,
+	userland_message& userland)
+{
+	status_t error = prepare_userland_msghdr(userMessage, message,
+		userland.userVecs, userland.vecsDeleter, userland.userAddress,
+		userland.address);
+	if (error != B_OK)
+		return error;
+
+	// prepare a buffer for ancillary data
+	userland.userAncillary = message.msg_control;
+	if (userland.userAncillary != NULL) {
+		if (!IS_USER_ADDRESS(userland.userAncillary))
+			return B_BAD_ADDRESS;
+		if (message.msg_controllen < 0)
+			return B_BAD_VALUE;
+		if (message.msg_controllen > MAX_ANCILLARY_DATA_LENGTH)
+			message.msg_controllen = MAX_ANCILLARY_DATA_LENGTH;
+
+		message.msg_control = malloc(message.msg_controllen);
+		if (message.msg_control == NULL)
+			return B_NO_MEMORY;
+		userland.ancillaryDeleter.SetTo(message.msg_control);
+	}
+
+	return B_OK;
+}
+
+
+/*!	Copies the address, the ancillary data, and the message header of a
+	received message back to userland.
+*/
+static status_t
+finish_userland_receive_message(msghdr* userMessage, msghdr& message,
+	userland_message& userland)
+{
+	void* ancillary = message.msg_control;
+
+	message.msg_name = userland.userAddress;
+	message.msg_iov = userland.userVecs;
+	message.msg_control = userland.userAncillary;
+	if ((userland.userAddress != NULL && user_memcpy(userland.userAddress,
+				userland.address, message.msg_namelen) != B_OK)
+		|| (userland.userAncillary != NULL && user_memcpy(
+				userland.userAncillary, ancillary, message.msg_controllen)
+					!= B_OK)
+		|| user_memcpy(userMessage, &message, sizeof(msghdr)) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	return B_OK;
+}
+
+
 // #pragma mark - socket file descriptor
 
 
@@ -551,6 +666,19 @@ common_recvmsg(int fd, struct msghdr *message, int flags, bool kernel)
 }
 
 
+static ssize_t
+common_recvmmsg(int fd, struct mmsghdr *messages, size_t count, int flags,
+	bigtime_t timeout, bool kernel)
+{
+	file_descriptor* descriptor;
+	GET_SOCKET_FD_OR_RETURN(fd, kernel, descriptor);
+	FileDescriptorPutter _(descriptor);
+
+	return sStackInterface->recvmmsg(FD_SOCKET(descriptor), messages, count,
+		flags, timeout);
+}
+
+
 static ssize_t
 common_send(int fd, const void *data, size_t length, int flags, bool kernel)
 {
@@ -586,6 +714,159 @@ common_sendmsg(int fd, const struct msghdr *message, int flags, bool kernel)
 }
 
 
+static ssize_t
+common_sendmmsg(int fd, struct mmsghdr *messages, size_t count, int flags,
+	bool kernel)
+{
+	file_descriptor* descriptor;
+	GET_SOCKET_FD_OR_RETURN(fd, kernel, descriptor);
+	FileDescriptorPutter _(descriptor);
+
+	return sStackInterface->sendmmsg(FD_SOCKET(descriptor), messages, count,
+		flags);
+}
+
+
+static void
+free_splice_chunk(void* chunk)
+{
+	free(chunk);
+}
+
+
+/*!	Moves up to \a length bytes from \a inFD to \a outFD without copying
+	them to userland. When the target is a socket, the data read from the
+	source is handed over to the network stack directly, which will keep
+	referencing it until it has been sent, instead of copying it again.
+	For all other targets, a kernel buffer is used in between.
+
+	If \a _inPosition, or \a _outPosition respectively, is \c NULL, the
+	current position of the file descriptor is used and updated; otherwise,
+	the position is taken from there and updated, leaving the descriptor
+	alone.
+*/
+static ssize_t
+common_splice(int inFD, off_t* _inPosition, int outFD, off_t* _outPosition,
+	size_t length, int flags, bool kernel)
+{
+	if ((flags & ~MSG_DONTWAIT) != 0)
+		return B_BAD_VALUE;
+	if ((_inPosition != NULL && *_inPosition < 0)
+		|| (_outPosition != NULL && *_outPosition < 0)) {
+		return B_BAD_VALUE;
+	}
+	if (length == 0)
+		return 0;
+	if (length > SSIZE_MAX)
+		length = SSIZE_MAX;
+
+	io_context* context = get_current_io_context(kernel);
+
+	FileDescriptorPutter input(get_fd(context, inFD));
+	FileDescriptorPutter output(get_fd(context, outFD));
+	if (!input.IsSet() || !output.IsSet())
+		return B_FILE_ERROR;
+
+	if ((input->open_mode & O_RWMASK) == O_WRONLY
+		|| (output->open_mode & O_RWMASK) == O_RDONLY) {
+		return B_FILE_ERROR;
+	}
+	if (input->ops->fd_read == NULL || output->ops->fd_write == NULL)
+		return B_BAD_VALUE;
+
+	const bool toSocket = output->ops == &sSocketFDOps;
+	if (toSocket && _outPosition != NULL)
+		return ESPIPE;
+
+	off_t inPosition = _inPosition != NULL ? *_inPosition : input->pos;
+	off_t outPosition = _outPosition != NULL ? *_outPosition : output->pos;
+
+	// For other targets than sockets, we can just reuse a single buffer
+	MemoryDeleter bufferDeleter;
+	if (!toSocket) {
+		bufferDeleter.SetTo(malloc(min_c(length, SPLICE_CHUNK_SIZE)));
+		if (!bufferDeleter.IsSet())
+			return B_NO_MEMORY;
+	}
+
+	status_t status = B_OK;
+	size_t transferred = 0;
+
+	while (transferred < length) {
+		size_t chunkSize = min_c(length - transferred, SPLICE_CHUNK_SIZE);
+		void* chunk = bufferDeleter.Get();
+		if (toSocket) {
+			chunk = malloc(chunkSize);
+			if (chunk == NULL) {
+				status = B_NO_MEMORY;
+				break;
+			}
+		}
+
+		size_t bytesRead = chunkSize;
+		status = input->ops->fd_read(input.Get(), inPosition, chunk,
+			&bytesRead);
+		if (status != B_OK || bytesRead == 0) {
+			if (toSocket)
+				free(chunk);
+			break;
+		}
+
+		ssize_t bytesWritten;
+		if (toSocket) {
+			// the stack takes over the chunk in any case
+			bytesWritten = sStackInterface->send_external(
+				FD_SOCKET(output), chunk, bytesRead, flags, &free_splice_chunk,
+				chunk);
+		} else {
+			size_t written = bytesRead;
+			status = output->ops->fd_write(output.Get(), outPosition, chunk,
+				&written);
+			bytesWritten = status == B_OK ? (ssize_t)written : status;
+		}
+		if (bytesWritten < 0) {
+			status = bytesWritten;
+			break;
+		}
+
+		// Note, if the source cannot seek, a partial write loses the rest of
+		// the chunk, as it does with read() and write() as well
+		if (inPosition != -1)
+			inPosition += bytesWritten;
+		if (outPosition != -1)
+			outPosition += bytesWritten;
+		transferred += bytesWritten;
+
+		if ((size_t)bytesWritten < bytesRead || bytesRead < chunkSize) {
+			// the target is full, or the source has no more data available
+			break;
+		}
+	}
+
+	if (transferred == 0 && status != B_OK)
+		return status;
+
+	if (_inPosition != NULL)
+		*_inPosition = inPosition;
+	else if (input->pos != -1)
+		input->pos = inPosition;
+
+	if (_outPosition != NULL)
+		*_outPosition = outPosition;
+	else if (output->pos != -1) {
+		if ((output->open_mode & O_APPEND) != 0
+			&& output->ops->fd_seek != NULL) {
+			off_t end = output->ops->fd_seek(output.Get(), 0, SEEK_END);
+			if (end >= 0)
+				outPosition = end;
+		}
+		output->pos = outPosition;
+	}
+
+	return transferred;
+}
+
+
 static status_t
 common_getsockopt(int fd, int level, int option, void *value,
 	socklen_t *_length, bool kernel)
@@ -1018,35 +1299,12 @@ _user_recvmsg(int socket, struct msghdr *userMessage, int flags)
 {
 	// copy message from userland
 	msghdr message;
-	iovec* userVecs;
-	MemoryDeleter vecsDeleter;
-	void* userAddress;
-	char address[MAX_SOCKET_ADDRESS_LENGTH];
-
-	status_t error = prepare_userland_msghdr(userMessage, message, userVecs,
-		vecsDeleter, userAddress, address);
+	userland_message userland;
+	status_t error = prepare_userland_receive_message(userMessage, message,
+		userland);
 	if (error != B_OK)
 		return error;
 
-	// prepare a buffer for ancillary data
-	MemoryDeleter ancillaryDeleter;
-	void* ancillary = NULL;
-	void* userAncillary = message.msg_control;
-	if (userAncillary != NULL) {
-		if (!IS_USER_ADDRESS(userAncillary))
-			return B_BAD_ADDRESS;
-		if (message.msg_controllen < 0)
-			return B_BAD_VALUE;
-		if (message.msg_controllen > MAX_ANCILLARY_DATA_LENGTH)
-			message.msg_controllen = MAX_ANCILLARY_DATA_LENGTH;
-
-		message.msg_control = ancillary = malloc(message.msg_controllen);
-		if (message.msg_control == NULL)
-			return B_NO_MEMORY;
-
-		ancillaryDeleter.SetTo(ancillary);
-	}
-
 	// recvmsg()
 	SyscallRestartWrapper<ssize_t> result;
 
@@ -1054,20 +1312,85 @@ _user_recvmsg(int socket, struct msghdr *userMessage, int flags)
 	if (result < 0)
 		return result;
 
-	// copy the address, the ancillary data, and the message header back to
-	// userland
-	message.msg_name = userAddress;
-	message.msg_iov = userVecs;
-	message.msg_control = userAncillary;
-	if ((userAddress != NULL && user_memcpy(userAddress, address,
-				message.msg_namelen) != B_OK)
-		|| (userAncillary != NULL && user_memcpy(userAncillary, ancillary,
-				message.msg_controllen) != B_OK)
-		|| user_memcpy(userMessage, &message, sizeof(msghdr)) != B_OK) {
+	error = finish_userland_receive_message(userMessage, message, userland);
+	if (error != B_OK)
+		return error;
+
+	return result;
+}
+
+
+ssize_t
+_user_recvmmsg(int socket, struct mmsghdr *userMessages, size_t count,
+	int flags, bigtime_t timeout)
+{
+	if (userMessages == NULL || !IS_USER_ADDRESS(userMessages))
 		return B_BAD_ADDRESS;
+	if (count > IOV_MAX)
+		count = IOV_MAX;
+
+	userland_message_batch* batch
+		= new(std::nothrow) userland_message_batch;
+	if (batch == NULL)
+		return B_NO_MEMORY;
+	ObjectDeleter<userland_message_batch> batchDeleter(batch);
+
+	bigtime_t deadline = B_INFINITE_TIMEOUT;
+	if (timeout != B_INFINITE_TIMEOUT)
+		deadline = system_time() + timeout;
+
+	SyscallRestartWrapper<ssize_t> result;
+	size_t received = 0;
+	ssize_t error = B_OK;
+
+	while (received < count) {
+		// copy the next batch of messages from userland
+		size_t batchCount = min_c(count - received, MAX_MESSAGE_BATCH);
+		for (size_t i = 0; i < batchCount; i++) {
+			error = prepare_userland_receive_message(
+				&userMessages[received + i].msg_hdr,
+				batch->messages[i].msg_hdr, batch->userland[i]);
+			if (error != B_OK) {
+				batchCount = i;
+				break;
+			}
+		}
+		if (batchCount == 0)
+			break;
+
+		bigtime_t batchTimeout = B_INFINITE_TIMEOUT;
+		if (deadline != B_INFINITE_TIMEOUT)
+			batchTimeout = max_c(deadline - system_time(), 0);
+
+		ssize_t batchReceived = common_recvmmsg(socket, batch->messages,
+			batchCount, flags, batchTimeout, false);
+		if (batchReceived < 0) {
+			error = batchReceived;
+			break;
+		}
+
+		for (ssize_t i = 0; i < batchReceived; i++) {
+			struct mmsghdr* userMessage = &userMessages[received + i];
+			if (finish_userland_receive_message(&userMessage->msg_hdr,
+					batch->messages[i].msg_hdr, batch->userland[i]) != B_OK
+				|| user_memcpy(&userMessage->msg_len,
+					&batch->messages[i].msg_len, sizeof(unsigned int))
+						!= B_OK) {
+				return result = B_BAD_ADDRESS;
+			}
+		}
+
+		received += batchReceived;
+		if (error != B_OK || (size_t)batchReceived < batchCount)
+			break;
+
+		if ((flags & MSG_WAITFORONE) != 0)
+			flags |= MSG_DONTWAIT;
 	}
 
-	return result;
+	if (received > 0)
+		return result = received;
+	return result = error;
 }
 
 
@@ -1118,48 +1441,116 @@ _user_sendmsg(int socket, const struct msghdr *userMessage, int flags)
 {
 	// copy message from userland
 	msghdr message;
-	iovec* userVecs;
-	MemoryDeleter vecsDeleter;
-	void* userAddress;
-	char address[MAX_SOCKET_ADDRESS_LENGTH];
-
-	status_t error = prepare_userland_msghdr(userMessage, message, userVecs,
-		vecsDeleter, userAddress, address);
+	userland_message userland;
+	status_t error = prepare_userland_send_message(userMessage, message,
+		userland);
 	if (error != B_OK)
 		return error;
 
-	// copy the address from userland
-	if (userAddress != NULL
-			&& user_memcpy(address, userAddress, message.msg_namelen) != B_OK) {
+	// sendmsg()
+	SyscallRestartWrapper<ssize_t> result;
+
+	return result = common_sendmsg(socket, &message, flags, false);
+}
+
+
+ssize_t
+_user_sendmmsg(int socket, struct mmsghdr *userMessages, size_t count,
+	int flags)
+{
+	if (userMessages == NULL || !IS_USER_ADDRESS(userMessages))
 		return B_BAD_ADDRESS;
-	}
+	if (count > IOV_MAX)
+		count = IOV_MAX;
 
-	// copy ancillary data from userland
-	MemoryDeleter ancillaryDeleter;
-	void* userAncillary = message.msg_control;
-	if (userAncillary != NULL) {
-		if (!IS_USER_ADDRESS(userAncillary))
-			return B_BAD_ADDRESS;
-		if (message.msg_controllen < 0
-				|| message.msg_controllen > MAX_ANCILLARY_DATA_LENGTH) {
-			return B_BAD_VALUE;
-		}
+	userland_message_batch* batch
+		= new(std::nothrow) userland_message_batch;
+	if (batch == NULL)
+		return B_NO_MEMORY;
+	ObjectDeleter<userland_message_batch> batchDeleter(batch);
 
-		message.msg_control = malloc(message.msg_controllen);
-		if (message.msg_control == NULL)
-			return B_NO_MEMORY;
-		ancillaryDeleter.SetTo(message.msg_control);
+	SyscallRestartWrapper<ssize_t> result;
+	size_t sent = 0;
+	ssize_t error = B_OK;
+
+	while (sent < count) {
+		// copy the next batch of messages from userland
+		size_t batchCount = min_c(count - sent, MAX_MESSAGE_BATCH);
+		for (size_t i = 0; i < batchCount; i++) {
+			error = prepare_userland_send_message(
+				&userMessages[sent + i].msg_hdr, batch->messages[i].msg_hdr,
+				batch->userland[i]);
+			if (error != B_OK) {
+				batchCount = i;
+				break;
+			}
+		}
+		if (batchCount == 0)
+			break;
+
+		ssize_t batchSent = common_sendmmsg(socket, batch->messages,
+			batchCount, flags, false);
+		if (batchSent < 0) {
+			error = batchSent;
+			break;
+		}
 
-		if (user_memcpy(message.msg_control, userAncillary,
-				message.msg_controllen) != B_OK) {
-			return B_BAD_ADDRESS;
+		for (ssize_t i = 0; i < batchSent; i++) {
+			if (user_memcpy(&userMessages[sent + i].msg_len,
+					&batch->messages[i].msg_len, sizeof(unsigned int))
+						!= B_OK) {
+				return result = B_BAD_ADDRESS;
+			}
 		}
+
+		sent += batchSent;
+		if (error != B_OK || (size_t)batchSent < batchCount)
+			break;
+	}
+
+	if (sent > 0)
+		return result = sent;
+	return result = error;
+}
+
+
+ssize_t
+_user_splice(int inFD, off_t* userInPosition, int outFD,
+	off_t* userOutPosition, size_t length, int flags)
+{
+	off_t inPosition;
+	off_t outPosition;
+	if (userInPosition != NULL
+		&& (!IS_USER_ADDRESS(userInPosition)
+			|| user_memcpy(&inPosition, userInPosition, sizeof(off_t))
+				!= B_OK)) {
+		return B_BAD_ADDRESS;
+	}
+	if (userOutPosition != NULL
+		&& (!IS_USER_ADDRESS(userOutPosition)
+			|| user_memcpy(&outPosition, userOutPosition, sizeof(off_t))
+				!= B_OK)) {
+		return B_BAD_ADDRESS;
 	}
 
-	// sendmsg()
 	SyscallRestartWrapper<ssize_t> result;
+	result = common_splice(inFD, userInPosition != NULL ? &inPosition : NULL,
+		outFD, userOutPosition != NULL ? &outPosition : NULL, length, flags,
+		false);
+	if (result < 0)
+		return result;
 
-	return result = common_sendmsg(socket, &message, flags, false);
+	// copy the new positions back to userland
+	if ((userInPosition != NULL
+			&& user_memcpy(userInPosition, &inPosition, sizeof(off_t))
+				!= B_OK)
+		|| (userOutPosition != NULL
+			&& user_memcpy(userOutPosition, &outPosition, sizeof(off_t))
+				!= B_OK)) {
+		return B_BAD_ADDRESS;
+	}
+
+	return result;
 }
 
 
@@ -1,5 +1,5 @@
 /*
- * Copyright 2002-2008, Haiku, Inc. All Rights Reserved.
+ * Copyright 2002-2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <syscall_utils.h>
@@ -286,6 +287,26 @@ recvmsg(int socket, struct msghdr *message, int flags)
 }
 
 
+extern "C" ssize_t
+recvmmsg(int socket, struct mmsghdr *messages, size_t count, int flags,
+	const struct timespec *timeout)
+{
+	bigtime_t relativeTimeout = B_INFINITE_TIMEOUT;
+	if (timeout != NULL) {
+		if (timeout->tv_sec < 0 || timeout->tv_nsec < 0
+			|| timeout->tv_nsec >= 1000000000) {
+			RETURN_AND_SET_ERRNO(B_BAD_VALUE);
+		}
+
+		relativeTimeout = (bigtime_t)timeout->tv_sec * 1000000
+			+ (timeout->tv_nsec + 999) / 1000;
+	}
+
+	RETURN_AND_SET_ERRNO_TEST_CANCEL(_kern_recvmmsg(socket, messages, count,
+		flags, relativeTimeout));
+}
+
+
 extern "C" ssize_t
 send(int socket, const void *data, size_t length, int flags)
 {
@@ -317,6 +338,14 @@ sendmsg(int socket, const struct msghdr *message, int flags)
 }
 
 
+extern "C" ssize_t
+sendmmsg(int socket, struct mmsghdr *messages, size_t count, int flags)
+{
+	RETURN_AND_SET_ERRNO_TEST_CANCEL(_kern_sendmmsg(socket, messages, count,
+		flags));
+}
+
+
 extern "C" int
 getsockopt(int socket, int level, int option, void *value, socklen_t *_length)
 {
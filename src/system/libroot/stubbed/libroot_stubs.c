@@ -1164,6 +1164,7 @@ void _kern_realtime_sem_wait() {}
 void _kern_receive_data() {}
 void _kern_recv() {}
 void _kern_recvfrom() {}
+void _kern_recvmmsg() {}
 void _kern_recvmsg() {}
 void _kern_register_file_device() {}
 void _kern_register_image() {}
@@ -1190,6 +1191,7 @@ void _kern_select() {}
 void _kern_send() {}
 void _kern_send_data() {}
 void _kern_send_signal() {}
+void _kern_sendmmsg() {}
 void _kern_sendmsg() {}
 void _kern_sendto() {}
 void _kern_set_area_protection() {}
@@ -1231,6 +1233,7 @@ void _kern_snooze_etc() {}
 void _kern_sockatmark() {}
 void _kern_socket() {}
 void _kern_socketpair() {}
+void _kern_splice() {}
 void _kern_spawn_thread() {}
 void _kern_start_watching() {}
 void _kern_start_watching_disks() {}
@@ -1,9 +1,10 @@
 /*
- * Copyright 2024, Haiku, Inc. All rights reserved.
+ * Copyright 2024-2026, Haiku, Inc. All rights reserved.
  * Distributed under the terms of the MIT License.
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #define DEBUG_QUERY
 #define PRINT(expr) printf expr
@@ -12,9 +13,140 @@
 #define QUERY_FATAL(message...) { fprintf(stderr, message); abort(); }
 #define QUERY_D(block) block
 #include <file_systems/QueryParser.h>
+#include <query_private.h>
+
+
+/*!	The nodes of a small simulated volume. Every node has a name and a type,
+	most have a rating, and some are marked. All of them are indexed, except
+	for the rating of the one node that got it before the index was created.
+*/
+struct Entry {
+	ino_t		id;
+	char		name[32];
+	const char*	type;
+	int32		rating;
+		// -1 if the node has no rating
+	int32		marked;
+		// -1 if the node is not marked
+	bool		ratingIndexed;
+};
+
+
+struct TestIndex {
+	const char*	name;
+	type_code	type;
+	int32		keySize;
+	Entry**		entries;
+		// sorted by key, and then by ID
+	int32		count;
+};
+
+
+static const int32 kNodeCount = 1000;
+static const ino_t kUnindexedNodeID = 5000;
+
+static Entry sEntries[kNodeCount + 1];
+static TestIndex sIndices[] = {
+	{ "name", B_STRING_TYPE, 0 },
+	{ "type", B_STRING_TYPE, 0 },
+	{ "rating", B_INT32_TYPE, sizeof(int32) },
+	{ "marked", B_INT32_TYPE, sizeof(int32) },
+};
+static int32 sLoadedNodes;
+
+
+static const void*
+index_key(const TestIndex* index, const Entry* entry, size_t* _length)
+{
+	switch (index - sIndices) {
+		case 0:
+			*_length = strlen(entry->name);
+			return entry->name;
+		case 1:
+			*_length = strlen(entry->type);
+			return entry->type;
+		case 2:
+			*_length = sizeof(int32);
+			return &entry->rating;
+		default:
+			*_length = sizeof(int32);
+			return &entry->marked;
+	}
+}
+
+
+static bool
+is_in_index(const TestIndex* index, const Entry* entry)
+{
+	switch (index - sIndices) {
+		case 2:
+			return entry->rating >= 0 && entry->ratingIndexed;
+		case 3:
+			return entry->marked >= 0;
+		default:
+			return true;
+	}
+}
+
+
+static const TestIndex* sSortIndex;
+
+
+static int
+compare_index_entries(const void* _a, const void* _b)
+{
+	const Entry* a = *(const Entry**)_a;
+	const Entry* b = *(const Entry**)_b;
+
+	size_t lengthA, lengthB;
+	const void* keyA = index_key(sSortIndex, a, &lengthA);
+	const void* keyB = index_key(sSortIndex, b, &lengthB);
+
+	int compare = QueryParser::compareKeys(sSortIndex->type, keyA, lengthA,
+		keyB, lengthB);
+	if (compare != 0)
+		return compare;
+
+	return a->id < b->id ? -1 : (a->id > b->id ? 1 : 0);
+}
 
 
-class Entry;
+static void
+init_volume()
+{
+	for (int32 i = 0; i < kNodeCount; i++) {
+		Entry& entry = sEntries[i];
+		entry.id = 1000 + i;
+		snprintf(entry.name, sizeof(entry.name), "file%" B_PRId32, i);
+		entry.type = i % 10 == 0 ? "text/plain" : "image/png";
+		entry.rating = i % 7 != 0 ? i % 100 : -1;
+		entry.marked = i % 50 == 0 ? 1 : -1;
+		entry.ratingIndexed = true;
+	}
+
+	Entry& unindexed = sEntries[kNodeCount];
+	unindexed.id = kUnindexedNodeID;
+	strcpy(unindexed.name, "unindexed");
+	unindexed.type = "text/plain";
+	unindexed.rating = 40;
+	unindexed.marked = -1;
+	unindexed.ratingIndexed = false;
+
+	for (size_t i = 0; i < B_COUNT_OF(sIndices); i++) {
+		TestIndex& index = sIndices[i];
+		index.entries = new Entry*[kNodeCount + 1];
+		index.count = 0;
+
+		for (int32 j = 0; j <= kNodeCount; j++) {
+			if (is_in_index(&index, &sEntries[j]))
+				index.entries[index.count++] = &sEntries[j];
+		}
+
+		sSortIndex = &index;
+		qsort(index.entries, index.count, sizeof(Entry*),
+			&compare_index_entries);
+	}
+}
 
 
 class Query {
@@ -22,6 +154,9 @@ public:
 	static	status_t		Create(void* volume, const char* queryString,
 								uint32 flags, port_id port, uint32 token,
 								Query*& _query);
+							~Query();
+
+			status_t		GetNextEntry(struct dirent* dirent, size_t size);
 
 private:
 	struct QueryPolicy;
@@ -47,25 +182,30 @@ struct Query::QueryPolicy {
 
 	struct Index {
 		Query*		query;
+		TestIndex*	index;
 
 		Index(Context* context)
 			:
-			query(context)
+			query(context),
+			index(NULL)
 		{
 		}
 	};
 
 	struct IndexIterator {
-		Entry* entry;
+		TestIndex*	index;
+		int32		position;
+			// the entry after the current one
 	};
 
 	static const int32 kMaxFileNameLength = B_FILE_NAME_LENGTH;
+	static const bool kHasTrigramIndices = false;
 
 	// Entry interface
 
 	static ino_t EntryGetParentID(Entry* entry)
 	{
-		return -1;
+		return 1;
 	}
 
 	static Node* EntryGetNode(Entry* entry)
@@ -75,48 +215,67 @@ struct Query::QueryPolicy {
 
 	static ino_t EntryGetNodeID(Entry* entry)
 	{
-		return -1;
+		return entry->id;
 	}
 
 	static ssize_t EntryGetName(Entry* entry, void* buffer, size_t bufferSize)
 	{
-		return B_ERROR;
+		return strlcpy((char*)buffer, entry->name, bufferSize);
 	}
 
 	static const char* EntryGetNameNoCopy(NodeHolder& holder, Entry* entry)
 	{
-		return NULL;
+		return entry->name;
 	}
 
 	// Index interface
 
 	static status_t IndexSetTo(Index& index, const char* attribute)
 	{
-		return B_ERROR;
+		for (size_t i = 0; i < B_COUNT_OF(sIndices); i++) {
+			if (strcmp(sIndices[i].name, attribute) == 0) {
+				index.index = &sIndices[i];
+				return B_OK;
+			}
+		}
+
+		return B_ENTRY_NOT_FOUND;
 	}
 
 	static void IndexUnset(Index& index)
 	{
+		index.index = NULL;
 	}
 
 	static int32 IndexGetSize(Index& index)
 	{
-		return 0;
+		return index.index->count;
 	}
 
 	static type_code IndexGetType(Index& index)
 	{
-		return 0;
+		return index.index->type;
 	}
 
 	static int32 IndexGetKeySize(Index& index)
 	{
-		return 0;
+		return index.index->keySize;
+	}
+
+	static bool IndexHasAllTrigrams(Index& index)
+	{
+		return false;
 	}
 
 	static IndexIterator* IndexCreateIterator(Index& index)
 	{
-		return NULL;
+		IndexIterator* iterator = new(std::nothrow) IndexIterator;
+		if (iterator == NULL)
+			return NULL;
+
+		iterator->index = index.index;
+		iterator->position = 0;
+		return iterator;
 	}
 
 	// IndexIterator interface
@@ -129,22 +288,55 @@ struct Query::QueryPolicy {
 	static status_t IndexIteratorFind(IndexIterator* indexIterator,
 		const void* value, size_t size)
 	{
-		return B_ERROR;
+		TestIndex* index = indexIterator->index;
+		for (int32 i = 0; i < index->count; i++) {
+			size_t length;
+			const void* key = index_key(index, index->entries[i], &length);
+			int compare = QueryParser::compareKeys(index->type, key, length,
+				value, size);
+			if (compare >= 0) {
+				indexIterator->position = i;
+				return compare == 0 ? B_OK : B_ENTRY_NOT_FOUND;
+			}
+		}
+
+		indexIterator->position = index->count;
+		return B_ENTRY_NOT_FOUND;
 	}
 
 	static status_t IndexIteratorFetchNextEntry(IndexIterator* indexIterator,
 		void* value, size_t* _valueLength, size_t bufferSize, size_t* duplicate)
 	{
-		return B_ERROR;
+		TestIndex* index = indexIterator->index;
+		if (indexIterator->position >= index->count)
+			return B_ENTRY_NOT_FOUND;
+
+		size_t length;
+		const void* key = index_key(index,
+			index->entries[indexIterator->position++], &length);
+		if (length >= bufferSize)
+			return B_BUFFER_OVERFLOW;
+
+		memcpy(value, key, length);
+		((char*)value)[length] = '\0';
+		*_valueLength = length;
+		*duplicate = 0;
+		return B_OK;
 	}
 
 	static status_t IndexIteratorGetEntry(Context* context, IndexIterator* indexIterator,
 		NodeHolder& holder, Entry** _entry)
 	{
-		*_entry = indexIterator->entry;
+		sLoadedNodes++;
+		*_entry = indexIterator->index->entries[indexIterator->position - 1];
 		return B_OK;
 	}
 
+	static ino_t IndexIteratorGetNodeID(IndexIterator* indexIterator)
+	{
+		return indexIterator->index->entries[indexIterator->position - 1]->id;
+	}
+
 	static void IndexIteratorSkipDuplicates(IndexIterator* indexIterator)
 	{
 	}
@@ -172,7 +364,29 @@ struct Query::QueryPolicy {
 	static status_t NodeGetAttribute(NodeHolder& nodeHolder, Node* node,
 		const char* attribute, void* buffer, size_t* _size, int32* _type)
 	{
-		return B_ERROR;
+		if (strcmp(attribute, "type") == 0) {
+			size_t length = strlen(node->type);
+			if (length >= *_size)
+				return B_BUFFER_OVERFLOW;
+
+			strcpy((char*)buffer, node->type);
+			*_size = length;
+			*_type = B_STRING_TYPE;
+			return B_OK;
+		}
+
+		int32 value = -1;
+		if (strcmp(attribute, "rating") == 0)
+			value = node->rating;
+		else if (strcmp(attribute, "marked") == 0)
+			value = node->marked;
+		if (value < 0)
+			return B_ENTRY_NOT_FOUND;
+
+		memcpy(buffer, &value, sizeof(int32));
+		*_size = sizeof(int32);
+		*_type = B_INT32_TYPE;
+		return B_OK;
 	}
 
 	static Entry* NodeGetFirstReferrer(Node* node)
@@ -187,6 +401,13 @@ struct Query::QueryPolicy {
 
 	// Volume interface
 
+	static status_t ContextGetEntry(Context* context, ino_t id,
+		NodeHolder& holder, Entry** _entry)
+	{
+		// only needed for trigram indices
+		return B_NOT_SUPPORTED;
+	}
+
 	static dev_t ContextGetVolumeID(Context* context)
 	{
 		return 0;
@@ -220,6 +441,19 @@ Query::Query()
 }
 
 
+Query::~Query()
+{
+	delete fImpl;
+}
+
+
+status_t
+Query::GetNextEntry(struct dirent* dirent, size_t size)
+{
+	return fImpl->GetNextEntry(dirent, size);
+}
+
+
 status_t
 Query::_Init(const char* queryString, uint32 flags, port_id port, uint32 token)
 {
@@ -232,9 +466,124 @@ Query::_Init(const char* queryString, uint32 flags, port_id port, uint32 token)
 }
 
 
+static bool
+expected_rating_40(const Entry& entry)
+{
+	return strcmp(entry.type, "text/plain") == 0 && entry.rating == 40;
+}
+
+
+static bool
+expected_rating_40_or_60(const Entry& entry)
+{
+	return strcmp(entry.type, "text/plain") == 0
+		&& (entry.rating == 40 || entry.rating == 60);
+}
+
+
+static bool
+expected_marked_rating_50(const Entry& entry)
+{
+	return entry.marked == 1 && entry.rating == 50;
+}
+
+
+/*!	Runs \a queryString, and checks that it returns exactly the nodes for
+	which \a expected is true, except for the one whose rating is not in the
+	index, if \a includesUnindexed is false; it also checks how many nodes
+	were loaded to evaluate the query.
+*/
+static bool
+test_query(const char* queryString, uint32 flags,
+	bool (*expected)(const Entry& entry), bool includesUnindexed,
+	int32 expectedLoads)
+{
+	Query* query;
+	status_t error = Query::Create(NULL, queryString, flags, 0, 0, query);
+	if (error != B_OK) {
+		fprintf(stderr, "%s: could not create query: %s\n", queryString,
+			strerror(error));
+		return false;
+	}
+
+	bool found[kNodeCount + 1] = {};
+	bool success = true;
+	sLoadedNodes = 0;
+
+	char buffer[sizeof(struct dirent) + B_FILE_NAME_LENGTH];
+	struct dirent* dirent = (struct dirent*)buffer;
+	while (query->GetNextEntry(dirent, sizeof(buffer)) == B_OK) {
+		int32 index = dirent->d_ino == kUnindexedNodeID
+			? kNodeCount : dirent->d_ino - 1000;
+		if (index < 0 || index > kNodeCount || found[index]) {
+			fprintf(stderr, "%s: unexpected node %" B_PRIdINO "\n",
+				queryString, dirent->d_ino);
+			success = false;
+			continue;
+		}
+		found[index] = true;
+	}
+
+	delete query;
+
+	for (int32 i = 0; i <= kNodeCount; i++) {
+		bool shouldBeFound = expected(sEntries[i])
+			&& (includesUnindexed || sEntries[i].ratingIndexed);
+		if (found[i] != shouldBeFound) {
+			fprintf(stderr, "%s: node %" B_PRIdINO " was %sreturned\n",
+				queryString, sEntries[i].id, found[i] ? "" : "not ");
+			success = false;
+		}
+	}
+
+	if (sLoadedNodes != expectedLoads) {
+		fprintf(stderr, "%s: loaded %" B_PRId32 " nodes, expected %" B_PRId32
+			"\n", queryString, sLoadedNodes, expectedLoads);
+		success = false;
+	}
+
+	return success;
+}
+
+
+/*!	Checks how the indices of the terms that are combined by "and" with the
+	iterated one are used to filter out nodes before they are loaded.
+*/
+static bool
+test_filters()
+{
+	init_volume();
+
+	bool success = true;
+
+	// The type index is iterated, and the rating index is used to filter
+	// the nodes; the node whose rating is not in the index is not returned
+	// then.
+	success &= test_query("(type==\"text/plain\")&&(rating==40)", 0,
+		&expected_rating_40, false, 8);
+	success &= test_query("(type==\"text/plain\")&&(rating==40)",
+		B_QUERY_SINGLE_INDEX, &expected_rating_40, true, 101);
+
+	// "or" terms contribute the union of their children's nodes
+	success &= test_query(
+		"(type==\"text/plain\")&&((rating==40)||(rating==60))", 0,
+		&expected_rating_40_or_60, false, 17);
+
+	// The rating index is much larger than the one of the marked nodes, so
+	// it is not worth scanning it
+	success &= test_query("(marked==1)&&(rating==50)", 0,
+		&expected_marked_rating_50, true, 20);
+
+	return success;
+}
+
+
 int
 main(int argc, char* argv[])
 {
+	if (!test_filters())
+		return 1;
+
 	for (int i = 1; i < argc; i++) {
 		Query* query;
 		status_t error = Query::Create(NULL, argv[i], 0, 0, 0, query);
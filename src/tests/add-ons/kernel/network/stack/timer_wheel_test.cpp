@@ -0,0 +1,251 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Stress test for the network stack's TimerWheel: arms, re-arms, and
+	cancels a large number of timers against a simulated clock, and verifies
+	that every armed timer expires exactly once, never early, and never much
+	too late, that canceled timers never expire at all, and that the wheel
+	reports when its next timer is actually due.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <OS.h>
+
+#include "TimerWheel.h"
+
+
+struct test_timer {
+	list_link	link;
+	bigtime_t	due;
+	bool		armed;
+	int32		expirations;
+};
+
+typedef TimerWheel<test_timer> Wheel;
+
+static const int32 kTimerCount = 100000;
+static const int32 kOperationCount = 5000000;
+static const bigtime_t kMaxStep = 5000;
+	// the simulated clock advances by up to this many usecs at a time
+
+static test_timer sTimers[kTimerCount];
+static Wheel sWheel;
+static uint32 sSeed = 0x12345678;
+static int32 sErrors;
+
+
+static uint32
+random_value()
+{
+	// xorshift32
+	sSeed ^= sSeed << 13;
+	sSeed ^= sSeed >> 17;
+	sSeed ^= sSeed << 5;
+	return sSeed;
+}
+
+
+static bigtime_t
+random_delay()
+{
+	// mostly short timers (retransmits, delayed ACKs), some long ones
+	// (keep-alive, TIME_WAIT), and a few beyond the range of the wheel
+	switch (random_value() % 16) {
+		case 0:
+			return (bigtime_t)(random_value() % 7200) * 1000000LL * 5;
+		case 1:
+		case 2:
+			return (bigtime_t)(random_value() % 120000) * 1000;
+		default:
+			return random_value() % 500000;
+	}
+}
+
+
+static void
+error(const char* format, test_timer* timer, bigtime_t now)
+{
+	if (sErrors++ < 10) {
+		fprintf(stderr, format, (int)(timer - sTimers));
+		fprintf(stderr, " (due %" B_PRId64 ", now %" B_PRId64 ")\n",
+			timer->due, now);
+	}
+}
+
+
+static int32
+expire(bigtime_t now, bigtime_t step)
+{
+	struct list expired;
+	list_init(&expired);
+
+	if (!sWheel.Advance(now, &expired))
+		return 0;
+
+	int32 count = 0;
+	while (test_timer* timer = (test_timer*)list_get_first_item(&expired)) {
+		sWheel.Remove(timer);
+
+		if (!timer->armed)
+			error("timer %d expired, but was not armed", timer, now);
+		if (timer->due > now)
+			error("timer %d expired early", timer, now);
+		if (now - timer->due >= step + Wheel::kResolution)
+			error("timer %d expired late", timer, now);
+
+		timer->armed = false;
+		timer->expirations++;
+		count++;
+	}
+
+	return count;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	bigtime_t now = 1234567890LL;
+	sWheel.Init(now);
+
+	int32 armed = 0;
+	int32 canceled = 0;
+	int32 expired = 0;
+
+	bigtime_t start = system_time();
+
+	for (int32 i = 0; i < kOperationCount; i++) {
+		test_timer* timer = &sTimers[random_value() % kTimerCount];
+
+		switch (random_value() % 8) {
+			case 0:
+			case 1:
+				// cancel
+				if (timer->armed) {
+					sWheel.Remove(timer);
+					timer->armed = false;
+					canceled++;
+				}
+				break;
+
+			case 2:
+			{
+				// advance the clock
+				bigtime_t step = random_value() % kMaxStep;
+				now += step;
+				expired += expire(now, kMaxStep);
+				break;
+			}
+
+			default:
+				// arm, or re-arm
+				if (timer->armed) {
+					sWheel.Remove(timer);
+					canceled++;
+				}
+
+				timer->due = now + random_delay();
+				timer->armed = true;
+				timer->expirations--;
+				sWheel.Add(timer, now);
+				armed++;
+				break;
+		}
+	}
+
+	bigtime_t elapsed = system_time() - start;
+
+	// let all remaining timers expire, as the timer thread would: it only
+	// wakes up when the next one is due, so each wake-up must expire one
+	int32 remaining = sWheel.Count();
+	while (sWheel.Count() > 0) {
+		bigtime_t next = sWheel.NextTimeout();
+		if (next > now)
+			now = next;
+
+		int32 count = expire(now, 0);
+		if (count == 0) {
+			fprintf(stderr, "nothing expired at the next timeout %" B_PRId64
+				"\n", now);
+			sErrors++;
+			break;
+		}
+		expired += count;
+	}
+
+	// After the wheel has been idle for a day, a new timer must not make it
+	// walk through all the ticks it missed
+	now += 86400LL * 1000000;
+	test_timer* timer = &sTimers[0];
+	timer->due = now + 10000;
+	timer->armed = true;
+	timer->expirations--;
+	sWheel.Add(timer, now);
+	if (sWheel.NextTimeout() < now) {
+		fprintf(stderr, "wheel did not catch up after being idle\n");
+		sErrors++;
+	}
+
+	// A single timer far beyond the first level must not make the timer
+	// thread wake up before it is due
+	test_timer* longTimer = &sTimers[1];
+	longTimer->due = now + 30 * 1000000LL;
+	longTimer->armed = true;
+	longTimer->expirations--;
+	sWheel.Remove(timer);
+	sWheel.Add(longTimer, now);
+	if (sWheel.NextTimeout() < longTimer->due) {
+		fprintf(stderr, "next timeout %" B_PRId64 " is before the only timer"
+			" %" B_PRId64 "\n", sWheel.NextTimeout(), longTimer->due);
+		sErrors++;
+	}
+	sWheel.Remove(longTimer);
+	longTimer->armed = false;
+	canceled++;
+	sWheel.Add(timer, now);
+	now = timer->due + Wheel::kResolution;
+	expired += expire(now, Wheel::kResolution);
+
+	int32 pending = 0;
+	for (int32 i = 0; i < kTimerCount; i++) {
+		test_timer* timer = &sTimers[i];
+		if (timer->armed)
+			pending++;
+	}
+
+	// Every arming decrements "expirations", every expiration increments
+	// it, and every cancel is balanced below, so all timers must end at 0.
+	// As cancels are not attributed to a specific timer, verify the sums.
+	int64 balance = 0;
+	for (int32 i = 0; i < kTimerCount; i++)
+		balance += sTimers[i].expirations;
+	if (balance != -(int64)canceled) {
+		fprintf(stderr, "expiration balance is %lld, expected %lld\n",
+			(long long)balance, -(long long)canceled);
+		sErrors++;
+	}
+	if (pending != 0) {
+		fprintf(stderr, "%ld timers never expired\n", (long)pending);
+		sErrors++;
+	}
+
+	printf("%ld timers armed, %ld canceled, %ld expired (%ld in the end)\n",
+		(long)armed, (long)canceled, (long)expired, (long)remaining);
+	printf("%ld operations in %lld usecs, %g operations/s\n",
+		(long)kOperationCount, (long long)elapsed,
+		kOperationCount * 1000000.0 / elapsed);
+
+	if (sErrors != 0) {
+		fprintf(stderr, "%ld errors\n", (long)sErrors);
+		return 1;
+	}
+
+	printf("passed\n");
+	return 0;
+}
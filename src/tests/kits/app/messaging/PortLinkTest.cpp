@@ -6,6 +6,7 @@
 
 
 const int32 kBufferSize = 2048;
+const size_t kRingSize = 32768;
 
 
 void
@@ -23,6 +24,72 @@ get_next_message(BPrivate::PortLink &link, int32 expectedCode)
 }
 
 
+/*!	Sends messages through a ring, often enough to wrap around it a few
+	times, and with the receiver lagging behind, so that the sender has to
+	fall back to the port in between.
+*/
+int
+test_ring(port_id port)
+{
+	BPrivate::PortLink sender(port, -1);
+	BPrivate::PortLink receiver(-1, port);
+
+	void* ring = malloc(kRingSize);
+	if (receiver.Receiver().SetRing(ring, kRingSize) != B_OK
+		|| sender.Sender().SetRing(ring, kRingSize) != B_OK) {
+		fprintf(stderr, "setting the ring failed!\n");
+		return -1;
+	}
+
+	char test[kBufferSize * 3];
+	for (size_t i = 0; i < sizeof(test); i++)
+		test[i] = (char)i;
+
+	int32 sent = 0;
+	int32 received = 0;
+	for (int32 round = 0; round < 50; round++) {
+		for (int32 i = 0; i < 20; i++) {
+			int32 size = (sent * 397) % sizeof(test);
+			sender.StartMessage('rng0' + sent % 10);
+			sender.Attach<int32>(size);
+			if (size > 0)
+				sender.Attach(test, size);
+			sent++;
+		}
+
+		if (sender.Flush() != B_OK) {
+			fprintf(stderr, "flushing into the ring failed!\n");
+			return -1;
+		}
+
+		// only catch up every other round
+		if (round % 2 == 0)
+			continue;
+
+		while (received < sent) {
+			get_next_message(receiver, 'rng0' + received % 10);
+
+			int32 size;
+			char buffer[sizeof(test)];
+			if (receiver.Read<int32>(&size) != B_OK
+				|| size != (received * 397) % (int32)sizeof(test)
+				|| (size > 0 && (receiver.Read(buffer, size) != B_OK
+					|| memcmp(buffer, test, size) != 0))) {
+				fprintf(stderr, "message %ld from the ring is wrong!\n",
+					received);
+				return -1;
+			}
+			received++;
+		}
+	}
+
+	sender.Sender().SetRing(NULL, 0);
+	receiver.Receiver().SetRing(NULL, 0);
+	free(ring);
+	return 0;
+}
+
+
 int
 main()
 {
@@ -102,6 +169,9 @@ main()
 		return -1;
 	}
 
+	if (test_ring(port) != 0)
+		return -1;
+
 	puts("All OK!");
 	return 0;
 }
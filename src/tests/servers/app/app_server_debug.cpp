@@ -1,5 +1,6 @@
 /*
  * Copyright 2010, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -28,9 +29,12 @@ send_debug_message(team_id team, int32 code)
 	if (status != B_OK)
 		return status;
 
-	status = link.Attach(team);
-	if (status != B_OK)
-		return status;
+	// the team is not needed for messages about the server itself
+	if (team >= 0) {
+		status = link.Attach(team);
+		if (status != B_OK)
+			return status;
+	}
 
 	// send it
 	return link.Flush();
@@ -40,7 +44,7 @@ send_debug_message(team_id team, int32 code)
 void
 usage()
 {
-	fprintf(stderr, "usage: %s -[ab] <team-id> [...]\n", __progname);
+	fprintf(stderr, "usage: %s -[abfr] [<team-id> ...]\n", __progname);
 	exit(1);
 }
 
@@ -53,15 +57,21 @@ main(int argc, char** argv)
 
 	bool dumpAllocator = false;
 	bool dumpBitmaps = false;
+	bool dumpFontCache = false;
+	bool dumpRedraws = false;
 
 	int32 i = 1;
-	while (argv[i][0] == '-') {
+	while (i < argc && argv[i][0] == '-') {
 		const char* arg = &argv[i][1];
 		while (arg[0]) {
 			if (arg[0] == 'a')
 				dumpAllocator = true;
 			else if (arg[0] == 'b')
 				dumpBitmaps = true;
+			else if (arg[0] == 'f')
+				dumpFontCache = true;
+			else if (arg[0] == 'r')
+				dumpRedraws = true;
 			else
 				usage();
 
@@ -70,6 +80,11 @@ main(int argc, char** argv)
 		i++;
 	}
 
+	if (dumpFontCache)
+		send_debug_message(-1, AS_DUMP_FONT_CACHE);
+	if (dumpRedraws)
+		send_debug_message(-1, AS_DUMP_REDRAWS);
+
 	for (int32 i = 1; i < argc; i++) {
 		team_id team = atoi(argv[i]);
 		if (team <= 0)
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Sends series of frames through the tile encoder and decoder, with a
+	StreamingRingBuffer standing in for the network, checks that every frame
+	arrives unchanged, and reports how much data had to be sent and how long
+	encoding and decoding took. Also checks that the decoder recovers when its
+	tile cache got out of sync with the encoder's.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Bitmap.h>
+#include <OS.h>
+
+#include "RemoteMessage.h"
+#include "StreamingRingBuffer.h"
+#include "TileCodec.h"
+
+
+static const int32 kWidth = 1024;
+static const int32 kHeight = 768;
+static const int32 kBytesPerRow = kWidth * 4;
+static const int32 kFrameCount = 30;
+
+
+enum {
+	FRAMES_STATIC,
+	FRAMES_SMALL_DAMAGE,
+	FRAMES_SCROLLING,
+	FRAMES_NOISE,
+
+	FRAMES_COUNT
+};
+
+static const char* kFramesNames[] = {
+	"static", "small damage", "scrolling", "noise"
+};
+
+
+static uint32
+random_bits()
+{
+	return ((uint32)rand() << 16) ^ (uint32)rand();
+}
+
+
+static void
+fill_rect(uint8* bits, int32 left, int32 top, int32 width, int32 height,
+	uint32 color)
+{
+	for (int32 y = top; y < top + height && y < kHeight; y++) {
+		uint32* row = (uint32*)(bits + y * kBytesPerRow);
+		for (int32 x = left; x < left + width && x < kWidth; x++)
+			row[x] = color;
+	}
+}
+
+
+/*!	Draws something that looks a bit like a desktop: a gradient, some
+	windows, and rows of "text" in them.
+*/
+static void
+draw_desktop(uint8* bits, int32 scroll)
+{
+	for (int32 y = 0; y < kHeight; y++) {
+		uint32* row = (uint32*)(bits + y * kBytesPerRow);
+		uint32 blue = 96 + y * 128 / kHeight;
+		for (int32 x = 0; x < kWidth; x++)
+			row[x] = 0xff000000 | 0x3366 << 8 | blue;
+	}
+
+	fill_rect(bits, 100, 80, 600, 500, 0xffd8d8d8);
+	fill_rect(bits, 100, 80, 600, 20, 0xffffcb00);
+	fill_rect(bits, 400, 300, 500, 400, 0xffe8e8e8);
+	fill_rect(bits, 400, 300, 500, 20, 0xffffcb00);
+
+	// text lines in the front window, these move when scrolling
+	for (int32 line = 0; line < 30; line++) {
+		int32 y = 330 + line * 12 - scroll;
+		if (y < 325 || y > 690)
+			continue;
+
+		// the same glyphs every time
+		uint32 seed = line * 2654435761U;
+		for (int32 x = 410; x < 880; x += 6) {
+			seed = seed * 1103515245 + 12345;
+			if ((seed >> 16) % 5 != 0) {
+				fill_rect(bits, x, y, 4, 8,
+					0xff000000 | (seed >> 24) % 64 * 0x010101);
+			}
+		}
+	}
+}
+
+
+static void
+make_frame(uint8* bits, int32 kind, int32 frame)
+{
+	switch (kind) {
+		case FRAMES_STATIC:
+			draw_desktop(bits, 0);
+			break;
+
+		case FRAMES_SMALL_DAMAGE:
+			// a blinking cursor, and a clock
+			draw_desktop(bits, 0);
+			if (frame % 2 == 0)
+				fill_rect(bits, 500, 450, 1, 12, 0xff000000);
+			fill_rect(bits, 960, 0, 64, 16, 0xff000000 | frame * 0x030201);
+			break;
+
+		case FRAMES_SCROLLING:
+			draw_desktop(bits, frame * 3);
+			break;
+
+		case FRAMES_NOISE:
+			for (int32 i = 0; i < kWidth * kHeight; i++)
+				((uint32*)bits)[i] = random_bits();
+			break;
+	}
+}
+
+
+static bool
+run_frames(int32 kind, StreamingRingBuffer& ringBuffer, uint8* bits)
+{
+	TileEncoder encoder;
+	TileDecoder decoder;
+	encoder.SetEnabled(true);
+
+	RemoteMessage sender(NULL, &ringBuffer);
+	RemoteMessage receiver(&ringBuffer, NULL);
+
+	bigtime_t decodeTime = 0;
+	bool success = true;
+
+	for (int32 frame = 0; frame < kFrameCount; frame++) {
+		make_frame(bits, kind, frame);
+
+		sender.Start(RP_DRAW_BITMAP_TILES);
+		encoder.AddBitmap(sender, bits, kWidth, kHeight, kBytesPerRow,
+			B_RGB32, B_BITMAP_NO_SERVER_LINK);
+		sender.Flush();
+
+		bigtime_t startTime = system_time();
+
+		uint16 code;
+		BBitmap* bitmap = NULL;
+		status_t result = receiver.NextMessage(code);
+		if (result == B_OK)
+			result = decoder.ReadBitmap(receiver, &bitmap);
+
+		decodeTime += system_time() - startTime;
+
+		if (result != B_OK) {
+			fprintf(stderr, "%s: frame %" B_PRId32 " could not be decoded: "
+				"%s\n", kFramesNames[kind], frame, strerror(result));
+			success = false;
+			continue;
+		}
+
+		for (int32 y = 0; y < kHeight; y++) {
+			if (memcmp((uint8*)bitmap->Bits() + y * bitmap->BytesPerRow(),
+					bits + y * kBytesPerRow, kBytesPerRow) != 0) {
+				fprintf(stderr, "%s: frame %" B_PRId32 " differs in row %"
+					B_PRId32 "\n", kFramesNames[kind], frame, y);
+				success = false;
+				break;
+			}
+		}
+
+		delete bitmap;
+	}
+
+	tile_statistics statistics;
+	encoder.GetStatistics(statistics);
+
+	uint64 tiles = statistics.cachedTiles + statistics.rawTiles
+		+ statistics.compressedTiles;
+	printf("%-14s%10.2f%10.2f%8.1f%%%8" B_PRIu64 "%%%8" B_PRIu64 "%%%8"
+		B_PRIu64 "%%%10.2f%10.2f  %s\n", kFramesNames[kind],
+		statistics.rawBytes / 1048576.0, statistics.encodedBytes / 1048576.0,
+		statistics.encodedBytes * 100.0 / statistics.rawBytes,
+		statistics.cachedTiles * 100 / tiles,
+		statistics.compressedTiles * 100 / tiles,
+		statistics.rawTiles * 100 / tiles,
+		statistics.encodeTime / 1000.0 / kFrameCount,
+		decodeTime / 1000.0 / kFrameCount, success ? "ok" : "FAILED");
+
+	return success;
+}
+
+
+/*!	Lets the decoder lose its cache behind the encoder's back, and checks that
+	the next bitmap is refused, and that both sides work again after starting
+	over the way RemoteView does it.
+*/
+static bool
+run_recovery(StreamingRingBuffer& ringBuffer, uint8* bits)
+{
+	TileEncoder encoder;
+	TileDecoder decoder;
+	encoder.SetEnabled(true);
+
+	RemoteMessage sender(NULL, &ringBuffer);
+	RemoteMessage receiver(&ringBuffer, NULL);
+
+	make_frame(bits, FRAMES_STATIC, 0);
+
+	bool decodes[] = { true, false, true };
+	bool success = true;
+
+	for (int32 frame = 0; frame < 3; frame++) {
+		if (frame == 1) {
+			// all tiles of the next frame are sent as cached
+			decoder.Reset();
+		}
+
+		sender.Start(RP_DRAW_BITMAP_TILES);
+		encoder.AddBitmap(sender, bits, kWidth, kHeight, kBytesPerRow,
+			B_RGB32, B_BITMAP_NO_SERVER_LINK);
+		sender.Flush();
+
+		uint16 code;
+		BBitmap* bitmap = NULL;
+		status_t result = receiver.NextMessage(code);
+		if (result == B_OK)
+			result = decoder.ReadBitmap(receiver, &bitmap);
+
+		if ((result == B_OK) != decodes[frame]) {
+			fprintf(stderr, "recovery: frame %" B_PRId32 " was%s decoded: "
+				"%s\n", frame, result == B_OK ? "" : " not",
+				strerror(result));
+			success = false;
+		}
+
+		if (result != B_OK) {
+			decoder.Reset();
+			encoder.SetEnabled(true);
+			continue;
+		}
+
+		if (memcmp(bitmap->Bits(), bits, kBytesPerRow * kHeight) != 0) {
+			fprintf(stderr, "recovery: frame %" B_PRId32 " differs\n", frame);
+			success = false;
+		}
+
+		delete bitmap;
+	}
+
+	printf("%-14s%s\n", "recovery", success ? "ok" : "FAILED");
+	return success;
+}
+
+
+int
+main()
+{
+	srand(42);
+
+	// large enough for a frame that could not be compressed at all
+	StreamingRingBuffer ringBuffer(kBytesPerRow * kHeight * 2);
+	if (ringBuffer.InitCheck() != B_OK) {
+		fprintf(stderr, "could not create the ring buffer\n");
+		return 1;
+	}
+
+	uint8* bits = (uint8*)malloc(kBytesPerRow * kHeight);
+	if (bits == NULL)
+		return 1;
+
+	printf("%" B_PRId32 " frames of %" B_PRId32 "x%" B_PRId32 "\n\n",
+		kFrameCount, kWidth, kHeight);
+	printf("%-14s%10s%10s%9s%9s%9s%9s%10s%10s\n", "frames", "raw MB",
+		"sent MB", "ratio", "cached", "packed", "raw", "enc ms", "dec ms");
+
+	bool success = true;
+	for (int32 kind = 0; kind < FRAMES_COUNT; kind++)
+		success &= run_frames(kind, ringBuffer, bits);
+	success &= run_recovery(ringBuffer, bits);
+
+	free(bits);
+	return success ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Covers a window with another one, and checks that the uncovered parts
+	are restored without asking the client to redraw when the app_server
+	retains window contents, and that an invalidation still reaches the
+	client. The setting is restored afterwards.
+*/
+
+
+#include <stdio.h>
+
+#include <Application.h>
+#include <Bitmap.h>
+#include <Screen.h>
+#include <String.h>
+#include <View.h>
+#include <Window.h>
+
+#include <InterfacePrivate.h>
+
+
+static const rgb_color kContentsColor = { 40, 160, 80, 255 };
+static const bigtime_t kSettleDelay = 500000;
+
+static int32 sErrors;
+
+
+class CountingView : public BView {
+public:
+							CountingView(BRect frame);
+
+	virtual	void			Draw(BRect updateRect);
+
+			int32			DrawCount() const
+								{ return atomic_get(&fDrawCount); }
+
+private:
+	mutable	int32			fDrawCount;
+};
+
+
+class Application : public BApplication {
+public:
+							Application();
+
+	virtual	void			ReadyToRun();
+
+private:
+	static	status_t		_TestThread(void* self);
+};
+
+
+CountingView::CountingView(BRect frame)
+	:
+	BView(frame, "counting", B_FOLLOW_ALL, B_WILL_DRAW),
+	fDrawCount(0)
+{
+	SetViewColor(B_TRANSPARENT_COLOR);
+}
+
+
+void
+CountingView::Draw(BRect updateRect)
+{
+	SetHighColor(kContentsColor);
+	FillRect(updateRect);
+
+	atomic_add(&fDrawCount, 1);
+}
+
+
+//	#pragma mark -
+
+
+static void
+check(bool condition, bool retain, const char* what)
+{
+	if (condition)
+		return;
+
+	fprintf(stderr, "%s contents: %s\n", retain ? "retained" : "no retained",
+		what);
+	sErrors++;
+}
+
+
+static void
+settle(BWindow* window)
+{
+	if (window->Lock()) {
+		window->Sync();
+		window->Unlock();
+	}
+	snooze(kSettleDelay);
+}
+
+
+static bool
+shows_contents(BRect frame)
+{
+	BBitmap* bitmap;
+	if (BScreen().GetBitmap(&bitmap, false, &frame) != B_OK)
+		return false;
+
+	bool matches = true;
+	const uint8* bits = (const uint8*)bitmap->Bits();
+	int32 width = bitmap->Bounds().IntegerWidth() + 1;
+	int32 height = bitmap->Bounds().IntegerHeight() + 1;
+	for (int32 y = 0; y < height && matches; y++) {
+		const uint8* pixel = bits + y * bitmap->BytesPerRow();
+		for (int32 x = 0; x < width; x++, pixel += 4) {
+			if (pixel[0] != kContentsColor.blue
+				|| pixel[1] != kContentsColor.green
+				|| pixel[2] != kContentsColor.red) {
+				matches = false;
+				break;
+			}
+		}
+	}
+
+	delete bitmap;
+	return matches;
+}
+
+
+static void
+test_expose(bool retain)
+{
+	BPrivate::set_retain_window_contents(retain);
+
+	// the setting only applies to windows opened afterwards
+	BWindow* window = new BWindow(BRect(100, 100, 399, 399),
+		"RetainWindowContents-Test", B_TITLED_WINDOW,
+		B_NOT_MOVABLE | B_NOT_RESIZABLE | B_ASYNCHRONOUS_CONTROLS);
+	CountingView* view = new CountingView(window->Bounds());
+	window->AddChild(view);
+	window->Show();
+	settle(window);
+
+	check(view->DrawCount() > 0, retain, "window was never drawn");
+
+	BWindow* cover = new BWindow(BRect(150, 150, 349, 349),
+		"RetainWindowContents-Cover", B_BORDERED_WINDOW_LOOK,
+		B_FLOATING_ALL_WINDOW_FEEL, B_AVOID_FOCUS);
+	cover->Show();
+	settle(cover);
+
+	int32 drawCount = view->DrawCount();
+
+	if (cover->Lock())
+		cover->Quit();
+	settle(window);
+
+	BRect exposed(150, 150, 349, 349);
+	if (retain) {
+		check(view->DrawCount() == drawCount, retain,
+			"uncovered window was redrawn");
+	} else {
+		check(view->DrawCount() > drawCount, retain,
+			"uncovered window was not redrawn");
+	}
+	check(shows_contents(exposed), retain,
+		"uncovered window shows wrong contents");
+
+	// an invalidation must still ask the client to draw
+	drawCount = view->DrawCount();
+	if (window->Lock()) {
+		view->Invalidate();
+		window->Unlock();
+	}
+	settle(window);
+
+	check(view->DrawCount() > drawCount, retain,
+		"invalidated window was not redrawn");
+	check(shows_contents(window->Frame()), retain,
+		"invalidated window shows wrong contents");
+
+	if (window->Lock())
+		window->Quit();
+}
+
+
+//	#pragma mark -
+
+
+Application::Application()
+	:
+	BApplication("application/x-vnd.haiku-retain_window_contents")
+{
+}
+
+
+void
+Application::ReadyToRun()
+{
+	// the windows are synchronized with, so the test cannot run in the
+	// application thread
+	thread_id thread = spawn_thread(&_TestThread, "test", B_NORMAL_PRIORITY,
+		this);
+	if (thread < B_OK || resume_thread(thread) != B_OK) {
+		sErrors++;
+		PostMessage(B_QUIT_REQUESTED);
+	}
+}
+
+
+/*static*/ status_t
+Application::_TestThread(void* self)
+{
+	bool retain = BPrivate::retain_window_contents();
+
+	test_expose(true);
+	test_expose(false);
+
+	BPrivate::set_retain_window_contents(retain);
+
+	((Application*)self)->PostMessage(B_QUIT_REQUESTED);
+	return B_OK;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	Application app;
+	app.Run();
+
+	if (sErrors != 0) {
+		fprintf(stderr, "%ld errors\n", (long)sErrors);
+		return 1;
+	}
+
+	printf("passed\n");
+	return 0;
+}
@@ -0,0 +1,335 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Checks all span blender implementations usable on this CPU against the
+	blending macros of the drawing modes, and compares their speed.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "SpanBlender.h"
+
+
+static const uint32 kMaxTestLength = 67;
+static const uint32 kBenchmarkLength = 1920;
+static const double kBenchmarkTime = 0.2;
+
+
+static uint32
+random_bits()
+{
+	return ((uint32)rand() << 16) ^ (uint32)rand();
+}
+
+
+static double
+current_time()
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+
+static void
+fill_random(uint8* buffer, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+		buffer[i] = (uint8)random_bits();
+}
+
+
+/*!	Fills the covers with runs like those of an anti-aliased shape: empty,
+	fully covered and partially covered ones.
+*/
+static void
+fill_covers(uint8* covers, uint32 count)
+{
+	for (uint32 i = 0; i < count;) {
+		uint32 run = 1 + random_bits() % 12;
+		uint32 kind = random_bits() % 3;
+		for (; run > 0 && i < count; run--, i++) {
+			if (kind == 0)
+				covers[i] = 0;
+			else if (kind == 1)
+				covers[i] = 255;
+			else
+				covers[i] = (uint8)random_bits();
+		}
+	}
+}
+
+
+// #pragma mark - reference
+
+
+// The same as BLEND16 in DrawingMode.h, BLEND is BLEND16 with alpha << 8.
+static void
+reference_blend(uint8* d, const uint8* s, uint32 alpha)
+{
+	d[0] = (((s[0] - d[0]) * (int32)alpha) + (d[0] << 16)) >> 16;
+	d[1] = (((s[1] - d[1]) * (int32)alpha) + (d[1] << 16)) >> 16;
+	d[2] = (((s[2] - d[2]) * (int32)alpha) + (d[2] << 16)) >> 16;
+	d[3] = 255;
+}
+
+
+static void
+reference_assign(uint8* d, const uint8* s)
+{
+	d[0] = s[0];
+	d[1] = s[1];
+	d[2] = s[2];
+	d[3] = 255;
+}
+
+
+static void
+reference_fill(uint8* dst, uint32 count, uint32 color)
+{
+	for (uint32 i = 0; i < count; i++)
+		reference_assign(dst + i * 4, (const uint8*)&color);
+}
+
+
+static void
+reference_blend_span(uint8* dst, uint32 count, uint32 color, uint16 alpha)
+{
+	for (uint32 i = 0; i < count; i++)
+		reference_blend(dst + i * 4, (const uint8*)&color, alpha);
+}
+
+
+static void
+reference_blend_covers(uint8* dst, uint32 count, uint32 color, uint16 scale,
+	uint16 opaque, const uint8* covers)
+{
+	for (uint32 i = 0; i < count; i++) {
+		uint32 alpha = covers[i] * scale;
+		if (alpha == opaque)
+			reference_assign(dst + i * 4, (const uint8*)&color);
+		else if (alpha != 0)
+			reference_blend(dst + i * 4, (const uint8*)&color, alpha);
+	}
+}
+
+
+static void
+reference_blend_colors(uint8* dst, uint32 count, const uint8* colors,
+	const uint8* covers)
+{
+	for (uint32 i = 0; i < count; i++) {
+		const uint8* c = colors + i * 4;
+		uint8 s[4] = { c[2], c[1], c[0], 255 };
+		uint32 alpha = c[3] * covers[i];
+		if (alpha == 255 * 255)
+			reference_assign(dst + i * 4, s);
+		else if (alpha != 0)
+			reference_blend(dst + i * 4, s, alpha);
+	}
+}
+
+
+// #pragma mark - tests
+
+
+struct test_buffers {
+	uint8	original[(kMaxTestLength + 8) * 4];
+	uint8	expected[(kMaxTestLength + 8) * 4];
+	uint8	result[(kMaxTestLength + 8) * 4];
+	uint8	colors[(kMaxTestLength + 8) * 4];
+	uint8	covers[kMaxTestLength + 8];
+};
+
+
+static void
+reset(test_buffers& buffers)
+{
+	memcpy(buffers.expected, buffers.original, sizeof(buffers.original));
+	memcpy(buffers.result, buffers.original, sizeof(buffers.original));
+}
+
+
+static bool
+check(const SpanBlender* blender, const char* function, test_buffers& buffers,
+	uint32 offset, uint32 length)
+{
+	if (memcmp(buffers.expected, buffers.result, sizeof(buffers.result)) == 0)
+		return true;
+
+	for (uint32 i = 0; i < sizeof(buffers.result); i++) {
+		if (buffers.expected[i] == buffers.result[i])
+			continue;
+
+		fprintf(stderr, "%s: %s() differs at pixel %" B_PRIu32 " (offset %"
+			B_PRIu32 ", length %" B_PRIu32 "), channel %" B_PRIu32
+			": %u instead of %u\n", blender->name, function, i / 4 - offset,
+			offset, length, i % 4, buffers.result[i], buffers.expected[i]);
+		break;
+	}
+	return false;
+}
+
+
+static bool
+test_implementation(const SpanBlender* blender)
+{
+	test_buffers buffers;
+	bool success = true;
+
+	for (uint32 round = 0; round < 64; round++) {
+		for (uint32 length = 0; length <= kMaxTestLength; length++) {
+			uint32 offset = random_bits() % 8;
+			fill_random(buffers.original, sizeof(buffers.original));
+			fill_random(buffers.colors, sizeof(buffers.colors));
+			fill_covers(buffers.covers, sizeof(buffers.covers));
+
+			uint8* expected = buffers.expected + offset * 4;
+			uint8* result = buffers.result + offset * 4;
+			const uint8* colors = buffers.colors + offset * 4;
+			const uint8* covers = buffers.covers + offset;
+			uint32 color = random_bits() | 0xff000000;
+
+			// alpha values of BLEND (cover << 8) and BLEND16 (alpha * cover)
+			uint16 alpha = random_bits() % 2 == 0
+				? (random_bits() % 256) << 8 : random_bits() % 65025;
+			uint16 scale = 256;
+			uint16 opaque = 255 * 256;
+			if (random_bits() % 2 == 0) {
+				scale = random_bits() % 256;
+				opaque = 255 * 255;
+			}
+
+			reset(buffers);
+			reference_fill(expected, length, color);
+			blender->Fill(result, length, color);
+			success &= check(blender, "Fill", buffers, offset, length);
+
+			reset(buffers);
+			reference_blend_span(expected, length, color, alpha);
+			blender->Blend(result, length, color, alpha);
+			success &= check(blender, "Blend", buffers, offset, length);
+
+			reset(buffers);
+			reference_blend_covers(expected, length, color, scale, opaque,
+				covers);
+			blender->BlendCovers(result, length, color, scale, opaque, covers);
+			success &= check(blender, "BlendCovers", buffers, offset, length);
+
+			reset(buffers);
+			reference_blend_colors(expected, length, colors, covers);
+			blender->BlendColors(result, length, colors, covers);
+			success &= check(blender, "BlendColors", buffers, offset, length);
+
+			if (!success)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
+// #pragma mark - benchmark
+
+
+struct benchmark_buffers {
+	uint8	dst[kBenchmarkLength * 4];
+	uint8	colors[kBenchmarkLength * 4];
+	uint8	covers[kBenchmarkLength];
+};
+
+
+static void
+run_operation(const SpanBlender* blender, int operation,
+	benchmark_buffers& buffers)
+{
+	uint32 color = 0xff3080c0;
+	switch (operation) {
+		case 0:
+			blender->Fill(buffers.dst, kBenchmarkLength, color);
+			break;
+		case 1:
+			blender->Blend(buffers.dst, kBenchmarkLength, color, 128 << 8);
+			break;
+		case 2:
+			blender->BlendCovers(buffers.dst, kBenchmarkLength, color, 256,
+				255 * 256, buffers.covers);
+			break;
+		case 3:
+			blender->BlendCovers(buffers.dst, kBenchmarkLength, color, 160,
+				255 * 255, buffers.covers);
+			break;
+		case 4:
+			blender->BlendColors(buffers.dst, kBenchmarkLength,
+				buffers.colors, buffers.covers);
+			break;
+	}
+}
+
+
+static void
+benchmark(benchmark_buffers& buffers)
+{
+	static const char* kOperations[] = {
+		"fill", "blend", "covers (copy/over)", "covers (alpha)",
+		"colors (alpha)"
+	};
+	static const int kOperationCount = 5;
+
+	printf("%-20s", "Mpixels/s");
+	for (int32 i = 0; SpanBlender::ImplementationAt(i) != NULL; i++)
+		printf("%10s", SpanBlender::ImplementationAt(i)->name);
+	printf("\n");
+
+	for (int operation = 0; operation < kOperationCount; operation++) {
+		printf("%-20s", kOperations[operation]);
+		for (int32 i = 0; SpanBlender::ImplementationAt(i) != NULL; i++) {
+			const SpanBlender* blender = SpanBlender::ImplementationAt(i);
+			fill_random(buffers.dst, sizeof(buffers.dst));
+
+			uint64 rows = 0;
+			double start = current_time();
+			double elapsed;
+			do {
+				for (int row = 0; row < 64; row++)
+					run_operation(blender, operation, buffers);
+				rows += 64;
+				elapsed = current_time() - start;
+			} while (elapsed < kBenchmarkTime);
+
+			printf("%10.1f", rows * kBenchmarkLength / elapsed / 1000000.0);
+		}
+		printf("\n");
+	}
+}
+
+
+int
+main()
+{
+	srand(42);
+
+	bool success = true;
+	for (int32 i = 0; SpanBlender::ImplementationAt(i) != NULL; i++) {
+		const SpanBlender* blender = SpanBlender::ImplementationAt(i);
+		bool passed = test_implementation(blender);
+		printf("%s: %s\n", blender->name, passed ? "ok" : "FAILED");
+		success &= passed;
+	}
+	printf("default: %s\n\n", SpanBlender::Default()->name);
+
+	benchmark_buffers* buffers = new benchmark_buffers;
+	fill_random(buffers->colors, sizeof(buffers->colors));
+	fill_covers(buffers->covers, sizeof(buffers->covers));
+	benchmark(*buffers);
+	delete buffers;
+
+	return success ? 0 : 1;
+}
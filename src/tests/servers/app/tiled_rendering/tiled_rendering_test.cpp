@@ -0,0 +1,285 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+/*!	Renders solid and gradient paths, and rectangle fills, once in one go
+	like the Painter does without tiles, and once split into tiles by the
+	TileRenderer, and verifies that both results are identical.
+*/
+
+
+#include <math.h>
+#include <stdio.h>
+
+#include <Region.h>
+
+#include <agg_ellipse.h>
+#include <agg_path_storage.h>
+
+#include "PatternHandler.h"
+#include "TileRenderer.h"
+
+
+static const int32 kWidth = 640;
+static const int32 kHeight = 480;
+static const int32 kTileCounts[] = { 2, 3, 7, 16, 61 };
+
+static int32 sErrors;
+
+
+class Canvas {
+public:
+	Canvas(const BRegion& clipping)
+		:
+		fBits(new uint8[kWidth * kHeight * 4]),
+		fBuffer(fBits, kWidth, kHeight, kWidth * 4),
+		fClipping(clipping),
+		fPixelFormat(fBuffer, &fPatternHandler),
+		fBaseRenderer(fPixelFormat)
+	{
+		Clear();
+
+		fPixelFormat.SetDrawingMode(B_OP_ALPHA, B_PIXEL_ALPHA,
+			B_ALPHA_OVERLAY);
+		fBaseRenderer.set_clipping_region(&fClipping);
+	}
+
+	~Canvas()
+	{
+		delete[] fBits;
+	}
+
+	void Clear()
+	{
+		// a background that shows any difference in blending
+		for (int32 i = 0; i < kWidth * kHeight * 4; i++)
+			fBits[i] = (uint8)(i * 7 + i / (kWidth * 4));
+	}
+
+	const uint8* Bits() const { return fBits; }
+	agg::rendering_buffer& Buffer() { return fBuffer; }
+	renderer_base& BaseRenderer() { return fBaseRenderer; }
+	clipping_rect ClipBox() const { return fClipping.FrameInt(); }
+
+private:
+	uint8*					fBits;
+	agg::rendering_buffer	fBuffer;
+	BRegion					fClipping;
+	PatternHandler			fPatternHandler;
+	pixfmt					fPixelFormat;
+	renderer_base			fBaseRenderer;
+};
+
+
+class PatternRectFiller : public RectTileJob {
+public:
+	PatternRectFiller(Canvas& canvas, int32 left, int32 top, int32 right,
+		int32 bottom)
+		:
+		RectTileJob(canvas.BaseRenderer(), canvas.Buffer(), left, top, right,
+			bottom)
+	{
+	}
+
+protected:
+	virtual void FillRow(uint8* bits, int32 y, int32 width)
+	{
+		for (int32 x = 0; x < width; x++) {
+			bits[x * 4 + 0] = (uint8)(x + y);
+			bits[x * 4 + 1] = (uint8)y;
+			bits[x * 4 + 2] = (uint8)(x * 3);
+			bits[x * 4 + 3] = 255;
+		}
+	}
+};
+
+
+static void
+compare(const char* test, int32 tileCount, const Canvas& serial,
+	const Canvas& tiled)
+{
+	const uint8* a = serial.Bits();
+	const uint8* b = tiled.Bits();
+
+	for (int32 i = 0; i < kWidth * kHeight * 4; i++) {
+		if (a[i] == b[i])
+			continue;
+
+		int32 pixel = i / 4;
+		fprintf(stderr, "%s, %ld tiles: pixel %ld,%ld differs\n", test,
+			(long)tileCount, (long)(pixel % kWidth), (long)(pixel / kWidth));
+		sErrors++;
+		return;
+	}
+}
+
+
+static void
+make_star(agg::path_storage& path)
+{
+	// a self-intersecting star, so that the filling rule matters
+	const int32 points = 11;
+	for (int32 i = 0; i < points; i++) {
+		double angle = i * 4 * M_PI / points;
+		double x = kWidth / 2 + cos(angle) * kWidth * 0.6;
+		double y = kHeight / 2 + sin(angle) * kHeight * 0.6;
+		if (i == 0)
+			path.move_to(x, y);
+		else
+			path.line_to(x, y);
+	}
+	path.close_polygon();
+
+	agg::ellipse ellipse(kWidth / 3, kHeight / 3, kWidth / 4, kHeight / 5, 64);
+	path.concat_path(ellipse);
+}
+
+
+static void
+render_serial(Canvas& canvas, agg::path_storage& path,
+	agg::filling_rule_e fillingRule, const agg::rgba8& color)
+{
+	clipping_rect clipBox = canvas.ClipBox();
+
+	rasterizer_type rasterizer;
+#if ALIASED_DRAWING
+	rasterizer.gamma(agg::gamma_threshold(0.5));
+#endif
+	rasterizer.clip_box(clipBox.left, clipBox.top, clipBox.right + 1,
+		clipBox.bottom + 1);
+	rasterizer.filling_rule(fillingRule);
+	rasterizer.add_path(path);
+
+	renderer_type renderer(canvas.BaseRenderer());
+	renderer.color(color);
+	scanline_packed_type scanline;
+	agg::render_scanlines(rasterizer, scanline, renderer);
+}
+
+
+static void
+test_solid_path(WorkerPool& pool, const BRegion& clipping,
+	agg::filling_rule_e fillingRule)
+{
+	const char* name = fillingRule == agg::fill_non_zero
+		? "solid path, non-zero" : "solid path, even-odd";
+	agg::rgba8 color(200, 40, 90, 170);
+
+	agg::path_storage path;
+	make_star(path);
+
+	Canvas serial(clipping);
+	render_serial(serial, path, fillingRule, color);
+
+	for (uint32 i = 0; i < B_COUNT_OF(kTileCounts); i++) {
+		Canvas tiled(clipping);
+		PathTileJob<SolidTile> job(path, tiled.ClipBox(), fillingRule,
+			tiled.BaseRenderer(), color);
+		pool.Execute(job, kTileCounts[i]);
+
+		compare(name, kTileCounts[i], serial, tiled);
+	}
+}
+
+
+static void
+test_gradient_path(WorkerPool& pool, const BRegion& clipping)
+{
+	typedef GradientTile<agg::gradient_x> tile_type;
+
+	agg::path_storage path;
+	make_star(path);
+
+	agg::gradient_x function;
+	tile_type::color_array_type colors;
+	for (int32 i = 0; i < 256; i++)
+		colors[i] = agg::rgba8(i, 255 - i, (i * 5) & 0xff, 128 + i / 2);
+
+	agg::trans_affine transform;
+	transform.translate(-kWidth / 4, 0);
+	transform.scale(100.0 / kWidth);
+
+	tile_type::setup_type setup;
+	setup.transform = &transform;
+	setup.function = &function;
+	setup.colors = &colors;
+	setup.stop = 100;
+
+	// the serial path renders the scanlines the same way a tile does
+	Canvas serial(clipping);
+	{
+		clipping_rect clipBox = serial.ClipBox();
+		rasterizer_type rasterizer;
+		rasterizer.clip_box(clipBox.left, clipBox.top, clipBox.right + 1,
+			clipBox.bottom + 1);
+		rasterizer.add_path(path);
+
+		tile_type::interpolator_type interpolator(transform);
+		tile_type::span_allocator_type allocator;
+		tile_type::span_gradient_type spanGradient(interpolator, function,
+			colors, 0, setup.stop);
+		tile_type::renderer_gradient_type renderer(serial.BaseRenderer(),
+			allocator, spanGradient);
+		scanline_unpacked_type scanline;
+		agg::render_scanlines(rasterizer, scanline, renderer);
+	}
+
+	for (uint32 i = 0; i < B_COUNT_OF(kTileCounts); i++) {
+		Canvas tiled(clipping);
+		PathTileJob<tile_type> job(path, tiled.ClipBox(), agg::fill_non_zero,
+			tiled.BaseRenderer(), setup);
+		pool.Execute(job, kTileCounts[i]);
+
+		compare("gradient path", kTileCounts[i], serial, tiled);
+	}
+}
+
+
+static void
+test_rect(WorkerPool& pool, const BRegion& clipping)
+{
+	Canvas serial(clipping);
+	PatternRectFiller serialFiller(serial, 10, 5, kWidth - 20, kHeight - 3);
+	serialFiller.Fill(serial.BaseRenderer());
+
+	for (uint32 i = 0; i < B_COUNT_OF(kTileCounts); i++) {
+		Canvas tiled(clipping);
+		PatternRectFiller filler(tiled, 10, 5, kWidth - 20, kHeight - 3);
+		pool.Execute(filler, kTileCounts[i]);
+
+		compare("rect", kTileCounts[i], serial, tiled);
+	}
+}
+
+
+int
+main(int argc, char** argv)
+{
+	// a clipping region with several rectangles, and holes in it
+	BRegion clipping;
+	clipping.Include(BRect(0, 0, kWidth - 1, kHeight / 3));
+	clipping.Include(BRect(20, kHeight / 3 + 5, kWidth / 2, kHeight - 40));
+	clipping.Include(BRect(kWidth / 2 + 7, kHeight / 2, kWidth - 1,
+		kHeight - 1));
+
+	BRegion full(BRect(0, 0, kWidth - 1, kHeight - 1));
+
+	WorkerPool pool(3);
+
+	const BRegion* regions[] = { &full, &clipping };
+	for (uint32 i = 0; i < B_COUNT_OF(regions); i++) {
+		test_solid_path(pool, *regions[i], agg::fill_non_zero);
+		test_solid_path(pool, *regions[i], agg::fill_even_odd);
+		test_gradient_path(pool, *regions[i]);
+		test_rect(pool, *regions[i]);
+	}
+
+	if (sErrors != 0) {
+		fprintf(stderr, "%ld errors\n", (long)sErrors);
+		return 1;
+	}
+
+	printf("passed\n");
+	return 0;
+}
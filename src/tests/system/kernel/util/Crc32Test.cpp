@@ -0,0 +1,190 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "Crc32Test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cppunit/TestAssert.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+
+#include <OS.h>
+
+#include <util/crc32.h>
+
+
+typedef uint32 (*crc_function)(uint32 crc, const void* buffer, size_t length,
+	crc_implementation implementation);
+
+
+static const size_t kBufferSize = 64 * 1024;
+
+
+static uint8*
+create_random_buffer(size_t size)
+{
+	uint8* buffer = (uint8*)malloc(size);
+	CPPUNIT_ASSERT(buffer != NULL);
+
+	srand(42);
+	for (size_t i = 0; i < size; i++)
+		buffer[i] = rand();
+
+	return buffer;
+}
+
+
+/*!	Compares all implementations to the byte-wise one for all alignments,
+	and for lengths around the block sizes the hardware versions use.
+*/
+static void
+compare_implementations(crc_function function, const uint8* buffer)
+{
+	for (size_t offset = 0; offset < 16; offset++) {
+		for (size_t length = 0; length < 5000;
+				length += length < 300 ? 1 : 37) {
+			uint32 expected = function(0x12345678, buffer + offset, length,
+				CRC_IMPLEMENTATION_BYTEWISE);
+
+			CPPUNIT_ASSERT_EQUAL(expected, function(0x12345678,
+				buffer + offset, length, CRC_IMPLEMENTATION_SLICING_BY_8));
+			CPPUNIT_ASSERT_EQUAL(expected, function(0x12345678,
+				buffer + offset, length, CRC_IMPLEMENTATION_HARDWARE));
+			CPPUNIT_ASSERT_EQUAL(expected, function(0x12345678,
+				buffer + offset, length, CRC_IMPLEMENTATION_DEFAULT));
+		}
+	}
+}
+
+
+static void
+benchmark(const char* name, crc_function function, const uint8* buffer,
+	size_t length)
+{
+	static const char* const kImplementations[] = {
+		"default", "byte-wise", "slicing-by-8", "hardware"
+	};
+	static const int kRounds = 2000;
+
+	for (int implementation = CRC_IMPLEMENTATION_DEFAULT;
+			implementation <= CRC_IMPLEMENTATION_HARDWARE; implementation++) {
+		uint32 crc = 0;
+		bigtime_t start = system_time();
+		for (int round = 0; round < kRounds; round++) {
+			crc = function(crc, buffer, length,
+				(crc_implementation)implementation);
+		}
+		bigtime_t duration = max_c(system_time() - start, 1);
+
+		printf("\n  %s, %6zu bytes, %-12s %8.1f MB/s", name, length,
+			kImplementations[implementation],
+			(double)kRounds * length / duration);
+	}
+}
+
+
+// #pragma mark -
+
+
+Crc32Test::Crc32Test(std::string name)
+	:
+	BTestCase(name)
+{
+}
+
+
+CppUnit::Test*
+Crc32Test::Suite()
+{
+	CppUnit::TestSuite* suite = new CppUnit::TestSuite("Crc32");
+
+	suite->addTest(new CppUnit::TestCaller<Crc32Test>(
+		"Crc32::CheckValue test", &Crc32Test::CheckValueTest));
+	suite->addTest(new CppUnit::TestCaller<Crc32Test>(
+		"Crc32::Implementations test", &Crc32Test::ImplementationsTest));
+	suite->addTest(new CppUnit::TestCaller<Crc32Test>(
+		"Crc32::Incremental test", &Crc32Test::IncrementalTest));
+	suite->addTest(new CppUnit::TestCaller<Crc32Test>(
+		"Crc32::Benchmark test", &Crc32Test::BenchmarkTest));
+
+	return suite;
+}
+
+
+void
+Crc32Test::CheckValueTest()
+{
+	// the standard check values of both algorithms
+	const char* data = "123456789";
+
+	CPPUNIT_ASSERT_EQUAL((uint32)0xcbf43926,
+		~calculate_crc32(~(uint32)0, data, 9));
+	CPPUNIT_ASSERT_EQUAL((uint32)0xe3069283,
+		~calculate_crc32c(~(uint32)0, data, 9));
+
+	// iSCSI test vector from RFC 3720, B.4
+	uint8 zeros[32] = {};
+	CPPUNIT_ASSERT_EQUAL((uint32)0x8a9136aa,
+		~calculate_crc32c(~(uint32)0, zeros, sizeof(zeros)));
+
+	CPPUNIT_ASSERT_EQUAL((uint32)0x12345678,
+		calculate_crc32c(0x12345678, data, 0));
+}
+
+
+void
+Crc32Test::ImplementationsTest()
+{
+	uint8* buffer = create_random_buffer(kBufferSize);
+
+	compare_implementations(&calculate_crc32_etc, buffer);
+	compare_implementations(&calculate_crc32c_etc, buffer);
+
+	free(buffer);
+}
+
+
+void
+Crc32Test::IncrementalTest()
+{
+	uint8* buffer = create_random_buffer(kBufferSize);
+
+	uint32 crc32 = calculate_crc32(~(uint32)0, buffer, kBufferSize);
+	uint32 crc32c = calculate_crc32c(~(uint32)0, buffer, kBufferSize);
+
+	for (size_t split = 1; split < kBufferSize; split = split * 3 + 1) {
+		uint32 crc = calculate_crc32(~(uint32)0, buffer, split);
+		CPPUNIT_ASSERT_EQUAL(crc32, calculate_crc32(crc, buffer + split,
+			kBufferSize - split));
+
+		crc = calculate_crc32c(~(uint32)0, buffer, split);
+		CPPUNIT_ASSERT_EQUAL(crc32c, calculate_crc32c(crc, buffer + split,
+			kBufferSize - split));
+	}
+
+	free(buffer);
+}
+
+
+void
+Crc32Test::BenchmarkTest()
+{
+	uint8* buffer = create_random_buffer(kBufferSize);
+
+	printf("\n  hardware support: CRC-32 %s, CRC-32C %s",
+		crc32_has_hardware_support() ? "yes" : "no",
+		crc32c_has_hardware_support() ? "yes" : "no");
+
+	benchmark("CRC-32 ", &calculate_crc32_etc, buffer, 4096);
+	benchmark("CRC-32 ", &calculate_crc32_etc, buffer, kBufferSize);
+	benchmark("CRC-32C", &calculate_crc32c_etc, buffer, 4096);
+	benchmark("CRC-32C", &calculate_crc32c_etc, buffer, kBufferSize);
+	printf("\n");
+
+	free(buffer);
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef CRC32_TEST_H
+#define CRC32_TEST_H
+
+
+#include <TestCase.h>
+
+
+class Crc32Test : public BTestCase {
+public:
+	Crc32Test(std::string name = "");
+
+	void CheckValueTest();
+	void ImplementationsTest();
+	void IncrementalTest();
+	void BenchmarkTest();
+
+	static CppUnit::Test* Suite();
+};
+
+
+#endif // CRC32_TEST_H
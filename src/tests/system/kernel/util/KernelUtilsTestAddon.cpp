@@ -4,6 +4,7 @@
 //#include "AVLTreeMapTest.h"
 #include "BOpenHashTableTest.h"
 #include "BitmapTest.h"
+#include "Crc32Test.h"
 #include "DoublyLinkedListTest.h"
 #include "SinglyLinkedListTest.h"
 #include "VectorMapTest.h"
@@ -16,6 +17,7 @@ BTestSuite* getTestSuite() {
 //	suite->addTest("AVLTreeMap", AVLTreeMapTest::Suite());
 	suite->addTest("BOpenHashTable", BOpenHashTableTest::Suite());
 	suite->addTest("Bitmap", BitmapTest::Suite());
+	suite->addTest("Crc32", Crc32Test::Suite());
 	suite->addTest("SinglyLinkedList", SinglyLinkedListTest::Suite());
 	suite->addTest("DoublyLinkedList", DoublyLinkedListTest::Suite());
 	suite->addTest("VectorMap", VectorMapTest::Suite());
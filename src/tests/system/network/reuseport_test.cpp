@@ -0,0 +1,279 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Binds several TCP listeners and UDP sockets to the same port with
+	SO_REUSEPORT, and checks that connections and datagrams from different
+	source ports are spread among them, while each flow sticks to one socket.
+	Also checks that a user other than root can still add a listener to the
+	port once connections were accepted on it.
+*/
+
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+static const int kSocketCount = 4;
+static const int kFlowCount = 64;
+static const uid_t kTestUser = 1000;
+
+
+static void
+fail(const char* what)
+{
+	fprintf(stderr, "%s: %s\n", what, strerror(errno));
+	exit(1);
+}
+
+
+static int
+open_shared_socket(int type, sockaddr_in& address)
+{
+	int fd = socket(AF_INET, type, 0);
+	if (fd < 0)
+		fail("socket");
+
+	int enable = 1;
+	if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable))
+			!= 0) {
+		fail("setsockopt(SO_REUSEPORT)");
+	}
+
+	if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0)
+		fail("bind");
+
+	socklen_t length = sizeof(address);
+	if (getsockname(fd, (sockaddr*)&address, &length) != 0)
+		fail("getsockname");
+
+	return fd;
+}
+
+
+/*!	Returns the index of the socket in \a fds that has something to read,
+	or -1 if none of them has.
+*/
+static int
+ready_socket(const int* fds)
+{
+	pollfd pollFDs[kSocketCount];
+	for (int i = 0; i < kSocketCount; i++) {
+		pollFDs[i].fd = fds[i];
+		pollFDs[i].events = POLLIN;
+		pollFDs[i].revents = 0;
+	}
+
+	if (poll(pollFDs, kSocketCount, 1000) <= 0)
+		return -1;
+
+	for (int i = 0; i < kSocketCount; i++) {
+		if ((pollFDs[i].revents & POLLIN) != 0)
+			return i;
+	}
+	return -1;
+}
+
+
+static int
+check_distribution(const char* name, const int* counts)
+{
+	int used = 0;
+	for (int i = 0; i < kSocketCount; i++) {
+		printf("  %s socket %d: %d\n", name, i, counts[i]);
+		if (counts[i] > 0)
+			used++;
+	}
+
+	if (used < 2) {
+		fprintf(stderr, "%s: all flows went to a single socket\n", name);
+		return 1;
+	}
+
+	printf("%s: ok\n", name);
+	return 0;
+}
+
+
+static int
+tcp_test()
+{
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_len = sizeof(address);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	int listeners[kSocketCount];
+	for (int i = 0; i < kSocketCount; i++) {
+		listeners[i] = open_shared_socket(SOCK_STREAM, address);
+		if (listen(listeners[i], kFlowCount) != 0)
+			fail("listen");
+	}
+
+	// a socket without SO_REUSEPORT must not be able to join the group
+	int intruder = socket(AF_INET, SOCK_STREAM, 0);
+	if (bind(intruder, (sockaddr*)&address, sizeof(address)) == 0) {
+		fprintf(stderr, "TCP: could bind without SO_REUSEPORT\n");
+		return 1;
+	}
+	close(intruder);
+
+	int counts[kSocketCount] = {};
+	for (int flow = 0; flow < kFlowCount; flow++) {
+		int client = socket(AF_INET, SOCK_STREAM, 0);
+		if (connect(client, (sockaddr*)&address, sizeof(address)) != 0)
+			fail("connect");
+
+		int index = ready_socket(listeners);
+		if (index < 0) {
+			fprintf(stderr, "TCP: connection %d was not accepted\n", flow);
+			return 1;
+		}
+
+		int connection = accept(listeners[index], NULL, NULL);
+		if (connection < 0)
+			fail("accept");
+
+		counts[index]++;
+		close(connection);
+		close(client);
+	}
+
+	for (int i = 0; i < kSocketCount; i++)
+		close(listeners[i]);
+
+	return check_distribution("TCP", counts);
+}
+
+
+static int
+udp_test()
+{
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_len = sizeof(address);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	int receivers[kSocketCount];
+	for (int i = 0; i < kSocketCount; i++)
+		receivers[i] = open_shared_socket(SOCK_DGRAM, address);
+
+	int counts[kSocketCount] = {};
+	for (int flow = 0; flow < kFlowCount; flow++) {
+		int sender = socket(AF_INET, SOCK_DGRAM, 0);
+		if (sender < 0)
+			fail("socket");
+
+		// every datagram of a flow must arrive at the same socket
+		int first = -1;
+		for (int i = 0; i < 4; i++) {
+			if (sendto(sender, &flow, sizeof(flow), 0, (sockaddr*)&address,
+					sizeof(address)) != sizeof(flow)) {
+				fail("sendto");
+			}
+
+			int index = ready_socket(receivers);
+			if (index < 0) {
+				fprintf(stderr, "UDP: datagram of flow %d got lost\n", flow);
+				return 1;
+			}
+
+			int data;
+			if (recv(receivers[index], &data, sizeof(data), 0) != sizeof(data))
+				fail("recv");
+
+			if (first < 0)
+				first = index;
+			else if (first != index) {
+				fprintf(stderr, "UDP: flow %d moved from socket %d to %d\n",
+					flow, first, index);
+				return 1;
+			}
+		}
+
+		counts[first]++;
+		close(sender);
+	}
+
+	for (int i = 0; i < kSocketCount; i++)
+		close(receivers[i]);
+
+	return check_distribution("UDP", counts);
+}
+
+
+/*!	Connections are created by the kernel, but must belong to the user of
+	their listener, or they would keep that user from binding another
+	listener to the port.
+*/
+static int
+owner_test()
+{
+	uid_t user = geteuid();
+	if (user == 0 && seteuid(kTestUser) != 0)
+		fail("seteuid");
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_len = sizeof(address);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	int listener = open_shared_socket(SOCK_STREAM, address);
+	if (listen(listener, 1) != 0)
+		fail("listen");
+
+	int client = socket(AF_INET, SOCK_STREAM, 0);
+	if (connect(client, (sockaddr*)&address, sizeof(address)) != 0)
+		fail("connect");
+
+	int connection = accept(listener, NULL, NULL);
+	if (connection < 0)
+		fail("accept");
+
+	// the connection is still open when the second listener joins
+	int result = 0;
+	int second = socket(AF_INET, SOCK_STREAM, 0);
+	int enable = 1;
+	if (setsockopt(second, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable))
+			!= 0) {
+		fail("setsockopt(SO_REUSEPORT)");
+	}
+	if (bind(second, (sockaddr*)&address, sizeof(address)) != 0
+		|| listen(second, 1) != 0) {
+		fprintf(stderr, "owner: could not share the port as user %u with a "
+			"live connection: %s\n", (unsigned)geteuid(), strerror(errno));
+		result = 1;
+	} else
+		printf("owner: ok\n");
+
+	close(second);
+	close(connection);
+	close(client);
+	close(listener);
+
+	if (user == 0 && seteuid(0) != 0)
+		fail("seteuid");
+
+	return result;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	if (tcp_test() != 0 || udp_test() != 0 || owner_test() != 0)
+		return 1;
+
+	return 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Serves a file over a loopback TCP connection, once by bouncing it
+	through a userland buffer with read() and write(), and once with
+	sendfile(), and compares the throughput of both.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+
+static const size_t kDefaultFileSize = 64 * 1024 * 1024;
+static const size_t kBufferSize = 64 * 1024;
+static const int kRounds = 4;
+
+
+struct client_data {
+	int		socket;
+	off_t	received;
+};
+
+
+static void
+fail(const char* what)
+{
+	fprintf(stderr, "%s: %s\n", what, strerror(errno));
+	exit(1);
+}
+
+
+static void*
+client_thread(void* _data)
+{
+	client_data* data = (client_data*)_data;
+	char buffer[kBufferSize];
+
+	while (true) {
+		ssize_t bytesRead = recv(data->socket, buffer, sizeof(buffer), 0);
+		if (bytesRead <= 0)
+			break;
+
+		data->received += bytesRead;
+	}
+
+	return NULL;
+}
+
+
+static void
+connect_loopback(int listener, int& serverSocket, int& clientSocket)
+{
+	sockaddr_in address;
+	socklen_t addressLength = sizeof(address);
+	if (getsockname(listener, (sockaddr*)&address, &addressLength) != 0)
+		fail("getsockname");
+
+	clientSocket = socket(AF_INET, SOCK_STREAM, 0);
+	if (clientSocket < 0)
+		fail("socket");
+	if (connect(clientSocket, (sockaddr*)&address, addressLength) != 0)
+		fail("connect");
+
+	serverSocket = accept(listener, NULL, NULL);
+	if (serverSocket < 0)
+		fail("accept");
+}
+
+
+static bool
+serve_file(int listener, int file, off_t fileSize, bool useSendfile)
+{
+	int serverSocket;
+	client_data client = {};
+	connect_loopback(listener, serverSocket, client.socket);
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, &client_thread, &client);
+
+	bigtime_t start = system_time();
+
+	off_t sent = 0;
+	if (useSendfile) {
+		off_t offset = 0;
+		while (offset < fileSize) {
+			ssize_t bytesSent = sendfile(serverSocket, file, &offset,
+				fileSize - offset);
+			if (bytesSent <= 0)
+				fail("sendfile");
+		}
+		sent = offset;
+	} else {
+		char* buffer = (char*)malloc(kBufferSize);
+		while (sent < fileSize) {
+			ssize_t bytesRead = pread(file, buffer, kBufferSize, sent);
+			if (bytesRead <= 0)
+				fail("read");
+
+			for (ssize_t written = 0; written < bytesRead;) {
+				ssize_t bytesWritten = write(serverSocket, buffer + written,
+					bytesRead - written);
+				if (bytesWritten <= 0)
+					fail("write");
+				written += bytesWritten;
+			}
+			sent += bytesRead;
+		}
+		free(buffer);
+	}
+
+	close(serverSocket);
+	pthread_join(thread, NULL);
+	close(client.socket);
+
+	bigtime_t elapsed = system_time() - start;
+
+	printf("  %-10s %8.1f MB/s\n", useSendfile ? "sendfile" : "read/write",
+		sent / (elapsed / 1000000.0) / (1024 * 1024));
+	return client.received == sent;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	size_t fileSize = kDefaultFileSize;
+	if (argc > 1)
+		fileSize = strtoul(argv[1], NULL, 0) * 1024 * 1024;
+
+	// create the file to be served; it will be in the file cache afterwards
+	char path[] = "/tmp/sendfile_benchmark-XXXXXX";
+	int file = mkstemp(path);
+	if (file < 0)
+		fail("mkstemp");
+	unlink(path);
+
+	char* buffer = (char*)malloc(kBufferSize);
+	for (size_t offset = 0; offset < fileSize; offset += kBufferSize) {
+		for (size_t i = 0; i < kBufferSize; i++)
+			buffer[i] = (char)(offset + i);
+		if (write(file, buffer, kBufferSize) != (ssize_t)kBufferSize)
+			fail("write file");
+	}
+	free(buffer);
+
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	if (listener < 0)
+		fail("socket");
+
+	sockaddr_in address = {};
+	address.sin_len = sizeof(address);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0)
+		fail("bind");
+	if (listen(listener, 1) != 0)
+		fail("listen");
+
+	printf("serving %zu MB over loopback:\n", fileSize / (1024 * 1024));
+
+	bool success = true;
+	for (int round = 0; round < kRounds; round++) {
+		success &= serve_file(listener, file, fileSize, false);
+		success &= serve_file(listener, file, fileSize, true);
+	}
+
+	close(listener);
+	close(file);
+
+	if (!success) {
+		fprintf(stderr, "the client did not receive all data!\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,301 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Tests sendmmsg() and recvmmsg() over a loopback UDP connection, as well as
+	the coalescing of received datagrams via the UDP_GRO option, and
+	compares the datagram rate of batched and single calls.
+*/
+
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+
+static const int kBatchSize = 32;
+static const size_t kDatagramSize = 64;
+static const int kBenchmarkDatagrams = 200000;
+
+
+static void
+fail(const char* what)
+{
+	fprintf(stderr, "%s: %s\n", what, strerror(errno));
+	exit(1);
+}
+
+
+static int
+open_socket(sockaddr_in& address)
+{
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0)
+		fail("socket");
+
+	memset(&address, 0, sizeof(address));
+	address.sin_len = sizeof(address);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0)
+		fail("bind");
+
+	socklen_t length = sizeof(address);
+	if (getsockname(fd, (sockaddr*)&address, &length) != 0)
+		fail("getsockname");
+
+	return fd;
+}
+
+
+static void
+fill_datagram(char* buffer, int index)
+{
+	memset(buffer, 'a' + index % 26, kDatagramSize);
+	memcpy(buffer, &index, sizeof(int));
+}
+
+
+static int
+batch_test(int sender, int receiver, const sockaddr_in& address)
+{
+	char buffers[kBatchSize][kDatagramSize];
+	iovec vecs[kBatchSize];
+	mmsghdr messages[kBatchSize];
+	memset(messages, 0, sizeof(messages));
+
+	for (int i = 0; i < kBatchSize; i++) {
+		fill_datagram(buffers[i], i);
+		vecs[i].iov_base = buffers[i];
+		vecs[i].iov_len = kDatagramSize;
+		messages[i].msg_hdr.msg_name = (void*)&address;
+		messages[i].msg_hdr.msg_namelen = sizeof(address);
+		messages[i].msg_hdr.msg_iov = &vecs[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	ssize_t sent = sendmmsg(sender, messages, kBatchSize, 0);
+	if (sent != kBatchSize) {
+		fprintf(stderr, "sendmmsg() sent %zd of %d messages: %s\n", sent,
+			kBatchSize, strerror(errno));
+		return 1;
+	}
+	for (int i = 0; i < kBatchSize; i++) {
+		if (messages[i].msg_len != kDatagramSize) {
+			fprintf(stderr, "sendmmsg() reported %u bytes for message %d\n",
+				messages[i].msg_len, i);
+			return 1;
+		}
+	}
+
+	memset(buffers, 0, sizeof(buffers));
+	memset(messages, 0, sizeof(messages));
+	sockaddr_in sources[kBatchSize];
+	for (int i = 0; i < kBatchSize; i++) {
+		messages[i].msg_hdr.msg_name = &sources[i];
+		messages[i].msg_hdr.msg_namelen = sizeof(sources[i]);
+		messages[i].msg_hdr.msg_iov = &vecs[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	int received = 0;
+	while (received < kBatchSize) {
+		timespec timeout = { 1, 0 };
+		ssize_t count = recvmmsg(receiver, messages + received,
+			kBatchSize - received, MSG_WAITFORONE, &timeout);
+		if (count <= 0) {
+			fprintf(stderr, "recvmmsg() failed after %d messages: %s\n",
+				received, strerror(errno));
+			return 1;
+		}
+		received += count;
+	}
+
+	for (int i = 0; i < kBatchSize; i++) {
+		char expected[kDatagramSize];
+		fill_datagram(expected, i);
+		if (messages[i].msg_len != kDatagramSize
+			|| memcmp(buffers[i], expected, kDatagramSize) != 0) {
+			fprintf(stderr, "message %d was not received correctly\n", i);
+			return 1;
+		}
+	}
+
+	// nothing else is queued, so this must time out
+	timespec timeout = { 0, 50000000 };
+	bigtime_t start = system_time();
+	ssize_t count = recvmmsg(receiver, messages, kBatchSize, 0, &timeout);
+	if (count != -1 || (errno != B_TIMED_OUT && errno != B_WOULD_BLOCK)) {
+		fprintf(stderr, "recvmmsg() did not time out: %zd, %s\n", count,
+			strerror(errno));
+		return 1;
+	}
+	if (system_time() - start < 40000) {
+		fprintf(stderr, "recvmmsg() returned too early\n");
+		return 1;
+	}
+
+	printf("sendmmsg()/recvmmsg(): ok\n");
+	return 0;
+}
+
+
+static int
+gro_test(int sender, int receiver, const sockaddr_in& address)
+{
+	int enable = 1;
+	if (setsockopt(receiver, IPPROTO_UDP, UDP_GRO, &enable, sizeof(enable))
+			!= 0) {
+		fail("setsockopt(UDP_GRO)");
+	}
+
+	static const int kSegments = 8;
+	char buffer[kSegments * kDatagramSize];
+	for (int i = 0; i < kSegments; i++) {
+		fill_datagram(buffer, i);
+		if (sendto(sender, buffer, kDatagramSize, 0, (sockaddr*)&address,
+				sizeof(address)) != (ssize_t)kDatagramSize) {
+			fail("sendto");
+		}
+	}
+
+	// give the stack the chance to queue all datagrams
+	snooze(10000);
+
+	iovec vec = { buffer, sizeof(buffer) };
+	char control[CMSG_SPACE(sizeof(int))];
+	msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = &vec;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	ssize_t bytesReceived = recvmsg(receiver, &message, 0);
+	if (bytesReceived != (ssize_t)sizeof(buffer)) {
+		fprintf(stderr, "expected %zu coalesced bytes, got %zd\n",
+			sizeof(buffer), bytesReceived);
+		return 1;
+	}
+
+	cmsghdr* header = CMSG_FIRSTHDR(&message);
+	if (header == NULL || header->cmsg_level != IPPROTO_UDP
+		|| header->cmsg_type != UDP_GRO
+		|| *(int*)CMSG_DATA(header) != (int)kDatagramSize) {
+		fprintf(stderr, "missing or wrong UDP_GRO control message\n");
+		return 1;
+	}
+
+	for (int i = 0; i < kSegments; i++) {
+		char expected[kDatagramSize];
+		fill_datagram(expected, i);
+		if (memcmp(buffer + i * kDatagramSize, expected, kDatagramSize) != 0) {
+			fprintf(stderr, "segment %d is corrupt\n", i);
+			return 1;
+		}
+	}
+
+	enable = 0;
+	setsockopt(receiver, IPPROTO_UDP, UDP_GRO, &enable, sizeof(enable));
+
+	printf("UDP_GRO: ok\n");
+	return 0;
+}
+
+
+static void
+benchmark(int sender, int receiver, const sockaddr_in& address, bool batched)
+{
+	char buffer[kDatagramSize];
+	memset(buffer, 'x', sizeof(buffer));
+	char receiveBuffers[kBatchSize][kDatagramSize];
+
+	iovec vecs[kBatchSize];
+	mmsghdr messages[kBatchSize];
+	memset(messages, 0, sizeof(messages));
+	for (int i = 0; i < kBatchSize; i++) {
+		messages[i].msg_hdr.msg_iov = &vecs[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	bigtime_t start = system_time();
+	int done = 0;
+	while (done < kBenchmarkDatagrams) {
+		// send one batch, and then receive it again, so that we never
+		// overflow the receive buffer
+		if (batched) {
+			for (int i = 0; i < kBatchSize; i++) {
+				vecs[i].iov_base = buffer;
+				vecs[i].iov_len = sizeof(buffer);
+				messages[i].msg_hdr.msg_name = (void*)&address;
+				messages[i].msg_hdr.msg_namelen = sizeof(address);
+			}
+			if (sendmmsg(sender, messages, kBatchSize, 0) != kBatchSize)
+				fail("sendmmsg");
+
+			for (int i = 0; i < kBatchSize; i++) {
+				vecs[i].iov_base = receiveBuffers[i];
+				messages[i].msg_hdr.msg_name = NULL;
+				messages[i].msg_hdr.msg_namelen = 0;
+			}
+			int received = 0;
+			while (received < kBatchSize) {
+				ssize_t count = recvmmsg(receiver, messages + received,
+					kBatchSize - received, MSG_WAITFORONE, NULL);
+				if (count <= 0)
+					fail("recvmmsg");
+				received += count;
+			}
+		} else {
+			for (int i = 0; i < kBatchSize; i++) {
+				if (sendto(sender, buffer, sizeof(buffer), 0,
+						(sockaddr*)&address, sizeof(address)) < 0) {
+					fail("sendto");
+				}
+			}
+			for (int i = 0; i < kBatchSize; i++) {
+				if (recv(receiver, receiveBuffers[i], kDatagramSize, 0) < 0)
+					fail("recv");
+			}
+		}
+
+		done += kBatchSize;
+	}
+
+	bigtime_t duration = system_time() - start;
+	printf("%-22s %8.0f datagrams/s\n",
+		batched ? "sendmmsg()/recvmmsg():" : "sendto()/recv():",
+		done * 1000000.0 / duration);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	sockaddr_in senderAddress;
+	sockaddr_in receiverAddress;
+	int sender = open_socket(senderAddress);
+	int receiver = open_socket(receiverAddress);
+
+	if (batch_test(sender, receiver, receiverAddress) != 0
+		|| gro_test(sender, receiver, receiverAddress) != 0) {
+		return 1;
+	}
+
+	benchmark(sender, receiver, receiverAddress, false);
+	benchmark(sender, receiver, receiverAddress, true);
+
+	close(sender);
+	close(receiver);
+	return 0;
+}
@@ -1,5 +1,6 @@
 /*
  * Copyright 2012, Axel Dörfler, axeld@pinc-software.de.
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
  * Distributed under the terms of the MIT License.
  */
 
@@ -7,6 +8,8 @@
 #include "fssh.h"
 
 #include "command_checkfs.h"
+#include "command_indexbench.h"
+#include "command_querybench.h"
 #include "command_resizefs.h"
 
 
@@ -18,6 +21,10 @@ register_additional_commands()
 {
 	CommandManager::Default()->AddCommand(command_checkfs, "checkfs",
 		"check file system");
+	CommandManager::Default()->AddCommand(command_indexbench, "indexbench",
+		"benchmark bulk indexing against rewriting attributes");
+	CommandManager::Default()->AddCommand(command_querybench, "querybench",
+		"benchmark queries with and without multi-index plans");
 	CommandManager::Default()->AddCommand(command_resizefs, "resizefs",
 		"resize file system");
 }
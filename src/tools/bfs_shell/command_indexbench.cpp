@@ -0,0 +1,301 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "command_indexbench.h"
+
+#include <stdlib.h>
+
+#include "fssh_fcntl.h"
+#include "fssh_stat.h"
+#include "fssh_stdio.h"
+#include "syscalls.h"
+
+#include "bfs.h"
+#include "bfs_control.h"
+
+
+namespace FSShell {
+
+
+static const char* kDirectory = "/myfs/indexbench";
+static const char* kRewriteIndex = "indexbench:rewrite";
+static const char* kBulkIndex = "indexbench:bulk";
+static const size_t kKeyLength = 16;
+
+
+struct bench_file {
+	fssh_ino_t	inode;
+	char		key[kKeyLength];
+};
+
+
+static int
+compare_files(const void* _a, const void* _b)
+{
+	const bench_file* a = (const bench_file*)_a;
+	const bench_file* b = (const bench_file*)_b;
+
+	int compare = strcmp(a->key, b->key);
+	if (compare != 0)
+		return compare;
+
+	return a->inode < b->inode ? -1 : a->inode > b->inode ? 1 : 0;
+}
+
+
+static fssh_status_t
+write_attribute(int fd, const char* name, const char* key)
+{
+	int attr = _kern_create_attr(fd, name, B_STRING_TYPE,
+		FSSH_O_WRONLY | FSSH_O_TRUNC);
+	if (attr < 0)
+		return attr;
+
+	fssh_ssize_t written = _kern_write(attr, 0, key, strlen(key) + 1);
+	_kern_close(attr);
+
+	return written < 0 ? written : B_OK;
+}
+
+
+static fssh_status_t
+read_attribute(int fd, const char* name, char* key)
+{
+	int attr = _kern_open_attr(fd, name, FSSH_O_RDONLY);
+	if (attr < 0)
+		return attr;
+
+	fssh_ssize_t bytesRead = _kern_read(attr, 0, key, kKeyLength);
+	_kern_close(attr);
+
+	if (bytesRead < 0)
+		return bytesRead;
+
+	key[kKeyLength - 1] = '\0';
+	return B_OK;
+}
+
+
+/*!	Creates \a count files in a fresh directory, each with a random key in
+	two attributes, one for each of the indices that are built afterwards.
+*/
+static fssh_status_t
+create_files(int32 count, bench_file* files)
+{
+	fssh_status_t status = _kern_create_dir(-1, kDirectory, 0755);
+	if (status != B_OK)
+		return status;
+
+	int dir = _kern_open_dir(-1, kDirectory);
+	if (dir < 0)
+		return dir;
+
+	uint32 seed = 0x12345678;
+	for (int32 i = 0; i < count && status == B_OK; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "file-%" B_PRId32, i);
+
+		int fd = _kern_open(dir, name, FSSH_O_RDWR | FSSH_O_CREAT, 0644);
+		if (fd < 0) {
+			status = fd;
+			break;
+		}
+
+		seed = seed * 1103515245 + 12345;
+		snprintf(files[i].key, kKeyLength, "%08" B_PRIx32, seed);
+
+		status = write_attribute(fd, kRewriteIndex, files[i].key);
+		if (status == B_OK)
+			status = write_attribute(fd, kBulkIndex, files[i].key);
+
+		struct fssh_stat st;
+		if (status == B_OK) {
+			status = _kern_read_stat(fd, NULL, false, &st,
+				sizeof(struct fssh_stat));
+		}
+		if (status == B_OK)
+			files[i].inode = st.fssh_st_ino;
+
+		_kern_close(fd);
+	}
+
+	_kern_close(dir);
+	return status;
+}
+
+
+/*!	Fills the index like reindex used to do it: every attribute is removed,
+	and written again, so that it is added to the index one by one.
+*/
+static fssh_status_t
+rewrite_attributes(int32 count)
+{
+	int dir = _kern_open_dir(-1, kDirectory);
+	if (dir < 0)
+		return dir;
+
+	fssh_status_t status = B_OK;
+	for (int32 i = 0; i < count && status == B_OK; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "file-%" B_PRId32, i);
+
+		int fd = _kern_open(dir, name, FSSH_O_RDWR, 0);
+		if (fd < 0) {
+			status = fd;
+			break;
+		}
+
+		char key[kKeyLength];
+		status = read_attribute(fd, kRewriteIndex, key);
+		if (status == B_OK)
+			status = _kern_remove_attr(fd, kRewriteIndex);
+		if (status == B_OK)
+			status = write_attribute(fd, kRewriteIndex, key);
+
+		_kern_close(fd);
+	}
+
+	_kern_close(dir);
+	return status;
+}
+
+
+/*!	Fills the index via BFS_IOCTL_BULK_INDEX, with the files sorted by their
+	keys, as reindex does it now.
+*/
+static fssh_status_t
+bulk_index(int32 count, bench_file* files)
+{
+	int dir = _kern_open_dir(-1, kDirectory);
+	if (dir < 0)
+		return dir;
+
+	fssh_status_t status = B_OK;
+	for (int32 i = 0; i < count && status == B_OK; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "file-%" B_PRId32, i);
+
+		int fd = _kern_open(dir, name, FSSH_O_RDONLY, 0);
+		if (fd < 0) {
+			status = fd;
+			break;
+		}
+
+		status = read_attribute(fd, kBulkIndex, files[i].key);
+		_kern_close(fd);
+	}
+	if (status != B_OK) {
+		_kern_close(dir);
+		return status;
+	}
+
+	qsort(files, count, sizeof(bench_file), &compare_files);
+
+	int64 inodes[BFS_BULK_INDEX_MAX_INODES];
+	for (int32 i = 0; i < count && status == B_OK;) {
+		uint32 batch = 0;
+		while (i < count && batch < BFS_BULK_INDEX_MAX_INODES)
+			inodes[batch++] = files[i++].inode;
+
+		bfs_bulk_index bulk;
+		bulk.name = kBulkIndex;
+		bulk.inodes = inodes;
+		bulk.count = batch;
+		bulk.flags = 0;
+		bulk.inserted = 0;
+		status = _kern_ioctl(dir, BFS_IOCTL_BULK_INDEX, &bulk, sizeof(bulk));
+		if (status == B_OK && bulk.inserted != batch)
+			status = B_ERROR;
+	}
+
+	_kern_close(dir);
+	return status;
+}
+
+
+static void
+print_result(fssh_dev_t volume, const char* name, const char* index,
+	bigtime_t time)
+{
+	struct fssh_stat st;
+	fssh_off_t size = 0;
+	if (_kern_read_index_stat(volume, index, &st) == B_OK)
+		size = st.fssh_st_size;
+
+	fssh_dprintf("  %-9s %10" B_PRId64 " usecs, index size %8" B_PRIdOFF
+		" bytes\n", name, time, size);
+}
+
+
+/*!	Creates a number of files with indexed attributes, and compares how long
+	it takes to add them to an index one by one, and in bulk, and how large
+	the resulting index becomes.
+*/
+fssh_status_t
+command_indexbench(int argc, const char* const* argv)
+{
+	int32 count = 10000;
+	if (argc == 3 && !strcmp(argv[1], "-n")) {
+		if (fssh_sscanf(argv[2], "%" B_SCNd32, &count) < 1)
+			count = 0;
+	} else if (argc != 1)
+		count = 0;
+
+	if (count <= 0) {
+		fssh_dprintf("Usage: %s [-n <files>]\n"
+			"Compares adding files to an index by rewriting their attributes,\n"
+			"and via bulk indexing.\n", argv[0]);
+		return B_BAD_VALUE;
+	}
+
+	struct fssh_stat st;
+	fssh_status_t status = _kern_read_stat(-1, "/myfs", false, &st,
+		sizeof(st));
+	if (status != B_OK) {
+		fssh_dprintf("Error: Couldn't stat root directory\n");
+		return status;
+	}
+	fssh_dev_t volume = st.fssh_st_dev;
+
+	bench_file* files = (bench_file*)malloc(count * sizeof(bench_file));
+	if (files == NULL)
+		return B_NO_MEMORY;
+
+	fssh_dprintf("Creating %" B_PRId32 " files...\n", count);
+	status = create_files(count, files);
+
+	bigtime_t rewriteTime = 0;
+	if (status == B_OK) {
+		bigtime_t start = system_time();
+		status = _kern_create_index(volume, kRewriteIndex, B_STRING_TYPE, 0);
+		if (status == B_OK)
+			status = rewrite_attributes(count);
+		rewriteTime = system_time() - start;
+	}
+
+	bigtime_t bulkTime = 0;
+	if (status == B_OK) {
+		bigtime_t start = system_time();
+		status = _kern_create_index(volume, kBulkIndex, B_STRING_TYPE, 0);
+		if (status == B_OK)
+			status = bulk_index(count, files);
+		bulkTime = system_time() - start;
+	}
+
+	free(files);
+
+	if (status != B_OK) {
+		fssh_dprintf("Error: %s\n", fssh_strerror(status));
+		return status;
+	}
+
+	print_result(volume, "rewrite:", kRewriteIndex, rewriteTime);
+	print_result(volume, "bulk:", kBulkIndex, bulkTime);
+	return B_OK;
+}
+
+
+}	// namespace FSShell
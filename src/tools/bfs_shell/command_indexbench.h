@@ -0,0 +1,21 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef COMMAND_INDEXBENCH_H
+#define COMMAND_INDEXBENCH_H
+
+
+#include "fssh_types.h"
+
+
+namespace FSShell {
+
+
+fssh_status_t command_indexbench(int argc, const char* const* argv);
+
+
+}	// namespace FSShell
+
+
+#endif	// COMMAND_INDEXBENCH_H
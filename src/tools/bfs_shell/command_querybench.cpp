@@ -0,0 +1,127 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "command_querybench.h"
+
+#include "fssh_dirent.h"
+#include "fssh_stat.h"
+#include "fssh_stdio.h"
+#include "syscalls.h"
+
+#include "bfs.h"
+
+#include <query_private.h>
+
+
+namespace FSShell {
+
+
+/*!	Runs the query once with the given \a flags, and returns the number of
+	entries it found, and the time it took.
+*/
+static fssh_status_t
+run_query(fssh_dev_t volume, const char* query, uint32 flags,
+	int32& _entries, bigtime_t& _time)
+{
+	bigtime_t start = system_time();
+
+	int fd = _kern_open_query(volume, query, strlen(query), flags, -1, -1);
+	if (fd < 0)
+		return fd;
+
+	char buffer[sizeof(fssh_dirent) + B_FILE_NAME_LENGTH];
+	fssh_dirent* entry = (fssh_dirent*)buffer;
+	int32 entries = 0;
+	fssh_ssize_t entriesRead;
+	while ((entriesRead = _kern_read_dir(fd, entry, sizeof(buffer), 1)) == 1)
+		entries++;
+
+	_kern_close(fd);
+
+	if (entriesRead < 0)
+		return entriesRead;
+
+	_entries = entries;
+	_time = system_time() - start;
+	return B_OK;
+}
+
+
+static fssh_status_t
+benchmark_query(fssh_dev_t volume, const char* query, uint32 flags,
+	int32 iterations, const char* name)
+{
+	int32 entries = 0;
+	bigtime_t total = 0;
+	bigtime_t best = B_INFINITE_TIMEOUT;
+
+	for (int32 i = 0; i < iterations; i++) {
+		bigtime_t time;
+		fssh_status_t status = run_query(volume, query, flags, entries, time);
+		if (status != B_OK) {
+			fssh_dprintf("Query failed: %s\n", fssh_strerror(status));
+			return status;
+		}
+
+		total += time;
+		if (time < best)
+			best = time;
+	}
+
+	fssh_dprintf("  %-13s %8" B_PRId32 " entries, %10" B_PRId64 " usecs "
+		"average, %10" B_PRId64 " usecs best\n", name, entries,
+		total / iterations, best);
+	return B_OK;
+}
+
+
+/*!	Runs queries repeatedly using all indices the query planner can make use
+	of, and using only the single best index, and prints how long they took.
+*/
+fssh_status_t
+command_querybench(int argc, const char* const* argv)
+{
+	int32 iterations = 10;
+	int argi = 1;
+	if (argi + 1 < argc && !strcmp(argv[argi], "-i")) {
+		if (fssh_sscanf(argv[argi + 1], "%" B_SCNd32, &iterations) < 1)
+			iterations = 0;
+		argi += 2;
+	}
+
+	if (argi >= argc || iterations <= 0) {
+		fssh_dprintf("Usage: %s [-i <iterations>] <query> ...\n"
+			"Runs each query with and without multi-index query plans.\n",
+			argv[0]);
+		return B_BAD_VALUE;
+	}
+
+	struct fssh_stat st;
+	fssh_status_t status = _kern_read_stat(-1, "/myfs", false, &st,
+		sizeof(st));
+	if (status != B_OK) {
+		fssh_dprintf("Error: Couldn't stat root directory\n");
+		return status;
+	}
+
+	for (; argi < argc; argi++) {
+		fssh_dprintf("%s\n", argv[argi]);
+
+		status = benchmark_query(st.fssh_st_dev, argv[argi], 0, iterations,
+			"multi-index:");
+		if (status == B_OK) {
+			status = benchmark_query(st.fssh_st_dev, argv[argi],
+				B_QUERY_SINGLE_INDEX, iterations, "single index:");
+		}
+		if (status != B_OK)
+			return status;
+	}
+
+	return B_OK;
+}
+
+
+}	// namespace FSShell
@@ -0,0 +1,21 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef COMMAND_QUERYBENCH_H
+#define COMMAND_QUERYBENCH_H
+
+
+#include "fssh_types.h"
+
+
+namespace FSShell {
+
+
+fssh_status_t command_querybench(int argc, const char* const* argv);
+
+
+}	// namespace FSShell
+
+
+#endif	// COMMAND_QUERYBENCH_H